@@ -32,9 +32,9 @@
 #include <zephyr/pm/device.h>
 #include <zephyr/pm/policy.h>
 
-LOG_MODULE_REGISTER(gc9a01, CONFIG_DISPLAY_LOG_LEVEL);
+#include "buydisplay_gc9a01.h"
 
-#define GC9A01_SPI_PROFILING
+LOG_MODULE_REGISTER(gc9a01, CONFIG_DISPLAY_LOG_LEVEL);
 
 /**
  * gc9a01 display controller driver.
@@ -62,6 +62,7 @@ LOG_MODULE_REGISTER(gc9a01, CONFIG_DISPLAY_LOG_LEVEL);
 #define GC9A01A_MADCTL 0x36   ///< Memory Access Control
 #define GC9A01A_VSCRSADD 0x37 ///< Vertical Scrolling Start Address
 #define GC9A01A_PIXFMT 0x3A   ///< COLMOD: Pixel Format Set
+#define GC9A01A_TESCAN 0x44   ///< Set Tear Scanline
 
 #define GC9A01A1_DFUNCTR 0xB6 ///< Display Function Control
 
@@ -95,6 +96,12 @@ LOG_MODULE_REGISTER(gc9a01, CONFIG_DISPLAY_LOG_LEVEL);
 
 #define DISPLAY_WIDTH         DT_INST_PROP(0, width)
 #define DISPLAY_HEIGHT        DT_INST_PROP(0, height)
+#define DISPLAY_FRAME_BYTES   (DISPLAY_WIDTH * DISPLAY_HEIGHT * 16 / 8)
+
+#define BUS_TIMEOUT_MS        500
+
+// Slowest panel refresh the tearing effect period is measured from.
+#define TE_MAX_PERIOD_US      100000
 
 // Command codes:
 #define COL_ADDR_SET        0x2A
@@ -167,7 +174,8 @@ static const uint8_t initcmd[] = {
     0x67, 10, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x01, 0x54, 0x10, 0x32, 0x98,
     0x74, 7, 0x10, 0x85, 0x80, 0x00, 0x00, 0x4E, 0x00,
     0x98, 2, 0x3e, 0x07,
-    GC9A01A_TEON, 1, GC9A01A_INVOFF,
+    GC9A01A_TEON, 1, 0x00, // TE pulse on V-blank only
+    GC9A01A_TESCAN, 2, 0x00, 0x00, // at scanline 0
     GC9A01A_INVON, 0,
     GC9A01A_DISPON, 0x80, // Display on
     GC9A01A_SLPOUT, 0x80, // Exit sleep
@@ -179,6 +187,7 @@ struct gc9a01_config {
     struct gpio_dt_spec dc_gpio;
     struct gpio_dt_spec bl_gpio;
     struct gpio_dt_spec reset_gpio;
+    struct gpio_dt_spec te_gpio;
 };
 
 struct gc9a01_point {
@@ -189,14 +198,372 @@ struct gc9a01_frame {
     struct gc9a01_point start, end;
 };
 
+// Address window last sent to the controller, valid until it is reset.
 static struct gc9a01_frame frame = {{0, 0}, {DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1}};
+static bool frame_valid;
+// Row the controller writes next, right below the last area.
+static uint16_t next_row;
+static bool bus_resumed;
+// From the first until the last area of an LVGL refresh, the bus stays resumed meanwhile.
+static bool session_active;
+// Chip select is held and the bus locked from the first command of a session until suspend.
+static bool cs_held;
+static struct gc9a01_bus_stats stats;
+static const struct spi_config seq_config = SPI_CONFIG_DT_INST(0, SPI_OP_MODE_MASTER | SPI_WORD_SET(8) |
+                                                               SPI_HOLD_ON_CS | SPI_LOCK_ON, 0);
+
+#ifdef CONFIG_GC9A01_ASYNC_WRITE
+static void bus_suspend_work_handler(struct k_work *work);
+
+// Held while the bus is in use, by the pixel data transfer until it completes.
+static K_SEM_DEFINE(bus_sem, 1, 1);
+static K_WORK_DEFINE(bus_suspend_work, bus_suspend_work_handler);
+// The SPI driver walks the buffer set during the transfer, must outlive gc9a01_write.
+static struct spi_buf pixel_buf;
+static const struct spi_buf_set pixel_buf_set = {.buffers = &pixel_buf, .count = 1};
+#endif
+
+#ifdef CONFIG_GC9A01_PROFILING
+// The transfer completion updates the profile from the SPI interrupt with CONFIG_GC9A01_ASYNC_WRITE.
+static struct k_spinlock profile_lock;
+static struct {
+    bool in_frame;
+    bool frame_last;
+    uint32_t frame_start;
+    uint32_t transfer_start;
+    uint32_t bytes;
+    uint32_t wire_ns;
+    uint32_t stall_ns;
+} profile;
+
+static void profile_write_begin(uint16_t x, uint16_t y)
+{
+    k_spinlock_key_t key;
+
+    if (x == 0 && y == 0) {
+        key = k_spin_lock(&profile_lock);
+        profile.in_frame = true;
+        profile.frame_start = k_cycle_get_32();
+        profile.bytes = 0;
+        profile.wire_ns = 0;
+        profile.stall_ns = 0;
+        k_spin_unlock(&profile_lock, key);
+    }
+}
+
+static void profile_transfer_start(size_t len, uint16_t x_end, uint16_t y_end)
+{
+    k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+    profile.transfer_start = k_cycle_get_32();
+    profile.bytes += len;
+    profile.frame_last = (x_end == DISPLAY_WIDTH - 1) && (y_end == DISPLAY_HEIGHT - 1);
+    k_spin_unlock(&profile_lock, key);
+}
+
+/*
+* Time the display write was blocked while the bus was busy, rendering could not continue meanwhile.
+*/
+static void profile_add_stall(uint32_t start)
+{
+    k_spinlock_key_t key = k_spin_lock(&profile_lock);
+
+    profile.stall_ns += k_cyc_to_ns_ceil32(k_cycle_get_32() - start);
+    k_spin_unlock(&profile_lock, key);
+}
+
+static void profile_transfer_done(void)
+{
+    uint32_t now = k_cycle_get_32();
+    k_spinlock_key_t key = k_spin_lock(&profile_lock);
+    uint32_t bytes = profile.bytes;
+    uint32_t wire_ns;
+    uint32_t frame_us;
+    uint32_t overlap;
+
+    profile.wire_ns += k_cyc_to_ns_ceil32(now - profile.transfer_start);
+    wire_ns = profile.wire_ns;
+    if (!profile.in_frame || !profile.frame_last) {
+        k_spin_unlock(&profile_lock, key);
+        return;
+    }
+
+    profile.in_frame = false;
+    frame_us = k_cyc_to_us_ceil32(now - profile.frame_start);
+    overlap = wire_ns - MIN(profile.stall_ns, wire_ns);
+    k_spin_unlock(&profile_lock, key);
+
+    if (bytes < DISPLAY_FRAME_BYTES) {
+        // Partial redraw, only full screen redraws are comparable.
+        return;
+    }
+
+    LOG_INF("Full redraw: %u B in %u us (%u.%u fps), SPI %u us, %u%% overlapped with rendering",
+            bytes, frame_us, 1000000 / frame_us, (10000000 / frame_us) % 10, wire_ns / 1000,
+            (uint32_t)((uint64_t)overlap * 100 / MAX(wire_ns, 1)));
+}
+#else
+static inline void profile_write_begin(uint16_t x, uint16_t y) {}
+static inline void profile_transfer_start(size_t len, uint16_t x_end, uint16_t y_end) {}
+static inline void profile_add_stall(uint32_t start) {}
+static inline void profile_transfer_done(void) {}
+#endif
+
+#ifdef CONFIG_GC9A01_TE
+static struct gpio_callback te_cb;
+static bool te_cb_added;
+static bool te_gate = true;
+// Start of the last panel refresh and the refresh period, 0 until measured.
+static volatile uint32_t te_last_cycles;
+static volatile uint32_t te_period_cycles;
+
+static void gc9a01_te_isr(const struct device *port, struct gpio_callback *cb, gpio_port_pins_t pins)
+{
+    uint32_t now = k_cycle_get_32();
+    uint32_t period = now - te_last_cycles;
+    uint32_t prev_period = te_period_cycles;
+
+    te_last_cycles = now;
+    stats.te_count++;
+
+    if (period > k_us_to_cyc_ceil32(TE_MAX_PERIOD_US)) {
+        // First pulse after the display woke up.
+        return;
+    }
+    if (prev_period == 0) {
+        te_period_cycles = period;
+    } else if (period < prev_period * 3 / 2) {
+        // Smooth the jitter, a missed pulse is left out.
+        te_period_cycles = (prev_period * 3 + period) / 4;
+    }
+}
+
+static void gc9a01_te_enable(const struct device *dev, bool enable)
+{
+    const struct gc9a01_config *config = dev->config;
+
+    te_period_cycles = 0;
+    gpio_pin_interrupt_configure_dt(&config->te_gpio, enable ? GPIO_INT_EDGE_TO_ACTIVE : GPIO_INT_DISABLE);
+}
+
+static int gc9a01_te_init(const struct device *dev)
+{
+    const struct gc9a01_config *config = dev->config;
+    int rc;
+
+    if (!device_is_ready(config->te_gpio.port)) {
+        LOG_ERR("TE GPIO device not ready");
+        return -ENODEV;
+    }
+
+    rc = gpio_pin_configure_dt(&config->te_gpio, GPIO_INPUT);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (!te_cb_added) {
+        gpio_init_callback(&te_cb, gc9a01_te_isr, BIT(config->te_gpio.pin));
+        rc = gpio_add_callback_dt(&config->te_gpio, &te_cb);
+        if (rc != 0) {
+            return rc;
+        }
+        te_cb_added = true;
+    }
 
+    gc9a01_te_enable(dev, true);
+
+    return 0;
+}
+
+static uint32_t gc9a01_te_since_us(uint32_t period_us)
+{
+    return k_cyc_to_us_floor32(k_cycle_get_32() - te_last_cycles) % period_us;
+}
+
+/*
+* Wait until writing the area cannot cross the scanline. The panel scans top to bottom once
+* per period, the write follows right behind the scanline as it passes the top of the area,
+* and must neither overtake it nor be lapped by it before the last row is sent.
+*/
+static void gc9a01_te_wait_for_scanline(const struct device *dev, uint16_t y, uint16_t height, size_t len)
+{
+    const struct gc9a01_config *config = dev->config;
+    uint32_t period_us = k_cyc_to_us_floor32(te_period_cycles);
+    int32_t wire_us;
+    int32_t area_us;
+    int32_t lo;
+    int32_t hi;
+    int32_t lead;
+
+    if (!te_gate || height < CONFIG_GC9A01_TE_MIN_ROWS || period_us == 0) {
+        return;
+    }
+
+    wire_us = (int32_t)((uint64_t)len * 8 * USEC_PER_SEC / config->bus.config.frequency);
+    area_us = (int32_t)((uint64_t)height * period_us / DISPLAY_HEIGHT);
+    // How far the scanline may be past the top of the area when the write starts.
+    lo = MAX(0, area_us - wire_us) + period_us / DISPLAY_HEIGHT;
+    hi = (int32_t)period_us - MAX(0, wire_us - area_us);
+    if (lo >= hi) {
+        // Longer than a refresh, tears wherever it starts.
+        return;
+    }
+
+    lead = (int32_t)gc9a01_te_since_us(period_us) - (int32_t)((uint64_t)y * period_us / DISPLAY_HEIGHT);
+    lead = (lead + (int32_t)period_us) % (int32_t)period_us;
+    if (lead < lo || lead >= hi) {
+        stats.te_waits++;
+        k_sleep(K_USEC((lo - lead + (int32_t)period_us) % (int32_t)period_us));
+    }
+}
+
+uint32_t gc9a01_te_get_period_us(const struct device *dev)
+{
+    return k_cyc_to_us_floor32(te_period_cycles);
+}
+
+uint32_t gc9a01_te_align(const struct device *dev, uint32_t delay_us)
+{
+    uint32_t period_us = k_cyc_to_us_floor32(te_period_cycles);
+    uint32_t since_us;
+
+    if (period_us == 0) {
+        return delay_us;
+    }
+
+    since_us = gc9a01_te_since_us(period_us);
+    return DIV_ROUND_UP(since_us + delay_us, period_us) * period_us - since_us;
+}
+
+uint32_t gc9a01_te_get_slot_us(const struct device *dev, uint32_t min_period_us)
+{
+    uint32_t period_us = k_cyc_to_us_floor32(te_period_cycles);
+
+    if (period_us == 0) {
+        return 0;
+    }
+
+    return DIV_ROUND_UP(min_period_us, period_us) * period_us;
+}
+
+int gc9a01_te_set_gate(const struct device *dev, bool enable)
+{
+    te_gate = enable;
+
+    return 0;
+}
+#else
+static inline int gc9a01_te_init(const struct device *dev)
+{
+    return 0;
+}
+
+static inline void gc9a01_te_enable(const struct device *dev, bool enable) {}
+static inline void gc9a01_te_wait_for_scanline(const struct device *dev, uint16_t y, uint16_t height,
+                                               size_t len) {}
+#endif
+
+/*
+* Wait for the bus, a pending pixel data transfer must complete before the next command.
+*/
+static int gc9a01_bus_acquire(const struct device *dev)
+{
+#ifdef CONFIG_GC9A01_ASYNC_WRITE
+    if (k_sem_take(&bus_sem, K_MSEC(BUS_TIMEOUT_MS)) != 0) {
+        LOG_ERR("Timeout waiting for the previous transfer");
+        return -ETIMEDOUT;
+    }
+#endif
+    return 0;
+}
+
+static void gc9a01_bus_release(const struct device *dev)
+{
+#ifdef CONFIG_GC9A01_ASYNC_WRITE
+    k_sem_give(&bus_sem);
+#endif
+}
+
+static void gc9a01_bus_resume(const struct device *dev)
+{
+    const struct gc9a01_config *config = dev->config;
+    int rc;
+
+    if (!bus_resumed) {
+        rc = pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_RESUME);
+        __ASSERT(rc == 0 || rc == -EALREADY || rc == -ENOSYS, "Failed resume SPI Bus");
+        bus_resumed = true;
+        stats.pm_transitions++;
+    }
+}
+
+/*
+* Ends the held chip select, the next command starts a new SPI transaction.
+*/
+static void gc9a01_cs_release(const struct device *dev)
+{
+    const struct gc9a01_config *config = dev->config;
+
+    if (cs_held) {
+        spi_release(config->bus.bus, &seq_config);
+        cs_held = false;
+    }
+}
+
+static void gc9a01_bus_suspend(const struct device *dev)
+{
+    const struct gc9a01_config *config = dev->config;
+    int rc;
+
+    gc9a01_cs_release(dev);
+    if (bus_resumed) {
+        rc = pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_SUSPEND);
+        __ASSERT(rc == 0 || rc == -EALREADY || rc == -ENOSYS, "Failed suspend SPI Bus");
+        bus_resumed = false;
+        stats.pm_transitions++;
+    }
+}
+
+#ifdef CONFIG_GC9A01_ASYNC_WRITE
+static void bus_suspend_work_handler(struct k_work *work)
+{
+    const struct device *dev = DEVICE_DT_INST_GET(0);
+
+    // Leave the bus resumed if the next write already started or more areas of the frame follow.
+    if (k_sem_take(&bus_sem, K_NO_WAIT) == 0) {
+        if (!session_active) {
+            gc9a01_bus_suspend(dev);
+        }
+        k_sem_give(&bus_sem);
+    }
+}
+
+static void gc9a01_pixel_data_done(const struct device *spi_dev, int result, void *data)
+{
+    if (result != 0) {
+        LOG_ERR("Failed sending pixel data: %d", result);
+    }
+    profile_transfer_done();
+    k_sem_give(&bus_sem);
+    k_work_submit(&bus_suspend_work);
+}
+#endif
+
+/*
+* Standalone command in its own SPI transactions, ends a held chip select first. The address
+* window is sent again with the next area, sleep and display on/off may not keep it.
+*/
 static inline int gc9a01_write_cmd(const struct device *dev, uint8_t cmd,
                                    const uint8_t *data, size_t len)
 {
     const struct gc9a01_config *config = dev->config;
     struct spi_buf buf = {.buf = &cmd, .len = sizeof(cmd)};
     struct spi_buf_set buf_set = {.buffers = &buf, .count = 1};
+
+    gc9a01_cs_release(dev);
+    frame_valid = false;
+    stats.transactions++;
+    stats.cmd_bytes += sizeof(cmd);
     gpio_pin_set_dt(&config->dc_gpio, 0);
     if (spi_write_dt(&config->bus, &buf_set) != 0) {
         LOG_ERR("Failed sending data");
@@ -206,6 +573,8 @@ static inline int gc9a01_write_cmd(const struct device *dev, uint8_t cmd,
     if (data != NULL && len != 0) {
         buf.buf = (void *)data;
         buf.len = len;
+        stats.transactions++;
+        stats.cmd_bytes += len;
         gpio_pin_set_dt(&config->dc_gpio, 1);
         if (spi_write_dt(&config->bus, &buf_set) != 0) {
             LOG_ERR("Failed sending data");
@@ -216,31 +585,109 @@ static inline int gc9a01_write_cmd(const struct device *dev, uint8_t cmd,
     return 0;
 }
 
-static void gc9a01_set_frame(const struct device *dev, struct gc9a01_frame frame)
+/*
+* Command and parameters sent while chip select is held, only the first command of a session
+* asserts it and locks the bus.
+*/
+static int gc9a01_write_seq(const struct device *dev, uint8_t cmd, const uint8_t *data, size_t len)
+{
+    const struct gc9a01_config *config = dev->config;
+    struct spi_buf buf = {.buf = &cmd, .len = sizeof(cmd)};
+    struct spi_buf_set buf_set = {.buffers = &buf, .count = 1};
+
+    if (!cs_held) {
+        cs_held = true;
+        stats.transactions++;
+    }
+    stats.cmd_bytes += sizeof(cmd) + len;
+
+    gpio_pin_set_dt(&config->dc_gpio, 0);
+    if (spi_write(config->bus.bus, &seq_config, &buf_set) != 0) {
+        LOG_ERR("Failed sending data");
+        return -EIO;
+    }
+
+    if (data != NULL && len != 0) {
+        buf.buf = (void *)data;
+        buf.len = len;
+        gpio_pin_set_dt(&config->dc_gpio, 1);
+        if (spi_write(config->bus.bus, &seq_config, &buf_set) != 0) {
+            LOG_ERR("Failed sending data");
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+/*
+* Standalone command, waits for a pending pixel data transfer.
+*/
+static int gc9a01_send_cmd(const struct device *dev, uint8_t cmd)
+{
+    int rc = gc9a01_bus_acquire(dev);
+
+    if (rc != 0) {
+        return rc;
+    }
+    gc9a01_bus_resume(dev);
+    rc = gc9a01_write_cmd(dev, cmd, NULL, 0);
+    if (!session_active) {
+        gc9a01_bus_suspend(dev);
+    }
+    gc9a01_bus_release(dev);
+
+    return rc;
+}
+
+/*
+* Point the controller at an area, CASET and RASET are left out when they would not change
+* the window. Returns the memory write command to start the pixel data with.
+*/
+static uint8_t gc9a01_set_frame(const struct device *dev, uint16_t x, uint16_t x_end, uint16_t y)
 {
     uint8_t data[4];
+    bool same_columns = frame_valid && frame.start.X == x && frame.end.X == x_end;
 
-    data[0] = (frame.start.X >> 8) & 0xFF;
-    data[1] = frame.start.X & 0xFF;
-    data[2] = (frame.end.X >> 8) & 0xFF;
-    data[3] = frame.end.X & 0xFF;
-    gc9a01_write_cmd(dev, COL_ADDR_SET, data, sizeof(data));
+    if (same_columns && y == next_row) {
+        // Right below the previous area, the controller continues where it stopped.
+        stats.window_skips += 2;
+        return MEM_WR_CONT;
+    }
 
+    if (same_columns) {
+        stats.window_skips++;
+    } else {
+        frame.start.X = x;
+        frame.end.X = x_end;
+        data[0] = (frame.start.X >> 8) & 0xFF;
+        data[1] = frame.start.X & 0xFF;
+        data[2] = (frame.end.X >> 8) & 0xFF;
+        data[3] = frame.end.X & 0xFF;
+        gc9a01_write_seq(dev, COL_ADDR_SET, data, sizeof(data));
+    }
+
+    // Open down to the last row, so an area below with the same columns can continue.
+    frame.start.Y = y;
+    frame.end.Y = DISPLAY_HEIGHT - 1;
     data[0] = (frame.start.Y >> 8) & 0xFF;
     data[1] = frame.start.Y & 0xFF;
     data[2] = (frame.end.Y >> 8) & 0xFF;
     data[3] = frame.end.Y & 0xFF;
-    gc9a01_write_cmd(dev, ROW_ADDR_SET, data, sizeof(data));
+    gc9a01_write_seq(dev, ROW_ADDR_SET, data, sizeof(data));
+    frame_valid = true;
+
+    return MEM_WR;
 }
 
 static int gc9a01_blanking_off(const struct device *dev)
 {
-    return gc9a01_write_cmd(dev, GC9A01A_DISPON, NULL, 0);
+    return gc9a01_send_cmd(dev, GC9A01A_DISPON);
 }
 
 static int gc9a01_blanking_on(const struct device *dev)
 {
-    return gc9a01_write_cmd(dev, GC9A01A_DISPOFF, NULL, 0);
+    return gc9a01_send_cmd(dev, GC9A01A_DISPOFF);
 }
 
 static int gc9a01_write(const struct device *dev, const uint16_t x, const uint16_t y,
@@ -248,37 +695,74 @@ static int gc9a01_write(const struct device *dev, const uint16_t x, const uint16
                         const void *buf)
 {
     const struct gc9a01_config *config = dev->config;
-    __ASSERT(pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_RESUME) == 0, "Failed resume SPI Bus");
-#ifdef GC9A01_SPI_PROFILING
-    uint32_t start_time;
-    uint32_t stop_time;
-    uint32_t cycles_spent;
-    uint32_t nanoseconds_spent;
-#endif
     uint16_t x_end_idx = x + desc->width - 1;
     uint16_t y_end_idx = y + desc->height - 1;
+    size_t len = desc->width * desc->height * 16 / 8;
+    uint32_t wait_start = k_cycle_get_32();
+    uint8_t mem_wr;
+    int rc;
 
-    frame.start.X = x;
-    frame.end.X = x_end_idx;
-    frame.start.Y = y;
-    frame.end.Y = y_end_idx;
-    gc9a01_set_frame(dev, frame);
+    profile_write_begin(x, y);
+    rc = gc9a01_bus_acquire(dev);
+    if (rc != 0) {
+        return rc;
+    }
+#ifdef CONFIG_GC9A01_ASYNC_WRITE
+    profile_add_stall(wait_start);
+#endif
+    gc9a01_te_wait_for_scanline(dev, y, desc->height, len);
+    gc9a01_bus_resume(dev);
+
+    // LVGL clears frame_incomplete on the last area of a refresh, which ends the session.
+    session_active = desc->frame_incomplete;
+    stats.writes++;
+    stats.pixel_bytes += len;
+    if (!session_active) {
+        stats.frames++;
+    }
 
-    size_t len = (x_end_idx + 1 - x) * (y_end_idx + 1 - y) * 16 / 8;
-    //printk("x_start: %d, y_start: %d, x_end: %d, y_end: %d, buf_size: %d, pitch: %d len: %d\n", x, y, x_end_idx, y_end_idx, desc->buf_size, desc->pitch, len);
+    mem_wr = gc9a01_set_frame(dev, x, x_end_idx, y);
+    next_row = y_end_idx + 1;
+
+    profile_transfer_start(len, x_end_idx, y_end_idx);
+    rc = gc9a01_write_seq(dev, mem_wr, NULL, 0);
+    gpio_pin_set_dt(&config->dc_gpio, 1);
+#ifdef CONFIG_GC9A01_ASYNC_WRITE
+    pixel_buf.buf = (void *)buf;
+    pixel_buf.len = len;
+    // Returns as soon as the transfer is started, the bus is released from the completion and suspended after the frame.
+    if (rc == 0) {
+        rc = spi_transceive_cb(config->bus.bus, &seq_config, &pixel_buf_set, NULL, gc9a01_pixel_data_done, NULL);
+    }
+    if (rc != 0) {
+        LOG_ERR("Failed starting pixel data transfer: %d", rc);
+        frame_valid = false;
+        session_active = false;
+        gc9a01_bus_suspend(dev);
+        gc9a01_bus_release(dev);
+    }
+#else
+    struct spi_buf pixel_buf = {.buf = (void *)buf, .len = len};
+    struct spi_buf_set pixel_buf_set = {.buffers = &pixel_buf, .count = 1};
 
-#ifdef GC9A01_SPI_PROFILING
-    start_time = k_cycle_get_32();
-#endif
-    gc9a01_write_cmd(dev, GC9A01A_RAMWR, buf, len);
-#ifdef GC9A01_SPI_PROFILING
-    stop_time = k_cycle_get_32();
-    cycles_spent = stop_time - start_time;
-    nanoseconds_spent = k_cyc_to_ns_ceil32(cycles_spent);
-    LOG_DBG("%d =>: %dns", len, nanoseconds_spent);
+    if (rc == 0 && spi_write(config->bus.bus, &seq_config, &pixel_buf_set) != 0) {
+        LOG_ERR("Failed sending pixel data");
+        rc = -EIO;
+    }
+    profile_transfer_done();
+    // Blocked for the whole transfer.
+    profile_add_stall(wait_start);
+    if (rc != 0) {
+        frame_valid = false;
+        session_active = false;
+    }
+    if (!session_active) {
+        gc9a01_bus_suspend(dev);
+    }
+    gc9a01_bus_release(dev);
 #endif
-    __ASSERT(pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_SUSPEND) == 0, "Failed suspend SPI Bus");
-    return 0;
+
+    return rc;
 }
 
 static int gc9a01_read(const struct device *dev, const uint16_t x, const uint16_t y,
@@ -334,7 +818,6 @@ static int gc9a01_set_pixel_format(const struct device *dev,
 
 static int gc9a01_controller_init(const struct device *dev)
 {
-    int rc;
     int i = 0;
     uint8_t cmd, x, numArgs;
     const uint8_t *addr;
@@ -345,8 +828,9 @@ static int gc9a01_controller_init(const struct device *dev)
     k_msleep(5);
     gpio_pin_set_dt(&config->reset_gpio, 1);
     k_msleep(150);
-    rc = pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_RESUME);
-    __ASSERT(rc == -EALREADY || rc == 0, "Failed resume SPI Bus");
+    gc9a01_bus_resume(dev);
+    // The reset cleared the address window.
+    frame_valid = false;
 
     addr = initcmd;
     while ((cmd = *addr++) > 0) {
@@ -360,13 +844,15 @@ static int gc9a01_controller_init(const struct device *dev)
         i++;
     }
 
-    __ASSERT(pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_SUSPEND) == 0, "Failed suspend SPI Bus");
+    gc9a01_bus_suspend(dev);
     return 0;
 }
 
 static int gc9a01_init(const struct device *dev)
 {
     const struct gc9a01_config *config = dev->config;
+    int rc;
+
     LOG_DBG("");
 
     if (!device_is_ready(config->reset_gpio.port)) {
@@ -388,23 +874,37 @@ static int gc9a01_init(const struct device *dev)
 
     // Default to 0 brightness
     gpio_pin_configure_dt(&config->bl_gpio, GPIO_OUTPUT_INACTIVE);
-    return gc9a01_controller_init(dev);
+    rc = gc9a01_controller_init(dev);
+    if (rc != 0) {
+        return rc;
+    }
+
+    return gc9a01_te_init(dev);
 }
 
 static int gc9a01_pm_action(const struct device *dev,
                             enum pm_device_action action)
 {
-    int err = 0;
-    const struct gc9a01_config *config = dev->config;
-    __ASSERT(pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_RESUME) == 0, "Failed resume SPI Bus");
+    int err = gc9a01_bus_acquire(dev);
+
+    if (err != 0) {
+        return err;
+    }
+    gc9a01_bus_resume(dev);
 
     switch (action) {
         case PM_DEVICE_ACTION_RESUME:
+            frame_valid = false;
             err = gc9a01_write_cmd(dev, GC9A01A_SLPOUT, NULL, 0);
             k_msleep(5); // According to datasheet wait 5ms after SLPOUT before next command.
             err = gc9a01_write_cmd(dev, GC9A01A_DISPON, NULL, 0);
+            gc9a01_te_enable(dev, true);
             break;
         case PM_DEVICE_ACTION_SUSPEND:
+            session_active = false;
+            frame_valid = false;
+            // No pulses while sleeping, and no interrupt every refresh either.
+            gc9a01_te_enable(dev, false);
             err = gc9a01_write_cmd(dev, GC9A01A_DISPOFF, NULL, 0);
             err = gc9a01_write_cmd(dev, GC9A01A_SLPIN, NULL, 0);
             break;
@@ -417,12 +917,8 @@ static int gc9a01_pm_action(const struct device *dev,
             err = -ENOTSUP;
     }
 
-    err = pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_SUSPEND);
-    __ASSERT(err == 0 || err == -EALREADY, "Failed suspend SPI Bus");
-
-    if (err == -EALREADY) {
-        err = 0;
-    }
+    gc9a01_bus_suspend(dev);
+    gc9a01_bus_release(dev);
 
     if (err < 0) {
         LOG_ERR("%s: failed to set power mode", dev->name);
@@ -431,11 +927,22 @@ static int gc9a01_pm_action(const struct device *dev,
     return err;
 }
 
+void gc9a01_get_bus_stats(const struct device *dev, struct gc9a01_bus_stats *p_stats)
+{
+    *p_stats = stats;
+}
+
+void gc9a01_reset_bus_stats(const struct device *dev)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
 static const struct gc9a01_config gc9a01_config = {
     .bus = SPI_DT_SPEC_INST_GET(0, SPI_OP_MODE_MASTER | SPI_WORD_SET(8), 0),
     .reset_gpio = GPIO_DT_SPEC_INST_GET(0, reset_gpios),
     .dc_gpio = GPIO_DT_SPEC_INST_GET(0, dc_gpios),
     .bl_gpio = GPIO_DT_SPEC_INST_GET(0, bl_gpios),
+    .te_gpio = GPIO_DT_SPEC_INST_GET_OR(0, te_gpios, {0}),
 };
 
 static struct display_driver_api gc9a01_driver_api = {
@@ -0,0 +1,116 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+/*
+ * The display writes of one LVGL refresh form a frame session, from the first area until the
+ * area written with frame_incomplete cleared in its buffer descriptor. The SPI bus stays resumed
+ * and chip select stays asserted for the whole session.
+ */
+
+/** SPI bus usage counted since boot or gc9a01_reset_bus_stats. */
+struct gc9a01_bus_stats {
+    uint32_t frames;                    /**< Completed frame sessions. */
+    uint32_t writes;                    /**< Display writes, one per area. */
+    uint32_t pm_transitions;            /**< SPI bus resumes and suspends. */
+    uint32_t transactions;              /**< Chip select assertions. */
+    uint32_t cmd_bytes;                 /**< Command and parameter bytes, all but pixel data. */
+    uint32_t pixel_bytes;
+    uint32_t window_skips;              /**< CASET and RASET left out as the window was already set. */
+    uint32_t te_count;                  /**< Tearing effect pulses, one per panel refresh. */
+    uint32_t te_waits;                  /**< Writes delayed until the scanline passed the area. */
+};
+
+void gc9a01_get_bus_stats(const struct device *dev, struct gc9a01_bus_stats *p_stats);
+
+void gc9a01_reset_bus_stats(const struct device *dev);
+
+#ifdef CONFIG_GC9A01_TE
+
+/** @brief Get the measured panel refresh period.
+ *  @return Period in microseconds, 0 until two tearing effect pulses were seen since wakeup.
+*/
+uint32_t gc9a01_te_get_period_us(const struct device *dev);
+
+/** @brief          Round a delay up to the start of a panel refresh.
+ *  @param delay_us Shortest delay
+ *  @return         Delay in microseconds until the first refresh starting after delay_us, delay_us
+ *                  unchanged while the refresh period is unknown.
+*/
+uint32_t gc9a01_te_align(const struct device *dev, uint32_t delay_us);
+
+/** @brief              Get the refresh period of a renderer locked to the panel refresh.
+ *  @param min_period_us Shortest period the renderer wants
+ *  @return             Smallest whole number of panel refreshes at least min_period_us long, in
+ *                      microseconds, 0 while the refresh period is unknown.
+*/
+uint32_t gc9a01_te_get_slot_us(const struct device *dev, uint32_t min_period_us);
+
+/** @brief          Enable or disable waiting for the scanline before writing large areas, on by default.
+ *  @return         0 on success.
+*/
+int gc9a01_te_set_gate(const struct device *dev, bool enable);
+
+#else
+
+static inline uint32_t gc9a01_te_get_period_us(const struct device *dev)
+{
+    return 0;
+}
+
+static inline uint32_t gc9a01_te_align(const struct device *dev, uint32_t delay_us)
+{
+    return delay_us;
+}
+
+static inline uint32_t gc9a01_te_get_slot_us(const struct device *dev, uint32_t min_period_us)
+{
+    return 0;
+}
+
+static inline int gc9a01_te_set_gate(const struct device *dev, bool enable)
+{
+    return -ENOTSUP;
+}
+
+#endif
+
+#ifdef CONFIG_GC9A01_EMUL
+struct emul;
+
+/** @brief          Get the display memory of the emulated controller.
+ *  @param target   The GC9A01 emulator
+ *  @return         width * height RGB565 pixels, row by row.
+*/
+const uint16_t *gc9a01_emul_get_framebuffer(const struct emul *target);
+
+/** Scanout of the emulated panel, refreshing every CONFIG_GC9A01_EMUL_REFRESH_US. */
+struct gc9a01_emul_stats {
+    uint32_t refreshes;
+    uint32_t torn_writes;               /**< Pixel data writes crossed by the scanline. */
+};
+
+void gc9a01_emul_get_stats(const struct emul *target, struct gc9a01_emul_stats *p_stats);
+
+void gc9a01_emul_reset_stats(const struct emul *target);
+#endif
@@ -0,0 +1,268 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define DT_DRV_COMPAT buydisplay_gc9a01
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "buydisplay_gc9a01.h"
+
+LOG_MODULE_REGISTER(gc9a01_emul, CONFIG_DISPLAY_LOG_LEVEL);
+
+/*
+ * Emulates the address window and display memory of the GC9A01, so the command stream of the
+ * driver can be checked by reading back what ended up on the emulated screen.
+ * The panel scans out top to bottom every CONFIG_GC9A01_EMUL_REFRESH_US, pulsing TE at the
+ * start. Pixel data takes its time on the wire, a write is torn when the scanline crosses the
+ * row being written.
+ */
+
+#define COL_ADDR_SET        0x2A
+#define ROW_ADDR_SET        0x2B
+#define MEM_WR              0x2C
+#define MEM_WR_CONT         0x3C
+
+#define DISPLAY_WIDTH       DT_INST_PROP(0, width)
+#define DISPLAY_HEIGHT      DT_INST_PROP(0, height)
+#define REFRESH_US          CONFIG_GC9A01_EMUL_REFRESH_US
+
+struct gc9a01_emul_data {
+    uint16_t framebuffer[DISPLAY_WIDTH * DISPLAY_HEIGHT];
+    uint8_t cmd;
+    uint8_t params[4];
+    uint8_t num_params;
+    uint16_t col_start, col_end;
+    uint16_t row_start, row_end;
+    // Memory position of the next pixel.
+    uint16_t col, row;
+    uint8_t pixel_msb;
+    bool pixel_half;
+    const struct emul *target;
+    struct k_timer refresh_timer;
+    int64_t refresh_start_us;
+    struct gc9a01_emul_stats stats;
+};
+
+struct gc9a01_emul_cfg {
+    struct gpio_dt_spec dc_gpio;
+    struct gpio_dt_spec te_gpio;
+};
+
+static int64_t gc9a01_emul_now_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static void gc9a01_emul_refresh(struct k_timer *timer)
+{
+    struct gc9a01_emul_data *data = CONTAINER_OF(timer, struct gc9a01_emul_data, refresh_timer);
+    const struct gc9a01_emul_cfg *cfg = data->target->cfg;
+
+    data->refresh_start_us = gc9a01_emul_now_us();
+    data->stats.refreshes++;
+
+    if (cfg->te_gpio.port != NULL) {
+        // Fails until the driver configured the pin as input.
+        gpio_emul_input_set(cfg->te_gpio.port, cfg->te_gpio.pin, 1);
+        gpio_emul_input_set(cfg->te_gpio.port, cfg->te_gpio.pin, 0);
+    }
+}
+
+/*
+* The write runs from first_row at start_us for wire_us, the scanline from the top every REFRESH_US.
+* Torn when one catches up with the other, like the scanline overtaking the row being written.
+*/
+static bool gc9a01_emul_is_torn(struct gc9a01_emul_data *data, int64_t start_us, uint16_t first_row,
+                                uint16_t rows, uint32_t wire_us)
+{
+    int64_t since_us = (start_us - data->refresh_start_us) % REFRESH_US;
+    int64_t lead_start = since_us - (int64_t)first_row * REFRESH_US / DISPLAY_HEIGHT;
+    int64_t lead_end;
+
+    // How far the scanline is ahead of the write, at the start and at the end of the write.
+    lead_start = (lead_start + REFRESH_US) % REFRESH_US;
+    lead_end = lead_start + wire_us - (int64_t)rows * REFRESH_US / DISPLAY_HEIGHT;
+
+    return lead_end < 0 || lead_end >= REFRESH_US;
+}
+
+static void gc9a01_emul_command(struct gc9a01_emul_data *data, uint8_t cmd)
+{
+    data->cmd = cmd;
+    data->num_params = 0;
+    data->pixel_half = false;
+
+    if (cmd == MEM_WR) {
+        data->col = data->col_start;
+        data->row = data->row_start;
+    }
+}
+
+static void gc9a01_emul_pixel(struct gc9a01_emul_data *data, uint16_t pixel)
+{
+    if (data->col < DISPLAY_WIDTH && data->row < DISPLAY_HEIGHT) {
+        data->framebuffer[data->row * DISPLAY_WIDTH + data->col] = pixel;
+    }
+
+    if (data->col < data->col_end) {
+        data->col++;
+        return;
+    }
+
+    data->col = data->col_start;
+    data->row = data->row < data->row_end ? data->row + 1 : data->row_start;
+}
+
+static void gc9a01_emul_parameter(struct gc9a01_emul_data *data, uint8_t value)
+{
+    switch (data->cmd) {
+        case COL_ADDR_SET:
+        case ROW_ADDR_SET:
+            if (data->num_params >= sizeof(data->params)) {
+                break;
+            }
+            data->params[data->num_params++] = value;
+            if (data->num_params == sizeof(data->params)) {
+                uint16_t start = sys_get_be16(&data->params[0]);
+                uint16_t end = sys_get_be16(&data->params[2]);
+
+                if (data->cmd == COL_ADDR_SET) {
+                    data->col_start = start;
+                    data->col_end = end;
+                } else {
+                    data->row_start = start;
+                    data->row_end = end;
+                }
+            }
+            break;
+        case MEM_WR:
+        case MEM_WR_CONT:
+            if (data->pixel_half) {
+                gc9a01_emul_pixel(data, (data->pixel_msb << 8) | value);
+            } else {
+                data->pixel_msb = value;
+            }
+            data->pixel_half = !data->pixel_half;
+            break;
+        default:
+            break;
+    }
+}
+
+static int gc9a01_emul_io(const struct emul *target, const struct spi_config *config,
+                          const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+    const struct gc9a01_emul_cfg *cfg = target->cfg;
+    struct gc9a01_emul_data *data = target->data;
+    bool is_data = gpio_emul_output_get(cfg->dc_gpio.port, cfg->dc_gpio.pin) == 1;
+    bool is_pixels = is_data && (data->cmd == MEM_WR || data->cmd == MEM_WR_CONT);
+    int64_t start_us = gc9a01_emul_now_us();
+    uint16_t first_row = data->row;
+    uint16_t width = data->col_end - data->col_start + 1;
+    size_t len = 0;
+    uint32_t wire_us;
+
+    if (tx_bufs == NULL) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < tx_bufs->count; i++) {
+        const struct spi_buf *buf = &tx_bufs->buffers[i];
+        const uint8_t *bytes = buf->buf;
+
+        for (size_t j = 0; j < buf->len; j++) {
+            if (is_data) {
+                gc9a01_emul_parameter(data, bytes[j]);
+            } else {
+                gc9a01_emul_command(data, bytes[j]);
+            }
+        }
+        len += buf->len;
+    }
+
+    if (!is_pixels) {
+        return 0;
+    }
+
+    wire_us = (uint64_t)len * 8 * USEC_PER_SEC / config->frequency;
+    if (gc9a01_emul_is_torn(data, start_us, first_row, DIV_ROUND_UP(len / 2, width), wire_us)) {
+        data->stats.torn_writes++;
+    }
+    k_sleep(K_USEC(wire_us));
+
+    return 0;
+}
+
+const uint16_t *gc9a01_emul_get_framebuffer(const struct emul *target)
+{
+    struct gc9a01_emul_data *data = target->data;
+
+    return data->framebuffer;
+}
+
+void gc9a01_emul_get_stats(const struct emul *target, struct gc9a01_emul_stats *p_stats)
+{
+    struct gc9a01_emul_data *data = target->data;
+
+    *p_stats = data->stats;
+}
+
+void gc9a01_emul_reset_stats(const struct emul *target)
+{
+    struct gc9a01_emul_data *data = target->data;
+
+    memset(&data->stats, 0, sizeof(data->stats));
+}
+
+static int gc9a01_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct gc9a01_emul_data *data = target->data;
+
+    data->target = target;
+    data->col_end = DISPLAY_WIDTH - 1;
+    data->row_end = DISPLAY_HEIGHT - 1;
+    data->refresh_start_us = gc9a01_emul_now_us();
+    k_timer_init(&data->refresh_timer, gc9a01_emul_refresh, NULL);
+    k_timer_start(&data->refresh_timer, K_USEC(REFRESH_US), K_USEC(REFRESH_US));
+
+    return 0;
+}
+
+static struct spi_emul_api gc9a01_emul_api_spi = {
+    .io = gc9a01_emul_io,
+};
+
+#define GC9A01_EMUL(inst)                                                                                   \
+    static struct gc9a01_emul_data gc9a01_emul_data_##inst;                                                 \
+    static const struct gc9a01_emul_cfg gc9a01_emul_cfg_##inst = {                                          \
+        .dc_gpio = GPIO_DT_SPEC_INST_GET(inst, dc_gpios),                                                   \
+        .te_gpio = GPIO_DT_SPEC_INST_GET_OR(inst, te_gpios, {0}),                                           \
+    };                                                                                                      \
+    EMUL_DT_INST_DEFINE(inst, gc9a01_emul_init, &gc9a01_emul_data_##inst, &gc9a01_emul_cfg_##inst,         \
+                        &gc9a01_emul_api_spi, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(GC9A01_EMUL)
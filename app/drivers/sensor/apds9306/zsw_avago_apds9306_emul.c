@@ -73,6 +73,9 @@ struct apds9306_emul_data {
     uint8_t regs[APDS9306_REGISTER_ALS_THRES_VAR + 1];
     uint32_t measurement_rate;
     uint8_t current_register;
+    /* Set with emul_sensor_backend_set_channel, random values until then */
+    bool lux_set;
+    uint32_t lux;
 };
 
 struct apds9306_emul_cfg {
@@ -102,8 +105,12 @@ static void apds9306_emul_worker(struct k_work *p_work)
         factor = 14;
     }
 
-    /* Get a random LUX value in the range of 0 to 1000 */
-    lux = sys_rand32_get() % 1000;
+    if (data->lux_set) {
+        lux = data->lux;
+    } else {
+        /* Get a random LUX value in the range of 0 to 1000 */
+        lux = sys_rand32_get() % 1000;
+    }
 
     /* Use the inverted formula from the driver to get the data value */
     raw = lux * gain * integration_time / factor;
@@ -210,6 +217,11 @@ static int apds9306_emul_set_channel(const struct emul *target, struct sensor_ch
 
     switch (ch.chan_type) {
     case SENSOR_CHAN_LIGHT:
+        if (*value < 0) {
+            return -EINVAL;
+        }
+        data->lux = (uint32_t)(((int64_t)*value << shift) >> 31);
+        data->lux_set = true;
         break;
     default:
         return -ENOTSUP;
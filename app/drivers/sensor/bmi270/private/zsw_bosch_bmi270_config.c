@@ -15,6 +15,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/sensor.h>
 
@@ -654,3 +655,120 @@ int bmi2_reset_step_counter(const struct device* p_dev)
 
     return 0;
 }
+
+#ifdef CONFIG_ZSW_BMI270_FIFO
+// Header byte, accelerometer and gyroscope data.
+#define BOSCH_BMI270_FIFO_FRAME_LEN         13
+// Header byte and 24 bit sensor time, only appended when the FIFO is read until empty.
+#define BOSCH_BMI270_FIFO_TIME_FRAME_LEN    4
+#define BOSCH_BMI270_FIFO_MAX_FRAMES        (CONFIG_ZSW_BMI270_FIFO_BUFFER_SIZE / BOSCH_BMI270_FIFO_FRAME_LEN)
+
+static uint8_t fifo_buffer[CONFIG_ZSW_BMI270_FIFO_BUFFER_SIZE];
+static struct bmi2_sens_axes_data fifo_accel[BOSCH_BMI270_FIFO_MAX_FRAMES];
+static struct bmi2_sens_axes_data fifo_gyro[BOSCH_BMI270_FIFO_MAX_FRAMES];
+
+int bmi2_configure_fifo(const struct device *p_dev, uint16_t num_frames)
+{
+    struct bmi270_data *data = p_dev->data;
+    enum bmi2_hw_int_pin int_pin;
+
+#ifdef CONFIG_ZSW_BMI270_USE_INT1
+    int_pin = BMI2_INT1;
+#else
+    int_pin = BMI2_INT2;
+#endif
+
+    // Leave room for frames arriving while a batch is read.
+    if (num_frames > (BOSCH_BMI270_FIFO_MAX_FRAMES / 2)) {
+        return -EINVAL;
+    }
+
+    LOG_DBG("Set FIFO watermark to %u frames", num_frames);
+
+    // Always start over from an empty FIFO, old frames may have another ODR.
+    if ((bmi2_map_data_int(BMI2_FWM_INT, BMI2_INT_NONE, &data->bmi2) != BMI2_OK) ||
+        (bmi2_set_fifo_config(BMI2_FIFO_ALL_EN, BMI2_DISABLE, &data->bmi2) != BMI2_OK) ||
+        (bmi2_set_command_register(BMI2_FIFO_FLUSH_CMD, &data->bmi2) != BMI2_OK)) {
+        return -EFAULT;
+    }
+
+    data->fifo_wm_frames = 0;
+
+    if (num_frames == 0) {
+        return 0;
+    }
+
+    // Accelerometer and gyroscope run at the same ODR, so each frame holds one sample of both.
+    if ((bmi2_set_fifo_config(BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN | BMI2_FIFO_HEADER_EN | BMI2_FIFO_TIME_EN,
+                              BMI2_ENABLE, &data->bmi2) != BMI2_OK) ||
+        (bmi2_set_fifo_wm(num_frames * BOSCH_BMI270_FIFO_FRAME_LEN, &data->bmi2) != BMI2_OK) ||
+        (bmi2_map_data_int(BMI2_FWM_INT, int_pin, &data->bmi2) != BMI2_OK)) {
+        return -EFAULT;
+    }
+
+    data->fifo_wm_frames = num_frames;
+
+    return 0;
+}
+
+int bmi2_read_fifo(const struct device *p_dev, struct bosch_bmi270_fifo_frame *p_frames, uint16_t *p_num_frames,
+                   uint32_t *p_sensor_time)
+{
+    uint16_t fifo_length;
+    uint16_t accel_length;
+    uint16_t gyro_length;
+    struct bmi2_fifo_frame fifo;
+    struct bmi270_data *data = p_dev->data;
+
+    accel_length = MIN(*p_num_frames, ARRAY_SIZE(fifo_accel));
+    gyro_length = accel_length;
+    *p_num_frames = 0;
+    *p_sensor_time = 0;
+
+    if (data->fifo_wm_frames == 0) {
+        return -ENODATA;
+    }
+
+    if (bmi2_get_fifo_length(&fifo_length, &data->bmi2) != BMI2_OK) {
+        return -EFAULT;
+    }
+
+    memset(&fifo, 0, sizeof(fifo));
+    fifo.data = fifo_buffer;
+    if (fifo_length <= accel_length * BOSCH_BMI270_FIFO_FRAME_LEN) {
+        // Everything fits, read one frame past the data so the sensor time frame is included.
+        fifo.length = fifo_length + BOSCH_BMI270_FIFO_TIME_FRAME_LEN + data->bmi2.dummy_byte;
+    } else {
+        // Only as many frames as the caller takes, the rest stays for the next read. The FIFO isn't
+        // read until empty so there is no sensor time frame for these frames.
+        fifo.length = accel_length * BOSCH_BMI270_FIFO_FRAME_LEN + data->bmi2.dummy_byte;
+    }
+    fifo.length = MIN(fifo.length, sizeof(fifo_buffer));
+
+    if (bmi2_read_fifo_data(&fifo, &data->bmi2) != BMI2_OK) {
+        return -EFAULT;
+    }
+
+    // Warnings like an empty or partially read FIFO are positive and fine here.
+    if ((bmi2_extract_accel(fifo_accel, &accel_length, &fifo, &data->bmi2) < BMI2_OK) ||
+        (bmi2_extract_gyro(fifo_gyro, &gyro_length, &fifo, &data->bmi2) < BMI2_OK)) {
+        return -EFAULT;
+    }
+
+    for (uint16_t i = 0; i < MIN(accel_length, gyro_length); i++) {
+        p_frames[i].ax = fifo_accel[i].x;
+        p_frames[i].ay = fifo_accel[i].y;
+        p_frames[i].az = fifo_accel[i].z;
+        p_frames[i].gx = fifo_gyro[i].x;
+        p_frames[i].gy = fifo_gyro[i].y;
+        p_frames[i].gz = fifo_gyro[i].z;
+    }
+
+    *p_num_frames = MIN(accel_length, gyro_length);
+    *p_sensor_time = fifo.sensor_time;
+
+    LOG_DBG("Read %u FIFO frames, sensor time %u", *p_num_frames, *p_sensor_time);
+
+    return 0;
+}
+#endif
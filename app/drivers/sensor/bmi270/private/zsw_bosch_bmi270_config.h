@@ -146,3 +146,22 @@ int bmi2_enable_feature(const struct device *p_dev, uint8_t feature, bool int_en
  *  @return         0 when successful
 */
 int bmi2_reset_step_counter(const struct device *p_dev);
+
+/** @brief              Configure the FIFO for headered accelerometer, gyroscope and sensor time frames
+ *                      and map the watermark interrupt.
+ *  @param p_dev
+ *  @param num_frames   Watermark in frames, 0 disables the FIFO
+ *  @return             0 when successful
+*/
+int bmi2_configure_fifo(const struct device *p_dev, uint16_t num_frames);
+
+/** @brief              Read accelerometer and gyroscope frames from the FIFO, oldest first.
+ *                      Frames that don't fit are left in the FIFO for the next read.
+ *  @param p_dev
+ *  @param p_frames     Output frames
+ *  @param p_num_frames In: room in p_frames, out: number of frames read
+ *  @param p_sensor_time Sensor time after the last frame when the FIFO was read until empty, 0 otherwise
+ *  @return             0 when successful, -ENODATA when the FIFO isn't configured
+*/
+int bmi2_read_fifo(const struct device *p_dev, struct bosch_bmi270_fifo_frame *p_frames, uint16_t *p_num_frames,
+                   uint32_t *p_sensor_time);
@@ -55,6 +55,7 @@ struct bmi270_data {
     sensor_trigger_handler_t gesture;
     sensor_trigger_handler_t stationary;
     sensor_trigger_handler_t motion;
+    sensor_trigger_handler_t fifo_wm;
 #endif
 
 #if defined(CONFIG_ZSW_BMI270_TRIGGER_OWN_THREAD)
@@ -75,5 +76,6 @@ struct bmi270_data {
     uint16_t gyr_range;
     uint8_t gyr_odr;
     uint8_t gyr_osr;
+    uint16_t fifo_wm_frames;
     struct bmi2_dev bmi2;
 };
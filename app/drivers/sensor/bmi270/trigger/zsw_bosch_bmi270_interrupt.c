@@ -92,6 +92,21 @@ static void bmi2_process_int(const struct device *p_dev)
 
     LOG_DBG("Status: %u", status);
 
+    if (status & BMI2_FWM_INT_STATUS_MASK) {
+        trigger->type = SENSOR_TRIG_FIFO_WATERMARK;
+
+        if (data->fifo_wm) {
+            data->fifo_wm(p_dev, trigger);
+        }
+
+        // The watermark fires at a high rate while streaming, don't poll the features below
+        // and don't bother the global handler when nothing else happened.
+        if ((status & ~BMI2_FWM_INT_STATUS_MASK) == 0) {
+            bmi2_enable_int(p_dev, true);
+            return;
+        }
+    }
+
     if (status & BMI270_SIG_MOT_STATUS_MASK) {
         LOG_DBG("BMI270_SIG_MOT_STATUS_MASK");
 
@@ -286,7 +301,8 @@ int bmi270_trigger_set(const struct device *p_dev, const struct sensor_trigger *
     struct bmi270_data *data = p_dev->data;
     const struct bmi270_config *config = p_dev->config;
 
-    if ((!config->int_gpio.port) || ((p_trig->chan != SENSOR_CHAN_GESTURE) && (p_trig->chan != SENSOR_CHAN_ALL))) {
+    if ((!config->int_gpio.port) || ((p_trig->chan != SENSOR_CHAN_GESTURE) && (p_trig->chan != SENSOR_CHAN_FIFO) &&
+                                     (p_trig->chan != SENSOR_CHAN_ALL))) {
         return -ENOTSUP;
     }
 
@@ -319,6 +335,9 @@ int bmi270_trigger_set(const struct device *p_dev, const struct sensor_trigger *
             case SENSOR_TRIG_MOTION:
                 data->motion = handler;
                 break;
+            case SENSOR_TRIG_FIFO_WATERMARK:
+                data->fifo_wm = handler;
+                break;
             default:
                 return -ENOTSUP;
         }
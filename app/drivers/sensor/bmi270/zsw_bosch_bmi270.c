@@ -308,6 +308,22 @@ static int bmi270_attr_set(const struct device *p_dev, enum sensor_channel chann
             default:
                 return -ENOTSUP;
         }
+    } else if (channel == SENSOR_CHAN_FIFO) {
+        // FIFO configuration channel. Supported options:
+        //  - Configuration
+        //      p_value.val1:
+        //          - Watermark in frames, 0 disables the FIFO
+        switch (attribute) {
+#ifdef CONFIG_ZSW_BMI270_FIFO
+            case SENSOR_ATTR_CONFIGURATION:
+                if ((p_value->val1 < 0) || (p_value->val1 > UINT16_MAX)) {
+                    return -EINVAL;
+                }
+                return bmi2_configure_fifo(p_dev, p_value->val1);
+#endif
+            default:
+                return -ENOTSUP;
+        }
     } else if (channel == SENSOR_CHAN_CONFIG) {
         // TODO: Implement this
         return -ENOTSUP;
@@ -316,6 +332,61 @@ static int bmi270_attr_set(const struct device *p_dev, enum sensor_channel chann
     return -ENOTSUP;
 }
 
+/** @brief
+ *  @param p_dev
+ *  @param channel
+ *  @param attribute
+ *  @param p_value
+ *  @return             0 when successful
+*/
+static int bmi270_attr_get(const struct device *p_dev, enum sensor_channel channel, enum sensor_attribute attribute,
+                           struct sensor_value *p_value)
+{
+    struct bmi270_data *data = p_dev->data;
+
+    __ASSERT_NO_MSG(p_value != NULL);
+
+    // Sampling frequency is the ODR register value, same as for attr_set.
+    // Full scale is in g for the accelerometer and degrees per second for the gyroscope.
+    p_value->val2 = 0;
+
+    if ((channel == SENSOR_CHAN_ACCEL_X) || (channel == SENSOR_CHAN_ACCEL_Y) || (channel == SENSOR_CHAN_ACCEL_Z) ||
+        (channel == SENSOR_CHAN_ACCEL_XYZ)) {
+        switch (attribute) {
+            case SENSOR_ATTR_SAMPLING_FREQUENCY:
+                p_value->val1 = data->acc_odr;
+                return 0;
+            case SENSOR_ATTR_FULL_SCALE:
+                p_value->val1 = data->acc_range;
+                return 0;
+            default:
+                return -ENOTSUP;
+        }
+    } else if ((channel == SENSOR_CHAN_GYRO_X) || (channel == SENSOR_CHAN_GYRO_Y) || (channel == SENSOR_CHAN_GYRO_Z) ||
+               (channel == SENSOR_CHAN_GYRO_XYZ)) {
+        switch (attribute) {
+            case SENSOR_ATTR_SAMPLING_FREQUENCY:
+                p_value->val1 = data->gyr_odr;
+                return 0;
+            case SENSOR_ATTR_FULL_SCALE:
+                p_value->val1 = data->gyr_range;
+                return 0;
+            default:
+                return -ENOTSUP;
+        }
+    } else if (channel == SENSOR_CHAN_FIFO) {
+        switch (attribute) {
+            case SENSOR_ATTR_CONFIGURATION:
+                p_value->val1 = data->fifo_wm_frames;
+                return 0;
+            default:
+                return -ENOTSUP;
+        }
+    }
+
+    return -ENOTSUP;
+}
+
 /** @brief
  *  @param p_dev
  *  @param channel
@@ -342,10 +413,6 @@ static int bmi270_sample_fetch(const struct device *p_dev, enum sensor_channel c
 
     LOG_DBG("Start fetching new data...");
 
-    if (bmi2_get_sensor_data(&sensor_data, &data->bmi2) != BMI2_OK) {
-        return -EFAULT;
-    }
-
     if ((channel == SENSOR_CHAN_ALL) || (channel == SENSOR_CHAN_AMBIENT_TEMP)) {
         if (bmi2_get_temperature_data(&temp, &data->bmi2) != BMI2_OK) {
             return -EFAULT;
@@ -354,6 +421,15 @@ static int bmi270_sample_fetch(const struct device *p_dev, enum sensor_channel c
         data->temp = temp;
     }
 
+    // The temperature is in separate registers, no need to read the motion data for it.
+    if (channel == SENSOR_CHAN_AMBIENT_TEMP) {
+        return 0;
+    }
+
+    if (bmi2_get_sensor_data(&sensor_data, &data->bmi2) != BMI2_OK) {
+        return -EFAULT;
+    }
+
     data->ax = sensor_data.acc.x;
     data->ay = sensor_data.acc.y;
     data->az = sensor_data.acc.z;
@@ -436,8 +512,64 @@ static int bmi270_channel_get(const struct device *p_dev, enum sensor_channel ch
     return 0;
 }
 
+int bosch_bmi270_read_sample(const struct device *p_dev, struct bosch_bmi270_sample *p_sample)
+{
+    enum pm_device_state pm_state;
+    struct bmi270_data *data = p_dev->data;
+    struct bmi2_sens_data sensor_data;
+
+    __ASSERT_NO_MSG(p_sample != NULL);
+
+    pm_device_state_get(p_dev, &pm_state);
+    if (pm_state != PM_DEVICE_STATE_ACTIVE) {
+        return -EFAULT;
+    }
+
+    if (bmi2_get_sensor_data(&sensor_data, &data->bmi2) != BMI2_OK) {
+        return -EFAULT;
+    }
+
+    data->ax = sensor_data.acc.x;
+    data->ay = sensor_data.acc.y;
+    data->az = sensor_data.acc.z;
+
+    data->gx = sensor_data.gyr.x;
+    data->gy = sensor_data.gyr.y;
+    data->gz = sensor_data.gyr.z;
+
+    p_sample->ax = data->ax;
+    p_sample->ay = data->ay;
+    p_sample->az = data->az;
+    p_sample->gx = data->gx;
+    p_sample->gy = data->gy;
+    p_sample->gz = data->gz;
+    p_sample->sensor_time = sensor_data.sens_time & BOSCH_BMI270_SENSOR_TIME_MASK;
+
+    return 0;
+}
+
+int bosch_bmi270_fifo_read(const struct device *p_dev, struct bosch_bmi270_fifo_frame *p_frames,
+                           uint16_t *p_num_frames, uint32_t *p_sensor_time)
+{
+#ifdef CONFIG_ZSW_BMI270_FIFO
+    enum pm_device_state pm_state;
+
+    __ASSERT_NO_MSG((p_frames != NULL) && (p_num_frames != NULL) && (p_sensor_time != NULL));
+
+    pm_device_state_get(p_dev, &pm_state);
+    if (pm_state != PM_DEVICE_STATE_ACTIVE) {
+        return -EFAULT;
+    }
+
+    return bmi2_read_fifo(p_dev, p_frames, p_num_frames, p_sensor_time);
+#else
+    return -ENOTSUP;
+#endif
+}
+
 static const struct sensor_driver_api bmi270_driver_api = {
     .attr_set = bmi270_attr_set,
+    .attr_get = bmi270_attr_get,
     .sample_fetch = bmi270_sample_fetch,
     .channel_get = bmi270_channel_get,
 #ifdef CONFIG_ZSW_BMI270_TRIGGER
@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <errno.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
 /** @brief Step counting sensor channel.
 */
 #define SENSOR_CHAN_STEPS               (SENSOR_CHAN_PRIV_START + 1)
@@ -37,6 +41,11 @@
 */
 #define SENSOR_CHAN_CONFIG              (SENSOR_CHAN_PRIV_START + 5)
 
+/** @brief  Hardware FIFO channel. Configure with SENSOR_ATTR_CONFIGURATION where val1 is the watermark
+ *          in frames (0 disables the FIFO) and install a SENSOR_TRIG_FIFO_WATERMARK trigger to get notified.
+*/
+#define SENSOR_CHAN_FIFO                (SENSOR_CHAN_PRIV_START + 6)
+
 /** @brief Wrist gesture detection like flick in/out, push arm down(pivot up, wrist jiggle/shake).
 */
 #define SENSOR_TRIG_WRIST_GESTURE       (SENSOR_TRIG_PRIV_START + 1)
@@ -176,3 +185,66 @@
 #define BOSCH_BMI270_GYR_OSR4           0x00
 #define BOSCH_BMI270_GYR_OSR2           0x01
 #define BOSCH_BMI270_GYR_OSR1           0x02
+
+/** @brief Convert sensor time ticks (39.0625 us each) to microseconds.
+*/
+#define BOSCH_BMI270_SENSOR_TIME_TO_US(ticks)   (((uint64_t)(ticks) * 390625ULL) / 10000ULL)
+
+/** @brief Sensor time is a 24 bit counter.
+*/
+#define BOSCH_BMI270_SENSOR_TIME_MASK           0x00FFFFFF
+
+/** @brief One raw FIFO frame with accelerometer and gyroscope data sampled at the same time.
+*/
+struct bosch_bmi270_fifo_frame {
+    int16_t ax;
+    int16_t ay;
+    int16_t az;
+    int16_t gx;
+    int16_t gy;
+    int16_t gz;
+};
+
+/** @brief One raw accelerometer and gyroscope sample read in a single burst.
+*/
+struct bosch_bmi270_sample {
+    int16_t ax;
+    int16_t ay;
+    int16_t az;
+    int16_t gx;
+    int16_t gy;
+    int16_t gz;
+    uint32_t sensor_time;   /**< Sensor time (24 bit, see BOSCH_BMI270_SENSOR_TIME_TO_US) of the sample. */
+};
+
+#ifdef CONFIG_ZSW_BMI270
+/** @brief              Read the latest accelerometer and gyroscope data in one I2C burst, without temperature.
+ *                      Also updates the values returned by sensor_channel_get.
+ *  @param p_dev        BMI270 device
+ *  @param p_sample     Where to store the sample
+ *  @return             0 when successful
+*/
+int bosch_bmi270_read_sample(const struct device *p_dev, struct bosch_bmi270_sample *p_sample);
+
+/** @brief              Drain the hardware FIFO.
+ *  @param p_dev        BMI270 device
+ *  @param p_frames     Where to store the frames, oldest first
+ *  @param p_num_frames In: size of p_frames, out: number of frames read
+ *  @param p_sensor_time Sensor time (24 bit, see BOSCH_BMI270_SENSOR_TIME_TO_US) when the
+ *                      last frame was read, 0 if not available
+ *  @return             0 when successful
+*/
+int bosch_bmi270_fifo_read(const struct device *p_dev, struct bosch_bmi270_fifo_frame *p_frames,
+                           uint16_t *p_num_frames, uint32_t *p_sensor_time);
+#else
+static inline int bosch_bmi270_read_sample(const struct device *p_dev, struct bosch_bmi270_sample *p_sample)
+{
+    return -ENODEV;
+}
+
+static inline int bosch_bmi270_fifo_read(const struct device *p_dev, struct bosch_bmi270_fifo_frame *p_frames,
+                                         uint16_t *p_num_frames, uint32_t *p_sensor_time)
+{
+    return -ENODEV;
+}
+#endif
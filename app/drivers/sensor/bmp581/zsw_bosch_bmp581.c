@@ -15,6 +15,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/i2c.h>
@@ -24,6 +25,7 @@
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
 
 #include "bmp5.h"
 #include "zsw_bosch_bmp581.h"
@@ -44,6 +46,12 @@ static struct bmp5_osr_odr_press_config bmp5_osr_odr_press_cfg;
 static const struct device *device;
 static struct bmp5_dev bmp5_dev;
 
+#ifdef CONFIG_ZSW_BMP581_FIFO
+static struct bmp5_fifo bmp5_fifo;
+static uint8_t fifo_buffer[BMP5_FIFO_DATA_BUFFER_SIZE];
+static struct bmp5_sensor_data fifo_data[BOSCH_BMP581_FIFO_FRAMES];
+#endif
+
 /** @brief              Platform specific i2c read function.
  *  @param reg_addr     Register address
  *  @param p_reg_data   Register data
@@ -123,6 +131,53 @@ static int8_t bmp5_set_config(struct bmp5_osr_odr_press_config *p_cfg, struct bm
     return rslt;
 }
 
+#ifdef CONFIG_ZSW_BMP581_FIFO
+/** @brief              Enable or disable the pressure FIFO and set the IIR filter.
+ *                      Both can only be changed in standby, the previous power mode is restored.
+ *  @param enable       Buffer pressure samples in the FIFO
+ *  @param iir_coeff    IIR filter coefficient for pressure and temperature
+ *  @param p_dev
+ *  @return             0 when successful
+*/
+static int8_t bmp5_configure_fifo(bool enable, uint8_t iir_coeff, struct bmp5_dev *p_dev)
+{
+    int8_t rslt;
+    enum bmp5_powermode power_mode;
+    struct bmp5_iir_config iir_cfg = { 0 };
+
+    rslt = bmp5_get_power_mode(&power_mode, p_dev);
+    if (rslt == BMP5_OK) {
+        rslt = bmp5_set_power_mode(BMP5_POWERMODE_STANDBY, p_dev);
+    }
+
+    if (rslt == BMP5_OK) {
+        iir_cfg.set_iir_t = iir_coeff;
+        iir_cfg.set_iir_p = iir_coeff;
+        iir_cfg.shdw_set_iir_t = BMP5_ENABLE;
+        iir_cfg.shdw_set_iir_p = BMP5_ENABLE;
+
+        rslt = bmp5_set_iir_config(&iir_cfg, p_dev);
+    }
+
+    if (rslt == BMP5_OK) {
+        memset(&bmp5_fifo, 0, sizeof(bmp5_fifo));
+        bmp5_fifo.frame_sel = enable ? BMP5_FIFO_PRESSURE_DATA : BMP5_FIFO_NOT_ENABLED;
+        bmp5_fifo.dec_sel = BMP5_FIFO_NO_DOWNSAMPLING;
+        bmp5_fifo.mode = BMP5_FIFO_MODE_STREAMING;
+        bmp5_fifo.set_fifo_iir_t = BMP5_ENABLE;
+        bmp5_fifo.set_fifo_iir_p = BMP5_ENABLE;
+
+        rslt = bmp5_set_fifo_configuration(&bmp5_fifo, p_dev);
+    }
+
+    if ((rslt == BMP5_OK) && (power_mode != BMP5_POWERMODE_STANDBY) && (power_mode != BMP5_POWERMODE_DEEP_STANDBY)) {
+        rslt = bmp5_set_power_mode(power_mode, p_dev);
+    }
+
+    return rslt;
+}
+#endif
+
 /** @brief
  *  @param p_dev
  *  @param channel
@@ -135,6 +190,28 @@ static int bmp581_attr_set(const struct device *p_dev, enum sensor_channel chann
 {
     __ASSERT_NO_MSG(p_value != NULL);
 
+    if ((int)channel == SENSOR_CHAN_BMP581_FIFO) {
+        // FIFO configuration channel. Supported options:
+        //  - Configuration
+        //      p_value.val1: 1 to enable, 0 to disable the FIFO
+        //      p_value.val2: IIR filter coefficient
+#ifdef CONFIG_ZSW_BMP581_FIFO
+        if ((attribute != SENSOR_ATTR_CONFIGURATION) || (p_value->val2 < BOSCH_BMP581_IIR_BYPASS) ||
+            (p_value->val2 > BOSCH_BMP581_IIR_COEFF_127)) {
+            return -EINVAL;
+        }
+
+        if (bmp5_configure_fifo(p_value->val1 != 0, p_value->val2, &bmp5_dev) != BMP5_OK) {
+            LOG_ERR("Failed to configure FIFO!");
+            return -EFAULT;
+        }
+
+        return 0;
+#else
+        return -ENOTSUP;
+#endif
+    }
+
     if (((channel != SENSOR_CHAN_ALL) && (channel != SENSOR_CHAN_AMBIENT_TEMP) && (channel != SENSOR_CHAN_PRESS)) ||
         ((attribute != SENSOR_ATTR_SAMPLING_FREQUENCY) && (attribute == SENSOR_ATTR_OVERSAMPLING))) {
         return -ENOTSUP;
@@ -280,6 +357,53 @@ static int bmp581_channel_get(const struct device *p_dev, enum sensor_channel ch
     return 0;
 }
 
+#ifdef CONFIG_ZSW_BMP581_FIFO
+int bosch_bmp581_fifo_read(const struct device *p_dev, float *p_pressure, uint16_t *p_num_frames)
+{
+    enum pm_device_state pm_state;
+    uint16_t num_frames;
+
+    __ASSERT_NO_MSG((p_pressure != NULL) && (p_num_frames != NULL));
+
+    pm_device_state_get(p_dev, &pm_state);
+    if (pm_state != PM_DEVICE_STATE_ACTIVE) {
+        return -EFAULT;
+    }
+
+    if (bmp5_fifo.frame_sel == BMP5_FIFO_NOT_ENABLED) {
+        return -ENODATA;
+    }
+
+    bmp5_fifo.data = fifo_buffer;
+    if (bmp5_get_fifo_len(&bmp5_fifo.length, &bmp5_fifo, &bmp5_dev) != BMP5_OK) {
+        return -EIO;
+    }
+
+    if (bmp5_fifo.length == 0) {
+        *p_num_frames = 0;
+        return 0;
+    }
+
+    if ((bmp5_get_fifo_data(&bmp5_fifo, &bmp5_dev) != BMP5_OK) ||
+        (bmp5_extract_fifo_data(&bmp5_fifo, fifo_data) != BMP5_OK)) {
+        LOG_ERR("FIFO read error!");
+        return -EIO;
+    }
+
+    // The whole FIFO is drained, keep the newest samples if the caller has less room.
+    num_frames = MIN(bmp5_fifo.fifo_count, ARRAY_SIZE(fifo_data));
+    if (num_frames > *p_num_frames) {
+        LOG_WRN("Dropping %u FIFO samples", num_frames - *p_num_frames);
+    }
+    for (uint16_t i = num_frames - MIN(num_frames, *p_num_frames), j = 0; i < num_frames; i++, j++) {
+        p_pressure[j] = fifo_data[i].pressure;
+    }
+    *p_num_frames = MIN(num_frames, *p_num_frames);
+
+    return 0;
+}
+#endif
+
 static const struct sensor_driver_api bmp581_driver_api = {
     .attr_set = bmp581_attr_set,
     .attr_get = bmp581_attr_get,
@@ -17,6 +17,11 @@
 
 #pragma once
 
+#include <errno.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+
 #define BOSCH_BMP581_ODR_240_HZ                         0x00
 #define BOSCH_BMP581_ODR_218_5_HZ                       0x01
 #define BOSCH_BMP581_ODR_199_1_HZ                       0x02
@@ -50,3 +55,37 @@
 #define BOSCH_BMP581_ODR_0_250_HZ                       0x1E
 #define BOSCH_BMP581_ODR_0_125_HZ                       0x1F
 #define BOSCH_BMP581_ODR_DEFAULT                        BOSCH_BMP581_ODR_0_250_HZ
+
+#define BOSCH_BMP581_IIR_BYPASS                         0x00
+#define BOSCH_BMP581_IIR_COEFF_1                        0x01
+#define BOSCH_BMP581_IIR_COEFF_3                        0x02
+#define BOSCH_BMP581_IIR_COEFF_7                        0x03
+#define BOSCH_BMP581_IIR_COEFF_15                       0x04
+#define BOSCH_BMP581_IIR_COEFF_31                       0x05
+#define BOSCH_BMP581_IIR_COEFF_63                       0x06
+#define BOSCH_BMP581_IIR_COEFF_127                      0x07
+
+/** @brief Number of pressure only frames the hardware FIFO holds.
+*/
+#define BOSCH_BMP581_FIFO_FRAMES                        32
+
+/** @brief  Hardware FIFO channel. Configure with SENSOR_ATTR_CONFIGURATION where val1 enables (1) or
+ *          disables (0) buffering of pressure samples at the configured ODR and val2 is the IIR
+ *          filter coefficient (BOSCH_BMP581_IIR_*) applied to both the FIFO and the data registers.
+*/
+#define SENSOR_CHAN_BMP581_FIFO                         (SENSOR_CHAN_PRIV_START + 0)
+
+#ifdef CONFIG_ZSW_BMP581_FIFO
+/** @brief              Drain the hardware FIFO.
+ *  @param p_dev        BMP581 device
+ *  @param p_pressure   Where to store the pressure samples, oldest first, same unit as SENSOR_CHAN_PRESS
+ *  @param p_num_frames In: size of p_pressure, out: number of samples read
+ *  @return             0 when successful
+*/
+int bosch_bmp581_fifo_read(const struct device *p_dev, float *p_pressure, uint16_t *p_num_frames);
+#else
+static inline int bosch_bmp581_fifo_read(const struct device *p_dev, float *p_pressure, uint16_t *p_num_frames)
+{
+    return -ENOTSUP;
+}
+#endif
@@ -23,20 +23,37 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
-#include <zephyr/random/random.h>
 #include <zephyr/drivers/emul.h>
 #include <zephyr/drivers/emul_sensor.h>
 #include <zephyr/drivers/i2c_emul.h>
+#include <math.h>
 
 #include "bmp5.h"
+#include "zsw_bosch_bmp581.h"
 
 #define BMP5_CHIP_ID_VALUE                        0x50
 
+#define BMP5_FIFO_PRESSURE_FRAME_SIZE             3
+
+/* Start values, change with emul_sensor_backend_set_channel */
+#define EMUL_DEFAULT_PRESSURE                     1013.25f
+#define EMUL_DEFAULT_TEMPERATURE                  22.0f
+
+/* The emulated pressure moves towards the set value by at most this much per sample,
+ * about 0.4 m of altitude, like walking up stairs at 1 Hz. */
+#define EMUL_PRESSURE_MAX_STEP                    0.05f
+
 #define DT_DRV_COMPAT                             zswatch_bmp581
 
 struct bmp581_emul_data {
     uint8_t regs[BMP5_REG_CMD + 1];
     uint8_t current_register;
+    float pressure;
+    float target_pressure;
+    float temperature;
+    struct k_spinlock lock;
+    uint8_t fifo[BOSCH_BMP581_FIFO_FRAMES * BMP5_FIFO_PRESSURE_FRAME_SIZE];
+    uint8_t fifo_frames;
 };
 
 struct bmp581_emul_cfg {
@@ -51,7 +68,7 @@ LOG_MODULE_REGISTER(zsw_bosch_bmp581_emul, CONFIG_SENSOR_LOG_LEVEL);
 
 static uint32_t bmp581_odr_to_ms(uint8_t odr_config)
 {
-    uint8_t odr = (odr_config >> 2) & 0x03;
+    uint8_t odr = (odr_config >> 2) & 0x1F;
 
     switch (odr)
     {
@@ -100,25 +117,38 @@ static void bmp581_emul_worker(struct k_work *p_work)
         CONTAINER_OF(dwork, struct bmp581_worker_item_t, dwork);
     struct bmp581_emul_data *data = item->data;
 
-    /* Get a random pressure value in the range of 800 to 1100 */
-    pressure = 800 + (sys_rand32_get() % 300);
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
 
-    /* Get a random temperature value in the range of -20 to +20 */
-    temperature = -20 + (sys_rand32_get() % 40);
+    data->pressure += CLAMP(data->target_pressure - data->pressure, -EMUL_PRESSURE_MAX_STEP, EMUL_PRESSURE_MAX_STEP);
 
-    LOG_INF("New simulated temperature value: %i", temperature);
-    LOG_INF("New simulated pressure value: %u", pressure);
+    LOG_DBG("New simulated temperature value: %d", (int)data->temperature);
+    LOG_DBG("New simulated pressure value: %d", (int)data->pressure);
 
-    temperature = temperature * 65536;
+    temperature = (int32_t)(data->temperature * 65536);
     data->regs[BMP5_REG_TEMP_DATA_XLSB] = (temperature & 0xFF);
     data->regs[BMP5_REG_TEMP_DATA_LSB] = ((temperature >> 8) & 0xFF);
     data->regs[BMP5_REG_TEMP_DATA_MSB] = ((temperature >> 16) & 0xFF);
 
-    pressure = pressure * 64;
+    pressure = (int32_t)(data->pressure * 64);
     data->regs[BMP5_REG_PRESS_DATA_XLSB] = (pressure & 0xFF);
     data->regs[BMP5_REG_PRESS_DATA_LSB] = ((pressure >> 8) & 0xFF);
     data->regs[BMP5_REG_PRESS_DATA_MSB] = ((pressure >> 16) & 0xFF);
 
+    if ((data->regs[BMP5_REG_FIFO_SEL] & 0x03) == BMP5_FIFO_PRESSURE_DATA) {
+        /* Streaming mode, the oldest frame is dropped when full */
+        if (data->fifo_frames == BOSCH_BMP581_FIFO_FRAMES) {
+            memmove(data->fifo, data->fifo + BMP5_FIFO_PRESSURE_FRAME_SIZE,
+                    sizeof(data->fifo) - BMP5_FIFO_PRESSURE_FRAME_SIZE);
+            data->fifo_frames--;
+        }
+        memcpy(&data->fifo[data->fifo_frames * BMP5_FIFO_PRESSURE_FRAME_SIZE], &data->regs[BMP5_REG_PRESS_DATA_XLSB],
+               BMP5_FIFO_PRESSURE_FRAME_SIZE);
+        data->fifo_frames++;
+        data->regs[BMP5_REG_FIFO_COUNT] = data->fifo_frames;
+    }
+
+    k_spin_unlock(&data->lock, key);
+
     uint8_t pwr_mode = data->regs[BMP5_REG_ODR_CONFIG] & 0x03;
     if (pwr_mode == 2) {
         LOG_DBG("Schedule new work. Delay: %u ms", bmp581_odr_to_ms(data->regs[BMP5_REG_ODR_CONFIG]));
@@ -129,8 +159,23 @@ static void bmp581_emul_worker(struct k_work *p_work)
 static int bmp581_emul_reg_read(const struct emul *target, uint8_t reg, uint8_t *out, uint8_t length)
 {
     struct bmp581_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    if (reg == BMP5_REG_FIFO_DATA) {
+        /* Pops whole frames, reading an empty FIFO returns 0x7F */
+        uint8_t frames = MIN(data->fifo_frames, length / BMP5_FIFO_PRESSURE_FRAME_SIZE);
+        uint16_t bytes = frames * BMP5_FIFO_PRESSURE_FRAME_SIZE;
+
+        memcpy(out, data->fifo, bytes);
+        memset(out + bytes, 0x7F, length - bytes);
+        memmove(data->fifo, data->fifo + bytes, sizeof(data->fifo) - bytes);
+        data->fifo_frames -= frames;
+        data->regs[BMP5_REG_FIFO_COUNT] = data->fifo_frames;
+    } else {
+        memcpy(out, data->regs + reg, length);
+    }
 
-    memcpy(out, data->regs + reg, length);
+    k_spin_unlock(&data->lock, key);
 
     LOG_DBG("Read register 0x%02X with length %u", reg, length);
     for (uint8_t i = 0; i < length; i++) {
@@ -151,6 +196,16 @@ static int bmp581_emul_reg_write(const struct emul *target, uint8_t reg, uint8_t
 
     switch (reg)
     {
+        case BMP5_REG_FIFO_SEL:
+        {
+            /* Changing the frame selection flushes the FIFO */
+            k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+            data->fifo_frames = 0;
+            data->regs[BMP5_REG_FIFO_COUNT] = 0;
+            k_spin_unlock(&data->lock, key);
+            break;
+        }
         case BMP5_REG_ODR_CONFIG:
         {
             uint8_t pwr_mode = data->regs[BMP5_REG_ODR_CONFIG] & 0x03;
@@ -237,20 +292,31 @@ static int bmp581_emul_transfer_i2c(const struct emul *target, struct i2c_msg *m
 static int bmp581_emul_set_channel(const struct emul *target, struct sensor_chan_spec ch,
                        const q31_t *value, int8_t shift)
 {
-    struct bmp581_emul_data *data = target->data;
+    struct bmp581_emul_data *data;
+    k_spinlock_key_t key;
+    float converted;
 
     if (!target || !target->data) {
         return -EINVAL;
     }
 
+    data = target->data;
+    converted = ldexpf((float)*value, shift - 31);
+
+    key = k_spin_lock(&data->lock);
     switch (ch.chan_type) {
     case SENSOR_CHAN_AMBIENT_TEMP:
+        data->temperature = converted;
         break;
     case SENSOR_CHAN_PRESS:
+        /* Reached gradually, see EMUL_PRESSURE_MAX_STEP */
+        data->target_pressure = converted;
         break;
     default:
+        k_spin_unlock(&data->lock, key);
         return -ENOTSUP;
     }
+    k_spin_unlock(&data->lock, key);
 
     return 0;
 }
@@ -271,6 +337,10 @@ static int bmp581_emul_init(const struct emul *target, const struct device *pare
     data->regs[BMP5_REG_INT_STATUS] = BMP5_INT_ASSERTED_POR_SOFTRESET_COMPLETE;
     data->regs[BMP5_REG_ODR_CONFIG] = 0x70;
 
+    data->pressure = EMUL_DEFAULT_PRESSURE;
+    data->target_pressure = EMUL_DEFAULT_PRESSURE;
+    data->temperature = EMUL_DEFAULT_TEMPERATURE;
+
     LOG_INF("Initialization done");
 
     return 0;
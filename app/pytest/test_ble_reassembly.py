@@ -0,0 +1,130 @@
+"""
+Replay fragmented Chronos and Gadgetbridge captures on native_sim and verify the BLE reassembler.
+
+Packets are injected with the ``ble rx <hex>`` shell command, which feeds them to the
+protocol parsers exactly like writes to the NUS RX characteristic. The reassembler
+counters from ``ble reassembly`` are compared before and after each replay.
+
+Usage::
+
+    pytest test_ble_reassembly.py -s
+    pytest test_ble_reassembly.py -s --exe-path path/to/zephyr.exe
+"""
+
+import re
+import struct
+import time
+
+import pytest
+from native_sim_runner import NativeSimDevice
+# The conftest overrides of test_native_app, native_sim tests manage their own process.
+from test_native_app import BOOT_MARKER, BOOT_TIMEOUT, _find_exe, prepare_device, reset_device, uart_logs  # noqa: F401
+
+# Keep in sync with CONFIG_BLE_REASSEMBLER_TIMEOUT_MS, GC runs every half timeout.
+REASSEMBLER_TIMEOUT = 3.0
+CHRONOS_FIRST_PACKET_SIZE = 20
+
+
+def chronos_message(command, size):
+    """Build a Chronos message of size bytes, header AB <len> FF <command> followed by a counting payload."""
+    payload = bytes(i & 0xFF for i in range(size - 5))
+    return bytes([0xAB]) + struct.pack(">H", size - 3) + bytes([0xFF, command]) + payload
+
+
+def chronos_fragments(message):
+    """Split a message the way the Chronos app does: 20 byte first packet, then index + 19 bytes."""
+    fragments = [message[:CHRONOS_FIRST_PACKET_SIZE]]
+    rest = message[CHRONOS_FIRST_PACKET_SIZE:]
+    step = CHRONOS_FIRST_PACKET_SIZE - 1
+    for index, offset in enumerate(range(0, len(rest), step)):
+        fragments.append(bytes([index]) + rest[offset:offset + step])
+    return fragments
+
+
+@pytest.mark.linux_only
+class TestBleReassembly:
+    @pytest.fixture(scope="class")
+    def sim(self, request):
+        exe = _find_exe(request)
+        if not exe:
+            pytest.skip("No native_sim executable found (build or provide --exe-path)")
+
+        device = NativeSimDevice(exe_path=exe)
+        device.start()
+        if not device.wait_for_log(BOOT_MARKER, timeout=BOOT_TIMEOUT):
+            device.stop()
+            pytest.fail(f"native_sim failed to boot within {BOOT_TIMEOUT}s")
+
+        yield device
+        device.stop()
+
+    def replay(self, sim, fragments, settle=0.5):
+        for fragment in fragments:
+            sim.shell_command(f"ble rx {fragment.hex()}")
+            time.sleep(0.05)
+        time.sleep(settle)
+
+    def stats(self, sim):
+        before = len(sim.get_shell_output())
+        sim.shell_command("ble reassembly")
+        time.sleep(0.5)
+        output = sim.get_shell_output()[before:]
+        stats = {}
+        for name in ("Completed", "Timeouts", "Aborted", "Rejected", "Duplicates"):
+            match = re.search(rf"{name}:\s+(\d+)", output)
+            assert match, f"'{name}' missing in shell output:\n{output}"
+            stats[name.lower()] = int(match.group(1))
+        return stats
+
+    def delta(self, sim, fragments, settle=0.5):
+        before = self.stats(sim)
+        self.replay(sim, fragments, settle)
+        after = self.stats(sim)
+        assert not sim.has_crash(), sim.get_logs()[-2000:]
+        return {key: after[key] - before[key] for key in after}
+
+    def test_in_order(self, sim):
+        fragments = chronos_fragments(chronos_message(0x72, 120))
+        assert self.delta(sim, fragments)["completed"] == 1
+
+    def test_single_packet(self, sim):
+        assert self.delta(sim, [chronos_message(0x71, 8)])["completed"] == 1
+
+    def test_out_of_order(self, sim):
+        fragments = chronos_fragments(chronos_message(0x72, 120))
+        reordered = [fragments[0]] + list(reversed(fragments[1:]))
+        assert self.delta(sim, reordered)["completed"] == 1
+
+    def test_duplicates(self, sim):
+        fragments = chronos_fragments(chronos_message(0x72, 120))
+        fragments.insert(2, fragments[1])
+        result = self.delta(sim, fragments)
+        assert result["completed"] == 1
+        assert result["duplicates"] == 1
+
+    def test_truncated_times_out(self, sim):
+        fragments = chronos_fragments(chronos_message(0x72, 120))[:-2]
+        result = self.delta(sim, fragments, settle=REASSEMBLER_TIMEOUT * 1.5 + 0.5)
+        assert result["completed"] == 0
+        assert result["timeouts"] == 1
+
+    def test_out_of_bounds(self, sim):
+        fragments = chronos_fragments(chronos_message(0x72, 60))
+        # Continuation index far past the announced length.
+        fragments.insert(1, bytes([0x10]) + bytes(19))
+        result = self.delta(sim, fragments)
+        assert result["rejected"] == 1
+        assert result["aborted"] == 1
+        assert result["completed"] == 0
+
+    def test_new_message_aborts_partial(self, sim):
+        first = chronos_fragments(chronos_message(0x72, 120))[:2]
+        second = chronos_fragments(chronos_message(0x72, 60))
+        result = self.delta(sim, first + second)
+        assert result["aborted"] == 1
+        assert result["completed"] == 1
+
+    def test_gadgetbridge_split(self, sim):
+        message = b'GB({"t":"notify","id":1,"src":"Test","title":"Reassembly","body":"' + b"x" * 200 + b'"})\n'
+        fragments = [message[i:i + 20] for i in range(0, len(message), 20)]
+        assert self.delta(sim, fragments)["completed"] == 1
@@ -0,0 +1,194 @@
+"""
+Replay captured phone traffic on native_sim and record how long the BLE RX path takes to parse it.
+
+Gadgetbridge and Chronos captures are injected with ``ble rx <hex>`` at different fragment sizes
+and packet intervals, no radio is involved. The firmware (CONFIG_ZSW_BLE_RX_BENCH) records for every
+reassembled message the time waiting for the protocol work queue, the time spent in the parser and
+until the first zbus event reached its listeners. Together with the stack high-water mark of the
+protocol work queue and the messages dropped by the reassembler, the results are written to a CSV
+for regression tracking.
+
+ANCS is not covered, its attributes are parsed by the NCS client from GATT Data Source
+notifications which need a bonded iOS peer.
+
+The firmware has to be built with boards/ble_rx_bench.conf, otherwise the tests are skipped::
+
+    west build app -b native_sim/native/64 -- -DSB_CONF_FILE=sysbuild_no_mcuboot_no_xip.conf \
+        -DEXTRA_CONF_FILE="boards/test_mode.conf;boards/ble_rx_bench.conf"
+
+Usage::
+
+    pytest test_ble_rx_benchmark.py -s
+    ZSW_BLE_BENCH_CSV=results.csv pytest test_ble_rx_benchmark.py -s --exe-path path/to/zephyr.exe
+"""
+
+import csv
+import os
+import re
+import struct
+import time
+
+import pytest
+from native_sim_runner import NativeSimDevice
+# The conftest overrides of test_native_app, native_sim tests manage their own process.
+from test_native_app import BOOT_MARKER, BOOT_TIMEOUT, _find_exe, prepare_device, reset_device, uart_logs  # noqa: F401
+from test_ble_reassembly import chronos_fragments
+
+CSV_PATH = os.environ.get("ZSW_BLE_BENCH_CSV", "/tmp/zswatch_ble_rx_bench.csv")
+CSV_FIELDS = [
+    "capture", "fragment_size", "interval_ms", "stream", "len", "queue_us", "decode_us", "publish_us", "events",
+    "stack_unused", "dropped",
+]
+
+# Each message is replayed this many times per scenario.
+REPEAT = 5
+# "ble rx <hex>" has to fit in the shell command buffer.
+MAX_FRAGMENT_SIZE = 120
+# Stack bytes that must stay unused on the protocol work queue.
+MIN_STACK_MARGIN = 512
+
+SAMPLE_RE = re.compile(r"(\w+),(\d+),(\d+),(\d+),(\d+),(\d+)\r?$", re.MULTILINE)
+
+
+def gadgetbridge(payload):
+    return b"GB(" + payload + b")\n"
+
+
+def chronos_notification(text):
+    """Chronos 0x72 notification, WhatsApp icon and state 2 (new notification)."""
+    body = bytes([0xFF, 0x72, 0x80, 0x0A, 0x02]) + text
+    return bytes([0xAB]) + struct.pack(">H", len(body)) + body
+
+
+def http_response(size):
+    item = b'{\\"t\\":12.5,\\"w\\":\\"cloudy\\"},'
+    results = (item * (size // len(item) + 1))[:size]
+    return gadgetbridge(b'{"t":"http","resp":"{\\"results\\":[' + results + b']}"}')
+
+
+GB_CAPTURES = {
+    "gb_notify": gadgetbridge(
+        b'{"t":"notify","id":1700000001,"src":"Messenger","title":"Alice",'
+        b'"body":"Are we still on for lunch tomorrow? I can book a table at noon.","sender":"Alice"}'
+    ),
+    "gb_weather": gadgetbridge(
+        b'{"t":"weather","temp":288,"hum":71,"code":802,"txt":"slightly cloudy","wind":3.0,"wdir":220,'
+        b'"loc":"MALMO"}'
+    ),
+    "gb_http": http_response(1400),
+}
+
+CHRONOS_CAPTURES = {
+    "chronos_notify": chronos_notification(b"Alice:Are we still on for lunch tomorrow? I can book a table."),
+    "chronos_notify_long": chronos_notification(b"Bob:" + b"Long message with a lot of text. " * 12),
+}
+
+
+def split(message, size):
+    return [message[i:i + size] for i in range(0, len(message), size)]
+
+
+@pytest.fixture(scope="module")
+def csv_rows():
+    rows = []
+    yield rows
+    with open(CSV_PATH, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=CSV_FIELDS)
+        writer.writeheader()
+        writer.writerows(rows)
+    print(f"\nBLE RX benchmark: {len(rows)} samples written to {CSV_PATH}")
+
+
+@pytest.mark.linux_only
+class TestBleRxBenchmark:
+    @pytest.fixture(scope="class")
+    def sim(self, request):
+        exe = _find_exe(request)
+        if not exe:
+            pytest.skip("No native_sim executable found (build or provide --exe-path)")
+
+        device = NativeSimDevice(exe_path=exe)
+        device.start()
+        if not device.wait_for_log(BOOT_MARKER, timeout=BOOT_TIMEOUT):
+            device.stop()
+            pytest.fail(f"native_sim failed to boot within {BOOT_TIMEOUT}s")
+
+        yield device
+        device.stop()
+
+    def command(self, sim, cmd, settle=0.5):
+        before = len(sim.get_shell_output())
+        sim.shell_command(cmd)
+        time.sleep(settle)
+        return sim.get_shell_output()[before:]
+
+    def summary(self, sim):
+        output = self.command(sim, "ble bench stats")
+        if "RX bench" not in output:
+            pytest.skip("Firmware built without CONFIG_ZSW_BLE_RX_BENCH")
+        summary = {}
+        for name in ("Messages", "Dropped", "Overflows", "Stack unused"):
+            match = re.search(rf"{name}:\s+(\d+)", output)
+            assert match, f"'{name}' missing in shell output:\n{output}"
+            summary[name.lower().replace(" ", "_")] = int(match.group(1))
+        return summary
+
+    def run(self, sim, csv_rows, capture, fragments, fragment_size, interval_ms):
+        self.command(sim, "ble bench reset")
+        self.summary(sim)
+
+        for _ in range(REPEAT):
+            for fragment in fragments:
+                sim.shell_command(f"ble rx {fragment.hex()}")
+                time.sleep(interval_ms / 1000)
+            time.sleep(0.1)
+        time.sleep(0.5)
+
+        summary = self.summary(sim)
+        output = self.command(sim, "ble bench dump", settle=1.0)
+        samples = SAMPLE_RE.findall(output)
+        assert not sim.has_crash(), sim.get_logs()[-2000:]
+
+        for stream, length, queue_us, decode_us, publish_us, events in samples:
+            csv_rows.append({
+                "capture": capture,
+                "fragment_size": fragment_size,
+                "interval_ms": interval_ms,
+                "stream": stream,
+                "len": int(length),
+                "queue_us": int(queue_us),
+                "decode_us": int(decode_us),
+                "publish_us": int(publish_us),
+                "events": int(events),
+                "stack_unused": summary["stack_unused"],
+                "dropped": summary["dropped"],
+            })
+
+        decode = sorted(int(sample[3]) for sample in samples)
+        if decode:
+            print(f"\n{capture} frag={fragment_size} interval={interval_ms}ms: {len(samples)} msgs, "
+                  f"decode median {decode[len(decode) // 2]} us max {decode[-1]} us, "
+                  f"stack unused {summary['stack_unused']}, dropped {summary['dropped']}")
+
+        assert summary["dropped"] == 0
+        assert summary["messages"] == REPEAT
+        assert len(samples) == REPEAT
+        if summary["stack_unused"]:
+            assert summary["stack_unused"] >= MIN_STACK_MARGIN
+        return samples
+
+    @pytest.mark.parametrize("interval_ms", [0, 20])
+    @pytest.mark.parametrize("fragment_size", [20, 64, MAX_FRAGMENT_SIZE])
+    @pytest.mark.parametrize("capture", sorted(GB_CAPTURES))
+    def test_gadgetbridge(self, sim, csv_rows, capture, fragment_size, interval_ms):
+        samples = self.run(sim, csv_rows, capture, split(GB_CAPTURES[capture], fragment_size), fragment_size,
+                           interval_ms)
+        assert all(sample[0] == "gadgetbridge_rx" for sample in samples)
+
+    # Chronos fragment layout is fixed by the protocol, 20 byte first packet then index + 19 bytes.
+    @pytest.mark.parametrize("interval_ms", [0, 20])
+    @pytest.mark.parametrize("capture", sorted(CHRONOS_CAPTURES))
+    def test_chronos(self, sim, csv_rows, capture, interval_ms):
+        samples = self.run(sim, csv_rows, capture, chronos_fragments(CHRONOS_CAPTURES[capture]), 20, interval_ms)
+        assert all(sample[0] == "chronos_rx" for sample in samples)
+        assert all(int(sample[5]) > 0 for sample in samples), "Notification not published on zbus"
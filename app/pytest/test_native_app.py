@@ -30,6 +30,7 @@ Options:
 """
 
 import os
+import re
 import subprocess
 import time
 
@@ -175,6 +176,218 @@ class TestNativeSim:
 
         sim.shell_command("app state")
 
+    def test_altitude_floors(self, sim):
+        """Ramp the emulated pressure down and verify the climb is counted as floors."""
+        sim.shell_command("altitude reset")
+        time.sleep(0.5)
+
+        # 1.25 hPa is about 10.5 m, the emulator ramps there at stair climbing speed in 25 s.
+        sim.shell_command("altitude emul 1012.0")
+        time.sleep(40)
+
+        sim.shell_command("altitude status")
+        time.sleep(0.5)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        floors = re.findall(r"Floors up: (\d+)", output)
+        assert floors, "No altitude status printed"
+        assert int(floors[-1]) >= 2, f"Expected at least 2 floors climbed, got {floors[-1]}"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during altitude test: {crash}"
+
+    def test_sensor_trace_record_replay(self, sim):
+        """Record pressure and light to a trace, replay it faster and verify every record is replayed."""
+        sim.shell_command("sensor_trace record pytest 100 pressure light")
+        time.sleep(3)
+        sim.shell_command("sensor_trace stop")
+        time.sleep(0.5)
+        sim.shell_command("sensor_trace status")
+        time.sleep(0.5)
+        recorded = re.findall(r"Records: (\d+)", sim.get_shell_output())
+        assert recorded and int(recorded[-1]) > 0, "Nothing recorded"
+
+        sim.shell_command("sensor_trace replay pytest 4")
+        time.sleep(2)
+        sim.shell_command("sensor_trace status")
+        time.sleep(0.5)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        modes = re.findall(r"Mode: (\w+)", output)
+        replayed = re.findall(r"Records: (\d+)", output)
+        assert modes[-1] == "idle", f"Replay still running: {modes[-1]}"
+        assert replayed[-1] == recorded[-1], f"Replayed {replayed[-1]} of {recorded[-1]} records"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during sensor trace test: {crash}"
+
+    def test_auto_brightness(self, sim):
+        """Brighten in emulated daylight, then dim once the light stays down in a dark room."""
+        sim.shell_command("power wake")
+        sim.shell_command("display auto_brightness on")
+        sim.shell_command("display emul_lux 5000")
+        time.sleep(5)
+
+        sim.shell_command("display auto_brightness")
+        time.sleep(0.5)
+        bright = re.findall(r"Backlight level: (\d+)", sim.get_shell_output())
+        assert bright, "No auto brightness status printed"
+
+        sim.shell_command("power wake")
+        sim.shell_command("display emul_lux 2")
+        time.sleep(10)
+
+        sim.shell_command("display auto_brightness")
+        time.sleep(0.5)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        dark = re.findall(r"Backlight level: (\d+)", output)
+        assert int(bright[-1]) > 20, f"Expected a bright backlight in daylight, got level {bright[-1]}"
+        assert int(dark[-1]) < 5, f"Expected a dim backlight in the dark, got level {dark[-1]}"
+        assert "Backlight energy saved" in output, "No energy comparison printed"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during auto brightness test: {crash}"
+
+    def test_display_bus_sessions(self, sim):
+        """Keep the SPI bus up for a whole frame and skip redundant windows on the emulated GC9A01."""
+        sim.shell_command("display bus_bench")
+        time.sleep(3)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        pattern = r"{}: (\d+) areas, (\d+) PM transitions, (\d+) transactions, (\d+) command bytes"
+        strips = re.search(pattern.format("Contiguous strips"), output)
+        scattered = re.search(pattern.format("Scattered areas"), output)
+        mismatches = re.search(r"Mismatched pixels: (\d+)", output)
+        assert strips and scattered and mismatches, "Bus benchmark did not complete"
+
+        areas, pm_transitions, transactions, cmd_bytes = (int(v) for v in strips.groups())
+        assert pm_transitions <= 2, f"Expected one resume and suspend per frame, got {pm_transitions}"
+        assert transactions == 1, f"Expected chip select held for the whole frame, got {transactions} transactions"
+        assert cmd_bytes < areas * 11 // 4, f"Expected contiguous strips to skip most windows, got {cmd_bytes} bytes"
+
+        areas, pm_transitions, _, cmd_bytes = (int(v) for v in scattered.groups())
+        assert pm_transitions <= 2, f"Expected one resume and suspend per frame, got {pm_transitions}"
+        assert cmd_bytes <= areas * 11, f"Expected command and parameters only, got {cmd_bytes} bytes"
+        assert int(mismatches.group(1)) == 0, "Emulated display memory does not match the written areas"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during display bus test: {crash}"
+
+    def test_display_render_on_te(self, sim):
+        """LVGL renders start on a refresh of the emulated panel, locked to a whole number of refreshes."""
+        sim.shell_command("power wake")
+        time.sleep(1)
+        sim.shell_command("display render_stats reset")
+        time.sleep(3)
+        sim.shell_command("display render_stats")
+        time.sleep(0.5)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        stats = re.search(r"LVGL renders: (\d+), (\d+) started on a panel refresh, refresh slot (\d+) us", output)
+        assert stats, "No render counters printed"
+
+        renders, on_te, slot_us = (int(v) for v in stats.groups())
+        assert renders > 0, "Expected LVGL to render while the watchface is shown"
+        assert slot_us > 0, "Expected the LVGL refresh period to be locked to the panel refresh"
+        assert on_te >= renders * 9 // 10, f"Expected renders to start on a panel refresh, {on_te} of {renders}"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during render pacing test: {crash}"
+
+    def test_display_te_gate(self, sim):
+        """Writes wait for the emulated scanline, so a sweeping second hand never tears."""
+        sim.shell_command("display te_bench")
+        time.sleep(6)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        pattern = r"{}: (\d+) frames, (\d+) panel refreshes, (\d+) dropped, (\d+) torn"
+        ungated = re.search(pattern.format("Without TE gate"), output)
+        gated = re.search(pattern.format("With TE gate"), output)
+        assert ungated and gated, "TE benchmark did not complete"
+
+        _, _, _, torn = (int(v) for v in ungated.groups())
+        assert torn > 0, "Expected torn frames without the TE gate, the emulated scanout is not exercised"
+
+        _, _, dropped, torn = (int(v) for v in gated.groups())
+        assert torn == 0, f"Expected no torn frames with the TE gate, got {torn}"
+        assert dropped == 0, f"Expected every LVGL refresh slot to be met, {dropped} dropped"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during TE gate test: {crash}"
+
+    def _select_watchface(self, sim, name):
+        """Show a watchface by name, the default one ticks once a minute, too rarely for a 10 s window."""
+        sim.shell_command("watchface wakeups")
+        time.sleep(0.5)
+        output = sim.get_shell_output()
+        face = re.search(r"\[(\d+)\] {} \(".format(re.escape(name)), output)
+        assert face, f"Watchface {name} not found"
+        sim.shell_command(f"watchface select {face.group(1)}")
+        time.sleep(1)
+
+    def test_watchface_redraw_planner(self, sim):
+        """Clock ticks on the watchface redraw and flush a small fraction of the screen."""
+        sim.shell_command("power wake")
+        time.sleep(1)
+        # Analog hands with a second hand, redrawn through the planner every second.
+        self._select_watchface(sim, "Analog Blue")
+        time.sleep(1)
+        sim.shell_command("watchface planner reset")
+        time.sleep(10)
+        sim.shell_command("watchface planner")
+        time.sleep(1)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        ticks = re.search(r"Ticks: (\d+), (\d+) skipped", output)
+        invalidated = re.search(r"Invalidated per tick: (\d+) px average, (\d+) px max, of (\d+) px", output)
+        flushed = re.search(r"Flushed: (\d+) areas, (\d+) bytes per second, (\d+) permille", output)
+        assert ticks and invalidated and flushed, "Watchface planner counters not printed"
+
+        assert int(ticks.group(1)) >= 5, f"Expected a clock tick every second, got {ticks.group(1)}"
+        average_px, _, screen_px = (int(v) for v in invalidated.groups())
+        assert average_px < screen_px // 10, f"Expected ticks to invalidate a small area, got {average_px} px"
+        permille = int(flushed.group(3))
+        assert permille < 100, f"Expected a small fraction of a frame flushed per second, got {permille} permille"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during watchface planner test: {crash}"
+
+    def test_watchface_wakeups(self, sim):
+        """The clock wakes up once per change of the shown time, not on a fixed period."""
+        sim.shell_command("power wake")
+        time.sleep(1)
+        # A minute face wakes up 0 or 1 times in the window, extrapolated per hour that says nothing.
+        self._select_watchface(sim, "Analog Blue")
+        time.sleep(1)
+        sim.shell_command("watchface wakeups reset")
+        time.sleep(10)
+        sim.shell_command("watchface wakeups")
+        time.sleep(1)
+        output = sim.get_shell_output()
+        print(f"\n=== Shell output ===\n{output}")
+
+        current = re.search(r"\((second|minute|sub-second)\): (\d+) wakeups in (\d+) s shown, (\d+) per hour \[current\]",
+                            output)
+        assert current, "Wakeups of the current watchface not printed"
+
+        granularity = current.group(1)
+        wakeups, _, per_hour = (int(v) for v in current.groups()[1:])
+        assert granularity == "second", f"Expected the selected second granularity watchface, got {granularity}"
+        expected = 3600
+        assert wakeups >= 5, f"Expected a clock wakeup every second, got {wakeups}"
+        assert per_hour <= expected * 5 // 4, f"Expected about {expected} wakeups per hour, got {per_hour}"
+
+        crash = sim.has_crash()
+        assert not crash, f"Crash during watchface wakeup test: {crash}"
+
 
 # ── BLE tests ────────────────────────────────────────────────
 
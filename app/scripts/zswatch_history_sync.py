@@ -0,0 +1,90 @@
+# Copyright (c) 2025 ZSWatch Project
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Download stored histories (steps, battery, ...) from the ZSWatch history sync GATT service.
+
+The watch only sends samples newer than the last one acked, so running the script twice
+in a row transfers nothing the second time.
+"""
+
+import argparse
+import asyncio
+import struct
+import time
+
+from bleak import BleakClient, BleakScanner
+
+SYNC_CTRL_UUID = "5a535702-6869-7374-8000-00805f9b34fb"
+SYNC_DATA_UUID = "5a535703-6869-7374-8000-00805f9b34fb"
+
+CMD_LIST = 0x01
+CMD_START = 0x02
+CMD_ACK = 0x03
+
+FRAME_DATA = 0x10
+FRAME_END = 0x11
+FRAME_INFO = 0x12
+
+
+async def sync(address, history_id, ack_every):
+    histories = {}
+    samples = []
+    done = asyncio.Event()
+    state = {"frames": 0, "next_seq": None}
+
+    device = await BleakScanner.find_device_by_address(address)
+    async with BleakClient(device) as client:
+        async def ack(seq):
+            await client.write_gatt_char(SYNC_CTRL_UUID, struct.pack("<BBI", CMD_ACK, history_id, seq), response=True)
+
+        def on_data(_, data: bytearray):
+            if data[0] == FRAME_INFO:
+                hid, sample_size, total, acked = struct.unpack_from("<BBII", data, 1)
+                histories[hid] = (sample_size, total, acked, data[11:].decode(errors="replace"))
+            elif data[0] == FRAME_DATA:
+                hid, first_seq, count = struct.unpack_from("<BIB", data, 1)
+                size = histories[hid][0]
+                for i in range(count):
+                    samples.append((first_seq + i, bytes(data[7 + i * size:7 + (i + 1) * size])))
+                state["frames"] += 1
+                state["next_seq"] = first_seq + count
+                if ack_every and state["frames"] % ack_every == 0:
+                    asyncio.get_event_loop().create_task(ack(state["next_seq"]))
+            elif data[0] == FRAME_END:
+                _, state["next_seq"] = struct.unpack_from("<BI", data, 1)
+                done.set()
+
+        await client.start_notify(SYNC_DATA_UUID, on_data)
+        await client.write_gatt_char(SYNC_CTRL_UUID, bytes([CMD_LIST]), response=True)
+        # One INFO frame per registered history, no end marker.
+        await asyncio.sleep(1)
+        for hid, (size, total, acked, key) in histories.items():
+            print(f"History {hid} '{key}': sample size {size}, total {total}, acked {acked}")
+
+        start = time.monotonic()
+        await client.write_gatt_char(SYNC_CTRL_UUID, bytes([CMD_START, history_id]), response=True)
+        await done.wait()
+        elapsed = time.monotonic() - start
+        await ack(state["next_seq"])
+
+        print(f"Received {len(samples)} samples in {state['frames']} frames, {elapsed:.2f} s")
+        if samples:
+            print(f"{elapsed * 1000 * 1000 / len(samples):.0f} ms and "
+                  f"{state['frames'] * 1000 / len(samples):.0f} notifications per 1000 samples")
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Sync stored histories from ZSWatch")
+    parser.add_argument("address", help="BLE address of the watch")
+    parser.add_argument("--id", type=int, default=0, help="History id, 0 = steps, 1 = battery")
+    parser.add_argument("--ack-every", type=int, default=20, help="Ack progress every N frames, 0 = only at end")
+    args = parser.parse_args()
+
+    for seq, data in asyncio.run(sync(args.address, args.id, args.ack_every)):
+        print(seq, data.hex())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+# Copyright (c) 2025 ZSWatch Project
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Record raw accelerometer and gyroscope samples from the ZSWatch IMU stream GATT service to CSV.
+
+Values are converted to m/s^2 and rad/s using the ranges read from the config characteristic.
+"""
+
+import argparse
+import asyncio
+import math
+import struct
+import sys
+
+from bleak import BleakClient, BleakScanner
+
+IMU_CONFIG_UUID = "5a535402-696d-7573-8000-00805f9b34fb"
+IMU_DATA_UUID = "5a535403-696d-7573-8000-00805f9b34fb"
+
+HEADER_LEN = 7
+SAMPLE_LEN = 12
+
+
+async def record(address, rate_hz, duration, out):
+    state = {"seq": None, "lost": 0, "samples": 0}
+
+    device = await BleakScanner.find_device_by_address(address)
+    async with BleakClient(device) as client:
+        await client.write_gatt_char(IMU_CONFIG_UUID, struct.pack("<H", rate_hz), response=True)
+        rate_hz, accel_range_g, gyro_range_dps = struct.unpack(
+            "<HBH", await client.read_gatt_char(IMU_CONFIG_UUID))
+        accel_scale = accel_range_g * 9.80665 / 32767
+        gyro_scale = math.radians(gyro_range_dps) / 32767
+        period_us = 1000000 // rate_hz
+
+        def on_data(_, data: bytearray):
+            seq, timestamp_us, count = struct.unpack_from("<HIB", data)
+            if state["seq"] is not None and seq != (state["seq"] + 1) & 0xFFFF:
+                state["lost"] += (seq - state["seq"] - 1) & 0xFFFF
+            state["seq"] = seq
+            for i in range(count):
+                raw = struct.unpack_from("<6h", data, HEADER_LEN + i * SAMPLE_LEN)
+                values = [v * accel_scale for v in raw[:3]] + [v * gyro_scale for v in raw[3:]]
+                out.write(f"{(timestamp_us + i * period_us) & 0xFFFFFFFF}," +
+                          ",".join(f"{v:.5f}" for v in values) + "\n")
+            state["samples"] += count
+
+        out.write("timestamp_us,ax,ay,az,gx,gy,gz\n")
+        await client.start_notify(IMU_DATA_UUID, on_data)
+        await asyncio.sleep(duration)
+        await client.stop_notify(IMU_DATA_UUID)
+
+    print(f"{state['samples']} samples at {rate_hz} Hz, {state['lost']} packets lost", file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Record raw IMU data from ZSWatch")
+    parser.add_argument("address", help="BLE address of the watch")
+    parser.add_argument("--rate", type=int, default=100, choices=[100, 200, 400], help="Sample rate in Hz")
+    parser.add_argument("--duration", type=float, default=10, help="Seconds to record")
+    parser.add_argument("--out", type=argparse.FileType("w"), default=sys.stdout, help="CSV file")
+    args = parser.parse_args()
+
+    asyncio.run(record(args.address, args.rate, args.duration, args.out))
+
+
+if __name__ == "__main__":
+    main()
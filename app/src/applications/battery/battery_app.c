@@ -22,6 +22,7 @@
 #include <zephyr/settings/settings.h>
 
 #include "history/zsw_history.h"
+#include "ble/zsw_history_sync.h"
 #include "battery/battery_ui.h"
 #include "events/battery_event.h"
 #include "managers/zsw_app_manager.h"
@@ -188,6 +189,8 @@ static int battery_app_add(void)
         return -EFAULT;
     }
 
+    zsw_history_sync_register(&battery_context, ZSW_HISTORY_SYNC_ID_BATTERY);
+
     return 0;
 }
 
@@ -19,11 +19,11 @@
 #include <zephyr/init.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/sensor.h>
-#include <math.h>
 
 #include "sensors_summary_ui.h"
-#include "sensors/zsw_pressure_sensor.h"
+#include "sensors/zsw_altitude.h"
 #include "sensors/zsw_light_sensor.h"
+#include "sensors/zsw_sensor_scheduler.h"
 #include "managers/zsw_app_manager.h"
 #include "ui/utils/zsw_ui_utils.h"
 
@@ -44,48 +44,44 @@ static application_t app = {
     .category = ZSW_APP_CATEGORY_SENSORS,
 };
 
+// Reuse readings other consumers made within half a refresh.
+#define SENSOR_MAX_AGE_MS   (CONFIG_APPLICATIONS_CONFIGURATION_SENSORS_SUMMARY_REFRESH_INTERVAL_MS / 2)
+
 static lv_timer_t *refresh_timer;
-static float relative_pressure;
+static float reference_altitude;
 
 static void sensors_summary_app_start(lv_obj_t *root, lv_group_t *group)
 {
     sensors_summary_ui_show(root, on_close_sensors_summary, on_ref_set);
 
-    // Set inital relative pressure.
+    // Set inital relative height.
     on_ref_set();
 
-    // Increase ODR since we want high accuracy here.
-    zsw_pressure_sensor_set_odr(BOSCH_BMP581_ODR_160_HZ);
     refresh_timer = lv_timer_create(timer_callback, CONFIG_APPLICATIONS_CONFIGURATION_SENSORS_SUMMARY_REFRESH_INTERVAL_MS,
                                     NULL);
 }
 
 static void sensors_summary_app_stop(void)
 {
-    // Cleanup after ourselves
-    // TODO need mechanism so that multiple user can request ODR without
-    // breaking for another when changed.
-    zsw_pressure_sensor_set_odr(BOSCH_BMP581_ODR_DEFAULT);
     lv_timer_del(refresh_timer);
     sensors_summary_ui_remove();
 }
 
-static double get_relative_height_m(double relative_pressure, double new_pressure, double temperature)
-{
-    return ((powf((relative_pressure / new_pressure), 1.f / 5.257f) - 1.f) * (temperature + 273.15f)) / 0.0065f;
-}
-
 static void timer_callback(lv_timer_t *timer)
 {
-    float pressure = 0.0;
     float light = -1.0;
+    zsw_sensor_reading_t reading;
+    zsw_altitude_state_t altitude = { 0 };
 
-    zsw_pressure_sensor_get_pressure(&pressure);
-    zsw_light_sensor_get_light(&light);
+    // The altitude engine owns the pressure sensor, its filtered samples are more stable than a single fetch.
+    zsw_altitude_get(&altitude);
+    if (zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_LIGHT, &reading, SENSOR_MAX_AGE_MS) == 0) {
+        light = reading.data.light;
+    }
 
-    sensors_summary_ui_set_pressure(pressure);
+    sensors_summary_ui_set_pressure(altitude.pressure);
     sensors_summary_ui_set_light(light);
-    sensors_summary_ui_set_rel_height(get_relative_height_m(relative_pressure, pressure, 0.0));
+    sensors_summary_ui_set_rel_height(altitude.altitude - reference_altitude);
 }
 
 static void on_close_sensors_summary(void)
@@ -95,7 +91,11 @@ static void on_close_sensors_summary(void)
 
 static void on_ref_set(void)
 {
-    zsw_pressure_sensor_get_pressure(&relative_pressure);
+    zsw_altitude_state_t altitude;
+
+    if (zsw_altitude_get(&altitude) == 0) {
+        reference_altitude = altitude.altitude;
+    }
 }
 
 static int sensors_summary_app_add(void)
@@ -27,9 +27,10 @@
 #include "ble/ble_aoa.h"
 #include "ble/ble_comm.h"
 #include "ble/ble_log_backend.h"
-#include "sensors/zsw_imu.h"
 #include "drivers/zsw_display_control.h"
 #include "managers/zsw_app_manager.h"
+#include "managers/zsw_brightness_manager.h"
+#include "managers/zsw_fitness_manager.h"
 #include "zsw_settings.h"
 #include <filesystem/zsw_rtt_flash_loader.h>
 #include "ui/popup/zsw_popup_window.h"
@@ -43,6 +44,7 @@ static bool settings_app_back(void);
 
 static void on_close_settings(void);
 static void on_brightness_changed(lv_setting_value_t value, bool final);
+static void on_auto_brightness_changed(lv_setting_value_t value, bool final);
 static void on_display_on_changed(lv_setting_value_t value, bool final);
 static void on_display_vib_press_changed(lv_setting_value_t value, bool final);
 static void on_relative_battery_press_changed(lv_setting_value_t value, bool final);
@@ -64,6 +66,7 @@ ZSW_LV_IMG_DECLARE(settings);
 
 typedef struct setting_app {
     zsw_settings_brightness_t           brightness;
+    zsw_settings_auto_brightness_t      auto_brightness;
     zsw_settings_vib_on_press_t         vibration_on_click;
     zsw_settings_display_always_on_t    display_always_on;
     zsw_settings_ble_log_en_t           ble_log_enabled;
@@ -77,6 +80,7 @@ K_WORK_DELAYABLE_DEFINE(ble_pairing_dwork, ble_pairing_work_handler);
 // Default values.
 static setting_app_t settings_app = {
     .brightness = 50,
+    .auto_brightness = true,
     .vibration_on_click = true,
     .display_always_on = false,
     .ble_log_enabled = false,
@@ -113,6 +117,17 @@ static lv_settings_item_t display_page_items[] = {
             }
         }
     },
+    {
+        .type = LV_SETTINGS_TYPE_SWITCH,
+        .icon = LV_SYMBOL_EYE_OPEN,
+        .change_callback = on_auto_brightness_changed,
+        .item = {
+            .sw = {
+                .name = "Auto brightness",
+                .inital_val = &settings_app.auto_brightness
+            }
+        }
+    },
     {
         .type = LV_SETTINGS_TYPE_SWITCH,
         .icon = LV_SYMBOL_TINT,
@@ -320,6 +335,7 @@ static void ble_pairing_work_handler(struct k_work *work)
 static void settings_app_start(lv_obj_t *root, lv_group_t *group)
 {
     settings_load_subtree(ZSW_SETTINGS_PATH); // Update any values that may have changed outside of the settings app.
+    settings_app.auto_brightness = zsw_brightness_manager_is_enabled();
     lv_settings_create(root, settings_menu, ARRAY_SIZE(settings_menu), "N/A", group, on_close_settings);
 }
 
@@ -347,6 +363,12 @@ static void on_brightness_changed(lv_setting_value_t value, bool final)
     }
 }
 
+static void on_auto_brightness_changed(lv_setting_value_t value, bool final)
+{
+    settings_app.auto_brightness = value.item.sw;
+    zsw_brightness_manager_set_enabled(settings_app.auto_brightness);
+}
+
 static void on_display_on_changed(lv_setting_value_t value, bool final)
 {
     settings_app.display_always_on = value.item.sw;
@@ -417,7 +439,7 @@ static void on_clear_bonded_changed(lv_setting_value_t value, bool final)
 static void on_reset_steps_changed(lv_setting_value_t value, bool final)
 {
     if (final) {
-        zsw_imu_reset_step_count();
+        zsw_fitness_manager_reset_steps();
     }
 }
 
@@ -588,7 +610,10 @@ static int settings_load_cb(const char *name, size_t len,
 
 static int settings_commit_cb(void)
 {
-    zsw_display_control_set_brightness(settings_app.brightness);
+    // With automatic brightness the stored brightness is only used when it is turned off.
+    if (!zsw_brightness_manager_is_enabled()) {
+        zsw_display_control_set_brightness(settings_app.brightness);
+    }
     return 0;
 }
 
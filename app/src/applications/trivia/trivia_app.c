@@ -73,7 +73,7 @@ static int trivia_app_add(void)
     return 0;
 }
 
-static void http_rsp_cb(ble_http_status_code_t status, char *response)
+static void http_rsp_cb(ble_http_status_code_t status, const char *response)
 {
     if (status == BLE_HTTP_STATUS_OK && app.current_state == ZSW_APP_STATE_UI_VISIBLE) {
         cJSON *parsed_response = cJSON_Parse(response);
@@ -32,34 +32,42 @@
 
 #include "watchface_app.h"
 #include "zsw_settings.h"
-#include "events/accel_event.h"
 #include "events/battery_event.h"
+#include "events/step_event.h"
 #include "events/activity_event.h"
 #include "events/ble_event.h"
-#include "sensors/zsw_imu.h"
-#include "sensors/zsw_pressure_sensor.h"
+#include "sensors/zsw_sensor_scheduler.h"
 #include "drivers/zsw_display_control.h"
+#include "managers/zsw_fitness_manager.h"
 #include "managers/zsw_notification_manager.h"
 #include "ui/watchfaces/zsw_watchface_dropdown_ui.h"
+#include "ui/watchfaces/zsw_watchface_planner.h"
 
 LOG_MODULE_REGISTER(watcface_app, LOG_LEVEL_WRN);
 
 #define MAX_WATCHFACES  15
-#define NORMAL_TIME_UPDATE_INTERVAL   K_MSEC(1000)
-#define SMOOTH_TIME_UPDATE_INTERVAL   K_MSEC(50)
+// Step of a smooth second hand.
+#define SUB_SECOND_TICK_US          50000
+// Wake up just after the clock passed the boundary, not just before it.
+#define TICK_MARGIN_US              2000
+// Woken up before the clock reached the boundary, the kernel clock and the RTC are not in phase.
+#define EARLY_TICK_RETRY            K_MSEC(10)
+// Below this the display is dimmed and a smooth second hand is not worth 20 wakeups per second.
+#define SUB_SECOND_MIN_BRIGHTNESS   30
 
 static void zbus_ble_comm_data_callback(const struct zbus_channel *chan);
-static void zbus_accel_data_callback(const struct zbus_channel *chan);
+static void zbus_step_data_callback(const struct zbus_channel *chan);
 static void zbus_battery_sample_data_callback(const struct zbus_channel *chan);
 static void zbus_activity_event_callback(const struct zbus_channel *chan);
+static void zbus_notification_callback(const struct zbus_channel *chan);
 static int settings_load_handler_watchface(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
                                            void *param);
 
 ZBUS_CHAN_DECLARE(ble_comm_data_chan);
 ZBUS_LISTENER_DEFINE(watchface_ble_comm_lis, zbus_ble_comm_data_callback);
 
-ZBUS_CHAN_DECLARE(accel_data_chan);
-ZBUS_LISTENER_DEFINE(watchface_accel_lis, zbus_accel_data_callback);
+ZBUS_CHAN_DECLARE(step_data_chan);
+ZBUS_LISTENER_DEFINE(watchface_step_lis, zbus_step_data_callback);
 
 ZBUS_CHAN_DECLARE(battery_sample_data_chan);
 ZBUS_LISTENER_DEFINE(watchface_battery_event, zbus_battery_sample_data_callback);
@@ -67,17 +75,23 @@ ZBUS_LISTENER_DEFINE(watchface_battery_event, zbus_battery_sample_data_callback)
 ZBUS_CHAN_DECLARE(activity_state_data_chan);
 ZBUS_LISTENER_DEFINE(watchface_activity_state_event, zbus_activity_event_callback);
 
+ZBUS_LISTENER_DEFINE(watchface_notification_lis, zbus_notification_callback);
+
 #define WORK_STACK_SIZE 3000
 #define WORK_PRIORITY   5
 
 #define RENDER_INTERVAL_LVGL    K_MSEC(100)
-#define SLOW_UPDATE_INTERVAL    K_MINUTES(1)
+// Values without an event of their own, read in the clock update once this old.
+#define VALUES_UPDATE_INTERVAL_MS   MSEC_PER_SEC
+#define SLOW_UPDATE_INTERVAL_MS     (60 * MSEC_PER_SEC)
+// The pressure sensor publishes every 10 s, a reading that old is fine for a watchface.
+#define PRESSURE_MAX_AGE_MS     10000
+// Same staleness as the step updates published while walking.
+#define STEPS_MAX_AGE_MS        (CONFIG_ZSW_FITNESS_MANAGER_STEP_UPDATE_INTERVAL_S * 1000)
 
 typedef enum work_type {
     UPDATE_CLOCK,
-    UPDATE_VALUES,
-    OPEN_WATCHFACE,
-    UPDATE_SLOW_VALUES
+    OPEN_WATCHFACE
 } work_type_t;
 
 typedef struct delayed_work_item {
@@ -86,9 +100,13 @@ typedef struct delayed_work_item {
 } delayed_work_item_t;
 
 static void general_work(struct k_work *item);
+static void update_clock(void);
+static void resume_updates(void);
+static void pause_updates(void);
 
 static void check_notifications(void);
 static void update_ui_from_event(struct k_work *item);
+static void update_notifications(struct k_work *item);
 static void watchface_gesture_cb(lv_event_t *e);
 
 static void connected(struct bt_conn *conn, uint8_t err);
@@ -100,13 +118,12 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
 };
 
 static delayed_work_item_t clock_work =     { .type = UPDATE_CLOCK };
-static delayed_work_item_t update_work =      { .type = UPDATE_VALUES };
-static delayed_work_item_t date_work =      { .type = UPDATE_SLOW_VALUES };
 
 static delayed_work_item_t general_work_item;
 static struct k_work_sync cancel_work_sync;
 
 static K_WORK_DEFINE(update_ui_work, update_ui_from_event);
+static K_WORK_DELAYABLE_DEFINE(notification_work, update_notifications);
 static ble_comm_data_type_t last_data_update_type;
 static ble_comm_weather_t last_weather_data;
 static ble_comm_music_info_t last_music_info;
@@ -124,12 +141,19 @@ static zsw_settings_watchface_t watchface_settings;
 
 static watchface_app_evt_listener watchface_evt_cb;
 
+// Minute or second last shown, -1 to update on the next wakeup whatever the time.
+static int last_tick_key = -1;
+static int64_t next_values_ms;
+static int64_t next_slow_values_ms;
+
+static watchface_app_wakeup_stats_t wakeup_stats[MAX_WATCHFACES];
+static bool wakeup_stats_counting;
+static int64_t shown_since_ms;
+
 static int watchface_app_init(void)
 {
     k_work_init_delayable(&general_work_item.work, general_work);
     k_work_init_delayable(&clock_work.work, general_work);
-    k_work_init_delayable(&update_work.work, general_work);
-    k_work_init_delayable(&date_work.work, general_work);
     running = false;
     is_suspended = false;
     watchface_views_created = false;
@@ -170,9 +194,7 @@ void watchface_app_stop(void)
 {
     running = false;
     is_suspended = false;
-    k_work_cancel_delayable_sync(&clock_work.work, &cancel_work_sync);
-    k_work_cancel_delayable_sync(&update_work.work, &cancel_work_sync);
-    k_work_cancel_delayable_sync(&date_work.work, &cancel_work_sync);
+    pause_updates();
     k_work_cancel_delayable_sync(&general_work_item.work, &cancel_work_sync);
 
     if (watchface_views_created) {
@@ -198,6 +220,7 @@ void watchface_change(int index)
         return;
     }
 
+    pause_updates();
     watchfaces[watchface_settings.watchface_index]->remove();
 
     // Make sure we have the latest settings
@@ -241,6 +264,27 @@ int watchface_app_get_face_info(int index, const lv_img_dsc_t **preview,  const
     return 0;
 }
 
+int watchface_app_get_wakeup_stats(int index, watchface_app_wakeup_stats_t *p_stats)
+{
+    if (index >= num_watchfaces) {
+        return -EEXIST;
+    }
+
+    *p_stats = wakeup_stats[index];
+    p_stats->granularity = watchfaces[index]->time_granularity;
+    if (wakeup_stats_counting && index == watchface_settings.watchface_index) {
+        p_stats->shown_ms += k_uptime_get() - shown_since_ms;
+    }
+
+    return 0;
+}
+
+void watchface_app_reset_wakeup_stats(void)
+{
+    memset(wakeup_stats, 0, sizeof(wakeup_stats));
+    shown_since_ms = k_uptime_get();
+}
+
 static void refresh_ui(void)
 {
     uint32_t steps;
@@ -255,10 +299,9 @@ static void refresh_ui(void)
         watchfaces[watchface_settings.watchface_index]->set_weather(last_weather_data.temperature_c,
                                                                     last_weather_data.weather_code);
     }
-    if (zsw_imu_fetch_num_steps(&steps) == 0) {
-        // TODO: Add calculation for distance and kcal
-        watchfaces[watchface_settings.watchface_index]->set_step(steps, 0, 0);
-    }
+    zsw_fitness_manager_get_steps(&steps, STEPS_MAX_AGE_MS);
+    // TODO: Add calculation for distance and kcal
+    watchfaces[watchface_settings.watchface_index]->set_step(steps, 0, 0);
     if (strlen(last_music_info.track_name) > 0) {
         zsw_watchface_dropdown_ui_set_music_info(last_music_info.track_name, last_music_info.artist);
     }
@@ -269,7 +312,6 @@ static void general_work(struct k_work *item)
     struct k_work_delayable *delayable_work = CONTAINER_OF(item, struct k_work_delayable, work);
 
     delayed_work_item_t *the_work = CONTAINER_OF(delayable_work, delayed_work_item_t, work);
-    uint32_t steps;
 
     switch (the_work->type) {
         case OPEN_WATCHFACE: {
@@ -280,50 +322,123 @@ static void general_work(struct k_work *item)
             zsw_watchface_dropdown_ui_add(watchface_root_screen, watchface_evt_cb, zsw_display_control_get_brightness());
             watchface_views_created = true;
             refresh_ui();
-
-            __ASSERT(0 <= k_work_schedule(&clock_work.work, K_NO_WAIT), "FAIL clock_work");
-            __ASSERT(0 <= k_work_schedule(&update_work.work, K_SECONDS(1)), "FAIL update_work");
-            __ASSERT(0 <= k_work_schedule(&date_work.work, K_SECONDS(1)), "FAIL date_work");
-            general_work_item.type = UPDATE_SLOW_VALUES;
-            __ASSERT(0 <= k_work_schedule(&general_work_item.work, K_MSEC(100)), "FAIL schedule");
-            break;
-        }
-        case UPDATE_VALUES: {
-            check_notifications();
-
-            // Realtime update of steps
-            if (zsw_imu_fetch_num_steps(&steps) == 0) {
-                // TODO: Add calculation for distance and kcal
-                watchfaces[watchface_settings.watchface_index]->set_step(steps, 0, 0);
-            }
-            __ASSERT(0 <= k_work_schedule(&update_work.work, K_SECONDS(1)), "FAIL update_work");
+            resume_updates();
             break;
         }
         case UPDATE_CLOCK: {
-            zsw_timeval_t time;
-            zsw_clock_get_time(&time);
-
-            if (watchfaces[watchface_settings.watchface_index]->set_datetime) {
-                // TODO: Add support for AM and 12/24 h mode
-                watchfaces[watchface_settings.watchface_index]->set_datetime(time.tm.tm_wday, time.tm.tm_mday, time.tm.tm_mday,
-                                                                             time.tm.tm_mon,
-                                                                             time.tm.tm_year, time.tm.tm_wday, time.tm.tm_hour, time.tm.tm_min, time.tm.tm_sec, time.tv_usec, false, false);
-            }
-
-            __ASSERT(0 <= k_work_schedule(&clock_work.work,
-                                          watchface_settings.smooth_second_hand ? SMOOTH_TIME_UPDATE_INTERVAL : NORMAL_TIME_UPDATE_INTERVAL), "FAIL clock_work");
+            update_clock();
             break;
         }
-        case UPDATE_SLOW_VALUES: {
-            float pressure = 0.0;
-            zsw_timeval_t time;
-            zsw_clock_get_time(&time);
+    }
+}
 
-            zsw_pressure_sensor_get_pressure(&pressure);
-            watchfaces[watchface_settings.watchface_index]->set_watch_env_sensors((int)pressure);
+static watchface_time_granularity_t get_tick_granularity(void)
+{
+    watchface_time_granularity_t granularity = watchfaces[watchface_settings.watchface_index]->time_granularity;
 
-            __ASSERT(0 <= k_work_schedule(&date_work.work, SLOW_UPDATE_INTERVAL), "FAIL date_work");
-        }
+    if (granularity == WATCHFACE_TIME_GRANULARITY_SUB_SECOND &&
+        (!watchface_settings.smooth_second_hand || zsw_display_control_get_brightness() < SUB_SECOND_MIN_BRIGHTNESS)) {
+        granularity = WATCHFACE_TIME_GRANULARITY_SECOND;
+    }
+
+    return granularity;
+}
+
+// Microseconds from the time read until the next time the watchface shows something new.
+static uint32_t get_us_to_next_tick(const zsw_timeval_t *time, watchface_time_granularity_t granularity)
+{
+    switch (granularity) {
+        case WATCHFACE_TIME_GRANULARITY_MINUTE:
+            return (59 - MIN(time->tm.tm_sec, 59)) * USEC_PER_SEC + USEC_PER_SEC - time->tv_usec;
+        case WATCHFACE_TIME_GRANULARITY_SUB_SECOND:
+            return SUB_SECOND_TICK_US - time->tv_usec % SUB_SECOND_TICK_US;
+        case WATCHFACE_TIME_GRANULARITY_SECOND:
+        default:
+            return USEC_PER_SEC - time->tv_usec;
+    }
+}
+
+static void update_slow_values(void)
+{
+    float pressure = 0.0;
+    zsw_sensor_reading_t reading;
+
+    if (zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_PRESSURE, &reading, PRESSURE_MAX_AGE_MS) == 0) {
+        pressure = reading.data.pressure.pressure;
+    }
+    watchfaces[watchface_settings.watchface_index]->set_watch_env_sensors((int)pressure);
+}
+
+/*
+* Wake up once per change of the shown time, at a deadline on the kernel clock taken from when the
+* time was read, so the wakeups stay on the clock boundaries instead of drifting by the time
+* spent updating. Values that are polled ride along on the same wakeup.
+*/
+static void update_clock(void)
+{
+    watchface_ui_api_t *face = watchfaces[watchface_settings.watchface_index];
+    watchface_time_granularity_t granularity = get_tick_granularity();
+    zsw_timeval_t time;
+    int64_t read_us;
+    int64_t now_ms;
+    int key;
+
+    wakeup_stats[watchface_settings.watchface_index].wakeups++;
+
+    zsw_clock_get_time(&time);
+    read_us = k_ticks_to_us_floor64(k_uptime_ticks());
+    now_ms = k_uptime_get();
+
+    key = granularity == WATCHFACE_TIME_GRANULARITY_MINUTE ? time.tm.tm_min : time.tm.tm_sec;
+    if (granularity != WATCHFACE_TIME_GRANULARITY_SUB_SECOND && key == last_tick_key) {
+        __ASSERT(0 <= k_work_schedule(&clock_work.work, EARLY_TICK_RETRY), "FAIL clock_work");
+        return;
+    }
+    last_tick_key = key;
+
+    if (face->set_datetime) {
+        zsw_watchface_planner_begin_tick();
+        // TODO: Add support for AM and 12/24 h mode
+        face->set_datetime(time.tm.tm_wday, time.tm.tm_mday, time.tm.tm_mday, time.tm.tm_mon, time.tm.tm_year,
+                           time.tm.tm_wday, time.tm.tm_hour, time.tm.tm_min, time.tm.tm_sec, time.tv_usec, false, false);
+        // A tick that changed nothing visible invalidated nothing, LVGL skips its next refresh on its own.
+        zsw_watchface_planner_end_tick();
+    }
+
+    if (now_ms >= next_values_ms) {
+        check_notifications();
+        next_values_ms = now_ms + VALUES_UPDATE_INTERVAL_MS;
+    }
+    if (now_ms >= next_slow_values_ms) {
+        update_slow_values();
+        next_slow_values_ms = now_ms + SLOW_UPDATE_INTERVAL_MS;
+    }
+
+    __ASSERT(0 <= k_work_schedule(&clock_work.work,
+                                  K_TIMEOUT_ABS_US(read_us + get_us_to_next_tick(&time, granularity) + TICK_MARGIN_US)),
+             "FAIL clock_work");
+}
+
+static void resume_updates(void)
+{
+    last_tick_key = -1;
+    next_values_ms = 0;
+    next_slow_values_ms = 0;
+    zsw_watchface_planner_start();
+    if (!wakeup_stats_counting) {
+        shown_since_ms = k_uptime_get();
+        wakeup_stats_counting = true;
+    }
+    __ASSERT(0 <= k_work_schedule(&clock_work.work, K_NO_WAIT), "FAIL clock_work");
+}
+
+static void pause_updates(void)
+{
+    k_work_cancel_delayable_sync(&clock_work.work, &cancel_work_sync);
+    zsw_watchface_planner_stop();
+    if (wakeup_stats_counting) {
+        wakeup_stats[watchface_settings.watchface_index].shown_ms += k_uptime_get() - shown_since_ms;
+        wakeup_stats_counting = false;
     }
 }
 
@@ -333,6 +448,13 @@ static void check_notifications(void)
     watchfaces[watchface_settings.watchface_index]->set_num_notifcations(num_unread);
 }
 
+static void update_notifications(struct k_work *item)
+{
+    if (running && !is_suspended) {
+        check_notifications();
+    }
+}
+
 static void connected(struct bt_conn *conn, uint8_t err)
 {
     is_connected = true;
@@ -367,7 +489,9 @@ static void update_ui_from_event(struct k_work *item)
             watchfaces[watchface_settings.watchface_index]->set_weather(last_weather_data.temperature_c,
                                                                         last_weather_data.weather_code);
         } else if (last_data_update_type == BLE_COMM_DATA_TYPE_SET_TIME) {
-            k_work_reschedule(&date_work.work, K_NO_WAIT);
+            last_tick_key = -1;
+            next_slow_values_ms = 0;
+            k_work_reschedule(&clock_work.work, K_NO_WAIT);
         } else if (last_data_update_type == BLE_COMM_DATA_TYPE_MUSIC_INFO) {
             zsw_watchface_dropdown_ui_set_music_info(last_music_info.track_name, last_music_info.artist);
         }
@@ -403,14 +527,12 @@ static void zbus_ble_comm_data_callback(const struct zbus_channel *chan)
     }
 }
 
-static void zbus_accel_data_callback(const struct zbus_channel *chan)
+static void zbus_step_data_callback(const struct zbus_channel *chan)
 {
     if (running && !is_suspended) {
-        const struct accel_event *event = zbus_chan_const_msg(chan);
-        if (event->data.type == ZSW_IMU_EVT_TYPE_STEP) {
-            // TODO: Add calculation for distance and kcal
-            watchfaces[watchface_settings.watchface_index]->set_step(event->data.data.step.count, 0, 0);
-        }
+        const struct step_event *event = zbus_chan_const_msg(chan);
+        // TODO: Add calculation for distance and kcal
+        watchfaces[watchface_settings.watchface_index]->set_step(event->steps, 0, 0);
     }
 }
 
@@ -434,20 +556,25 @@ static void zbus_activity_event_callback(const struct zbus_channel *chan)
         const struct activity_state_event *event = zbus_chan_const_msg(chan);
         if (event->state == ZSW_ACTIVITY_STATE_INACTIVE) {
             is_suspended = true;
-            k_work_cancel_delayable_sync(&clock_work.work, &cancel_work_sync);
-            k_work_cancel_delayable_sync(&date_work.work, &cancel_work_sync);
-            k_work_cancel_delayable_sync(&update_work.work, &cancel_work_sync);
+            pause_updates();
         } else if (event->state == ZSW_ACTIVITY_STATE_ACTIVE) {
             is_suspended = false;
             watchfaces[watchface_settings.watchface_index]->ui_invalidate_cached();
             refresh_ui();
-            __ASSERT(0 <= k_work_schedule(&clock_work.work, K_NO_WAIT), "FAIL clock_work");
-            __ASSERT(0 <= k_work_schedule(&date_work.work, K_SECONDS(1)), "FAIL clock_work");
-            __ASSERT(0 <= k_work_schedule(&update_work.work, K_SECONDS(1)), "FAIL clock_work");
+            resume_updates();
         }
     }
 }
 
+// The count is read in the clock update too, this shows it right away for faces that only update once a minute.
+static void zbus_notification_callback(const struct zbus_channel *chan)
+{
+    if (running && !is_suspended) {
+        // Removals are published before the count drops.
+        k_work_schedule(&notification_work, K_MSEC(100));
+    }
+}
+
 static int settings_load_handler_watchface(const char *key, size_t len,
                                            settings_read_cb read_cb, void *cb_arg, void *param)
 {
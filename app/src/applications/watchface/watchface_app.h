@@ -55,6 +55,19 @@ typedef struct watchface_app_evt_t {
 
 typedef void(*watchface_app_evt_listener)(watchface_app_evt_t);
 
+/** How often the time shown by a watchface changes, it is woken up once per change. */
+typedef enum watchface_time_granularity_t {
+    WATCHFACE_TIME_GRANULARITY_SECOND,      /**< Default, seconds digits or a ticking second hand. */
+    WATCHFACE_TIME_GRANULARITY_MINUTE,      /**< No seconds shown. */
+    WATCHFACE_TIME_GRANULARITY_SUB_SECOND   /**< Smooth second hand using usec, when enabled in the settings. */
+} watchface_time_granularity_t;
+
+typedef struct watchface_app_wakeup_stats_t {
+    uint32_t wakeups;                       /**< Clock updates, including ones retried as the clock was not there yet. */
+    uint32_t shown_ms;                      /**< Time the watchface was shown with the display on. */
+    watchface_time_granularity_t granularity;
+} watchface_app_wakeup_stats_t;
+
 typedef struct watchface_ui_api_t {
     void (*show)(lv_obj_t *root_screen, watchface_app_evt_listener, zsw_settings_watchface_t *settings);
     void (*remove)(void);
@@ -71,6 +84,7 @@ typedef struct watchface_ui_api_t {
     void (*ui_invalidate_cached)(void);
     const void *(*get_preview_img)(void);
     const char *name;
+    watchface_time_granularity_t time_granularity;
 } watchface_ui_api_t;
 
 void watchface_app_start(lv_obj_t *root_screen, lv_group_t *group, watchface_app_evt_listener evt_cb);
@@ -81,3 +95,5 @@ void watchface_app_register_ui(watchface_ui_api_t *ui);
 
 int watchface_app_get_num_faces(void);
 int watchface_app_get_face_info(int index, const lv_img_dsc_t **preview,  const char **name);
+int watchface_app_get_wakeup_stats(int index, watchface_app_wakeup_stats_t *p_stats);
+void watchface_app_reset_wakeup_stats(void);
@@ -35,6 +35,8 @@ LOG_MODULE_REGISTER(weather_app, LOG_LEVEL_DBG);
 
 #define MAX_GPS_AGED_TIME_MS 30 * 60 * 1000
 #define WEATHER_BACKGROUND_FETCH_INTERVAL_S (30 * 60)
+// Reopening the app within this time shows the last response without asking the phone.
+#define WEATHER_CACHE_MAX_AGE_S (10 * 60)
 
 // Functions needed for all applications
 static void weather_app_start(lv_obj_t *root, lv_group_t *group);
@@ -71,7 +73,7 @@ static application_t app = {
     .category = ZSW_APP_CATEGORY_ROOT
 };
 
-static void http_rsp_cb(ble_http_status_code_t status, char *response)
+static void http_rsp_cb(ble_http_status_code_t status, const char *response)
 {
     zsw_timeval_t time_now;
     weather_ui_current_weather_data_t current_weather;
@@ -150,7 +152,7 @@ static void fetch_weather_data(double lat, double lon)
 {
     char weather_url[512];
     snprintf(weather_url, sizeof(weather_url), HTTP_REQUEST_URL_FMT, lat, lon, WEATHER_UI_NUM_FORECASTS);
-    int ret = zsw_ble_http_get(weather_url, http_rsp_cb);
+    int ret = zsw_ble_http_get_cached(weather_url, http_rsp_cb, WEATHER_CACHE_MAX_AGE_S);
     if (ret != 0 && ret != -EBUSY) {
         LOG_ERR("Failed to send HTTP request: %d", ret);
         if (app.current_state == ZSW_APP_STATE_UI_VISIBLE) {
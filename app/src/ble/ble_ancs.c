@@ -45,23 +45,12 @@ static struct bt_gattp gattp;
 
 static atomic_t discovery_flags;
 
-/* Local copy to keep track of the newest arriving notifications. */
-static struct bt_ancs_evt_notif notification_latest;
-/* Local copy of the newest notification attribute. */
-static struct bt_ancs_attr notif_attr_latest;
-/* Local copy of the newest app attribute. */
-static struct bt_ancs_attr notif_attr_app_id_latest;
 /* Local copy of the current connection. */
 static struct bt_conn *current_conn;
-/* Buffers to store attribute data. */
+/* Buffers the ANCS client parses attribute data into, only used until copied to the arena. */
 static uint8_t attr_appid[BT_ANCS_ATTR_DATA_MAX];
 static uint8_t attr_title[BT_ANCS_ATTR_DATA_MAX];
-static uint8_t attr_subtitle[BT_ANCS_ATTR_DATA_MAX];
 static uint8_t attr_message[BT_ANCS_ATTR_DATA_MAX];
-static uint8_t attr_message_size[BT_ANCS_ATTR_DATA_MAX];
-static uint8_t attr_date[BT_ANCS_ATTR_DATA_MAX];
-static uint8_t attr_posaction[BT_ANCS_ATTR_DATA_MAX];
-static uint8_t attr_negaction[BT_ANCS_ATTR_DATA_MAX];
 static uint8_t attr_disp_name[BT_ANCS_ATTR_DATA_MAX];
 
 /* String literals for the iOS notification attribute types.
@@ -94,6 +83,30 @@ enum {
  */
 static const char *lit_appid[BT_ANCS_APP_ATTR_COUNT] = {"Display Name"};
 
+/* Attributes registered with the ANCS client, so the ones requested for every notification. */
+#define REQUESTED_ATTRS (BIT(ATTR_ID_APP_ID) | BIT(ATTR_ID_TITLE) | BIT(ATTR_ID_MESSAGE))
+/* Room for the NUL terminated app name, title and message. */
+#define ARENA_SLOT_DATA_SIZE (3 * (BT_ANCS_ATTR_DATA_MAX + 1))
+
+typedef enum ancs_slot_state {
+    ANCS_SLOT_FREE,
+    ANCS_SLOT_PENDING,      /* Waiting for the attribute request of another notification to finish. */
+    ANCS_SLOT_REQUESTED,    /* Attributes requested, waiting for the Data Source. */
+} ancs_slot_state_t;
+
+/* One notification being assembled. Attributes are copied once into data and
+ * the published event points into it, so the slot is only freed after publishing.
+ */
+typedef struct ancs_arena_slot {
+    ancs_slot_state_t state;
+    struct bt_ancs_evt_notif notif;
+    uint32_t seq;
+    uint32_t received_attrs;
+    ble_comm_notify_t notify;
+    uint16_t used;
+    uint8_t data[ARENA_SLOT_DATA_SIZE];
+} ancs_arena_slot_t;
+
 static void discover_ancs_first(struct bt_conn *conn);
 static void discover_ancs_again(struct bt_conn *conn);
 static void bt_ancs_notification_source_handler(struct bt_ancs_client *ancs_c, int err,
@@ -101,8 +114,14 @@ static void bt_ancs_notification_source_handler(struct bt_ancs_client *ancs_c, i
 static void bt_ancs_data_source_handler(struct bt_ancs_client *ancs_c, const struct bt_ancs_attr_response *response);
 static void bt_ancs_write_response_handler(struct bt_ancs_client *ancs_c, uint8_t err);
 static void gatt_discover_retry_handle(struct k_work *item);
+static void attr_request_timeout_handle(struct k_work *item);
 
 K_WORK_DELAYABLE_DEFINE(gatt_discover_retry, gatt_discover_retry_handle);
+K_WORK_DELAYABLE_DEFINE(attr_request_timeout, attr_request_timeout_handle);
+K_MUTEX_DEFINE(arena_mutex);
+
+static ancs_arena_slot_t arena[CONFIG_ZSW_ANCS_MAX_PENDING_NOTIFICATIONS];
+static uint32_t arena_seq;
 ZBUS_CHAN_DECLARE(ble_comm_data_chan);
 
 static void enable_ancs_notifications(struct bt_ancs_client *ancs_c)
@@ -332,6 +351,13 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
     if (current_conn) {
         bt_conn_unref(current_conn);
     }
+
+    k_work_cancel_delayable(&attr_request_timeout);
+    k_mutex_lock(&arena_mutex, K_FOREVER);
+    for (int i = 0; i < ARRAY_SIZE(arena); i++) {
+        arena[i].state = ANCS_SLOT_FREE;
+    }
+    k_mutex_unlock(&arena_mutex);
 }
 
 BT_CONN_CB_DEFINE(conn_callbacks) = {
@@ -396,61 +422,205 @@ static void notif_attr_print(const struct bt_ancs_attr *attr)
     }
 }
 
-static int parse_notify(const struct bt_ancs_attr *attr)
+static ancs_arena_slot_t *arena_find(uint32_t notif_uid)
+{
+    for (int i = 0; i < ARRAY_SIZE(arena); i++) {
+        if (arena[i].state != ANCS_SLOT_FREE && arena[i].notif.notif_uid == notif_uid) {
+            return &arena[i];
+        }
+    }
+
+    return NULL;
+}
+
+static ancs_arena_slot_t *arena_alloc(void)
+{
+    ancs_arena_slot_t *p_oldest = NULL;
+
+    for (int i = 0; i < ARRAY_SIZE(arena); i++) {
+        if (arena[i].state == ANCS_SLOT_FREE) {
+            return &arena[i];
+        }
+        if (arena[i].state == ANCS_SLOT_PENDING && (p_oldest == NULL || arena[i].seq < p_oldest->seq)) {
+            p_oldest = &arena[i];
+        }
+    }
+
+    // Full, a burst of notifications (ex. all existing ones on connect). Drop the oldest not yet requested.
+    if (p_oldest) {
+        LOG_WRN("ANCS arena full, dropping notification %u", p_oldest->notif.notif_uid);
+    }
+
+    return p_oldest;
+}
+
+static void arena_slot_reset(ancs_arena_slot_t *p_slot, const struct bt_ancs_evt_notif *notif)
 {
-    static struct ble_data_event evt = {0};
+    p_slot->state = ANCS_SLOT_PENDING;
+    p_slot->notif = *notif;
+    p_slot->seq = arena_seq++;
+    p_slot->received_attrs = 0;
+    p_slot->used = 0;
+    memset(&p_slot->notify, 0, sizeof(p_slot->notify));
+    p_slot->notify.id = notif->notif_uid;
+}
 
+/** @brief          Copy attribute data into the slot and NUL terminate it.
+ *  @param p_slot   Slot of the notification
+ *  @param data     Attribute data, not NUL terminated
+ *  @param len      Length of the attribute data
+ *  @param p_len    Where to store the copied length, less than len if the slot is full
+ *  @return         Start of the copy in the slot
+*/
+static char *arena_slot_copy(ancs_arena_slot_t *p_slot, const uint8_t *data, uint16_t len, int *p_len)
+{
+    char *p_dst = (char *)&p_slot->data[p_slot->used];
+
+    len = MIN(len, sizeof(p_slot->data) - p_slot->used - 1);
+    memcpy(p_dst, data, len);
+    p_dst[len] = '\0';
+    p_slot->used += len + 1;
+    *p_len = len;
+
+    return p_dst;
+}
+
+static void request_next(void)
+{
+    ancs_arena_slot_t *p_next;
+    int err;
+
+    while (true) {
+        p_next = NULL;
+        for (int i = 0; i < ARRAY_SIZE(arena); i++) {
+            if (arena[i].state == ANCS_SLOT_REQUESTED) {
+                // The ANCS client handles one Control Point request at a time.
+                return;
+            }
+            if (arena[i].state == ANCS_SLOT_PENDING && (p_next == NULL || arena[i].seq < p_next->seq)) {
+                p_next = &arena[i];
+            }
+        }
+
+        if (p_next == NULL) {
+            k_work_cancel_delayable(&attr_request_timeout);
+            return;
+        }
+
+        err = bt_ancs_request_attrs(&ancs_c, &p_next->notif, bt_ancs_write_response_handler);
+        if (err == 0) {
+            p_next->state = ANCS_SLOT_REQUESTED;
+            k_work_reschedule(&attr_request_timeout, K_MSEC(CONFIG_ZSW_ANCS_ATTR_TIMEOUT_MS));
+            return;
+        }
+
+        LOG_ERR("Failed requesting attributes for %u (err %d)", p_next->notif.notif_uid, err);
+        p_next->state = ANCS_SLOT_FREE;
+    }
+}
+
+static void attr_request_timeout_handle(struct k_work *item)
+{
+    k_mutex_lock(&arena_mutex, K_FOREVER);
+    for (int i = 0; i < ARRAY_SIZE(arena); i++) {
+        if (arena[i].state == ANCS_SLOT_REQUESTED) {
+            LOG_WRN("Attributes for notification %u incomplete, received 0x%x", arena[i].notif.notif_uid,
+                    arena[i].received_attrs);
+            arena[i].state = ANCS_SLOT_FREE;
+        }
+    }
+    request_next();
+    k_mutex_unlock(&arena_mutex);
+}
+
+static void parse_notify(uint32_t notif_uid, const struct bt_ancs_attr *attr)
+{
+    struct ble_data_event evt = {
+        .data.type = BLE_COMM_DATA_TYPE_NOTIFY,
+    };
+    ancs_arena_slot_t *p_slot;
+    const uint8_t *p_dot;
+    const uint8_t *p_name;
+
+    k_mutex_lock(&arena_mutex, K_FOREVER);
+
+    p_slot = arena_find(notif_uid);
+    if (p_slot == NULL || p_slot->state != ANCS_SLOT_REQUESTED) {
+        LOG_DBG("Attribute for unknown notification %u", notif_uid);
+        k_mutex_unlock(&arena_mutex);
+        return;
+    }
+
+    if (p_slot->received_attrs & BIT(attr->attr_id)) {
+        k_mutex_unlock(&arena_mutex);
+        return;
+    }
+
+    // attr_data is not NUL terminated, only attr_len bytes are valid.
     switch (attr->attr_id) {
         case ATTR_ID_TITLE:
-            evt.data.data.notify.title = attr->attr_data;
-            evt.data.data.notify.title_len = attr->attr_len;
+            p_slot->notify.title = arena_slot_copy(p_slot, attr->attr_data, attr->attr_len, &p_slot->notify.title_len);
             break;
 
         case ATTR_ID_MESSAGE:
-            evt.data.data.notify.body = (char *)attr->attr_data;
-            evt.data.data.notify.body_len = attr->attr_len;
+            p_slot->notify.body = arena_slot_copy(p_slot, attr->attr_data, attr->attr_len, &p_slot->notify.body_len);
             break;
 
         case ATTR_ID_APP_ID:
-            // This comes as example com.facebook.Messenger
-            evt.data.data.notify.src = strrchr(attr->attr_data, '.') + 1;
-            evt.data.data.notify.src_len = strlen(evt.data.data.notify.src);
-            evt.data.data.notify.id = notification_latest.notif_uid;
+            // This comes as example com.facebook.Messenger, only keep the last part.
+            p_name = attr->attr_data;
+            for (p_dot = attr->attr_data + attr->attr_len; p_dot > attr->attr_data; p_dot--) {
+                if (p_dot[-1] == '.') {
+                    p_name = p_dot;
+                    break;
+                }
+            }
+            p_slot->notify.src = arena_slot_copy(p_slot, p_name, attr->attr_len - (p_name - attr->attr_data),
+                                                 &p_slot->notify.src_len);
             break;
 
-        // the last message is Negative action label, send only when all data is received;
-        case ATTR_ID_NEGATIVE_ACTION_LABEL:
-
-            evt.data.type = BLE_COMM_DATA_TYPE_NOTIFY;
-
-            zbus_chan_pub(&ble_comm_data_chan, &evt, K_MSEC(250));
-
-            memset(&evt, 0, sizeof(evt));
-            break;
-        case ATTR_ID_DATE:
-        case ATTR_ID_MESSAGE_SIZE:
-        case ATTR_ID_SUBTITLE:
-        case ATTR_ID_POSITIVE_ACTION_LABEL:
         default:
-            // @todo
             break;
     }
 
-    return 0;
+    p_slot->received_attrs |= BIT(attr->attr_id);
+    if ((p_slot->received_attrs & REQUESTED_ATTRS) != REQUESTED_ATTRS) {
+        k_mutex_unlock(&arena_mutex);
+        return;
+    }
+
+    // Listeners run synchronously, the strings in the slot stay valid until publish returns.
+    evt.data.data.notify = p_slot->notify;
+    zbus_chan_pub(&ble_comm_data_chan, &evt, K_MSEC(250));
+
+    p_slot->state = ANCS_SLOT_FREE;
+    request_next();
+
+    k_mutex_unlock(&arena_mutex);
 }
 
 static void bt_ancs_notification_source_handler(struct bt_ancs_client *ancs_c,
                                                 int err, const struct bt_ancs_evt_notif *notif)
 {
+    ancs_arena_slot_t *p_slot;
+
     if (!err) {
-        notification_latest = *notif;
+        k_mutex_lock(&arena_mutex, K_FOREVER);
+        p_slot = arena_find(notif->notif_uid);
 
-        if (notification_latest.evt_id == BT_ANCS_EVENT_ID_NOTIFICATION_REMOVED) {
+        if (notif->evt_id == BT_ANCS_EVENT_ID_NOTIFICATION_REMOVED) {
             struct ble_data_event evt_notif_rem = {
                 .data.type = BLE_COMM_DATA_TYPE_NOTIFY_REMOVE,
-                .data.data.notify_remove.id = notification_latest.notif_uid,
+                .data.data.notify_remove.id = notif->notif_uid,
             };
 
+            // Removed before it was fully received, late attributes are ignored as the slot is gone.
+            if (p_slot) {
+                p_slot->state = ANCS_SLOT_FREE;
+                request_next();
+            }
+            k_mutex_unlock(&arena_mutex);
+
             LOG_DBG("Remove notification %d", evt_notif_rem.data.data.notify_remove.id);
 
             zbus_chan_pub(&ble_comm_data_chan, &evt_notif_rem, K_MSEC(250));
@@ -458,7 +628,20 @@ static void bt_ancs_notification_source_handler(struct bt_ancs_client *ancs_c,
             return;
         }
 
-        bt_ancs_request_attrs(ancs_c, &notification_latest, bt_ancs_write_response_handler);
+        // When already requested the ongoing response carries the modified data anyway.
+        if (p_slot == NULL) {
+            p_slot = arena_alloc();
+            if (p_slot) {
+                arena_slot_reset(p_slot, notif);
+            } else {
+                LOG_WRN("No room for notification %u", notif->notif_uid);
+            }
+        } else if (p_slot->state == ANCS_SLOT_PENDING) {
+            p_slot->notif = *notif;
+        }
+
+        request_next();
+        k_mutex_unlock(&arena_mutex);
     }
 }
 
@@ -467,13 +650,8 @@ static void bt_ancs_data_source_handler(struct bt_ancs_client *ancs_c,
 {
     switch (response->command_id) {
         case BT_ANCS_COMMAND_ID_GET_NOTIF_ATTRIBUTES:
-            notif_attr_latest = response->attr;
-            notif_attr_print(&notif_attr_latest);
-            parse_notify(&notif_attr_latest);
-            if (response->attr.attr_id ==
-                BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER) {
-                notif_attr_app_id_latest = response->attr;
-            }
+            notif_attr_print(&response->attr);
+            parse_notify(response->notif_uid, &response->attr);
             break;
 
         case BT_ANCS_COMMAND_ID_GET_APP_ATTRIBUTES:
@@ -490,6 +668,18 @@ static void bt_ancs_write_response_handler(struct bt_ancs_client *ancs_c,
                                            uint8_t err)
 {
     err_code_print(err);
+
+    if (err) {
+        // The request was rejected, no attributes will come for it.
+        k_mutex_lock(&arena_mutex, K_FOREVER);
+        for (int i = 0; i < ARRAY_SIZE(arena); i++) {
+            if (arena[i].state == ANCS_SLOT_REQUESTED) {
+                arena[i].state = ANCS_SLOT_FREE;
+            }
+        }
+        request_next();
+        k_mutex_unlock(&arena_mutex);
+    }
 }
 
 static int gattp_init(void)
@@ -542,46 +732,6 @@ int ble_ancs_init(void)
         return err;
     }
 
-    err = bt_ancs_register_attr(&ancs_c,
-                                BT_ANCS_NOTIF_ATTR_ID_SUBTITLE,
-                                attr_subtitle, BT_ANCS_ATTR_DATA_MAX);
-    if (err) {
-        LOG_ERR("Failed to start ANCS: 0x%x", err);
-        return err;
-    }
-
-    err = bt_ancs_register_attr(&ancs_c,
-                                BT_ANCS_NOTIF_ATTR_ID_MESSAGE_SIZE,
-                                attr_message_size, BT_ANCS_ATTR_DATA_MAX);
-    if (err) {
-        LOG_ERR("Failed to start ANCS: 0x%x", err);
-        return err;
-    }
-
-    err = bt_ancs_register_attr(&ancs_c,
-                                BT_ANCS_NOTIF_ATTR_ID_DATE,
-                                attr_date, BT_ANCS_ATTR_DATA_MAX);
-    if (err) {
-        LOG_ERR("Failed to start ANCS: 0x%x", err);
-        return err;
-    }
-
-    err = bt_ancs_register_attr(&ancs_c,
-                                BT_ANCS_NOTIF_ATTR_ID_POSITIVE_ACTION_LABEL,
-                                attr_posaction, BT_ANCS_ATTR_DATA_MAX);
-    if (err) {
-        LOG_ERR("Failed to start ANCS: 0x%x", err);
-        return err;
-    }
-
-    err = bt_ancs_register_attr(&ancs_c,
-                                BT_ANCS_NOTIF_ATTR_ID_NEGATIVE_ACTION_LABEL,
-                                attr_negaction, BT_ANCS_ATTR_DATA_MAX);
-    if (err) {
-        LOG_ERR("Failed to start ANCS: 0x%x", err);
-        return err;
-    }
-
     err = gattp_init();
     if (err) {
         LOG_ERR("Failed to start ANCS: 0x%x", err);
@@ -39,16 +39,10 @@
 #endif
 LOG_MODULE_REGISTER(ble_comm, CONFIG_ZSW_BLE_LOG_LEVEL);
 
-#define BLE_COMM_LONG_INT_MIN_MS                (400 / 1.25)
-#define BLE_COMM_LONG_INT_MAX_MS                (500 / 1.25)
-#define BLE_COMM_CONN_INT_UPDATE_TIMEOUT_MS     5000
-
 static void ble_connected(struct bt_conn *conn, uint8_t err);
 static void ble_disconnected(struct bt_conn *conn, uint8_t reason);
 static void ble_recycled(void);
 static void bt_receive_cb(struct bt_conn *conn, const uint8_t *const data, uint16_t len);
-static void update_conn_interval_slow_handler(struct k_work *item);
-static void update_conn_interval_short_handler(struct k_work *item);
 static int update_adv_interval(uint16_t interval_min, uint16_t interval_max);
 static void param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency, uint16_t timeout);
 static void phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param);
@@ -87,9 +81,6 @@ static struct bt_le_adv_param adv_param = {
     .interval_max = BT_GAP_ADV_SLOW_INT_MAX,
 };
 
-K_WORK_DELAYABLE_DEFINE(conn_interval_slow_work, update_conn_interval_slow_handler);
-K_WORK_DELAYABLE_DEFINE(conn_interval_fast_work, update_conn_interval_short_handler);
-
 ZBUS_CHAN_DECLARE(ble_comm_data_chan);
 ZBUS_CHAN_DECLARE(music_control_data_chan);
 
@@ -220,58 +211,6 @@ void ble_comm_set_pairable(bool pairable)
     pairing_enabled = pairable;
 }
 
-int ble_comm_set_short_connection_interval(void)
-{
-    int err;
-    struct bt_le_conn_param param = {
-        .interval_min = CONFIG_BT_PERIPHERAL_PREF_MIN_INT,
-        .interval_max = CONFIG_BT_PERIPHERAL_PREF_MAX_INT,
-        .latency = CONFIG_BT_PERIPHERAL_PREF_LATENCY,
-        .timeout = CONFIG_BT_PERIPHERAL_PREF_TIMEOUT,
-    };
-
-    // If someone explicitly requested short connection interval,
-    // don't change it back.
-    k_work_cancel_delayable(&conn_interval_slow_work);
-
-    if (current_conn == NULL) {
-        // Need context switch as this function can get called before
-        // the connection is propogated to this file.
-        // For example in CCC notify callbacks, triggered by a connect.
-        k_work_schedule(&conn_interval_fast_work, K_MSEC(1));
-        return 0;
-    }
-
-    LOG_DBG("Set short conection interval");
-
-    err = bt_conn_le_param_update(current_conn, &param);
-    if (err && err != -EALREADY) {
-        LOG_ERR("bt_conn_le_param_update failed: %d", err);
-    }
-
-    return err;
-}
-
-int ble_comm_set_default_connection_interval(void)
-{
-    int err;
-    struct bt_le_conn_param param = {
-        .interval_min = BLE_COMM_LONG_INT_MIN_MS,
-        .interval_max = BLE_COMM_LONG_INT_MAX_MS,
-        .latency = CONFIG_BT_PERIPHERAL_PREF_LATENCY,
-        .timeout = 500,
-    };
-
-    LOG_DBG("Set long conection interval");
-
-    err = bt_conn_le_param_update(current_conn, &param);
-    if (err && err != -EALREADY) {
-        LOG_ERR("bt_conn_le_param_update failed %d", err);
-    }
-
-    return err;
-}
-
 int ble_comm_set_fast_adv_interval(void)
 {
     return update_adv_interval(BT_GAP_ADV_FAST_INT_MIN_1, BT_GAP_ADV_FAST_INT_MAX_1);
@@ -333,20 +272,6 @@ static int update_adv_interval(uint16_t interval_min, uint16_t interval_max)
     return 0;
 }
 
-static void update_conn_interval_slow_handler(struct k_work *item)
-{
-    LOG_DBG("Change to long connection interval");
-    ble_comm_set_default_connection_interval();
-}
-
-static void update_conn_interval_short_handler(struct k_work *item)
-{
-    LOG_DBG("Change to fast connection interval");
-    if (current_conn != NULL) {
-        ble_comm_set_short_connection_interval();
-    }
-}
-
 static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_exchange_params *params)
 {
     if (!err) {
@@ -390,12 +315,6 @@ static void ble_connected(struct bt_conn *conn, uint8_t err)
     bt_conn_get_info(conn, &info);
     LOG_INF("Interval: %d, latency: %d, timeout: %d", info.le.interval, info.le.latency, info.le.timeout);
 
-    // Right after a new connection we want short connection interval
-    // to let the peer discover services etc. quickly.
-    // After some time assume the peer is done and change to longer intervals
-    // to save power.
-    k_work_schedule(&conn_interval_slow_work, K_MSEC(BLE_COMM_CONN_INT_UPDATE_TIMEOUT_MS));
-
     if (pairing_enabled) {
         int rc = bt_conn_set_security(conn, BT_SECURITY_L2);
         if (rc != 0) {
@@ -415,7 +334,6 @@ static void ble_disconnected(struct bt_conn *conn, uint8_t reason)
     LOG_INF("Disconnected: %s (reason %u)", addr, reason);
 
     if (current_conn) {
-        k_work_cancel_delayable(&conn_interval_slow_work);
         bt_conn_unref(current_conn);
         current_conn = NULL;
     }
@@ -470,6 +388,11 @@ static void bt_receive_cb(struct bt_conn *conn, const uint8_t *const data, uint1
 {
     LOG_HEXDUMP_DBG(data, len, "RX");
 
+    ble_comm_receive(data, len);
+}
+
+void ble_comm_receive(const uint8_t *data, uint16_t len)
+{
     ble_gadgetbridge_input(data, len);
 
     ble_chronos_input(data, len);
@@ -143,22 +143,18 @@ int ble_comm_init(void);
 */
 int ble_comm_send(const uint8_t *data, uint16_t len);
 
+/** @brief      Feed data to the protocol parsers as if the phone wrote it to the RX characteristic.
+ *  @param data
+ *  @param len
+*/
+void ble_comm_receive(const uint8_t *data, uint16_t len);
+
 /** @brief
  *  @param pairable
  *  @return         0 when successful
 */
 void ble_comm_set_pairable(bool pairable);
 
-/** @brief
- *  @return 0 when successful
-*/
-int ble_comm_set_short_connection_interval(void);
-
-/** @brief
- *  @return 0 when successful
-*/
-int ble_comm_set_default_connection_interval(void);
-
 /** @brief
  *  @return The MTU for current connection. 0 If no connection.
 */
@@ -0,0 +1,318 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+
+#include "ble/ble_conn_params.h"
+
+LOG_MODULE_REGISTER(ble_conn_params, CONFIG_ZSW_BLE_LOG_LEVEL);
+
+// All intervals in 1.25 ms units, timeouts in 10 ms units.
+#define IDLE_INTERVAL_MIN               (400 * 4 / 5)
+#define IDLE_INTERVAL_MAX               (500 * 4 / 5)
+#define IDLE_TIMEOUT                    500
+#define ACTIVE_TIMEOUT                  CONFIG_BT_PERIPHERAL_PREF_TIMEOUT
+#define SHORTEST_INTERVAL               6
+// Window given to the central, iOS wants max >= min + 15 ms.
+#define INTERVAL_WINDOW                 12
+
+// Payload of one notification with and without data length extension (L2CAP + ATT headers removed).
+#define LL_PAYLOAD_DEFAULT              (27 - 4 - 3)
+#define LL_PAYLOAD_EXTENDED             (CONFIG_BT_BUF_ACL_TX_SIZE - 4 - 3)
+
+#define DISCOVERY_LATENCY_MS            50
+
+static void connected(struct bt_conn *conn, uint8_t err);
+static void disconnected(struct bt_conn *conn, uint8_t reason);
+static void phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param);
+static void apply_work_handler(struct k_work *work);
+static void discovery_done_work_handler(struct k_work *work);
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .le_phy_updated = phy_updated,
+};
+
+K_WORK_DEFINE(apply_work, apply_work_handler);
+K_WORK_DELAYABLE_DEFINE(discovery_done_work, discovery_done_work_handler);
+K_MUTEX_DEFINE(demand_mutex);
+
+static const char *const user_names[BLE_CONN_PARAMS_USER_COUNT] = {
+    [BLE_CONN_PARAMS_USER_DISCOVERY] = "discovery",
+    [BLE_CONN_PARAMS_USER_SENSOR_STREAM] = "sensor_stream",
+    [BLE_CONN_PARAMS_USER_SMP] = "smp",
+    [BLE_CONN_PARAMS_USER_HISTORY_SYNC] = "history_sync",
+    [BLE_CONN_PARAMS_USER_IMU_STREAM] = "imu_stream",
+};
+
+static ble_conn_params_demand_t demands[BLE_CONN_PARAMS_USER_COUNT];
+static uint32_t active_users;
+static struct bt_conn *current_conn;
+static ble_conn_params_state_t applied;
+static bool high_throughput_applied;
+static bool phy_2m;
+static const char *last_reason = "connect";
+static ble_conn_params_user_t last_user;
+
+static void format_users(char *buf, size_t size, uint32_t users)
+{
+    size_t len = 0;
+
+    buf[0] = '\0';
+    for (int i = 0; i < BLE_CONN_PARAMS_USER_COUNT && len < size; i++) {
+        if (users & BIT(i)) {
+            len += snprintk(&buf[len], size - len, "%s%s", len > 0 ? "," : "", user_names[i]);
+        }
+    }
+}
+
+static bool demand_is_high_throughput(uint32_t throughput_bps)
+{
+    // Single default sized packet per event at the shortest interval can't keep up.
+    return throughput_bps > (LL_PAYLOAD_DEFAULT * 1000 * 4 / (SHORTEST_INTERVAL * 5));
+}
+
+static void calculate_params(struct bt_le_conn_param *param, bool *high_throughput)
+{
+    uint32_t max_latency_ms = UINT32_MAX;
+    uint32_t throughput_bps = 0;
+    uint32_t payload;
+    uint32_t interval;
+
+    if (active_users == 0) {
+        param->interval_min = IDLE_INTERVAL_MIN;
+        param->interval_max = IDLE_INTERVAL_MAX;
+        param->latency = CONFIG_BT_PERIPHERAL_PREF_LATENCY;
+        param->timeout = IDLE_TIMEOUT;
+        *high_throughput = false;
+        return;
+    }
+
+    for (int i = 0; i < BLE_CONN_PARAMS_USER_COUNT; i++) {
+        if (active_users & BIT(i)) {
+            max_latency_ms = MIN(max_latency_ms, demands[i].max_latency_ms);
+            throughput_bps += demands[i].throughput_bps;
+        }
+    }
+
+    *high_throughput = demand_is_high_throughput(throughput_bps);
+    payload = *high_throughput ? LL_PAYLOAD_EXTENDED : LL_PAYLOAD_DEFAULT;
+
+    // Interval in 1.25 ms units that fits the latency demand...
+    interval = max_latency_ms * 4 / 5;
+    // ...and moves the wanted amount of data given the packets a central typically allows per event.
+    if (throughput_bps > 0) {
+        interval = MIN(interval, CONFIG_BLE_CONN_PARAMS_PACKETS_PER_EVENT * payload * 1000 * 4 / (throughput_bps * 5));
+    }
+    interval = CLAMP(interval, SHORTEST_INTERVAL, IDLE_INTERVAL_MAX);
+
+    param->interval_max = interval;
+    param->interval_min = MAX(SHORTEST_INTERVAL, (int)interval - INTERVAL_WINDOW);
+    param->latency = 0;
+    param->timeout = ACTIVE_TIMEOUT;
+}
+
+static void apply_link_features(bool high_throughput)
+{
+    int err;
+
+    if (high_throughput_applied == high_throughput) {
+        return;
+    }
+
+    if (!high_throughput) {
+        // Nobody needs the bandwidth anymore, go back to what the link started with.
+        err = bt_conn_le_data_len_update(current_conn, BT_LE_DATA_LEN_PARAM_DEFAULT);
+        if (err && err != -EALREADY) {
+            LOG_WRN("Data length revert failed: %d", err);
+        }
+
+        if (phy_2m) {
+            err = bt_conn_le_phy_update(current_conn, BT_CONN_LE_PHY_PARAM_1M);
+            if (err && err != -EALREADY) {
+                LOG_WRN("PHY revert failed: %d", err);
+            }
+        }
+
+        high_throughput_applied = high_throughput;
+        return;
+    }
+
+    // More bytes per packet and half the airtime per byte, both lower the energy per transferred byte.
+    err = bt_conn_le_data_len_update(current_conn, BT_LE_DATA_LEN_PARAM_MAX);
+    if (err && err != -EALREADY) {
+        LOG_WRN("Data length update failed: %d", err);
+    }
+
+    if (!phy_2m) {
+        err = bt_conn_le_phy_update(current_conn, BT_CONN_LE_PHY_PARAM_2M);
+        if (err && err != -EALREADY) {
+            LOG_WRN("PHY update failed: %d", err);
+        }
+    }
+
+    high_throughput_applied = high_throughput;
+}
+
+static void apply_work_handler(struct k_work *work)
+{
+    struct bt_le_conn_param param;
+    bool high_throughput;
+    char users[64];
+    int err;
+
+    k_mutex_lock(&demand_mutex, K_FOREVER);
+
+    if (current_conn == NULL) {
+        k_mutex_unlock(&demand_mutex);
+        return;
+    }
+
+    calculate_params(&param, &high_throughput);
+    apply_link_features(high_throughput);
+
+    if (param.interval_max == applied.interval && param.latency == applied.latency &&
+        param.timeout == applied.timeout) {
+        k_mutex_unlock(&demand_mutex);
+        return;
+    }
+
+    format_users(users, sizeof(users), active_users);
+    LOG_INF("Conn params %u-%u (x1.25 ms) latency %u timeout %u, reason: %s %s, users: %s",
+            param.interval_min, param.interval_max, param.latency, param.timeout,
+            user_names[last_user], last_reason, active_users ? users : "none");
+
+    err = bt_conn_le_param_update(current_conn, &param);
+    if (err && err != -EALREADY) {
+        LOG_ERR("bt_conn_le_param_update failed: %d", err);
+    } else {
+        applied.interval = param.interval_max;
+        applied.latency = param.latency;
+        applied.timeout = param.timeout;
+        applied.num_updates++;
+    }
+
+    k_mutex_unlock(&demand_mutex);
+}
+
+static void discovery_done_work_handler(struct k_work *work)
+{
+    // Assume the peer is done discovering services, only keep what others need.
+    ble_conn_params_release(BLE_CONN_PARAMS_USER_DISCOVERY);
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+    ble_conn_params_demand_t discovery = {
+        .throughput_bps = 0,
+        .max_latency_ms = DISCOVERY_LATENCY_MS,
+    };
+
+    if (err) {
+        return;
+    }
+
+    k_mutex_lock(&demand_mutex, K_FOREVER);
+    current_conn = bt_conn_ref(conn);
+    applied.interval = 0;
+    applied.latency = 0;
+    applied.timeout = 0;
+    high_throughput_applied = false;
+    phy_2m = false;
+    k_mutex_unlock(&demand_mutex);
+
+    // Right after a new connection the peer discovers services, keep the link fast for a while.
+    ble_conn_params_request(BLE_CONN_PARAMS_USER_DISCOVERY, &discovery);
+    k_work_schedule(&discovery_done_work, K_MSEC(CONFIG_BLE_CONN_PARAMS_DISCOVERY_TIMEOUT_MS));
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    k_work_cancel_delayable(&discovery_done_work);
+
+    k_mutex_lock(&demand_mutex, K_FOREVER);
+    // Demands belong to the link, users request again on the next connection.
+    active_users = 0;
+    memset(demands, 0, sizeof(demands));
+    last_reason = "disconnected";
+    if (current_conn == conn) {
+        bt_conn_unref(current_conn);
+        current_conn = NULL;
+    }
+    k_mutex_unlock(&demand_mutex);
+}
+
+static void phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+    phy_2m = param->tx_phy == BT_GAP_LE_PHY_2M;
+}
+
+int ble_conn_params_request(ble_conn_params_user_t user, const ble_conn_params_demand_t *demand)
+{
+    if (user >= BLE_CONN_PARAMS_USER_COUNT || demand == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&demand_mutex, K_FOREVER);
+    demands[user] = *demand;
+    active_users |= BIT(user);
+    last_user = user;
+    last_reason = "requested";
+    k_mutex_unlock(&demand_mutex);
+
+    LOG_INF("%s requests %u B/s, %u ms", user_names[user], demand->throughput_bps, demand->max_latency_ms);
+
+    k_work_submit(&apply_work);
+
+    return 0;
+}
+
+int ble_conn_params_release(ble_conn_params_user_t user)
+{
+    if (user >= BLE_CONN_PARAMS_USER_COUNT) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&demand_mutex, K_FOREVER);
+    if ((active_users & BIT(user)) == 0) {
+        k_mutex_unlock(&demand_mutex);
+        return 0;
+    }
+    active_users &= ~BIT(user);
+    last_user = user;
+    last_reason = "released";
+    k_mutex_unlock(&demand_mutex);
+
+    LOG_INF("%s released its demand", user_names[user]);
+
+    k_work_submit(&apply_work);
+
+    return 0;
+}
+
+void ble_conn_params_get_state(ble_conn_params_state_t *state)
+{
+    k_mutex_lock(&demand_mutex, K_FOREVER);
+    *state = applied;
+    state->active_users = active_users;
+    k_mutex_unlock(&demand_mutex);
+}
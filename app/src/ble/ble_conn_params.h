@@ -0,0 +1,64 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef enum ble_conn_params_user {
+    BLE_CONN_PARAMS_USER_DISCOVERY,         /**< Peer discovering services right after connect. */
+    BLE_CONN_PARAMS_USER_SENSOR_STREAM,     /**< GATT sensor server notifications. */
+    BLE_CONN_PARAMS_USER_SMP,               /**< Firmware update and file transfer (voice memos) over SMP. */
+    BLE_CONN_PARAMS_USER_HISTORY_SYNC,      /**< Bulk history sync. */
+    BLE_CONN_PARAMS_USER_IMU_STREAM,        /**< High rate raw IMU streaming. */
+    BLE_CONN_PARAMS_USER_COUNT
+} ble_conn_params_user_t;
+
+typedef struct ble_conn_params_demand {
+    uint32_t throughput_bps;                /**< Bytes per second the user wants to move, 0 if only latency matters. */
+    uint16_t max_latency_ms;                /**< Max time data may wait for a connection event. */
+} ble_conn_params_demand_t;
+
+typedef struct ble_conn_params_state {
+    uint16_t interval;                      /**< Connection interval in 1.25 ms units. */
+    uint16_t latency;                       /**< Peripheral latency in connection events. */
+    uint16_t timeout;                       /**< Supervision timeout in 10 ms units. */
+    uint32_t active_users;                  /**< Bitmask of ble_conn_params_user_t with a demand registered. */
+    uint32_t num_updates;                   /**< Number of parameter updates requested since boot. */
+} ble_conn_params_state_t;
+
+/** @brief          Register or update the demand of a user. The connection parameters are
+ *                  recalculated from all registered demands and applied asynchronously.
+ *                  Demands are dropped on disconnect, a user that still needs the link
+ *                  requests again from its connected callback.
+ *  @param user     Who is asking
+ *  @param demand   Throughput and latency requirement
+ *  @return         0 when successful
+*/
+int ble_conn_params_request(ble_conn_params_user_t user, const ble_conn_params_demand_t *demand);
+
+/** @brief          Remove the demand of a user. When no demand is left the link
+ *                  goes back to low power parameters.
+ *  @param user     Who is done
+ *  @return         0 when successful
+*/
+int ble_conn_params_release(ble_conn_params_user_t user);
+
+/** @brief          Get the currently applied parameters and active users.
+ *  @param state    Where to store the state
+*/
+void ble_conn_params_get_state(ble_conn_params_state_t *state);
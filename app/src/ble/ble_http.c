@@ -11,99 +11,360 @@ LOG_MODULE_REGISTER(ble_http, LOG_LEVEL_DBG);
 
 #define GB_HTTP_REQUEST_FMT "{\"t\":\"http\", \"url\":\"%s\", id:\"%d\"} \n"
 
-#define HTTP_TIMEOUT_SECONDS 10
+#define HTTP_TIMEOUT_MS     (CONFIG_ZSW_BLE_HTTP_TIMEOUT_S * 1000)
+#define NUM_SLOTS           CONFIG_ZSW_BLE_HTTP_MAX_OUTSTANDING
+#define NUM_CACHE_ENTRIES   CONFIG_ZSW_BLE_HTTP_CACHE_ENTRIES
+
+typedef struct http_request {
+    char url[CONFIG_ZSW_BLE_HTTP_MAX_URL_LEN];
+    ble_http_callback cb;
+    uint32_t max_age_s;
+} http_request_t;
+
+typedef struct http_slot {
+    bool used;
+    uint16_t id;
+    ble_http_callback cb;
+    bool cache;
+    uint32_t url_hash;
+    int64_t sent_ms;
+} http_slot_t;
+
+typedef struct http_cache_entry {
+    uint32_t url_hash;
+    int64_t stored_ms;
+    char response[MAX_HTTP_FIELD_LENGTH + 1];
+} http_cache_entry_t;
 
 static void zbus_ble_comm_data_callback(const struct zbus_channel *chan);
 static void ble_http_timeout_handler(struct k_work *work);
+static void ble_http_queue_handler(struct k_work *work);
 
 ZBUS_LISTENER_DEFINE(ble_http_lis, zbus_ble_comm_data_callback);
 ZBUS_CHAN_DECLARE(ble_comm_data_chan);
 ZBUS_CHAN_ADD_OBS(ble_comm_data_chan, ble_http_lis, 1);
 
-static bool request_pending;
+K_WORK_DELAYABLE_DEFINE(ble_http_timeout_work, ble_http_timeout_handler);
+K_WORK_DEFINE(ble_http_queue_work, ble_http_queue_handler);
+K_MSGQ_DEFINE(ble_http_queue, sizeof(http_request_t), CONFIG_ZSW_BLE_HTTP_QUEUE_SIZE, 4);
+// Recursive, so callbacks of cache hits, called with the lock held, may start new requests.
+K_MUTEX_DEFINE(ble_http_mutex);
+
 static uint16_t request_id;
-static ble_http_callback ble_http_cb;
+static http_slot_t slots[NUM_SLOTS];
+#if NUM_CACHE_ENTRIES > 0
+static http_cache_entry_t cache[NUM_CACHE_ENTRIES];
+#endif
+static ble_http_stats_t stats;
+static uint64_t latency_sum_ms;
+// Only used with ble_http_mutex held, too large for the callers stacks.
+static http_request_t new_request;
+static http_request_t queued_request;
+static char request_buf[CONFIG_ZSW_BLE_HTTP_MAX_URL_LEN + sizeof(GB_HTTP_REQUEST_FMT) + 5];
 
-K_WORK_DELAYABLE_DEFINE(ble_http_timeout_work, ble_http_timeout_handler);
+static uint32_t url_hash(const char *url)
+{
+    // FNV-1a, the URL itself is not stored to keep the cache small.
+    uint32_t hash = 2166136261U;
+
+    while (*url) {
+        hash ^= (uint8_t)*url++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static const char *cache_lookup(uint32_t hash, uint32_t max_age_s)
+{
+#if NUM_CACHE_ENTRIES > 0
+    for (int i = 0; i < NUM_CACHE_ENTRIES; i++) {
+        if (cache[i].stored_ms != 0 && cache[i].url_hash == hash &&
+            k_uptime_get() - cache[i].stored_ms <= (int64_t)max_age_s * 1000) {
+            return cache[i].response;
+        }
+    }
+#endif
+    return NULL;
+}
+
+static void cache_store(uint32_t hash, const char *response)
+{
+#if NUM_CACHE_ENTRIES > 0
+    http_cache_entry_t *p_entry = &cache[0];
+
+    // Replace the entry for the same URL, otherwise the oldest one.
+    for (int i = 0; i < NUM_CACHE_ENTRIES; i++) {
+        if (cache[i].stored_ms != 0 && cache[i].url_hash == hash) {
+            p_entry = &cache[i];
+            break;
+        }
+        if (cache[i].stored_ms < p_entry->stored_ms) {
+            p_entry = &cache[i];
+        }
+    }
+
+    p_entry->url_hash = hash;
+    p_entry->stored_ms = k_uptime_get();
+    strncpy(p_entry->response, response, sizeof(p_entry->response) - 1);
+    p_entry->response[sizeof(p_entry->response) - 1] = '\0';
+#endif
+}
+
+static void schedule_timeout(void)
+{
+    int64_t oldest = INT64_MAX;
+
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        if (slots[i].used) {
+            oldest = MIN(oldest, slots[i].sent_ms);
+        }
+    }
+
+    if (oldest == INT64_MAX) {
+        k_work_cancel_delayable(&ble_http_timeout_work);
+    } else {
+        k_work_reschedule(&ble_http_timeout_work, K_MSEC(MAX(0, oldest + HTTP_TIMEOUT_MS - k_uptime_get())));
+    }
+}
+
+static int send_request(const http_request_t *p_request)
+{
+    http_slot_t *p_slot = NULL;
+    int ret;
+
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        if (!slots[i].used) {
+            p_slot = &slots[i];
+            break;
+        }
+    }
+
+    if (p_slot == NULL) {
+        return -EAGAIN;
+    }
+
+    request_id++;
+    snprintf(request_buf, sizeof(request_buf), GB_HTTP_REQUEST_FMT, p_request->url, request_id);
+    ret = ble_comm_send(request_buf, strlen(request_buf));
+    if (ret != 0) {
+        return ret;
+    }
+
+    p_slot->used = true;
+    p_slot->id = request_id;
+    p_slot->cb = p_request->cb;
+    p_slot->cache = p_request->max_age_s > 0;
+    p_slot->url_hash = url_hash(p_request->url);
+    p_slot->sent_ms = k_uptime_get();
+    stats.outstanding++;
+    schedule_timeout();
+
+    return 0;
+}
+
+static void ble_http_queue_handler(struct k_work *work)
+{
+    const char *cached;
+    int ret;
+
+    k_mutex_lock(&ble_http_mutex, K_FOREVER);
+
+    while (k_msgq_peek(&ble_http_queue, &queued_request) == 0) {
+        cached = queued_request.max_age_s > 0 ?
+                 cache_lookup(url_hash(queued_request.url), queued_request.max_age_s) : NULL;
+        if (cached) {
+            k_msgq_get(&ble_http_queue, &queued_request, K_NO_WAIT);
+            stats.cache_hits++;
+            queued_request.cb(BLE_HTTP_STATUS_OK, cached);
+            continue;
+        }
+
+        ret = send_request(&queued_request);
+        if (ret == -EAGAIN) {
+            // All slots in use, continue when a response arrives or a request times out.
+            break;
+        }
+        k_msgq_get(&ble_http_queue, &queued_request, K_NO_WAIT);
+        if (ret != 0) {
+            LOG_WRN("Failed sending queued request: %d", ret);
+            stats.errors++;
+            queued_request.cb(BLE_HTTP_STATUS_ERROR, NULL);
+        }
+    }
+
+    stats.queued = k_msgq_num_used_get(&ble_http_queue);
+
+    k_mutex_unlock(&ble_http_mutex);
+}
 
 static void ble_http_timeout_handler(struct k_work *work)
 {
-    LOG_WRN("HTTP Timeout");
-    request_pending = false;
-    ble_http_cb(BLE_HTTP_STATUS_TIMEOUT, NULL);
+    ble_http_callback expired[NUM_SLOTS];
+    int num_expired = 0;
+    int64_t now = k_uptime_get();
+
+    k_mutex_lock(&ble_http_mutex, K_FOREVER);
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        if (slots[i].used && now - slots[i].sent_ms >= HTTP_TIMEOUT_MS) {
+            LOG_WRN("HTTP Timeout, id: %d", slots[i].id);
+            expired[num_expired++] = slots[i].cb;
+            slots[i].used = false;
+            stats.outstanding--;
+            stats.timeouts++;
+        }
+    }
+    schedule_timeout();
+    k_mutex_unlock(&ble_http_mutex);
+
+    for (int i = 0; i < num_expired; i++) {
+        expired[i](BLE_HTTP_STATUS_TIMEOUT, NULL);
+    }
+
+    k_work_submit(&ble_http_queue_work);
+}
+
+static void fail_all_outstanding(void)
+{
+    ble_http_callback failed[NUM_SLOTS];
+    int num_failed = 0;
+
+    k_mutex_lock(&ble_http_mutex, K_FOREVER);
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        if (slots[i].used) {
+            failed[num_failed++] = slots[i].cb;
+            slots[i].used = false;
+            stats.outstanding--;
+            stats.errors++;
+        }
+    }
+    schedule_timeout();
+    k_mutex_unlock(&ble_http_mutex);
+
+    for (int i = 0; i < num_failed; i++) {
+        failed[i](BLE_HTTP_STATUS_ERROR, NULL);
+    }
 }
 
 static void zbus_ble_comm_data_callback(const struct zbus_channel *chan)
 {
     const struct ble_data_event *event = zbus_chan_const_msg(chan);
+    http_slot_t slot = { 0 };
+    uint32_t latency_ms;
+
+    if (event->data.type != BLE_COMM_DATA_TYPE_HTTP) {
+        return;
+    }
 
-    if (event->data.type == BLE_COMM_DATA_TYPE_HTTP) {
-        if (event->data.data.http_response.id != request_id) {
-            LOG_WRN("Not the expected response ID, was: %d, expected: %d", event->data.data.http_response.id, request_id);
-            return;
+    if (event->data.data.http_response.id < 0 && strlen(event->data.data.http_response.err) > 0) {
+        // Errors like "Internet access not enabled" come without id and apply to all requests.
+        LOG_WRN("HTTP request failed: %s", event->data.data.http_response.err);
+        fail_all_outstanding();
+        k_work_submit(&ble_http_queue_work);
+        return;
+    }
+
+    k_mutex_lock(&ble_http_mutex, K_FOREVER);
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        if (slots[i].used && slots[i].id == event->data.data.http_response.id) {
+            slot = slots[i];
+            slots[i].used = false;
+            stats.outstanding--;
+            break;
         }
-        struct k_work_sync sync;
-        k_work_cancel_delayable_sync(&ble_http_timeout_work, &sync);
-        request_pending = false;
-
-        if (strlen(event->data.data.http_response.err) > 0) {
-            LOG_WRN("HTTP request failed: %s", event->data.data.http_response.err);
-        } else if (strlen(event->data.data.http_response.response) > 0) {
-            char *fixed_rsp = k_malloc(strlen(event->data.data.http_response.response) + 1);
-            __ASSERT(fixed_rsp, "Failed to allocate memory for fixed_rsp");
-            // As the response from Gadgetbride contains two characters like this[\\, "] instead of just one character [\"],
-            // we need to remove them for it to be avalid JSON accepted by cJSON
-            int i;
-            int j;
-            for (i = 0, j = 0; i < strlen(event->data.data.http_response.response) - 1;) {
-                if (event->data.data.http_response.response[i] == '\\' && event->data.data.http_response.response[i + 1] == '"') {
-                    fixed_rsp[j] = '\"';
-                    j++;
-                    i += 2;
-                } else {
-                    fixed_rsp[j] = event->data.data.http_response.response[i];
-                    j++;
-                    i++;
-                }
-            }
-            if (j > 0) {
-                fixed_rsp[j - 1] = '\0'; // Remove the last " as it belongs not to the data
-            } else {
-                fixed_rsp[0] = '\0';
-            }
-            ble_http_cb(BLE_HTTP_STATUS_OK, fixed_rsp);
-            k_free(fixed_rsp);
+    }
+
+    if (!slot.used) {
+        k_mutex_unlock(&ble_http_mutex);
+        LOG_WRN("Response for unknown or timed out request ID: %d", event->data.data.http_response.id);
+        return;
+    }
+
+    latency_ms = k_uptime_get() - slot.sent_ms;
+    latency_sum_ms += latency_ms;
+    stats.completed++;
+    stats.latency_avg_ms = latency_sum_ms / stats.completed;
+    stats.latency_max_ms = MAX(stats.latency_max_ms, latency_ms);
+    schedule_timeout();
+    k_mutex_unlock(&ble_http_mutex);
+
+    LOG_DBG("HTTP response id %d after %u ms", slot.id, latency_ms);
+
+    if (strlen(event->data.data.http_response.err) > 0) {
+        LOG_WRN("HTTP request failed: %s", event->data.data.http_response.err);
+        k_mutex_lock(&ble_http_mutex, K_FOREVER);
+        stats.errors++;
+        k_mutex_unlock(&ble_http_mutex);
+        slot.cb(BLE_HTTP_STATUS_ERROR, NULL);
+    } else if (event->data.data.http_response.response[0] != '\0') {
+        // Already unescaped by the protocol parser, hand out the event buffer as is.
+        const char *response = event->data.data.http_response.response;
+
+        if (slot.cache) {
+            k_mutex_lock(&ble_http_mutex, K_FOREVER);
+            cache_store(slot.url_hash, response);
+            k_mutex_unlock(&ble_http_mutex);
         }
+        slot.cb(BLE_HTTP_STATUS_OK, response);
+    } else {
+        slot.cb(BLE_HTTP_STATUS_ERROR, NULL);
     }
+
+    k_work_submit(&ble_http_queue_work);
 }
 
-int zsw_ble_http_get(char *url, ble_http_callback cb)
+int zsw_ble_http_get_cached(const char *url, ble_http_callback cb, uint32_t max_age_s)
 {
     int ret;
-    char *request;
 
-    if (request_pending) {
-        // TODO implement a queue for requests
-        return -EBUSY;
+    if (strlen(url) >= CONFIG_ZSW_BLE_HTTP_MAX_URL_LEN) {
+        return -ENAMETOOLONG;
     }
 
-    request_id++;
+    k_mutex_lock(&ble_http_mutex, K_FOREVER);
+
+    strcpy(new_request.url, url);
+    new_request.cb = cb;
+    new_request.max_age_s = max_age_s;
 
-    request = k_calloc(1, strlen(url) + strlen(GB_HTTP_REQUEST_FMT) + 1);
-    __ASSERT(request, "Failed to allocate memory for request URL");
-    memset(request, 0, strlen(url) + strlen(GB_HTTP_REQUEST_FMT) + 1);
+    // Send right away when nothing is waiting, so errors like not connected reach the caller.
+    if (k_msgq_num_used_get(&ble_http_queue) == 0 &&
+        (max_age_s == 0 || cache_lookup(url_hash(url), max_age_s) == NULL)) {
+        ret = send_request(&new_request);
+        if (ret != -EAGAIN) {
+            if (ret == 0) {
+                stats.requests++;
+            }
+            k_mutex_unlock(&ble_http_mutex);
+            return ret;
+        }
+    }
 
-    snprintf(request, strlen(url) + strlen(GB_HTTP_REQUEST_FMT) + 1, GB_HTTP_REQUEST_FMT, url, request_id);
-    ret = ble_comm_send(request, strlen(request));
-    k_free(request);
+    // Cache hits also go through the queue, callbacks are never called from within this function.
+    ret = k_msgq_put(&ble_http_queue, &new_request, K_NO_WAIT);
     if (ret != 0) {
-        return ret;
+        stats.dropped++;
+        k_mutex_unlock(&ble_http_mutex);
+        return -EBUSY;
     }
+    stats.requests++;
+    stats.queued = k_msgq_num_used_get(&ble_http_queue);
 
-    ble_http_cb = cb;
-    request_pending = true;
+    k_mutex_unlock(&ble_http_mutex);
 
-    k_work_schedule(&ble_http_timeout_work, K_SECONDS(HTTP_TIMEOUT_SECONDS));
+    k_work_submit(&ble_http_queue_work);
 
     return 0;
-}
\ No newline at end of file
+}
+
+int zsw_ble_http_get(char *url, ble_http_callback cb)
+{
+    return zsw_ble_http_get_cached(url, cb, 0);
+}
+
+void zsw_ble_http_get_stats(ble_http_stats_t *p_stats)
+{
+    k_mutex_lock(&ble_http_mutex, K_FOREVER);
+    *p_stats = stats;
+    k_mutex_unlock(&ble_http_mutex);
+}
@@ -5,17 +5,31 @@ typedef enum {
     BLE_HTTP_STATUS_OK,
     BLE_HTTP_STATUS_TIMEOUT,
     BLE_HTTP_STATUS_BUSY,
+    BLE_HTTP_STATUS_ERROR,
 } ble_http_status_code_t;
 
+typedef struct ble_http_stats {
+    uint32_t requests;          /**< Requests accepted, including the ones answered from cache. */
+    uint32_t cache_hits;        /**< Requests answered from the response cache. */
+    uint32_t completed;         /**< Responses received from the phone. */
+    uint32_t errors;            /**< Requests the phone reported as failed or that could not be sent. */
+    uint32_t timeouts;          /**< Requests the phone never answered. */
+    uint32_t dropped;           /**< Requests rejected because the queue was full. */
+    uint32_t latency_avg_ms;    /**< Average time from sending a request to its response. */
+    uint32_t latency_max_ms;    /**< Longest time from sending a request to its response. */
+    uint8_t outstanding;        /**< Requests currently waiting for the phone. */
+    uint8_t queued;             /**< Requests currently waiting for a free slot. */
+} ble_http_stats_t;
+
 /**
  * @brief Callback function for HTTP GET requests.
  *
  * This callback function is invoked when an HTTP GET request has been completed.
  *
  * @param status    The status of the HTTP GET request.
- * @param response  The response data.
+ * @param response  The response data. Only valid during the callback and shall not be modified.
  */
-typedef void (*ble_http_callback)(ble_http_status_code_t status, char *response);
+typedef void (*ble_http_callback)(ble_http_status_code_t status, const char *response);
 
 /**
  * @brief Sends an HTTP GET request to the specified URL.
@@ -25,8 +39,32 @@ typedef void (*ble_http_callback)(ble_http_status_code_t status, char *response)
  * JSON format. The cJSON object parameter will be deleted automatically after the callback function returns.
  * Hence it shall not attempt to deleted in the callback.
  *
+ * Up to CONFIG_ZSW_BLE_HTTP_MAX_OUTSTANDING requests wait for the phone at the same time, further
+ * requests are queued and sent in order when a response arrives or a request times out.
+ *
  * @param url The URL to send the GET request to.
  * @param cb The callback function to invoke when the response is received.
- * @return Returns 0 on success, or a negative error code on failure.
+ * @return Returns 0 on success, -EBUSY if the queue is full, or a negative error code on failure.
+ */
+int zsw_ble_http_get(char *url, ble_http_callback cb);
+
+/**
+ * @brief Same as zsw_ble_http_get(), but answer from the response cache when possible.
+ *
+ * If a successful response for the same URL is younger than max_age_s the callback is invoked
+ * from the system work queue with the cached response and nothing is sent to the phone.
+ * Otherwise the request is sent and a successful response is stored in the cache.
+ *
+ * @param url The URL to send the GET request to.
+ * @param cb The callback function to invoke when the response is received.
+ * @param max_age_s Max age of a cached response that may be used, 0 to always ask the phone.
+ * @return Returns 0 on success, -EBUSY if the queue is full, or a negative error code on failure.
+ */
+int zsw_ble_http_get_cached(const char *url, ble_http_callback cb, uint32_t max_age_s);
+
+/**
+ * @brief Get request, cache and latency statistics.
+ *
+ * @param p_stats Where to store the statistics.
  */
-int zsw_ble_http_get(char *url, ble_http_callback cb);
\ No newline at end of file
+void zsw_ble_http_get_stats(ble_http_stats_t *p_stats);
@@ -23,6 +23,8 @@
 #include <zephyr/logging/log_ctrl.h>
 #include <zephyr/logging/log_output.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <zephyr/kernel.h>
 
 #include "ble/ble_comm.h"
@@ -35,18 +37,38 @@
 #define BLE_LOG_BACKEND_BUF_SIZE 256
 #define BLE_LOG_PREFIX "<BLELOG>"
 #define BLE_LOG_SUFFIX "</BLELOG>"
+// Binary dictionary output is framed with a little endian u16 length instead of a suffix.
+#define BLE_LOG_DICT_PREFIX "<BLELOGD>"
 
 // Wait this long after connection before sending logs
 #define BLE_LOG_CONN_DELAY_MS 3000
 
+// Largest notification with the max ATT MTU.
+#define BLE_LOG_MAX_FRAME_SIZE (CONFIG_BT_L2CAP_TX_MTU - 3)
+#define BLE_LOG_HIGH_WATER (CONFIG_ZSW_BLE_LOG_BUFFER_SIZE / 2)
+
+static void flush_work_handler(struct k_work *work);
+
 static uint8_t output_buf[BLE_LOG_BACKEND_BUF_SIZE];
 static bool panic_mode;
+#ifdef CONFIG_ZSW_BLE_LOG_DICTIONARY
+static uint32_t log_format_current = LOG_OUTPUT_DICT;
+#else
 static uint32_t log_format_current = LOG_OUTPUT_TEXT;
+#endif
 static bool first_enable;
 static bool backend_active;
 static int64_t ble_conn_time_ms;
 static atomic_t ble_connected = ATOMIC_INIT(0);
 
+RING_BUF_DECLARE(log_ring, CONFIG_ZSW_BLE_LOG_BUFFER_SIZE);
+static struct k_spinlock log_ring_lock;
+K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+static ble_log_backend_stats_t stats;
+static uint32_t rate_tokens;
+static int64_t rate_refill_ms;
+
 static void ble_log_backend_connected(struct bt_conn *conn, uint8_t err)
 {
     if (err == 0) {
@@ -58,6 +80,8 @@ static void ble_log_backend_connected(struct bt_conn *conn, uint8_t err)
 static void ble_log_backend_disconnected(struct bt_conn *conn, uint8_t reason)
 {
     atomic_set(&ble_connected, 0);
+    // Let the flush work, the only consumer, throw away what is left.
+    k_work_reschedule(&flush_work, K_NO_WAIT);
 }
 
 BT_CONN_CB_DEFINE(ble_log_backend_conn_cb) = {
@@ -67,10 +91,74 @@ BT_CONN_CB_DEFINE(ble_log_backend_conn_cb) = {
 
 static const struct log_backend log_backend_ble_comm;
 
+static void flush_work_handler(struct k_work *work)
+{
+    k_spinlock_key_t key;
+    uint8_t *p_data;
+    uint32_t frame_size;
+    uint32_t len;
+    int ret;
+
+    if (!atomic_get(&ble_connected)) {
+        key = k_spin_lock(&log_ring_lock);
+        ring_buf_reset(&log_ring);
+        k_spin_unlock(&log_ring_lock, key);
+        return;
+    }
+
+    frame_size = MIN(ble_comm_get_mtu() - 3, BLE_LOG_MAX_FRAME_SIZE);
+
+    while (true) {
+        len = ring_buf_get_claim(&log_ring, &p_data, frame_size);
+        if (len == 0) {
+            break;
+        }
+
+        ret = ble_comm_send(p_data, len);
+        if (ret == -ENOMEM || ret == -EAGAIN) {
+            // Out of BT buffers, keep the data and try again later.
+            ring_buf_get_finish(&log_ring, 0);
+            k_work_schedule(&flush_work, K_MSEC(CONFIG_ZSW_BLE_LOG_FLUSH_INTERVAL_MS));
+            return;
+        }
+
+        ring_buf_get_finish(&log_ring, len);
+        if (ret == 0) {
+            stats.frames++;
+            stats.bytes += len;
+        } else {
+            stats.dropped_bytes += len;
+        }
+    }
+}
+
+static bool rate_limit_allow(size_t length)
+{
+    int64_t now = k_uptime_get();
+    uint64_t refill = (now - rate_refill_ms) * CONFIG_ZSW_BLE_LOG_RATE_LIMIT_BPS / 1000;
+
+    if (refill > 0) {
+        rate_tokens = MIN(rate_tokens + refill, CONFIG_ZSW_BLE_LOG_BUFFER_SIZE);
+        rate_refill_ms = now;
+    }
+
+    if (rate_tokens < length) {
+        return false;
+    }
+
+    rate_tokens -= length;
+    return true;
+}
+
 static int line_out(uint8_t *data, size_t length, void *ctx)
 {
     ARG_UNUSED(ctx);
 
+    k_spinlock_key_t key;
+    uint16_t framing;
+    uint8_t dict_len[2];
+    bool dict = log_format_current == LOG_OUTPUT_DICT;
+
     if (!atomic_get(&ble_connected)) {
         // Not connected, pretend to send all
         return length;
@@ -81,11 +169,38 @@ static int line_out(uint8_t *data, size_t length, void *ctx)
         return length;
     }
 
-    const size_t capped_len = MIN(length, (size_t)UINT16_MAX);
+    framing = dict ? strlen(BLE_LOG_DICT_PREFIX) + sizeof(dict_len) : strlen(BLE_LOG_PREFIX) + strlen(BLE_LOG_SUFFIX);
+
+    if (!rate_limit_allow(length + framing)) {
+        stats.rate_limited_bytes += length;
+        return length;
+    }
+
+    // Called from the log thread only, the lock is against the flush work consuming.
+    key = k_spin_lock(&log_ring_lock);
+    if (ring_buf_space_get(&log_ring) < length + framing) {
+        k_spin_unlock(&log_ring_lock, key);
+        stats.dropped_bytes += length;
+        return length;
+    }
+    if (dict) {
+        sys_put_le16(length, dict_len);
+        ring_buf_put(&log_ring, (const uint8_t *)BLE_LOG_DICT_PREFIX, strlen(BLE_LOG_DICT_PREFIX));
+        ring_buf_put(&log_ring, dict_len, sizeof(dict_len));
+        ring_buf_put(&log_ring, data, length);
+    } else {
+        ring_buf_put(&log_ring, (const uint8_t *)BLE_LOG_PREFIX, strlen(BLE_LOG_PREFIX));
+        ring_buf_put(&log_ring, data, length);
+        ring_buf_put(&log_ring, (const uint8_t *)BLE_LOG_SUFFIX, strlen(BLE_LOG_SUFFIX));
+    }
+    k_spin_unlock(&log_ring_lock, key);
 
-    ble_comm_send((const uint8_t *)BLE_LOG_PREFIX, strlen(BLE_LOG_PREFIX));
-    ble_comm_send(data, (uint16_t)capped_len);
-    ble_comm_send((const uint8_t *)BLE_LOG_SUFFIX, strlen(BLE_LOG_SUFFIX));
+    // Batch lines into full notifications, unless the buffer is about to overflow.
+    if (ring_buf_size_get(&log_ring) >= BLE_LOG_HIGH_WATER) {
+        k_work_reschedule(&flush_work, K_NO_WAIT);
+    } else {
+        k_work_schedule(&flush_work, K_MSEC(CONFIG_ZSW_BLE_LOG_FLUSH_INTERVAL_MS));
+    }
 
     return length;
 }
@@ -106,6 +221,13 @@ static void process(const struct log_backend *const backend, union log_msg_gener
     log_output_func(&log_output_ble_comm, &msg->log, flags);
 }
 
+static void dropped(const struct log_backend *const backend, uint32_t cnt)
+{
+    ARG_UNUSED(backend);
+
+    stats.dropped_messages += cnt;
+}
+
 static int format_set(const struct log_backend *const backend, uint32_t log_type)
 {
     ARG_UNUSED(backend);
@@ -137,7 +259,7 @@ static int backend_ready(const struct log_backend *const backend)
 
 static const struct log_backend_api ble_log_backend_api = {
     .process = process,
-    .dropped = NULL,
+    .dropped = dropped,
     .panic = panic,
     .init = init_backend,
     .is_ready = backend_ready,
@@ -168,3 +290,8 @@ void ble_log_backend_set_enabled(bool enable)
         backend_active = false;
     }
 }
+
+void ble_log_backend_get_stats(ble_log_backend_stats_t *p_stats)
+{
+    *p_stats = stats;
+}
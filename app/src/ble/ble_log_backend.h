@@ -18,12 +18,31 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
+
+typedef struct ble_log_backend_stats {
+    uint32_t frames;                /**< Notifications sent. */
+    uint32_t bytes;                 /**< Bytes sent, including framing. */
+    uint32_t dropped_bytes;         /**< Log bytes lost because the buffer was full or sending failed. */
+    uint32_t rate_limited_bytes;    /**< Log bytes dropped by the rate limit. */
+    uint32_t dropped_messages;      /**< Messages dropped by the logging core before reaching the backend. */
+} ble_log_backend_stats_t;
 
 #ifdef CONFIG_LOG
 void ble_log_backend_set_enabled(bool enable);
+
+/** @brief          Get counters of sent and dropped log data.
+ *  @param p_stats  Where to store the counters
+*/
+void ble_log_backend_get_stats(ble_log_backend_stats_t *p_stats);
 #else
 static inline void ble_log_backend_set_enabled(bool enable)
 {
     (void)enable;
 }
+
+static inline void ble_log_backend_get_stats(ble_log_backend_stats_t *p_stats)
+{
+    *p_stats = (ble_log_backend_stats_t) { 0 };
+}
 #endif
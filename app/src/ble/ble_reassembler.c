@@ -0,0 +1,313 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+
+#include "ble/ble_reassembler.h"
+#include "ble/ble_rx_bench.h"
+
+LOG_MODULE_REGISTER(ble_reassembler, CONFIG_ZSW_BLE_LOG_LEVEL);
+
+// Header in front of the message in each slab block, lets a completed block go straight into the fifo.
+typedef struct {
+    void *fifo_reserved;
+    ble_reassembler_t *p_stream;
+    uint16_t len;
+#ifdef CONFIG_ZSW_BLE_RX_BENCH
+    uint64_t rx_start_ns;
+#endif
+    uint8_t data[];
+} reassembly_block_t;
+
+// One byte kept for the '\0' terminator.
+#define MAX_MESSAGE_LEN     (CONFIG_BLE_REASSEMBLER_BUFFER_SIZE - sizeof(reassembly_block_t) - 1)
+#define GC_INTERVAL_MS      (CONFIG_BLE_REASSEMBLER_TIMEOUT_MS / 2)
+
+BUILD_ASSERT(CONFIG_BLE_REASSEMBLER_BUFFER_SIZE % 4 == 0, "Slab block size must be word aligned");
+
+static void process_work_handler(struct k_work *work);
+static void gc_work_handler(struct k_work *work);
+
+K_MEM_SLAB_DEFINE_STATIC(reassembly_slab, CONFIG_BLE_REASSEMBLER_BUFFER_SIZE, CONFIG_BLE_REASSEMBLER_NUM_BUFFERS, 4);
+K_FIFO_DEFINE(completed_fifo);
+K_MUTEX_DEFINE(reassembler_mutex);
+K_THREAD_STACK_DEFINE(protocol_work_q_stack, CONFIG_BLE_PROTOCOL_WORKQUEUE_STACK_SIZE);
+
+static struct k_work_q protocol_work_q;
+K_WORK_DEFINE(process_work, process_work_handler);
+K_WORK_DELAYABLE_DEFINE(gc_work, gc_work_handler);
+
+static sys_slist_t active_streams = SYS_SLIST_STATIC_INIT(&active_streams);
+static ble_reassembler_stats_t stats;
+
+static void release_locked(ble_reassembler_t *p_stream)
+{
+    if (p_stream->p_block == NULL) {
+        return;
+    }
+
+    k_mem_slab_free(&reassembly_slab, p_stream->p_block);
+    p_stream->p_block = NULL;
+    sys_slist_find_and_remove(&active_streams, &p_stream->node);
+}
+
+static void hand_off_locked(ble_reassembler_t *p_stream)
+{
+    reassembly_block_t *p_block = p_stream->p_block;
+
+    p_block->p_stream = p_stream;
+    p_block->len = p_stream->len;
+    p_block->data[p_stream->len] = '\0';
+
+    // Ownership of the block moves to the protocol work queue, it frees it after the handler ran.
+    p_stream->p_block = NULL;
+    sys_slist_find_and_remove(&active_streams, &p_stream->node);
+    stats.completed++;
+
+    k_fifo_put(&completed_fifo, p_block);
+    k_work_submit_to_queue(&protocol_work_q, &process_work);
+}
+
+static void process_work_handler(struct k_work *work)
+{
+    reassembly_block_t *p_block;
+
+    while ((p_block = k_fifo_get(&completed_fifo, K_NO_WAIT)) != NULL) {
+        LOG_DBG("%s: message of %u bytes", p_block->p_stream->name, p_block->len);
+#ifdef CONFIG_ZSW_BLE_RX_BENCH
+        ble_rx_bench_decode_begin(p_block->p_stream->name, p_block->len, p_block->rx_start_ns);
+#endif
+        p_block->p_stream->handler(p_block->data, p_block->len);
+#ifdef CONFIG_ZSW_BLE_RX_BENCH
+        ble_rx_bench_decode_end();
+#endif
+        k_mem_slab_free(&reassembly_slab, p_block);
+    }
+}
+
+static void gc_work_handler(struct k_work *work)
+{
+    ble_reassembler_t *p_stream;
+    ble_reassembler_t *p_next;
+    int64_t now = k_uptime_get();
+
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+
+    SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&active_streams, p_stream, p_next, node) {
+        if ((now - p_stream->last_rx_ms) >= CONFIG_BLE_REASSEMBLER_TIMEOUT_MS) {
+            LOG_WRN("%s: dropping partial message, %u of %u bytes after %d ms", p_stream->name, p_stream->len,
+                    p_stream->expected_len, CONFIG_BLE_REASSEMBLER_TIMEOUT_MS);
+            release_locked(p_stream);
+            stats.timeouts++;
+        }
+    }
+
+    if (!sys_slist_is_empty(&active_streams)) {
+        k_work_schedule_for_queue(&protocol_work_q, &gc_work, K_MSEC(GC_INTERVAL_MS));
+    }
+
+    k_mutex_unlock(&reassembler_mutex);
+}
+
+int ble_reassembler_start(ble_reassembler_t *p_stream, uint16_t expected_len)
+{
+    void *p_block;
+
+    if (expected_len > MAX_MESSAGE_LEN) {
+        LOG_WRN("%s: message of %u bytes does not fit", p_stream->name, expected_len);
+        k_mutex_lock(&reassembler_mutex, K_FOREVER);
+        stats.rejected++;
+        k_mutex_unlock(&reassembler_mutex);
+        return -EMSGSIZE;
+    }
+
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+
+    if (p_stream->p_block != NULL) {
+        LOG_WRN("%s: new message before previous completed, %u of %u bytes dropped", p_stream->name,
+                p_stream->len, p_stream->expected_len);
+        release_locked(p_stream);
+        stats.aborted++;
+    }
+
+    if (k_mem_slab_alloc(&reassembly_slab, &p_block, K_NO_WAIT) != 0) {
+        LOG_WRN("%s: no free reassembly buffer", p_stream->name);
+        stats.rejected++;
+        k_mutex_unlock(&reassembler_mutex);
+        return -ENOMEM;
+    }
+
+    p_stream->p_block = p_block;
+#ifdef CONFIG_ZSW_BLE_RX_BENCH
+    ((reassembly_block_t *)p_block)->rx_start_ns = ble_rx_bench_now_ns();
+#endif
+    p_stream->expected_len = expected_len;
+    p_stream->len = 0;
+    p_stream->fragments = 0;
+    p_stream->last_rx_ms = k_uptime_get();
+    sys_slist_append(&active_streams, &p_stream->node);
+
+    k_work_schedule_for_queue(&protocol_work_q, &gc_work, K_MSEC(GC_INTERVAL_MS));
+
+    k_mutex_unlock(&reassembler_mutex);
+
+    return 0;
+}
+
+int ble_reassembler_put(ble_reassembler_t *p_stream, uint8_t index, uint16_t offset, const uint8_t *p_data,
+                        uint16_t len)
+{
+    reassembly_block_t *p_block;
+    int ret = 0;
+
+    if (index >= 32) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+
+    p_block = p_stream->p_block;
+    if ((p_block == NULL) || (p_stream->expected_len == 0)) {
+        stats.rejected++;
+        ret = -ENOENT;
+    } else if (((uint32_t)offset + len) > p_stream->expected_len) {
+        LOG_WRN("%s: fragment %u at %u+%u outside message of %u bytes", p_stream->name, index, offset, len,
+                p_stream->expected_len);
+        stats.rejected++;
+        ret = -EMSGSIZE;
+    } else if (p_stream->fragments & BIT(index)) {
+        stats.duplicates++;
+    } else {
+        memcpy(&p_block->data[offset], p_data, len);
+        p_stream->fragments |= BIT(index);
+        p_stream->len += len;
+        p_stream->last_rx_ms = k_uptime_get();
+
+        if (p_stream->len >= p_stream->expected_len) {
+            p_stream->len = p_stream->expected_len;
+            hand_off_locked(p_stream);
+            ret = 1;
+        }
+    }
+
+    k_mutex_unlock(&reassembler_mutex);
+
+    return ret;
+}
+
+int ble_reassembler_append(ble_reassembler_t *p_stream, const uint8_t *p_data, uint16_t len)
+{
+    reassembly_block_t *p_block;
+    int ret = 0;
+
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+
+    p_block = p_stream->p_block;
+    if (p_block == NULL) {
+        stats.rejected++;
+        ret = -ENOENT;
+    } else if (((uint32_t)p_stream->len + len) > MAX_MESSAGE_LEN) {
+        LOG_WRN("%s: message exceeds %u bytes, dropped", p_stream->name, MAX_MESSAGE_LEN);
+        release_locked(p_stream);
+        stats.aborted++;
+        ret = -EMSGSIZE;
+    } else {
+        memcpy(&p_block->data[p_stream->len], p_data, len);
+        p_stream->len += len;
+        p_stream->last_rx_ms = k_uptime_get();
+    }
+
+    k_mutex_unlock(&reassembler_mutex);
+
+    return ret;
+}
+
+int ble_reassembler_finish(ble_reassembler_t *p_stream)
+{
+    int ret = 0;
+
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+
+    if (p_stream->p_block == NULL) {
+        ret = -ENOENT;
+    } else {
+        hand_off_locked(p_stream);
+    }
+
+    k_mutex_unlock(&reassembler_mutex);
+
+    return ret;
+}
+
+void ble_reassembler_abort(ble_reassembler_t *p_stream)
+{
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+    if (p_stream->p_block != NULL) {
+        release_locked(p_stream);
+        stats.aborted++;
+    }
+    k_mutex_unlock(&reassembler_mutex);
+}
+
+bool ble_reassembler_is_active(ble_reassembler_t *p_stream)
+{
+    bool active;
+
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+    active = p_stream->p_block != NULL;
+    k_mutex_unlock(&reassembler_mutex);
+
+    return active;
+}
+
+void ble_reassembler_get_stats(ble_reassembler_stats_t *p_stats)
+{
+    k_mutex_lock(&reassembler_mutex, K_FOREVER);
+    *p_stats = stats;
+    k_mutex_unlock(&reassembler_mutex);
+}
+
+k_tid_t ble_reassembler_get_thread(void)
+{
+    return k_work_queue_thread_get(&protocol_work_q);
+}
+
+int ble_reassembler_get_unused_stack(size_t *p_unused)
+{
+#ifdef CONFIG_THREAD_STACK_INFO
+    return k_thread_stack_space_get(k_work_queue_thread_get(&protocol_work_q), p_unused);
+#else
+    return -ENOTSUP;
+#endif
+}
+
+static int ble_reassembler_init(void)
+{
+    struct k_work_queue_config cfg = {
+        .name = "ble_protocol",
+    };
+
+    k_work_queue_start(&protocol_work_q, protocol_work_q_stack, K_THREAD_STACK_SIZEOF(protocol_work_q_stack),
+                       K_PRIO_PREEMPT(CONFIG_BLE_PROTOCOL_WORKQUEUE_PRIORITY), &cfg);
+
+    return 0;
+}
+
+SYS_INIT(ble_reassembler_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
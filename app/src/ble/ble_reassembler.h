@@ -0,0 +1,119 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+/** @brief          Called on the protocol work queue with a complete message.
+ *  @param p_data   Message, always followed by a '\0' that is not part of len. Only valid during the call.
+ *  @param len      Message length
+*/
+typedef void (*ble_reassembler_handler_t)(uint8_t *p_data, uint16_t len);
+
+typedef struct ble_reassembler_stats {
+    uint32_t completed;             /**< Messages handed off to the protocol work queue. */
+    uint32_t timeouts;              /**< Partial messages garbage collected after CONFIG_BLE_REASSEMBLER_TIMEOUT_MS. */
+    uint32_t aborted;               /**< Partial messages dropped because a new one started or on errors. */
+    uint32_t rejected;              /**< Fragments out of bounds, without an ongoing message or without free buffer. */
+    uint32_t duplicates;            /**< Fragments received more than once. */
+} ble_reassembler_stats_t;
+
+/** @brief Reassembly state of one protocol stream, define with BLE_REASSEMBLER_DEFINE.
+*/
+typedef struct ble_reassembler {
+    const char *name;
+    ble_reassembler_handler_t handler;
+    /* Private, protected by the reassembler lock. */
+    sys_snode_t node;
+    void *p_block;
+    uint16_t expected_len;
+    uint16_t len;
+    uint32_t fragments;
+    int64_t last_rx_ms;
+} ble_reassembler_t;
+
+#define BLE_REASSEMBLER_DEFINE(_name, _handler) \
+    static ble_reassembler_t _name = {          \
+        .name = #_name,                         \
+        .handler = _handler,                    \
+    }
+
+/** @brief                  Start a new message, an ongoing partial message on the stream is dropped.
+ *  @param p_stream         Stream
+ *  @param expected_len     Total length when known up front (use ble_reassembler_put),
+ *                          0 when the end is detected by the protocol (use ble_reassembler_append)
+ *  @return                 0 when successful, -EMSGSIZE if too large, -ENOMEM if no buffer is free
+*/
+int ble_reassembler_start(ble_reassembler_t *p_stream, uint16_t expected_len);
+
+/** @brief                  Copy a fragment to its position in a message with known length. The message is
+ *                          handed off when all bytes are received, fragments may arrive in any order.
+ *  @param p_stream         Stream
+ *  @param index            Fragment number (0-31), used to detect duplicates
+ *  @param offset           Position of the fragment in the message
+ *  @param p_data           Fragment data
+ *  @param len              Fragment length
+ *  @return                 1 when the message completed, 0 when more fragments are needed, negative errno on error
+*/
+int ble_reassembler_put(ble_reassembler_t *p_stream, uint8_t index, uint16_t offset, const uint8_t *p_data,
+                        uint16_t len);
+
+/** @brief                  Append data to a message with unknown length.
+ *  @param p_stream         Stream
+ *  @param p_data           Data
+ *  @param len              Data length
+ *  @return                 0 when successful, -EMSGSIZE if the message does not fit (message is dropped)
+*/
+int ble_reassembler_append(ble_reassembler_t *p_stream, const uint8_t *p_data, uint16_t len);
+
+/** @brief                  Hand off a message built with ble_reassembler_append.
+ *  @param p_stream         Stream
+ *  @return                 0 when successful
+*/
+int ble_reassembler_finish(ble_reassembler_t *p_stream);
+
+/** @brief                  Drop the ongoing message, if any.
+ *  @param p_stream         Stream
+*/
+void ble_reassembler_abort(ble_reassembler_t *p_stream);
+
+/** @brief                  Check if a message is being assembled.
+ *  @param p_stream         Stream
+ *  @return                 true if a message is started and not yet finished, dropped or timed out
+*/
+bool ble_reassembler_is_active(ble_reassembler_t *p_stream);
+
+/** @brief                  Get statistics for all streams since boot.
+ *  @param p_stats          Where to store the statistics
+*/
+void ble_reassembler_get_stats(ble_reassembler_stats_t *p_stats);
+
+/** @brief                  Get the thread of the protocol work queue that runs the message handlers.
+ *  @return                 Thread id
+*/
+k_tid_t ble_reassembler_get_thread(void);
+
+/** @brief                  Get the unused stack of the protocol work queue.
+ *  @param p_unused         Where to store the number of never used bytes
+ *  @return                 0 when successful, -ENOTSUP without CONFIG_THREAD_STACK_INFO
+*/
+int ble_reassembler_get_unused_stack(size_t *p_unused);
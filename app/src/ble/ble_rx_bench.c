@@ -0,0 +1,157 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+#if defined(CONFIG_ARCH_POSIX) && defined(CONFIG_EXTERNAL_LIBC)
+#include <time.h>
+#endif
+
+#include "ble/ble_rx_bench.h"
+#include "ble/ble_reassembler.h"
+
+#define NUM_SAMPLES CONFIG_ZSW_BLE_RX_BENCH_SAMPLES
+
+static void zbus_ble_comm_data_callback(const struct zbus_channel *chan);
+
+ZBUS_CHAN_DECLARE(ble_comm_data_chan);
+ZBUS_LISTENER_DEFINE(ble_rx_bench_lis, zbus_ble_comm_data_callback);
+ZBUS_CHAN_ADD_OBS(ble_comm_data_chan, ble_rx_bench_lis, 1);
+
+K_MUTEX_DEFINE(bench_mutex);
+
+static ble_rx_bench_sample_t samples[NUM_SAMPLES];
+static uint32_t num_samples;
+static ble_rx_bench_summary_t summary;
+static uint64_t decode_sum_us;
+static uint32_t dropped_baseline;
+
+// Message currently being parsed, only one at a time as the protocol work queue is a single thread.
+static ble_rx_bench_sample_t current;
+static uint64_t decode_start_ns;
+static bool decode_active;
+
+uint64_t ble_rx_bench_now_ns(void)
+{
+#if defined(CONFIG_ARCH_POSIX) && defined(CONFIG_EXTERNAL_LIBC)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+#else
+    return k_cyc_to_ns_floor64(k_cycle_get_64());
+#endif
+}
+
+static uint32_t reassembler_drops(void)
+{
+    ble_reassembler_stats_t stats;
+
+    ble_reassembler_get_stats(&stats);
+
+    return stats.timeouts + stats.aborted + stats.rejected;
+}
+
+static void zbus_ble_comm_data_callback(const struct zbus_channel *chan)
+{
+    ARG_UNUSED(chan);
+
+    // Events from other sources (ex. apps publishing weather) are not part of a decode.
+    if (!decode_active || k_current_get() != ble_reassembler_get_thread()) {
+        return;
+    }
+
+    if (current.events == 0) {
+        current.publish_us = (ble_rx_bench_now_ns() - decode_start_ns) / NSEC_PER_USEC;
+    }
+    current.events++;
+}
+
+void ble_rx_bench_decode_begin(const char *p_stream, uint16_t len, uint64_t rx_start_ns)
+{
+    decode_start_ns = ble_rx_bench_now_ns();
+
+    current = (ble_rx_bench_sample_t) {
+        .p_stream = p_stream,
+        .len = len,
+        .queue_us = (decode_start_ns - rx_start_ns) / NSEC_PER_USEC,
+    };
+    decode_active = true;
+}
+
+void ble_rx_bench_decode_end(void)
+{
+    size_t unused;
+
+    current.decode_us = (ble_rx_bench_now_ns() - decode_start_ns) / NSEC_PER_USEC;
+    decode_active = false;
+
+    k_mutex_lock(&bench_mutex, K_FOREVER);
+
+    if (num_samples < NUM_SAMPLES) {
+        samples[num_samples++] = current;
+    } else {
+        summary.overflows++;
+    }
+
+    summary.messages++;
+    summary.queue_max_us = MAX(summary.queue_max_us, current.queue_us);
+    summary.decode_max_us = MAX(summary.decode_max_us, current.decode_us);
+    summary.publish_max_us = MAX(summary.publish_max_us, current.publish_us);
+    decode_sum_us += current.decode_us;
+    summary.decode_avg_us = decode_sum_us / summary.messages;
+
+    if (ble_reassembler_get_unused_stack(&unused) == 0) {
+        summary.stack_unused = summary.stack_unused == 0 ? unused : MIN(summary.stack_unused, unused);
+    }
+
+    k_mutex_unlock(&bench_mutex);
+}
+
+void ble_rx_bench_reset(void)
+{
+    k_mutex_lock(&bench_mutex, K_FOREVER);
+    num_samples = 0;
+    decode_sum_us = 0;
+    summary = (ble_rx_bench_summary_t) { 0 };
+    dropped_baseline = reassembler_drops();
+    k_mutex_unlock(&bench_mutex);
+}
+
+void ble_rx_bench_get_summary(ble_rx_bench_summary_t *p_summary)
+{
+    k_mutex_lock(&bench_mutex, K_FOREVER);
+    *p_summary = summary;
+    p_summary->dropped = reassembler_drops() - dropped_baseline;
+    k_mutex_unlock(&bench_mutex);
+}
+
+int ble_rx_bench_get_sample(uint32_t index, ble_rx_bench_sample_t *p_sample)
+{
+    int ret = 0;
+
+    k_mutex_lock(&bench_mutex, K_FOREVER);
+    if (index < num_samples) {
+        *p_sample = samples[index];
+    } else {
+        ret = -ENOENT;
+    }
+    k_mutex_unlock(&bench_mutex);
+
+    return ret;
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct ble_rx_bench_sample {
+    const char *p_stream;           /**< Reassembler stream the message came from. */
+    uint16_t len;                   /**< Message length. */
+    uint32_t queue_us;              /**< From the first fragment until the parser started. */
+    uint32_t decode_us;             /**< Time spent in the parser, including publishing. */
+    uint32_t publish_us;            /**< From parser start until the first zbus event reached the listeners, 0 if none. */
+    uint8_t events;                 /**< zbus events published while parsing the message. */
+} ble_rx_bench_sample_t;
+
+typedef struct ble_rx_bench_summary {
+    uint32_t messages;              /**< Messages parsed since the last reset. */
+    uint32_t overflows;             /**< Samples lost because the sample buffer was full. */
+    uint32_t dropped;               /**< Messages or fragments dropped by the reassembler since the last reset. */
+    uint32_t queue_max_us;
+    uint32_t decode_max_us;
+    uint32_t decode_avg_us;
+    uint32_t publish_max_us;
+    uint32_t stack_unused;          /**< Smallest unused stack of the protocol work queue, 0 if unknown. */
+} ble_rx_bench_summary_t;
+
+#ifdef CONFIG_ZSW_BLE_RX_BENCH
+/** @brief      Timestamp for the measurements. On native_sim the host clock, as simulated
+ *              time does not advance while code runs.
+ *  @return     Monotonic time in ns
+*/
+uint64_t ble_rx_bench_now_ns(void);
+
+/** @brief              Called by the reassembler before a complete message is parsed.
+ *  @param p_stream     Name of the stream
+ *  @param len          Message length
+ *  @param rx_start_ns  ble_rx_bench_now_ns() when the first fragment arrived
+*/
+void ble_rx_bench_decode_begin(const char *p_stream, uint16_t len, uint64_t rx_start_ns);
+
+/** @brief      Called by the reassembler after a message was parsed.
+*/
+void ble_rx_bench_decode_end(void);
+
+/** @brief      Clear all samples and counters.
+*/
+void ble_rx_bench_reset(void);
+
+/** @brief              Get aggregated results since the last reset.
+ *  @param p_summary    Where to store the results
+*/
+void ble_rx_bench_get_summary(ble_rx_bench_summary_t *p_summary);
+
+/** @brief              Get one recorded sample, oldest first.
+ *  @param index        Sample index
+ *  @param p_sample     Where to store the sample
+ *  @return             0 when successful, -ENOENT when index is past the last sample
+*/
+int ble_rx_bench_get_sample(uint32_t index, ble_rx_bench_sample_t *p_sample);
+#else
+static inline uint64_t ble_rx_bench_now_ns(void)
+{
+    return 0;
+}
+
+static inline void ble_rx_bench_decode_begin(const char *p_stream, uint16_t len, uint64_t rx_start_ns)
+{
+    (void)p_stream;
+    (void)len;
+    (void)rx_start_ns;
+}
+
+static inline void ble_rx_bench_decode_end(void)
+{
+}
+#endif
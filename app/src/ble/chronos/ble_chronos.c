@@ -3,6 +3,7 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/kernel.h>
 #include <zephyr/zbus/zbus.h>
+#include <zephyr/sys/byteorder.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
@@ -14,6 +15,7 @@
 
 #include "ui/zsw_ui.h"
 #include "ble/ble_comm.h"
+#include "ble/ble_reassembler.h"
 #include "ble/ble_transport.h"
 #include "events/ble_event.h"
 #include "events/music_event.h"
@@ -27,7 +29,13 @@ static void music_control_event_callback(const struct zbus_channel *chan);
 ZBUS_CHAN_DECLARE(ble_comm_data_chan);
 ZBUS_LISTENER_DEFINE(android_music_control_lis_chronos, music_control_event_callback);
 
-static chronos_data_t incoming; // variable to store incoming data
+static void chronos_message_handler(uint8_t *data, uint16_t len)
+{
+    ble_chronos_data_received(data, len);
+}
+
+BLE_REASSEMBLER_DEFINE(chronos_rx, chronos_message_handler);
+
 
 static chronos_notification_t notifications[CH_NOTIF_SIZE];
 static int notificationIndex = -1;
@@ -418,86 +426,58 @@ const char *ble_chronos_get_app_name(int id)
 /* DATA FROM CHRONOS APP FUNCTIONS */
 
 // Chronos received commands (data[0] is 0xAB or 0xEA or <= 0x19) on RX characteristic.
-// this function assembles data packets that are split over multiple transmissions
+// The first packet carries the total length, the following ones start with their index.
 void ble_chronos_on_receive_data(const uint8_t *data, uint16_t len)
 {
     // LOG_HEXDUMP_DBG(data, len, "Chronos RX");
-    if (len > 0) {
-
-        // Chronos app sends data starting with either AB or EA for the first packet and FE or FF at index 3
-        if ((data[0] == 0xAB || data[0] == 0xEA) && (data[3] == 0xFE || data[3] == 0xFF)) {
-            // start of data, assign length from packet
-            incoming.length = data[1] * 256 + data[2] + 3;
-            // copy data to incomingBuffer
-            for (int i = 0; i < len; i++) {
-                incoming.data[i] = data[i];
-            }
+    if (len == 0) {
+        return;
+    }
 
-            if (incoming.length <= len) {
-                // complete packet assembled
-                ble_chronos_data_received();
-                // Reset state after processing complete packet
-                incoming.length = 0;
-            } else {
-                // data is still being assembled
-                // LOG_INF("Incomplete");
-            }
-        } else if (data[0] < 0x19 && incoming.length > 0) {
-            // Only process subsequent packets if we have a valid ongoing Chronos data stream
-            // subsequent packets start with 0 (max anticipated is 25 -> 0x19)
-            int j = 20 + (data[0] * 19); // data packet position
-
-            // Bounds check to prevent buffer overflow
-            if (j + len - 1 <= sizeof(incoming.data) && j + len <= incoming.length) {
-                // copy data to incomingBuffer
-                for (int i = 0; i < len; i++) {
-                    incoming.data[j + i] = data[i + 1];
-                }
+    // Chronos app sends data starting with either AB or EA for the first packet and FE or FF at index 3
+    if (len >= CH_HEADER_SIZE && (data[0] == 0xAB || data[0] == 0xEA) && (data[3] == 0xFE || data[3] == 0xFF)) {
+        uint16_t length = sys_get_be16(&data[1]) + 3;
 
-                if (incoming.length <= len + j - 1) {
-                    // complete packet assembled
-                    ble_chronos_data_received();
-                    // Reset state after processing complete packet
-                    incoming.length = 0;
-                } else {
-                    // data is still being assembled
-                    // LOG_INF("Incomplete");
-                }
-            } else {
-                LOG_WRN("Buffer bounds check failed or invalid packet sequence, resetting");
-                incoming.length = 0;  // Reset to prevent further issues
-            }
-        } else {
-            // Not Chronos data or no active session
-            if (data[0] < 0x19 && incoming.length == 0) {
-                LOG_DBG("Ignoring packet - no active Chronos session");
-            } else {
-                LOG_DBG("Not Chronos data");
-            }
+        if (ble_reassembler_start(&chronos_rx, length) == 0) {
+            ble_reassembler_put(&chronos_rx, 0, 0, data, MIN(len, length));
+        }
+    } else if (data[0] < 0x19 && ble_reassembler_is_active(&chronos_rx)) {
+        // Subsequent packets start with 0 (max anticipated is 25 -> 0x19), followed by their part of the data.
+        uint16_t offset = CH_FIRST_PACKET_SIZE + data[0] * (CH_FIRST_PACKET_SIZE - 1);
+
+        if (ble_reassembler_put(&chronos_rx, data[0] + 1, offset, &data[1], len - 1) < 0) {
+            LOG_WRN("Invalid packet sequence, resetting");
+            ble_reassembler_abort(&chronos_rx);
         }
+    } else if (data[0] < 0x19) {
+        LOG_DBG("Ignoring packet - no active Chronos session");
+    } else {
+        LOG_DBG("Not Chronos data");
     }
 }
 
-void ble_chronos_data_received()
+void ble_chronos_data_received(const uint8_t *data, uint16_t len)
 {
-    int len = incoming.length;
-
     // LOG_INF("Complete data length %d", len);
-    // LOG_HEXDUMP_DBG(incoming.data, len, "Chronos RX");
+    // LOG_HEXDUMP_DBG(data, len, "Chronos RX");
 
-    if (incoming.data[0] == 0xAB) {
-        switch (incoming.data[4]) {
+    if (len < 5) {
+        return;
+    }
+
+    if (data[0] == 0xAB) {
+        switch (data[4]) {
             case 0x23:
                 // request to reset the watch
                 LOG_INF("Reset watch");
                 break;
             case 0x53:
-                // uint8_t hour = incoming.data[7];
-                // uint8_t minute = incoming.data[8];
-                // uint8_t hour2 = incoming.data[9];
-                // uint8_t minute2 = incoming.data[10];
-                // bool enabled = incoming.data[6];
-                // uint8_t interval = incoming.data[11]; // interval in minutes
+                // uint8_t hour = data[7];
+                // uint8_t minute = data[8];
+                // uint8_t hour2 = data[9];
+                // uint8_t minute2 = data[10];
+                // bool enabled = data[6];
+                // uint8_t interval = data[11]; // interval in minutes
                 break;
             case 0x71:
                 // find watch
@@ -505,13 +485,21 @@ void ble_chronos_data_received()
                 LOG_INF("find watch");
                 break;
             case 0x72: {
-                int icon = incoming.data[6]; // See ALERT ICONS
-                int state = incoming.data[7];
-                char message[512] = {0};
-
-                for (int i = 8; i < len; i++) {
-                    strncat(message, (char *)&incoming.data[i], 1);
+                int icon;
+                int state;
+                char message[512];
+                size_t message_len;
+
+                if (len < 8) {
+                    LOG_WRN("Notification too short: %u", len);
+                    break;
                 }
+                icon = data[6]; // See ALERT ICONS
+                state = data[7];
+                // Longer messages from the phone are cut off.
+                message_len = MIN(len - 8, sizeof(message) - 1);
+                memcpy(message, &data[8], message_len);
+                message[message_len] = '\0';
 
                 // LOG_INF("Notification id: %02X, state: %d", icon, state);
 
@@ -572,11 +560,11 @@ void ble_chronos_data_received()
             break;
             case 0x73: {
                 // alarms
-                // uint8_t index = incoming.data[6]; [0-7]
-                // bool enabled = incoming.data[7];
-                // uint8_t hour = incoming.data[8];
-                // uint8_t minute = incoming.data[9];
-                // uint8_t repeat = incoming.data[10]; //
+                // uint8_t index = data[6]; [0-7]
+                // bool enabled = data[7];
+                // uint8_t hour = data[8];
+                // uint8_t minute = data[9];
+                // uint8_t repeat = data[10]; //
                 // repeat values 0x80->Once or 0x01-0x7F -> Specify days with bits. Order [null,Sun,Sat,Fri,Thu,Wed,Tue,Mon]
                 // 0x80 [1000 0000] -> Once (one time alarm)
                 // 0x7F [0111 1111] -> everyday (null,Sun,Sat,Fri,Thu,Wed,Tue,Mon)
@@ -586,56 +574,56 @@ void ble_chronos_data_received()
             break;
             case 0x74:
                 // user details and settings from the app
-                // uint8_t stepLength = incoming.data[6]; // cm
-                // uint8_t age = incoming.data[7]; //yrs
-                // uint8_t height = incoming.data[8]; // cm
-                // uint8_t weight = incoming.data[9]; // kg
-                // uint8_t unit = incoming.data[10]; 0->Imperial 1->Metric
-                // uint8_t targetSteps = incoming.data[11] * 1000;
-                // uint8_t tempUnit = incoming.data[12]; 0->C 1->F
+                // uint8_t stepLength = data[6]; // cm
+                // uint8_t age = data[7]; //yrs
+                // uint8_t height = data[8]; // cm
+                // uint8_t weight = data[9]; // kg
+                // uint8_t unit = data[10]; 0->Imperial 1->Metric
+                // uint8_t targetSteps = data[11] * 1000;
+                // uint8_t tempUnit = data[12]; 0->C 1->F
 
                 break;
             case 0x75:
                 // sedentary reminder
-                // bool enabled = incoming.data[6];
-                // uint8_t hour = incoming.data[7]; // start
-                // uint8_t minute = incoming.data[8];
-                // uint8_t hour2 = incoming.data[9]; // end
-                // uint8_t minute2 = incoming.data[10];
-                // uint8_t interval = incoming.data[11]; // interval in minutes
+                // bool enabled = data[6];
+                // uint8_t hour = data[7]; // start
+                // uint8_t minute = data[8];
+                // uint8_t hour2 = data[9]; // end
+                // uint8_t minute2 = data[10];
+                // uint8_t interval = data[11]; // interval in minutes
                 break;
             case 0x76:
                 // quiet hours settings
-                // bool enabled = incoming.data[6];
-                // uint8_t hour = incoming.data[7];
-                // uint8_t minute = incoming.data[8];
-                // uint8_t hour2 = incoming.data[9];
-                // uint8_t minute2 = incoming.data[10];
+                // bool enabled = data[6];
+                // uint8_t hour = data[7];
+                // uint8_t minute = data[8];
+                // uint8_t hour2 = data[9];
+                // uint8_t minute2 = data[10];
                 break;
             case 0x77:
                 // raise to wake settings
-                // incoming.data[6]; 1->ON 0->OFF
+                // data[6]; 1->ON 0->OFF
 
                 break;
             case 0x78:
                 // health hourly settings (used to trigger health measurements every hour)
-                // incoming.data[6]; 1->ON 0->OFF
+                // data[6]; 1->ON 0->OFF
                 break;
             case 0x79:
                 // remote camera function
                 // this tells the watch that the camera is active on the app and ready to receive capture command
-                // _cameraReady = ((uint8_t)incoming.data[6] == 1);
+                // _cameraReady = ((uint8_t)data[6] == 1);
                 if (configuration_callback != NULL) {
-                    configuration_callback(CH_CONFIG_CAMERA, 0, (uint32_t)incoming.data[6]);
+                    configuration_callback(CH_CONFIG_CAMERA, 0, (uint32_t)data[6]);
                 }
                 break;
             case 0x7B:
                 // change watch language if supported
-                // incoming.data[6] is the language id; See LANGUAGE ID
+                // data[6] is the language id; See LANGUAGE ID
                 break;
             case 0x7C:
                 // 24 hour clock mode
-                // incoming.data[6]; 1->ON 0->OFF
+                // data[6]; 1->ON 0->OFF
                 break;
             case 0x7E:
                 // weather data received
@@ -649,10 +637,10 @@ void ble_chronos_data_received()
                 weather_info.time = time;
                 weather_info.size = 0;
                 for (int k = 0; k < (len - 6) / 2; k++) {
-                    int sign = (incoming.data[(k * 2) + 6] & 1) ? -1 : 1;
+                    int sign = (data[(k * 2) + 6] & 1) ? -1 : 1;
 
-                    int icon = incoming.data[(k * 2) + 6] >> 4; // icon id; See WEATHER ICONS
-                    int temp = ((int)incoming.data[(k * 2) + 7]) * sign;
+                    int icon = data[(k * 2) + 6] >> 4; // icon id; See WEATHER ICONS
+                    int temp = ((int)data[(k * 2) + 7]) * sign;
 
                     int dy = tm_info.tm_wday + k;
                     weather[k].day = dy % 7;
@@ -667,21 +655,21 @@ void ble_chronos_data_received()
             break;
             case 0x7F:
                 // sleep settings
-                // bool enabled = incoming.data[6];
-                // uint8_t hour = incoming.data[7];
-                // uint8_t minute = incoming.data[8];
-                // uint8_t hour2 = incoming.data[9];
-                // uint8_t minute2 = incoming.data[10];
+                // bool enabled = data[6];
+                // uint8_t hour = data[7];
+                // uint8_t minute = data[8];
+                // uint8_t hour2 = data[9];
+                // uint8_t minute2 = data[10];
                 break;
             case 0x88:
                 // weather data received
                 // contains high and low temperature forecast
                 for (int k = 0; k < (len - 6) / 2; k++) {
-                    int signH = (incoming.data[(k * 2) + 6] >> 7 & 1) ? -1 : 1;
-                    int tempH = ((int)incoming.data[(k * 2) + 6] & 0x7F) * signH;
+                    int signH = (data[(k * 2) + 6] >> 7 & 1) ? -1 : 1;
+                    int tempH = ((int)data[(k * 2) + 6] & 0x7F) * signH;
 
-                    int signL = (incoming.data[(k * 2) + 7] >> 7 & 1) ? -1 : 1;
-                    int tempL = ((int)incoming.data[(k * 2) + 7] & 0x7F) * signL;
+                    int signL = (data[(k * 2) + 7] >> 7 & 1) ? -1 : 1;
+                    int tempL = ((int)data[(k * 2) + 7] & 0x7F) * signL;
 
                     weather[k].high = tempH;
                     weather[k].low = tempL;
@@ -692,11 +680,11 @@ void ble_chronos_data_received()
                 }
                 break;
             case 0x91:
-                if (incoming.data[3] == 0xFE) {
+                if (data[3] == 0xFE) {
                     // custom app command
                     // status of the phone battery
-                    phone_info.state = incoming.data[6]; // 1->Charging 0->Not Charging
-                    phone_info.level = incoming.data[7]; // phone battery level %
+                    phone_info.state = data[6]; // 1->Charging 0->Not Charging
+                    phone_info.level = data[7]; // phone battery level %
                     if (configuration_callback != NULL) {
                         configuration_callback(CH_CONFIG_PBAT, phone_info.state, phone_info.level);
                     }
@@ -705,48 +693,48 @@ void ble_chronos_data_received()
                 break;
             case 0x93:
                 // time received (update watch time immediately)
-                // year; incoming.data[7] * 256 + incoming.data[8]
-                // month; incoming.data[9]
-                // day; incoming.data[10]
-                // hour; incoming.data[11]
-                // minute; incoming.data[12]
-                // seconds; incoming.data[13]
+                // year; data[7] * 256 + data[8]
+                // month; data[9]
+                // day; data[10]
+                // hour; data[11]
+                // minute; data[12]
+                // seconds; data[13]
             {
                 struct tm t = {0, 0, 0, 0, 0, 0, 0, 0, 0};      // Initalize to all 0's
-                t.tm_year = (incoming.data[7] * 256) + incoming.data[8] - 1900;    // This is year-1900, so 121 = 2021
-                t.tm_mon = incoming.data[9] - 1;
-                t.tm_mday = incoming.data[10];
-                t.tm_hour = incoming.data[11];
-                t.tm_min = incoming.data[12];
-                t.tm_sec = incoming.data[13];
+                t.tm_year = (data[7] * 256) + data[8] - 1900;    // This is year-1900, so 121 = 2021
+                t.tm_mon = data[9] - 1;
+                t.tm_mday = data[10];
+                t.tm_hour = data[11];
+                t.tm_min = data[12];
+                t.tm_sec = data[13];
                 time_t epoch = mktime(&t);
                 parse_time((uint32_t)epoch);
             }
             break;
             case 0x9C:
                 // watchface font style and color settings
-                // uint32_t colorRGB = ((uint32_t)incoming.data[5] << 16) | ((uint32_t)incoming.data[6] << 8) | (uint32_t)incoming.data[7]
-                // style incoming.data[8] [0-2]
-                // position incoming.data[9] 0->Top, 1->Center, 2->Bottom
+                // uint32_t colorRGB = ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | (uint32_t)data[7]
+                // style data[8] [0-2]
+                // position data[9] 0->Top, 1->Center, 2->Bottom
 
                 break;
             case 0xA8:
-                if (incoming.data[3] == 0xFE) {
+                if (data[3] == 0xFE) {
                     // end of qr data transmission (Chronos v3.7.0+)
-                    // incoming.data[5]; // number of links received
+                    // data[5]; // number of links received
                 }
-                if (incoming.data[3] == 0xFF) {
+                if (data[3] == 0xFF) {
                     // qr links with index
-                    // incoming.data[5]; // index of the current link
-                    // link incoming.data[6:len]
+                    // data[5]; // index of the current link
+                    // link data[6:len]
                 }
                 break;
             case 0xBF:
-                if (incoming.data[3] == 0xFE) {
+                if (data[3] == 0xFE) {
                     // remote touch data (Chronos v3.7.0+)
-                    remote_touch.state = incoming.data[5] == 1;
-                    remote_touch.x = (uint32_t)(incoming.data[6] << 8) | (uint32_t)(incoming.data[7]);
-                    remote_touch.y = (uint32_t)(incoming.data[8] << 8) | (uint32_t)(incoming.data[9]);
+                    remote_touch.state = data[5] == 1;
+                    remote_touch.x = (uint32_t)(data[6] << 8) | (uint32_t)(data[7]);
+                    remote_touch.y = (uint32_t)(data[8] << 8) | (uint32_t)(data[9]);
 
                     if (touch_callback != NULL) {
                         touch_callback(&remote_touch);
@@ -754,12 +742,12 @@ void ble_chronos_data_received()
                 }
                 break;
             case 0xCA:
-                if (incoming.data[3] == 0xFE) {
-                    app_info.code = (incoming.data[6] * 256) + incoming.data[7];
+                if (data[3] == 0xFE) {
+                    app_info.code = (data[6] * 256) + data[7];
 
                     char version[50] = {0};
                     for (int i = 8; i < len; i++) {
-                        strncat(version, (char *)&incoming.data[i], 1);
+                        strncat(version, (char *)&data[i], 1);
                     }
                     if (app_info.version) {
                         free(app_info.version);
@@ -772,18 +760,18 @@ void ble_chronos_data_received()
                 }
                 break;
             // case 0xCC:
-            //     if (incoming.data[3] == 0xFE) {
-            //         setChunkedTransfer(incoming.data[5] != 0x00);
+            //     if (data[3] == 0xFE) {
+            //         setChunkedTransfer(data[5] != 0x00);
             //     }
             //     break;
             case 0xEE:
-                if (incoming.data[3] == 0xFE) {
+                if (data[3] == 0xFE) {
                     // navigation icon data received
-                    uint8_t pos = incoming.data[6];
-                    uint32_t crc = (uint32_t)(incoming.data[7] << 24) | (uint32_t)(incoming.data[8] << 16) | (uint32_t)(
-                                       incoming.data[9] << 8) | (uint32_t)(incoming.data[10]);
+                    uint8_t pos = data[6];
+                    uint32_t crc = (uint32_t)(data[7] << 24) | (uint32_t)(data[8] << 16) | (uint32_t)(
+                                       data[9] << 8) | (uint32_t)(data[10]);
                     for (int i = 0; i < 96; i++) {
-                        navigation.icon[i + (96 * pos)] = incoming.data[11 + i];
+                        navigation.icon[i + (96 * pos)] = data[11 + i];
                     }
 
                     if (configuration_callback != NULL) {
@@ -792,7 +780,7 @@ void ble_chronos_data_received()
                 }
                 break;
             case 0xEF:
-                if (incoming.data[3] == 0xFE) {
+                if (data[3] == 0xFE) {
                     // navigation data received
                     char **fields[] = {
                         &navigation.title,
@@ -807,14 +795,14 @@ void ble_chronos_data_received()
                         *fields[i] = NULL;
                     }
 
-                    if (incoming.data[5] == 0x00) {
+                    if (data[5] == 0x00) {
                         navigation.active = false;
                         navigation.eta = strdup("Navigation");
                         navigation.duration = strdup("Inactive");
                         navigation.distance = strdup("");
                         navigation.title = strdup("Chronos");
                         navigation.directions = strdup("Start navigation on Google maps");
-                    } else if (incoming.data[5] == 0xFF) {
+                    } else if (data[5] == 0xFF) {
                         navigation.active = true;
                         navigation.eta = strdup("Navigation");
                         navigation.duration = strdup("Disabled");
@@ -823,15 +811,15 @@ void ble_chronos_data_received()
                         navigation.directions = strdup("Check Chronos app settings");
                         navigation.has_icon = false;
                         navigation.is_navigation = false;
-                    } else if (incoming.data[5] == 0x80) {
+                    } else if (data[5] == 0x80) {
                         navigation.active = true;
-                        navigation.has_icon = incoming.data[6] == 1;
-                        navigation.is_navigation = incoming.data[7] == 1;
-                        navigation.icon_crc = (uint32_t)(incoming.data[8] << 24) | (uint32_t)(incoming.data[9] << 16) | (uint32_t)(
-                                                  incoming.data[10] << 8) | (uint32_t)(incoming.data[11]);
+                        navigation.has_icon = data[6] == 1;
+                        navigation.is_navigation = data[7] == 1;
+                        navigation.icon_crc = (uint32_t)(data[8] << 24) | (uint32_t)(data[9] << 16) | (uint32_t)(
+                                                  data[10] << 8) | (uint32_t)(data[11]);
 
-                        const uint8_t *ptr = incoming.data + 12;
-                        const uint8_t *end = incoming.data + len;
+                        const uint8_t *ptr = data + 12;
+                        const uint8_t *end = data + len;
 
                         for (int i = 0; i < 5 && ptr < end; i++) {
                             size_t field_len = 0;
@@ -852,17 +840,17 @@ void ble_chronos_data_received()
             default:
                 break;
         }
-    } else if (incoming.data[0] == 0xEA) {
-        if (incoming.data[4] == 0x7E) {
-            switch (incoming.data[5]) {
+    } else if (data[0] == 0xEA) {
+        if (data[4] == 0x7E) {
+            switch (data[5]) {
                 case 0x01:
                     // weather city name
-                    // incoming.data[7:len]
+                    // data[7:len]
                 {
                     char city[512] = {0};
 
                     for (int i = 7; i < len; i++) {
-                        strncat(city, (char *)&incoming.data[i], 1);
+                        strncat(city, (char *)&data[i], 1);
                     }
 
                     if (weather_info.city) {
@@ -879,21 +867,21 @@ void ble_chronos_data_received()
                 case 0x02:
                     // hourly weather forecsat
                 {
-                    int size = incoming.data[6]; // data size
-                    int hour = incoming.data[7]; // current hour
+                    int size = data[6]; // data size
+                    int hour = data[7]; // current hour
                     struct tm tm_info = ble_chronos_get_time_struct();
                     for (int z = 0; z < size; z++) {
 
-                        int sign = (incoming.data[8 + (6 * z)] & 1) ? -1 : 1;
+                        int sign = (data[8 + (6 * z)] & 1) ? -1 : 1;
 
-                        int icon = incoming.data[8 + (6 * z)] >> 4; // See WEATHER ICONS
-                        int temp = ((int)incoming.data[9 + (6 * z)]) * sign;
+                        int icon = data[8 + (6 * z)] >> 4; // See WEATHER ICONS
+                        int temp = ((int)data[9 + (6 * z)]) * sign;
 
                         hourly_forecast[hour + z].day = tm_info.tm_yday;
                         hourly_forecast[hour + z].hour = hour + z;
-                        hourly_forecast[hour + z].wind = (incoming.data[10 + (6 * z)] * 256) + incoming.data[11 + (6 * z)];
-                        hourly_forecast[hour + z].humidity = incoming.data[12 + (6 * z)];
-                        hourly_forecast[hour + z].uv = incoming.data[13 + (6 * z)];
+                        hourly_forecast[hour + z].wind = (data[10 + (6 * z)] * 256) + data[11 + (6 * z)];
+                        hourly_forecast[hour + z].humidity = data[12 + (6 * z)];
+                        hourly_forecast[hour + z].uv = data[13 + (6 * z)];
                         hourly_forecast[hour + z].icon = icon;
                         hourly_forecast[hour + z].temp = temp;
                     }
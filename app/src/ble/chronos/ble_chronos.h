@@ -15,7 +15,8 @@
 #define CH_NOTIF_SIZE 10
 #define CH_WEATHER_SIZE 7
 #define CH_ALARM_SIZE 8
-#define CH_DATA_SIZE 512
+#define CH_HEADER_SIZE 5
+#define CH_FIRST_PACKET_SIZE 20
 #define CH_FORECAST_SIZE 24
 #define CH_QR_SIZE 9
 #define CH_ICON_SIZE 48
@@ -34,12 +35,6 @@ typedef enum chronos_control {
     CH_CONTROL_VOLUME_MUTE = 0x99A3,
 } chronos_control_t;
 
-// struct to store assembled incoming data from chronos
-typedef struct chronos_data {
-    int length;
-    uint8_t data[CH_DATA_SIZE];
-} chronos_data_t;
-
 typedef struct chronos_time {
     uint8_t hour;
     uint8_t minute;
@@ -201,4 +196,4 @@ struct tm ble_chronos_get_time_struct();
 const char *ble_chronos_get_app_name(int id);
 
 void ble_chronos_on_receive_data(const uint8_t *data, uint16_t len);
-void ble_chronos_data_received();
+void ble_chronos_data_received(const uint8_t *data, uint16_t len);
@@ -16,6 +16,7 @@
 #include "ui/zsw_ui.h"
 #include "ble/ble_comm.h"
 #include "ble/ble_log_backend.h"
+#include "ble/ble_reassembler.h"
 #include "ble/ble_transport.h"
 #include "events/ble_event.h"
 #include "events/music_event.h"
@@ -33,16 +34,16 @@ LOG_MODULE_REGISTER(ble_gadgetbridge, CONFIG_ZSW_BLE_LOG_LEVEL);
 typedef enum parse_state {
     WAIT_GB,
     WAIT_END,
-    PARSE_STATE_DONE,
 } parse_state_t;
 
 static uint8_t num_parsed_brackets;
 static parse_state_t parse_state = WAIT_GB;
-static uint16_t parsed_data_index = 0;
-static uint8_t receive_buf[MAX_GB_PACKET_LENGTH];
 
 static void music_control_event_callback(const struct zbus_channel *chan);
 static void parse_time_zone(char *offset);
+static void gadgetbridge_message_handler(uint8_t *data, uint16_t len);
+
+BLE_REASSEMBLER_DEFINE(gadgetbridge_rx, gadgetbridge_message_handler);
 
 ZBUS_CHAN_DECLARE(ble_comm_data_chan);
 ZBUS_LISTENER_DEFINE(android_music_control_lis, music_control_event_callback);
@@ -592,6 +593,58 @@ static int parse_musicstate(char *data, int len)
     return 0;
 }
 
+int ble_gadgetbridge_unescape_string(const char *p_src, char *p_dst, size_t dst_size)
+{
+    size_t len = 0;
+
+    while (*p_src != '\0' && *p_src != '"') {
+        if (len + 1 >= dst_size) {
+            p_dst[len] = '\0';
+            return -ENOSPC;
+        }
+
+        if (*p_src == '\\' && p_src[1] != '\0') {
+            p_src++;
+            switch (*p_src) {
+                case 'n':
+                    p_dst[len++] = '\n';
+                    break;
+                case 'r':
+                    p_dst[len++] = '\r';
+                    break;
+                case 't':
+                    p_dst[len++] = '\t';
+                    break;
+                case 'b':
+                    p_dst[len++] = '\b';
+                    break;
+                case 'f':
+                    p_dst[len++] = '\f';
+                    break;
+                case 'u':
+                    // Keep unicode escapes, only valid inside strings of the inner JSON where cJSON decodes them.
+                    p_dst[len++] = '\\';
+                    p_dst[len++] = 'u';
+                    if (len >= dst_size) {
+                        p_dst[dst_size - 1] = '\0';
+                        return -ENOSPC;
+                    }
+                    break;
+                default:
+                    p_dst[len++] = *p_src;
+                    break;
+            }
+            p_src++;
+        } else {
+            p_dst[len++] = *p_src++;
+        }
+    }
+
+    p_dst[len] = '\0';
+
+    return len;
+}
+
 static int parse_httpstate(char *data, int len)
 {
     // {"t":"http","resp":"{\"response_code\":0,\"results\":[{\"type\":\"boolean\",\"difficulty\":\"easy\",\"category\":\"Geography\",\"question\":\"Hungary is the only country in the world beginning with H.\",\"correct_answer\":\"False\",\"incorrect_answers\":[\"True\"]}]}"}
@@ -625,9 +678,13 @@ static int parse_httpstate(char *data, int len)
     } else {
         temp_value = extract_value_str("\"resp\":", data, &temp_len);
         if (temp_value) {
-            LOG_DBG("HTTP response: %s", temp_value);
-            memcpy(cb.data.data.http_response.response, temp_value,
-                   (strlen(temp_value) > MAX_HTTP_FIELD_LENGTH) ? MAX_HTTP_FIELD_LENGTH : strlen(temp_value)); /// @todo cast?
+            // The response is JSON sent as a JSON string, undo the escaping while copying it to the event.
+            temp_len = ble_gadgetbridge_unescape_string(temp_value, cb.data.data.http_response.response,
+                                                        sizeof(cb.data.data.http_response.response));
+            if (temp_len < 0) {
+                LOG_WRN("HTTP response truncated to %d bytes", MAX_HTTP_FIELD_LENGTH);
+            }
+            LOG_DBG("HTTP response: %s", cb.data.data.http_response.response);
             send_ble_data_event(&cb);
         }
     }
@@ -963,6 +1020,12 @@ static void parse_remote_control(char *data, int len)
     send_ble_data_event(&cb);
 }
 
+static void gadgetbridge_message_handler(uint8_t *data, uint16_t len)
+{
+    LOG_DBG("%s", data);
+    parse_data(data, len);
+}
+
 void ble_gadgetbridge_input(const uint8_t *const data, uint16_t len)
 {
     LOG_HEXDUMP_DBG(data, len, "RX");
@@ -993,64 +1056,52 @@ void ble_gadgetbridge_input(const uint8_t *const data, uint16_t len)
         return;
     }
 
-    switch (parse_state) {
-        case WAIT_GB: {
-            if (gb_start) {
-                gb_start += 3;
-                parse_state = WAIT_END;
-                num_parsed_brackets = 0;
-                parsed_data_index = 0;
-                memset(receive_buf, 0, sizeof(receive_buf));
-                uint32_t index = gb_start - (char *)data;
-                for (int i = index; i < len; i++) {
-                    receive_buf[parsed_data_index] = data[i];
-                    parsed_data_index++;
-                    if (data[i] == '{') {
-                        num_parsed_brackets++;
-                    } else if (data[i] == '}') {
-                        num_parsed_brackets--;
-                        if (num_parsed_brackets == 0) {
-                            parse_state = PARSE_STATE_DONE;
-                            break;
-                        }
-                    }
-                }
-            }
-            break;
+    // A partial message dropped by the reassembler timeout, wait for the next one.
+    if (parse_state == WAIT_END && !ble_reassembler_is_active(&gadgetbridge_rx)) {
+        parse_state = WAIT_GB;
+    }
+
+    const uint8_t *start = data;
+
+    if (parse_state == WAIT_GB) {
+        if (!gb_start) {
+            return;
         }
-        case WAIT_END: {
-            for (int i = 0; i < len; i++) {
-                receive_buf[parsed_data_index] = data[i];
-                parsed_data_index++;
-                if (parsed_data_index >= MAX_GB_PACKET_LENGTH) {
-                    LOG_ERR("Data from Gadgetbridge does not fit in MAX_GB_PACKET_LENGTH (%d)", MAX_GB_PACKET_LENGTH);
-                    parse_state = WAIT_GB;
-                    break;
-                }
-                if (data[i] == '{') {
-                    num_parsed_brackets++;
-                } else if (data[i] == '}') {
-                    num_parsed_brackets--;
-                    if (num_parsed_brackets == 0) {
-                        parse_state = PARSE_STATE_DONE;
-                        break;
-                    }
-                }
-            }
-            break;
+        if (ble_reassembler_start(&gadgetbridge_rx, 0) != 0) {
+            return;
         }
-        case PARSE_STATE_DONE: {
-            LOG_WRN("Busy parsing, ingnoring...");
-            break;
+        start = (const uint8_t *)gb_start + strlen("GB(");
+        parse_state = WAIT_END;
+        num_parsed_brackets = 0;
+    }
+
+    // Copy everything up to and including the closing bracket of the JSON object in one go.
+    const uint8_t *end = data + len;
+    const uint8_t *p;
+    bool done = false;
+
+    for (p = start; p < end; p++) {
+        if (*p == '{') {
+            num_parsed_brackets++;
+        } else if (*p == '}') {
+            num_parsed_brackets--;
+            if (num_parsed_brackets == 0) {
+                done = true;
+                p++;
+                break;
+            }
         }
-        default:
-            LOG_WRN("Unhandled state");
-            break;
     }
-    if (parse_state == PARSE_STATE_DONE) {
+
+    if (ble_reassembler_append(&gadgetbridge_rx, start, p - start) != 0) {
+        LOG_ERR("Data from Gadgetbridge does not fit in the reassembly buffer");
+        parse_state = WAIT_GB;
+        return;
+    }
+
+    if (done) {
         parse_state = WAIT_GB;
-        LOG_DBG("%s", receive_buf);
-        parse_data(receive_buf, parsed_data_index);
+        ble_reassembler_finish(&gadgetbridge_rx);
     }
 }
 
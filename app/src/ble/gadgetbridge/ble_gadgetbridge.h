@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "ble/ble_comm.h"
@@ -15,6 +16,19 @@ void ble_gadgetbridge_input(const uint8_t *const data, uint16_t len);
 
 void ble_gadgetbridge_send_version_info(void);
 
+/**
+ * @brief Copy a JSON string value and undo its escaping in a single pass.
+ *
+ * Copies until the closing unescaped quote or end of string. Used for HTTP responses,
+ * which Gadgetbridge sends as JSON encoded into a JSON string.
+ *
+ * @param p_src Start of the string value, just after the opening quote
+ * @param p_dst Destination, always NUL terminated
+ * @param dst_size Size of the destination
+ * @return Length of the result, -ENOSPC if it was truncated
+ */
+int ble_gadgetbridge_unescape_string(const char *p_src, char *p_dst, size_t dst_size);
+
 /**
  * @brief Send a notification action to Gadgetbridge.
  *
@@ -15,30 +15,35 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/zbus/zbus.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/byteorder.h>
 
 #include "events/periodic_event.h"
 #include "events/zsw_periodic_event.h"
 
 #include "ble/ble_comm.h"
+#include "ble/ble_conn_params.h"
 #include <ble/zsw_gatt_sensor_server.h>
 
 #include "sensor_fusion/zsw_sensor_fusion.h"
 #include "sensors/zsw_imu.h"
-#include "sensors/zsw_light_sensor.h"
-#include "sensors/zsw_magnetometer.h"
-#include "sensors/zsw_pressure_sensor.h"
+#include "sensors/zsw_sensor_scheduler.h"
 
 LOG_MODULE_REGISTER(zsw_gatt_sensor_server, CONFIG_ZSW_BLE_LOG_LEVEL);
 
 static ssize_t on_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf, uint16_t len, uint16_t offset);
 static void on_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value);
 static ssize_t on_ccc_cfg_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, uint16_t value);
+static ssize_t on_rates_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf, uint16_t len,
+                             uint16_t offset);
+static ssize_t on_rates_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+                              uint16_t offset, uint8_t flags);
 static void disconnected(struct bt_conn *conn, uint8_t reason);
 static void connected(struct bt_conn *conn, uint8_t err);
 
@@ -56,6 +61,14 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
 // 1 = 100ms, 5 = 500ms, 10 = 1s etc.
 #define ZSW_GATT_SENSOR_NOTIFY_INTERVAL_PERIODS    2
 
+#define SENSOR_FRAME_HEADER_LEN     (sizeof(uint32_t) + sizeof(uint16_t))
+
+// Reads within one 100 ms tick reuse the reading of other sensor consumers.
+#define SENSOR_READ_MAX_AGE_MS      100
+
+// Legacy characteristics send up to 8 small notifications every notify period.
+#define LEGACY_NOTIFY_BYTES         (8 * 20)
+
 #if CONFIG_BLE_DISABLE_PAIRING_REQUIRED
 #define ZSW_GATT_READ_WRITE_PERM    BT_GATT_PERM_READ | BT_GATT_PERM_WRITE
 #else
@@ -133,13 +146,67 @@ BT_GATT_SERVICE_DEFINE(light_service,
                        BT_GATT_CCC_WITH_WRITE_CB(on_ccc_cfg_changed, on_ccc_cfg_write, ZSW_GATT_READ_WRITE_PERM)
                       );
 
+BT_GATT_SERVICE_DEFINE(sensor_frame_service,
+                       BT_GATT_PRIMARY_SERVICE(ZSW_SERVICE_SENSOR_FRAME),
+                       BT_GATT_CHARACTERISTIC(ZSW_CHAR_SENSOR_FRAME,
+                                              BT_GATT_CHRC_NOTIFY,
+                                              ZSW_GATT_READ_WRITE_PERM,
+                                              NULL, NULL, NULL),
+                       BT_GATT_CCC_WITH_WRITE_CB(on_ccc_cfg_changed, on_ccc_cfg_write, ZSW_GATT_READ_WRITE_PERM),
+                       BT_GATT_CHARACTERISTIC(ZSW_CHAR_SENSOR_FRAME_RATES,
+                                              BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                                              ZSW_GATT_READ_WRITE_PERM,
+                                              on_rates_read, on_rates_write, NULL)
+                      );
+
+// Number of values of each channel in the sensor frame.
+static const uint8_t frame_channel_values[ZSW_SENSOR_FRAME_CH_COUNT] = {
+    [ZSW_SENSOR_FRAME_CH_ACCEL] = 3,
+    [ZSW_SENSOR_FRAME_CH_GYRO] = 3,
+    [ZSW_SENSOR_FRAME_CH_MAG] = 3,
+    [ZSW_SENSOR_FRAME_CH_QUAT] = 4,
+    [ZSW_SENSOR_FRAME_CH_PRESSURE] = 1,
+    [ZSW_SENSOR_FRAME_CH_LIGHT] = 1,
+    [ZSW_SENSOR_FRAME_CH_TEMPERATURE] = 1,
+    [ZSW_SENSOR_FRAME_CH_HUMIDITY] = 1,
+};
+
+// Periods of 100 ms between samples per channel. Pressure is only updated every few seconds by the sensor
+// and there is no humidity sensor.
+static uint8_t frame_channel_rates[ZSW_SENSOR_FRAME_CH_COUNT] = {
+    [ZSW_SENSOR_FRAME_CH_ACCEL] = 1,
+    [ZSW_SENSOR_FRAME_CH_GYRO] = 1,
+    [ZSW_SENSOR_FRAME_CH_MAG] = 1,
+    [ZSW_SENSOR_FRAME_CH_QUAT] = 1,
+    [ZSW_SENSOR_FRAME_CH_PRESSURE] = 10,
+    [ZSW_SENSOR_FRAME_CH_LIGHT] = 10,
+    [ZSW_SENSOR_FRAME_CH_TEMPERATURE] = 10,
+    [ZSW_SENSOR_FRAME_CH_HUMIDITY] = 0,
+};
+
+// Rates are written from the Bluetooth RX thread and used from the periodic event listener.
+static struct k_spinlock frame_lock;
+static uint32_t frame_tick;
+// Channels that were due but didn't fit in the previous frame.
+static uint16_t frame_pending_mask;
+// Channel picked first for the next frame, moves on so that no channel is starved by the MTU.
+static uint8_t frame_first_channel;
+
 static bool notif_enabled;
 static uint8_t notify_period_counter;
+// Keep the gyroscope and magnetometer powered while streaming, the magnetometer takes a few samples to settle after resume.
+static zsw_sensor_sched_request_t imu_request = {
+    .sensor = ZSW_SENSOR_SCHED_IMU,
+};
+static zsw_sensor_sched_request_t mag_request = {
+    .sensor = ZSW_SENSOR_SCHED_MAG,
+};
 // Flag to ignore restored CCCDs on first connect after reboot/disconnect
 // If phone did not properly disable notifications before disconnecting,
 // we don't want to start sending sensor data automatically.
 static bool ignore_restored_ccc;
 
+// The legacy one characteristic per sensor attributes first, the sensor frame last.
 static const struct bt_gatt_attr *const notify_attrs[] = {
     &temp_service.attrs[2],
     &accel_service.attrs[2],
@@ -149,9 +216,14 @@ static const struct bt_gatt_attr *const notify_attrs[] = {
     &gyro_service.attrs[2],
     &sensor_fusion_service.attrs[2],
     &light_service.attrs[2],
+    &sensor_frame_service.attrs[2],
 };
 
+#define NUM_LEGACY_NOTIFY_ATTRS     (ARRAY_SIZE(notify_attrs) - 1)
+
 struct notif_scan_ctx {
+    const struct bt_gatt_attr *const *attrs;
+    size_t num_attrs;
     bool enabled;
 };
 
@@ -165,49 +237,163 @@ static void notif_conn_scan(struct bt_conn *conn, void *data)
         return;
     }
 
-    for (size_t i = 0; i < sizeof(notify_attrs) / sizeof(notify_attrs[0]); i++) {
-        if (bt_gatt_is_subscribed(conn, notify_attrs[i], BT_GATT_CCC_NOTIFY)) {
+    for (size_t i = 0; i < state->num_attrs; i++) {
+        if (bt_gatt_is_subscribed(conn, state->attrs[i], BT_GATT_CCC_NOTIFY)) {
             state->enabled = true;
             return;
         }
     }
 }
 
+static bool is_subscribed(const struct bt_gatt_attr *const *attrs, size_t num_attrs)
+{
+    struct notif_scan_ctx ctx = {
+        .attrs = attrs,
+        .num_attrs = num_attrs,
+        .enabled = false,
+    };
+
+    bt_conn_foreach(BT_CONN_TYPE_LE, notif_conn_scan, &ctx);
+
+    return ctx.enabled;
+}
+
 static bool any_notification_enabled(uint16_t value)
 {
     if ((value & BT_GATT_CCC_NOTIFY) != 0U) {
         return true;
     }
 
-    struct notif_scan_ctx ctx = { 0 };
+    return is_subscribed(notify_attrs, ARRAY_SIZE(notify_attrs));
+}
 
-    bt_conn_foreach(BT_CONN_TYPE_LE, notif_conn_scan, &ctx);
+/*
+* Returns true if a subscribed stream limits the latency, demand->max_latency_ms is only set then.
+*/
+static bool calculate_stream_demand(ble_conn_params_demand_t *demand)
+{
+    uint8_t rates[ZSW_SENSOR_FRAME_CH_COUNT];
+    uint8_t min_rate = UINT8_MAX;
+    bool has_latency = false;
+    k_spinlock_key_t key;
+
+    demand->throughput_bps = 0;
+    demand->max_latency_ms = 0;
+
+    if (is_subscribed(notify_attrs, NUM_LEGACY_NOTIFY_ATTRS)) {
+        demand->throughput_bps += LEGACY_NOTIFY_BYTES * 10 / ZSW_GATT_SENSOR_NOTIFY_INTERVAL_PERIODS;
+        demand->max_latency_ms = ZSW_GATT_SENSOR_NOTIFY_INTERVAL_PERIODS * 100;
+        has_latency = true;
+    }
 
-    return ctx.enabled;
+    if (!is_subscribed(&notify_attrs[NUM_LEGACY_NOTIFY_ATTRS], 1)) {
+        return has_latency;
+    }
+
+    key = k_spin_lock(&frame_lock);
+    memcpy(rates, frame_channel_rates, sizeof(rates));
+    k_spin_unlock(&frame_lock, key);
+
+    for (int i = 0; i < ZSW_SENSOR_FRAME_CH_COUNT; i++) {
+        if (rates[i] != 0) {
+            demand->throughput_bps += frame_channel_values[i] * sizeof(float) * 10 / rates[i];
+            min_rate = MIN(min_rate, rates[i]);
+        }
+    }
+
+    if (min_rate != UINT8_MAX) {
+        demand->throughput_bps += SENSOR_FRAME_HEADER_LEN * 10 / min_rate;
+        demand->max_latency_ms = has_latency ? MIN(demand->max_latency_ms, min_rate * 100) : min_rate * 100;
+        has_latency = true;
+    }
+
+    return has_latency;
+}
+
+static void update_stream_demand(void)
+{
+    ble_conn_params_demand_t demand;
+
+    if (!calculate_stream_demand(&demand)) {
+        // Subscribed but all frame channels disabled, keep the link ready for the legacy period.
+        demand.max_latency_ms = ZSW_GATT_SENSOR_NOTIFY_INTERVAL_PERIODS * 100;
+    }
+    ble_conn_params_request(BLE_CONN_PARAMS_USER_SENSOR_STREAM, &demand);
+}
+
+static int read_imu(zsw_imu_snapshot_t *p_imu)
+{
+    zsw_sensor_reading_t reading;
+    int ret = zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_IMU, &reading, SENSOR_READ_MAX_AGE_MS);
+
+    if (ret == 0) {
+        *p_imu = reading.data.imu;
+    }
+    return ret;
+}
+
+static int read_mag(float *values)
+{
+    zsw_sensor_reading_t reading;
+    int ret = zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_MAG, &reading, SENSOR_READ_MAX_AGE_MS);
+
+    if (ret == 0) {
+        values[0] = reading.data.mag.x;
+        values[1] = reading.data.mag.y;
+        values[2] = reading.data.mag.z;
+    }
+    return ret;
+}
+
+static int read_pressure(float *pressure, float *temperature)
+{
+    zsw_sensor_reading_t reading;
+    int ret = zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_PRESSURE, &reading, SENSOR_READ_MAX_AGE_MS);
+
+    if (ret == 0) {
+        if (pressure != NULL) {
+            *pressure = reading.data.pressure.pressure;
+        }
+        if (temperature != NULL) {
+            *temperature = reading.data.pressure.temperature;
+        }
+    }
+    return ret;
+}
+
+static int read_light(float *light)
+{
+    zsw_sensor_reading_t reading;
+    int ret = zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_LIGHT, &reading, SENSOR_READ_MAX_AGE_MS);
+
+    if (ret == 0) {
+        *light = reading.data.light;
+    }
+    return ret;
 }
 
 static ssize_t on_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf, uint16_t len, uint16_t offset)
 {
-    int16_t x;
-    int16_t y;
-    int16_t z;
+    zsw_imu_snapshot_t imu;
     int write_len;
     float pressure = 0.0;
+    float temperature = 0.0;
     float *f_ptr;
 
     f_ptr = (float *)buf;
     write_len = 0;
 
-    zsw_pressure_sensor_get_pressure(&pressure);
+    read_pressure(&pressure, &temperature);
 
     if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&temp_service.attrs[2])) {
-        f_ptr[0] = 0.0;
+        f_ptr[0] = temperature;
         write_len = sizeof(float);
     } else if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&accel_service.attrs[2])) {
-        zsw_imu_fetch_accel(&x, &y, &z);
-        f_ptr[0] = x;
-        f_ptr[1] = y;
-        f_ptr[2] = z;
+        if (read_imu(&imu) == 0) {
+            memcpy(f_ptr, imu.accel, sizeof(imu.accel));
+        } else {
+            memset(f_ptr, 0, sizeof(imu.accel));
+        }
         write_len = 3 * sizeof(float);
     } else if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&humidity_service.attrs[2])) {
         f_ptr[0] = 0.0;
@@ -216,15 +402,14 @@ static ssize_t on_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, vo
         f_ptr[0] = pressure;
         write_len = sizeof(float);
     } else if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&mag_service.attrs[2])) {
-        zsw_magnetometer_set_enable(true);
-        zsw_magnetometer_get_all(&f_ptr[0], &f_ptr[1], &f_ptr[2]);
-        zsw_magnetometer_set_enable(false);
+        read_mag(f_ptr);
         write_len = 3 * sizeof(float);
     } else if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&gyro_service.attrs[2])) {
-        zsw_imu_fetch_gyro(&x, &y, &z);
-        f_ptr[0] = x;
-        f_ptr[1] = y;
-        f_ptr[2] = z;
+        if (read_imu(&imu) == 0) {
+            memcpy(f_ptr, imu.gyro, sizeof(imu.gyro));
+        } else {
+            memset(f_ptr, 0, sizeof(imu.gyro));
+        }
         write_len = 3 * sizeof(float);
     } else if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&sensor_fusion_service.attrs[2])) {
         zsw_quat_t quat;
@@ -236,13 +421,52 @@ static ssize_t on_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, vo
             write_len = 4 * sizeof(float);
         }
     } else if (bt_gatt_attr_get_handle(attr) == bt_gatt_attr_get_handle(&light_service.attrs[2])) {
-        zsw_light_sensor_get_light(&f_ptr[0]);
+        read_light(&f_ptr[0]);
         write_len = sizeof(float);
     }
 
     return write_len;
 }
 
+static ssize_t on_rates_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf, uint16_t len,
+                             uint16_t offset)
+{
+    uint8_t rates[ZSW_SENSOR_FRAME_CH_COUNT];
+    k_spinlock_key_t key = k_spin_lock(&frame_lock);
+
+    memcpy(rates, frame_channel_rates, sizeof(rates));
+    k_spin_unlock(&frame_lock, key);
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, rates, sizeof(rates));
+}
+
+static ssize_t on_rates_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+                              uint16_t offset, uint8_t flags)
+{
+    ARG_UNUSED(conn);
+    ARG_UNUSED(attr);
+    ARG_UNUSED(flags);
+
+    // A shorter write only updates the first channels.
+    if (offset + len > sizeof(frame_channel_rates)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&frame_lock);
+
+    memcpy(&frame_channel_rates[offset], buf, len);
+    frame_pending_mask = 0;
+    k_spin_unlock(&frame_lock, key);
+
+    LOG_DBG("Sensor frame rates updated");
+
+    if (notif_enabled) {
+        update_stream_demand();
+    }
+
+    return len;
+}
+
 static ssize_t on_ccc_cfg_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, uint16_t value)
 {
     ARG_UNUSED(conn);
@@ -269,17 +493,29 @@ static void on_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
     bool notifications_active = any_notification_enabled(value);
 
     if (!notif_enabled && notifications_active) {
+        k_spinlock_key_t key = k_spin_lock(&frame_lock);
+
+        frame_tick = 0;
+        frame_pending_mask = 0;
+        frame_first_channel = 0;
+        k_spin_unlock(&frame_lock, key);
+
         notif_enabled = true;
-        zsw_imu_feature_enable(ZSW_IMU_FEATURE_GYRO, false);
+        zsw_sensor_scheduler_request(&imu_request);
+        zsw_sensor_scheduler_request(&mag_request);
         if (zsw_sensor_fusion_init() != 0) {
             LOG_ERR("Failed to start sensor fusion for BLE notifications");
         }
-        ble_comm_set_short_connection_interval();
+        update_stream_demand();
         zsw_periodic_chan_add_obs(&periodic_event_100ms_chan, &azsw_gatt_sensor_server_lis);
+    } else if (notif_enabled && notifications_active) {
+        // Legacy characteristics and the sensor frame need different bandwidth.
+        update_stream_demand();
     } else if (notif_enabled && !notifications_active) {
-        ble_comm_set_default_connection_interval();
+        ble_conn_params_release(BLE_CONN_PARAMS_USER_SENSOR_STREAM);
         zsw_periodic_chan_rm_obs(&periodic_event_100ms_chan, &azsw_gatt_sensor_server_lis);
-        zsw_imu_feature_disable(ZSW_IMU_FEATURE_GYRO);
+        zsw_sensor_scheduler_release(&imu_request);
+        zsw_sensor_scheduler_release(&mag_request);
         zsw_sensor_fusion_deinit();
         notif_enabled = false;
     }
@@ -311,24 +547,168 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
         return;
     }
 
-    ble_comm_set_default_connection_interval();
+    ble_conn_params_release(BLE_CONN_PARAMS_USER_SENSOR_STREAM);
     zsw_periodic_chan_rm_obs(&periodic_event_100ms_chan, &azsw_gatt_sensor_server_lis);
-    zsw_imu_feature_disable(ZSW_IMU_FEATURE_GYRO);
+    zsw_sensor_scheduler_release(&imu_request);
+    zsw_sensor_scheduler_release(&mag_request);
     zsw_sensor_fusion_deinit();
     notif_enabled = false;
 }
 
+static int read_frame_channel(zsw_sensor_frame_channel_t channel, const zsw_imu_snapshot_t *imu, float *values)
+{
+    int ret = 0;
+    zsw_quat_t quat;
+
+    switch (channel) {
+        case ZSW_SENSOR_FRAME_CH_ACCEL:
+            if (imu == NULL) {
+                ret = -ENODATA;
+                break;
+            }
+            memcpy(values, imu->accel, sizeof(imu->accel));
+            break;
+        case ZSW_SENSOR_FRAME_CH_GYRO:
+            if (imu == NULL) {
+                ret = -ENODATA;
+                break;
+            }
+            memcpy(values, imu->gyro, sizeof(imu->gyro));
+            break;
+        case ZSW_SENSOR_FRAME_CH_MAG:
+            ret = read_mag(values);
+            break;
+        case ZSW_SENSOR_FRAME_CH_QUAT:
+            ret = zsw_sensor_fusion_get_quaternion(&quat);
+            values[0] = quat.w;
+            values[1] = quat.x;
+            values[2] = quat.y;
+            values[3] = quat.z;
+            break;
+        case ZSW_SENSOR_FRAME_CH_PRESSURE:
+            ret = read_pressure(&values[0], NULL);
+            break;
+        case ZSW_SENSOR_FRAME_CH_LIGHT:
+            ret = read_light(&values[0]);
+            break;
+        case ZSW_SENSOR_FRAME_CH_TEMPERATURE:
+            ret = read_pressure(NULL, &values[0]);
+            break;
+        default:
+            ret = -ENODEV;
+            break;
+    }
+
+    return ret;
+}
+
+static void send_sensor_frame(void)
+{
+    uint8_t buf[CONFIG_BT_L2CAP_TX_MTU];
+    float values[4];
+    uint16_t max_len = MIN(ble_comm_get_mtu() - 3, sizeof(buf));
+    uint16_t due_mask;
+    uint16_t fit_mask = 0;
+    uint16_t sent_mask = 0;
+    uint8_t first_channel;
+    uint8_t next_first_channel;
+    bool left_out = false;
+    size_t len = SENSOR_FRAME_HEADER_LEN;
+    size_t channel_len;
+    zsw_imu_snapshot_t imu;
+    const zsw_imu_snapshot_t *p_imu = NULL;
+    k_spinlock_key_t key;
+
+    key = k_spin_lock(&frame_lock);
+    due_mask = frame_pending_mask;
+    for (int i = 0; i < ZSW_SENSOR_FRAME_CH_COUNT; i++) {
+        if (frame_channel_rates[i] != 0 && (frame_tick % frame_channel_rates[i]) == 0) {
+            due_mask |= BIT(i);
+        }
+    }
+    frame_tick++;
+    first_channel = frame_first_channel;
+    k_spin_unlock(&frame_lock, key);
+
+    if (due_mask == 0) {
+        return;
+    }
+
+    // Pick channels starting after the last one that was left out, so every channel gets its turn.
+    next_first_channel = first_channel;
+    for (int n = 0; n < ZSW_SENSOR_FRAME_CH_COUNT; n++) {
+        int i = (first_channel + n) % ZSW_SENSOR_FRAME_CH_COUNT;
+
+        if ((due_mask & BIT(i)) == 0) {
+            continue;
+        }
+        channel_len = frame_channel_values[i] * sizeof(float);
+        if (len + channel_len > max_len) {
+            // A channel that doesn't even fit on its own can't be helped by going first.
+            if (!left_out && SENSOR_FRAME_HEADER_LEN + channel_len <= max_len) {
+                next_first_channel = i;
+                left_out = true;
+            }
+            continue;
+        }
+        len += channel_len;
+        fit_mask |= BIT(i);
+    }
+
+    // Accelerometer and gyroscope share one IMU read when both are due.
+    if ((fit_mask & (BIT(ZSW_SENSOR_FRAME_CH_ACCEL) | BIT(ZSW_SENSOR_FRAME_CH_GYRO))) != 0 &&
+        read_imu(&imu) == 0) {
+        p_imu = &imu;
+    }
+
+    // Values are packed in channel order, as the channel mask describes them.
+    len = SENSOR_FRAME_HEADER_LEN;
+    for (int i = 0; i < ZSW_SENSOR_FRAME_CH_COUNT; i++) {
+        if ((fit_mask & BIT(i)) == 0) {
+            continue;
+        }
+        if (read_frame_channel(i, p_imu, values) != 0) {
+            due_mask &= ~BIT(i);
+            continue;
+        }
+        channel_len = frame_channel_values[i] * sizeof(float);
+        memcpy(&buf[len], values, channel_len);
+        len += channel_len;
+        sent_mask |= BIT(i);
+    }
+
+    key = k_spin_lock(&frame_lock);
+    frame_pending_mask = due_mask & ~sent_mask;
+    frame_first_channel = next_first_channel;
+    k_spin_unlock(&frame_lock, key);
+
+    if (sent_mask == 0) {
+        return;
+    }
+
+    sys_put_le32(k_uptime_get_32(), &buf[0]);
+    sys_put_le16(sent_mask, &buf[sizeof(uint32_t)]);
+    bt_gatt_notify(NULL, &sensor_frame_service.attrs[2], buf, len);
+}
+
 static void zbus_periodic_fast_callback(const struct zbus_channel *chan)
 {
-    int16_t x;
-    int16_t y;
-    int16_t z;
+    zsw_imu_snapshot_t imu;
     int write_len;
     float *f_ptr;
     float pressure = 0.0;
+    float temperature = 0.0;
     zsw_quat_t quat;
     uint8_t buf[CONFIG_BT_L2CAP_TX_MTU];
 
+    if (is_subscribed(&notify_attrs[NUM_LEGACY_NOTIFY_ATTRS], 1)) {
+        send_sensor_frame();
+    }
+
+    if (!is_subscribed(notify_attrs, NUM_LEGACY_NOTIFY_ATTRS)) {
+        return;
+    }
+
     notify_period_counter++;
     if (notify_period_counter < ZSW_GATT_SENSOR_NOTIFY_INTERVAL_PERIODS) {
         return;
@@ -337,7 +717,9 @@ static void zbus_periodic_fast_callback(const struct zbus_channel *chan)
 
     f_ptr = (float *)buf;
 
-    f_ptr[0] = 0.0;
+    read_pressure(&pressure, &temperature);
+
+    f_ptr[0] = temperature;
     write_len = sizeof(float);
     bt_gatt_notify(NULL, &temp_service.attrs[2], &buf, write_len);
 
@@ -345,35 +727,27 @@ static void zbus_periodic_fast_callback(const struct zbus_channel *chan)
     write_len = sizeof(float);
     bt_gatt_notify(NULL, &humidity_service.attrs[2], &buf, write_len);
 
-    zsw_pressure_sensor_get_pressure(&pressure);
     f_ptr[0] = pressure;
     write_len = sizeof(float);
     bt_gatt_notify(NULL, &pressure_service.attrs[2], &buf, write_len);
 
-    if (zsw_imu_fetch_accel(&x, &y, &z) == 0) {
-        f_ptr[0] = x;
-        f_ptr[1] = y;
-        f_ptr[2] = z;
-        write_len = 3 * sizeof(float);
+    // Accelerometer and gyroscope from the same sample, one IMU read for both.
+    if (read_imu(&imu) == 0) {
+        memcpy(f_ptr, imu.accel, sizeof(imu.accel));
+        write_len = sizeof(imu.accel);
         bt_gatt_notify(NULL, &accel_service.attrs[2], &buf, write_len);
-    }
 
-    if (zsw_imu_fetch_gyro(&x, &y, &z) == 0) {
-        f_ptr[0] = x;
-        f_ptr[1] = y;
-        f_ptr[2] = z;
-        write_len = 3 * sizeof(float);
+        memcpy(f_ptr, imu.gyro, sizeof(imu.gyro));
+        write_len = sizeof(imu.gyro);
         bt_gatt_notify(NULL, &gyro_service.attrs[2], &buf, write_len);
     }
 
-    if (zsw_magnetometer_set_enable(true) == 0) {
-        zsw_magnetometer_get_all(&f_ptr[0], &f_ptr[1], &f_ptr[2]);
-        zsw_magnetometer_set_enable(false);
+    if (read_mag(f_ptr) == 0) {
         write_len = 3 * sizeof(float);
         bt_gatt_notify(NULL, &mag_service.attrs[2], &buf, write_len);
     }
 
-    if (zsw_light_sensor_get_light(&f_ptr[0]) == 0) {
+    if (read_light(&f_ptr[0]) == 0) {
         write_len = sizeof(float);
         bt_gatt_notify(NULL, &light_service.attrs[2], &buf, write_len);
     }
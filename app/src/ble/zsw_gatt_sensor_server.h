@@ -52,5 +52,31 @@
 
 #define ADAFRUIT_MEASUREMENT_PERIOD_ID  BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0xADAF0001, 0xC332, 0x42A8, 0x93BD, 0x25E905756CB8))
 
+#define ZSW_SERVICE_SENSOR_FRAME        BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x5a535301, 0x6672, 0x616d, 0x8000, 0x00805f9b34fb))
+#define ZSW_CHAR_SENSOR_FRAME           BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x5a535302, 0x6672, 0x616d, 0x8000, 0x00805f9b34fb))
+#define ZSW_CHAR_SENSOR_FRAME_RATES     BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x5a535303, 0x6672, 0x616d, 0x8000, 0x00805f9b34fb))
+
+/*
+ * Sensor frame: all channels sampled in the same period packed in one notification.
+ * Layout (little endian): u32 timestamp_ms, u16 channel_mask, then for each set bit in
+ * channel order the channel's float values. Channels that don't fit the MTU are sent in
+ * the next period instead, and the first of them gets picked first then so that channels
+ * take turns when the MTU is small.
+ *
+ * Rates characteristic: one u8 per channel, the number of 100 ms periods between samples.
+ * 0 disables the channel.
+ */
+typedef enum zsw_sensor_frame_channel {
+    ZSW_SENSOR_FRAME_CH_ACCEL,          /**< 3 floats, raw */
+    ZSW_SENSOR_FRAME_CH_GYRO,           /**< 3 floats, raw */
+    ZSW_SENSOR_FRAME_CH_MAG,            /**< 3 floats, uT */
+    ZSW_SENSOR_FRAME_CH_QUAT,           /**< 4 floats, w x y z */
+    ZSW_SENSOR_FRAME_CH_PRESSURE,       /**< 1 float, Pa */
+    ZSW_SENSOR_FRAME_CH_LIGHT,          /**< 1 float, lux */
+    ZSW_SENSOR_FRAME_CH_TEMPERATURE,    /**< 1 float, C */
+    ZSW_SENSOR_FRAME_CH_HUMIDITY,       /**< 1 float, % */
+    ZSW_SENSOR_FRAME_CH_COUNT
+} zsw_sensor_frame_channel_t;
+
 #define BLE_UUID_TRANSPORT_VAL \
     BT_UUID_128_ENCODE(0x6e400001, 0xb5a3, 0xf393, 0xe0a9, 0xe50e24dcca9e)
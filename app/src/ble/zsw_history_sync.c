@@ -0,0 +1,464 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include "ble/ble_conn_params.h"
+#include "ble/zsw_history_sync.h"
+
+LOG_MODULE_REGISTER(zsw_history_sync, CONFIG_ZSW_BLE_LOG_LEVEL);
+
+#define SETTINGS_HISTORY_SYNC           "hist_sync"
+#define DATA_FRAME_HEADER_LEN           7
+#define END_FRAME_LEN                   6
+#define INFO_FRAME_HEADER_LEN           11
+#define MAX_FRAMES_PER_RUN              8
+#define NO_BUFFER_RETRY_MS              5
+#define PERSIST_ACK_DELAY_S             2
+
+static const ble_conn_params_demand_t sync_demand = {
+    .throughput_bps = 8000,
+    .max_latency_ms = 50,
+};
+
+#if CONFIG_BLE_DISABLE_PAIRING_REQUIRED
+#define ZSW_GATT_READ_WRITE_PERM    BT_GATT_PERM_READ | BT_GATT_PERM_WRITE
+#else
+#define ZSW_GATT_READ_WRITE_PERM    BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT
+#endif
+
+typedef struct {
+    zsw_history_t *p_history;
+    uint32_t acked_seq;
+} sync_entry_t;
+
+typedef struct {
+    struct bt_conn *conn;
+    uint8_t id;
+    uint32_t next_seq;
+    int64_t start_time;
+    uint32_t samples;
+    uint32_t notifications;
+} sync_transfer_t;
+
+static ssize_t on_ctrl_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+                             uint16_t offset, uint8_t flags);
+static void disconnected(struct bt_conn *conn, uint8_t reason);
+static void sync_work_handler(struct k_work *work);
+static void persist_work_handler(struct k_work *work);
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .disconnected = disconnected,
+};
+
+BT_GATT_SERVICE_DEFINE(history_sync_service,
+                       BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(ZSW_HISTORY_SYNC_SERVICE_UUID)),
+                       BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZSW_HISTORY_SYNC_CTRL_UUID),
+                                              BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+                                              ZSW_GATT_READ_WRITE_PERM,
+                                              NULL, on_ctrl_write, NULL),
+                       BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZSW_HISTORY_SYNC_DATA_UUID),
+                                              BT_GATT_CHRC_NOTIFY,
+                                              ZSW_GATT_READ_WRITE_PERM,
+                                              NULL, NULL, NULL),
+                       BT_GATT_CCC(NULL, ZSW_GATT_READ_WRITE_PERM)
+                      );
+
+K_WORK_DELAYABLE_DEFINE(sync_work, sync_work_handler);
+K_WORK_DELAYABLE_DEFINE(persist_work, persist_work_handler);
+K_MUTEX_DEFINE(sync_mutex);
+
+static sync_entry_t entries[CONFIG_ZSW_HISTORY_SYNC_MAX_HISTORIES];
+static sync_transfer_t transfer;
+static struct bt_conn *list_conn;
+// INFO frames already queued for list_conn, a retry after -ENOMEM continues from here.
+static uint8_t list_next;
+static zsw_history_sync_stats_t last_stats;
+static bool has_stats;
+
+static const struct bt_gatt_attr *data_attr = &history_sync_service.attrs[4];
+
+static int ack_load_cb(const char *p_key, size_t len, settings_read_cb read_cb, void *p_cb_arg, void *p_param)
+{
+    uint32_t *p_acked = p_param;
+
+    if (len != sizeof(uint32_t)) {
+        return -EINVAL;
+    }
+
+    if (read_cb(p_cb_arg, p_acked, len) != sizeof(uint32_t)) {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+static uint32_t oldest_seq(zsw_history_t *p_history)
+{
+    return zsw_history_total_samples(p_history) - zsw_history_samples(p_history);
+}
+
+static void finish_transfer(bool completed)
+{
+    struct bt_conn_info info;
+    uint32_t interval_us = 0;
+
+    if (transfer.conn == NULL) {
+        return;
+    }
+
+    if (completed) {
+        if (bt_conn_get_info(transfer.conn, &info) == 0) {
+            interval_us = info.le.interval * 1250;
+        }
+
+        last_stats.id = transfer.id;
+        last_stats.samples = transfer.samples;
+        last_stats.notifications = transfer.notifications;
+        last_stats.duration_ms = k_uptime_get() - transfer.start_time;
+        last_stats.conn_events = interval_us ? DIV_ROUND_UP(last_stats.duration_ms * 1000ULL, interval_us) : 0;
+        has_stats = true;
+
+        LOG_INF("History %d synced: %u samples in %u ms, %u notifications, ~%u connection events",
+                last_stats.id, last_stats.samples, last_stats.duration_ms, last_stats.notifications,
+                last_stats.conn_events);
+        if (last_stats.samples > 0) {
+            LOG_INF("Per 1000 samples: %u notifications, ~%u connection events, %u ms",
+                    (uint32_t)(last_stats.notifications * 1000ULL / last_stats.samples),
+                    (uint32_t)(last_stats.conn_events * 1000ULL / last_stats.samples),
+                    (uint32_t)(last_stats.duration_ms * 1000ULL / last_stats.samples));
+        }
+    } else {
+        LOG_WRN("History %d sync aborted at seq %u", transfer.id, transfer.next_seq);
+    }
+
+    bt_conn_unref(transfer.conn);
+    transfer.conn = NULL;
+    ble_conn_params_release(BLE_CONN_PARAMS_USER_HISTORY_SYNC);
+}
+
+static int send_info_frames(struct bt_conn *conn)
+{
+    uint8_t frame[INFO_FRAME_HEADER_LEN + ZSW_HISTORY_MAX_KEY_LENGTH];
+    int ret;
+
+    for (; list_next < ARRAY_SIZE(entries); list_next++) {
+        const int i = list_next;
+        zsw_history_t *p_history = entries[i].p_history;
+        size_t key_len;
+
+        if (p_history == NULL) {
+            continue;
+        }
+
+        key_len = strnlen(p_history->key, ZSW_HISTORY_MAX_KEY_LENGTH);
+        frame[0] = ZSW_HISTORY_SYNC_FRAME_INFO;
+        frame[1] = i;
+        frame[2] = p_history->sample_size;
+        sys_put_le32(zsw_history_total_samples(p_history), &frame[3]);
+        sys_put_le32(entries[i].acked_seq, &frame[7]);
+        memcpy(&frame[INFO_FRAME_HEADER_LEN], p_history->key, key_len);
+
+        ret = bt_gatt_notify(conn, data_attr, frame, INFO_FRAME_HEADER_LEN + key_len);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int send_next_frames(void)
+{
+    uint8_t frame[CONFIG_BT_L2CAP_TX_MTU];
+    zsw_history_t *p_history = entries[transfer.id].p_history;
+    uint16_t max_len = MIN(bt_gatt_get_mtu(transfer.conn) - 3, sizeof(frame));
+    uint8_t per_frame = MIN((max_len - DATA_FRAME_HEADER_LEN) / p_history->sample_size, UINT8_MAX);
+    uint32_t total;
+    uint32_t oldest;
+    uint8_t count;
+    int ret;
+
+    if (per_frame == 0) {
+        LOG_ERR("Sample size %d does not fit MTU %d", p_history->sample_size, max_len);
+        return -EMSGSIZE;
+    }
+
+    for (int i = 0; i < MAX_FRAMES_PER_RUN; i++) {
+        total = zsw_history_total_samples(p_history);
+        oldest = oldest_seq(p_history);
+
+        // Samples may have been overwritten by new ones while the phone was away.
+        if (transfer.next_seq < oldest) {
+            transfer.next_seq = oldest;
+        }
+
+        if (transfer.next_seq >= total) {
+            frame[0] = ZSW_HISTORY_SYNC_FRAME_END;
+            frame[1] = transfer.id;
+            sys_put_le32(total, &frame[2]);
+            ret = bt_gatt_notify(transfer.conn, data_attr, frame, END_FRAME_LEN);
+            if (ret == 0) {
+                transfer.notifications++;
+                finish_transfer(true);
+            }
+            return ret;
+        }
+
+        count = MIN(per_frame, total - transfer.next_seq);
+        frame[0] = ZSW_HISTORY_SYNC_FRAME_DATA;
+        frame[1] = transfer.id;
+        sys_put_le32(transfer.next_seq, &frame[2]);
+        frame[6] = count;
+        for (int j = 0; j < count; j++) {
+            zsw_history_get(p_history, &frame[DATA_FRAME_HEADER_LEN + j * p_history->sample_size],
+                            transfer.next_seq - oldest + j);
+        }
+
+        ret = bt_gatt_notify(transfer.conn, data_attr, frame, DATA_FRAME_HEADER_LEN + count * p_history->sample_size);
+        if (ret) {
+            return ret;
+        }
+
+        transfer.next_seq += count;
+        transfer.samples += count;
+        transfer.notifications++;
+    }
+
+    return -EAGAIN;
+}
+
+static void sync_work_handler(struct k_work *work)
+{
+    int ret;
+
+    k_mutex_lock(&sync_mutex, K_FOREVER);
+
+    if (list_conn) {
+        ret = send_info_frames(list_conn);
+        if (ret == -ENOMEM) {
+            k_work_reschedule(&sync_work, K_MSEC(NO_BUFFER_RETRY_MS));
+            k_mutex_unlock(&sync_mutex);
+            return;
+        }
+        bt_conn_unref(list_conn);
+        list_conn = NULL;
+    }
+
+    if (transfer.conn) {
+        ret = send_next_frames();
+        if (ret == -EAGAIN) {
+            // Yield the system workqueue between bursts.
+            k_work_reschedule(&sync_work, K_NO_WAIT);
+        } else if (ret == -ENOMEM) {
+            k_work_reschedule(&sync_work, K_MSEC(NO_BUFFER_RETRY_MS));
+        } else if (ret) {
+            LOG_ERR("Failed to send history frame: %d", ret);
+            finish_transfer(false);
+        }
+    }
+
+    k_mutex_unlock(&sync_mutex);
+}
+
+static void persist_work_handler(struct k_work *work)
+{
+    char key[sizeof(SETTINGS_HISTORY_SYNC) + 4];
+    uint32_t acked;
+
+    for (int i = 0; i < ARRAY_SIZE(entries); i++) {
+        if (entries[i].p_history == NULL) {
+            continue;
+        }
+        k_mutex_lock(&sync_mutex, K_FOREVER);
+        acked = entries[i].acked_seq;
+        k_mutex_unlock(&sync_mutex);
+
+        snprintf(key, sizeof(key), SETTINGS_HISTORY_SYNC "/%d", i);
+        if (settings_save_one(key, &acked, sizeof(acked))) {
+            LOG_ERR("Failed to store acked seq for history %d", i);
+        }
+    }
+}
+
+static int start_transfer(struct bt_conn *conn, uint8_t id)
+{
+    sync_entry_t *entry = &entries[id];
+    uint32_t total = zsw_history_total_samples(entry->p_history);
+
+    if (!bt_gatt_is_subscribed(conn, data_attr, BT_GATT_CCC_NOTIFY)) {
+        return -EACCES;
+    }
+
+    if (transfer.conn) {
+        return -EBUSY;
+    }
+
+    // History was cleared on the watch since last sync, start over.
+    if (entry->acked_seq > total) {
+        entry->acked_seq = 0;
+    }
+
+    transfer.conn = bt_conn_ref(conn);
+    transfer.id = id;
+    transfer.next_seq = MAX(entry->acked_seq, oldest_seq(entry->p_history));
+    transfer.start_time = k_uptime_get();
+    transfer.samples = 0;
+    transfer.notifications = 0;
+
+    LOG_INF("Start sync of history %d from seq %u of %u", id, transfer.next_seq, total);
+
+    ble_conn_params_request(BLE_CONN_PARAMS_USER_HISTORY_SYNC, &sync_demand);
+    k_work_reschedule(&sync_work, K_NO_WAIT);
+
+    return 0;
+}
+
+static ssize_t on_ctrl_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+                             uint16_t offset, uint8_t flags)
+{
+    const uint8_t *data = buf;
+    uint8_t id;
+    uint32_t seq;
+    int ret = 0;
+
+    if (offset != 0 || len < 1) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    if (data[0] == ZSW_HISTORY_SYNC_CMD_START || data[0] == ZSW_HISTORY_SYNC_CMD_ACK) {
+        if (len < 2 || data[1] >= ARRAY_SIZE(entries) || entries[data[1]].p_history == NULL) {
+            return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
+        }
+    }
+
+    k_mutex_lock(&sync_mutex, K_FOREVER);
+
+    switch (data[0]) {
+        case ZSW_HISTORY_SYNC_CMD_LIST:
+            if (list_conn == NULL) {
+                list_conn = bt_conn_ref(conn);
+                list_next = 0;
+                k_work_reschedule(&sync_work, K_NO_WAIT);
+            }
+            break;
+        case ZSW_HISTORY_SYNC_CMD_START:
+            ret = start_transfer(conn, data[1]);
+            break;
+        case ZSW_HISTORY_SYNC_CMD_ACK:
+            if (len < 6) {
+                ret = -EINVAL;
+                break;
+            }
+            id = data[1];
+            seq = sys_get_le32(&data[2]);
+            if (seq > zsw_history_total_samples(entries[id].p_history)) {
+                ret = -EINVAL;
+                break;
+            }
+            entries[id].acked_seq = seq;
+            // Phone may ack often during a long transfer, only write flash once it settles.
+            k_work_reschedule(&persist_work, K_SECONDS(PERSIST_ACK_DELAY_S));
+            break;
+        case ZSW_HISTORY_SYNC_CMD_STOP:
+            finish_transfer(false);
+            break;
+        default:
+            ret = -ENOTSUP;
+            break;
+    }
+
+    k_mutex_unlock(&sync_mutex);
+
+    if (ret) {
+        LOG_WRN("History sync command 0x%02x failed: %d", data[0], ret);
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    }
+
+    return len;
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    ARG_UNUSED(reason);
+
+    k_mutex_lock(&sync_mutex, K_FOREVER);
+    if (transfer.conn == conn) {
+        // Next START continues from the last acked sample.
+        finish_transfer(false);
+    }
+    if (list_conn == conn) {
+        bt_conn_unref(list_conn);
+        list_conn = NULL;
+    }
+    k_mutex_unlock(&sync_mutex);
+}
+
+int zsw_history_sync_register(zsw_history_t *p_history, zsw_history_sync_id_t id)
+{
+    char key[sizeof(SETTINGS_HISTORY_SYNC) + 4];
+
+    if (p_history == NULL || id >= ARRAY_SIZE(entries)) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&sync_mutex, K_FOREVER);
+    entries[id].p_history = p_history;
+    entries[id].acked_seq = 0;
+    snprintf(key, sizeof(key), SETTINGS_HISTORY_SYNC "/%d", id);
+    if (settings_load_subtree_direct(key, ack_load_cb, &entries[id].acked_seq)) {
+        LOG_WRN("No stored sync state for history %d", id);
+    }
+    k_mutex_unlock(&sync_mutex);
+
+    LOG_DBG("Registered history %s as %d, acked %u", p_history->key, id, entries[id].acked_seq);
+
+    return 0;
+}
+
+bool zsw_history_sync_is_active(void)
+{
+    bool active;
+
+    k_mutex_lock(&sync_mutex, K_FOREVER);
+    active = transfer.conn != NULL;
+    k_mutex_unlock(&sync_mutex);
+
+    return active;
+}
+
+int zsw_history_sync_get_stats(zsw_history_sync_stats_t *p_stats)
+{
+    int ret = -ENODATA;
+
+    k_mutex_lock(&sync_mutex, K_FOREVER);
+    if (has_stats) {
+        *p_stats = last_stats;
+        ret = 0;
+    }
+    k_mutex_unlock(&sync_mutex);
+
+    return ret;
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "history/zsw_history.h"
+
+#define ZSW_HISTORY_SYNC_SERVICE_UUID \
+    BT_UUID_128_ENCODE(0x5a535701, 0x6869, 0x7374, 0x8000, 0x00805f9b34fb)
+#define ZSW_HISTORY_SYNC_CTRL_UUID \
+    BT_UUID_128_ENCODE(0x5a535702, 0x6869, 0x7374, 0x8000, 0x00805f9b34fb)
+#define ZSW_HISTORY_SYNC_DATA_UUID \
+    BT_UUID_128_ENCODE(0x5a535703, 0x6869, 0x7374, 0x8000, 0x00805f9b34fb)
+
+/* Commands written by the phone to the control characteristic. */
+#define ZSW_HISTORY_SYNC_CMD_LIST       0x01    /**< No payload. Answered with one INFO frame per history. */
+#define ZSW_HISTORY_SYNC_CMD_START      0x02    /**< u8 id. Stream all samples after the last acked one. */
+#define ZSW_HISTORY_SYNC_CMD_ACK        0x03    /**< u8 id, u32 seq. All samples before seq are received. */
+#define ZSW_HISTORY_SYNC_CMD_STOP       0x04    /**< No payload. Abort the ongoing transfer. */
+
+/* Frames notified by the watch on the data characteristic, all integers little endian. */
+#define ZSW_HISTORY_SYNC_FRAME_DATA     0x10    /**< u8 id, u32 first_seq, u8 count, count * sample_size bytes. */
+#define ZSW_HISTORY_SYNC_FRAME_END      0x11    /**< u8 id, u32 next_seq. Transfer done, phone should ACK. */
+#define ZSW_HISTORY_SYNC_FRAME_INFO     0x12    /**< u8 id, u8 sample_size, u32 total, u32 acked, key string. */
+
+typedef enum zsw_history_sync_id {
+    ZSW_HISTORY_SYNC_ID_STEPS,
+    ZSW_HISTORY_SYNC_ID_BATTERY,
+} zsw_history_sync_id_t;
+
+typedef struct zsw_history_sync_stats {
+    uint8_t id;                     /**< History of the last finished transfer. */
+    uint32_t samples;               /**< Samples sent in the last transfer. */
+    uint32_t notifications;         /**< Notifications needed for the last transfer. */
+    uint32_t conn_events;           /**< Estimated connection events used by the last transfer. */
+    uint32_t duration_ms;           /**< Time from START to END frame. */
+} zsw_history_sync_stats_t;
+
+#ifdef CONFIG_ZSW_HISTORY_SYNC
+/** @brief              Make a history available for bulk sync over BLE.
+ *  @param p_history    Initialized history object, must outlive the sync service
+ *  @param id           Stable id the phone uses to address the history
+ *  @return             0 when successful
+*/
+int zsw_history_sync_register(zsw_history_t *p_history, zsw_history_sync_id_t id);
+
+/** @brief              Check if a transfer is ongoing.
+ *  @return             true if a history is currently being streamed
+*/
+bool zsw_history_sync_is_active(void);
+
+/** @brief              Get statistics of the last finished transfer.
+ *  @param p_stats      Where to store the statistics
+ *  @return             0 when successful, -ENODATA if no transfer finished yet
+*/
+int zsw_history_sync_get_stats(zsw_history_sync_stats_t *p_stats);
+#else
+static inline int zsw_history_sync_register(zsw_history_t *p_history, zsw_history_sync_id_t id)
+{
+    (void)p_history;
+    (void)id;
+    return 0;
+}
+#endif
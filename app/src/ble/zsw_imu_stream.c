@@ -0,0 +1,315 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include "ble/ble_comm.h"
+#include "ble/ble_conn_params.h"
+#include "ble/zsw_imu_stream.h"
+#include "sensors/zsw_imu.h"
+
+LOG_MODULE_REGISTER(zsw_imu_stream, CONFIG_ZSW_BLE_LOG_LEVEL);
+
+#define DEFAULT_RATE_HZ         100
+// Watermark interrupts per second, trades latency against I2C transactions and wakeups.
+#define BATCHES_PER_SECOND      16
+#define CONFIG_READ_LEN         5
+#define MAX_PACKET_LEN          (CONFIG_BT_L2CAP_TX_MTU - 3)
+#define NO_BUFFER_RETRY_MS      5
+
+#if CONFIG_BLE_DISABLE_PAIRING_REQUIRED
+#define ZSW_GATT_READ_WRITE_PERM    BT_GATT_PERM_READ | BT_GATT_PERM_WRITE
+#else
+#define ZSW_GATT_READ_WRITE_PERM    BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT
+#endif
+
+static ssize_t on_config_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf, uint16_t len,
+                              uint16_t offset);
+static ssize_t on_config_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+                               uint16_t offset, uint8_t flags);
+static void on_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value);
+static ssize_t on_ccc_cfg_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, uint16_t value);
+static void connected(struct bt_conn *conn, uint8_t err);
+static void disconnected(struct bt_conn *conn, uint8_t reason);
+static void send_work_handler(struct k_work *work);
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+};
+
+BT_GATT_SERVICE_DEFINE(imu_stream_service,
+                       BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(ZSW_IMU_STREAM_SERVICE_UUID)),
+                       BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZSW_IMU_STREAM_CONFIG_UUID),
+                                              BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                                              ZSW_GATT_READ_WRITE_PERM,
+                                              on_config_read, on_config_write, NULL),
+                       BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZSW_IMU_STREAM_DATA_UUID),
+                                              BT_GATT_CHRC_NOTIFY,
+                                              ZSW_GATT_READ_WRITE_PERM,
+                                              NULL, NULL, NULL),
+                       BT_GATT_CCC_WITH_WRITE_CB(on_ccc_cfg_changed, on_ccc_cfg_write, ZSW_GATT_READ_WRITE_PERM)
+                      );
+
+K_MSGQ_DEFINE(sample_queue, sizeof(zsw_imu_fifo_sample_t), CONFIG_ZSW_IMU_STREAM_QUEUE_SIZE, 4);
+K_WORK_DELAYABLE_DEFINE(send_work, send_work_handler);
+K_MUTEX_DEFINE(stream_mutex);
+
+static const struct bt_gatt_attr *data_attr = &imu_stream_service.attrs[4];
+
+static uint16_t rate_hz = DEFAULT_RATE_HZ;
+static bool streaming;
+// A CCC restored from bonding data must not start streaming, only a write from the phone in this connection does.
+static bool ignore_restored_ccc;
+static uint16_t packet_seq;
+static zsw_imu_stream_stats_t stats;
+static atomic_t dropped;
+
+// A packet is built once and kept until the stack accepts it, so no samples are lost on -ENOMEM.
+static uint8_t packet[MAX_PACKET_LEN];
+static uint16_t packet_len;
+
+static void on_fifo_batch(const zsw_imu_fifo_sample_t *samples, uint16_t num_samples)
+{
+    for (uint16_t i = 0; i < num_samples; i++) {
+        if (k_msgq_put(&sample_queue, &samples[i], K_NO_WAIT) != 0) {
+            atomic_add(&dropped, num_samples - i);
+            break;
+        }
+    }
+
+    k_work_schedule(&send_work, K_NO_WAIT);
+}
+
+static uint16_t build_packet(void)
+{
+    zsw_imu_fifo_sample_t sample;
+    uint16_t max_samples;
+    uint8_t count = 0;
+    uint8_t *p;
+
+    max_samples = MIN((MIN(ble_comm_get_mtu(), MAX_PACKET_LEN + 3) - 3 - ZSW_IMU_STREAM_HEADER_LEN) /
+                      ZSW_IMU_STREAM_SAMPLE_LEN, UINT8_MAX);
+    p = &packet[ZSW_IMU_STREAM_HEADER_LEN];
+
+    while ((count < max_samples) && (k_msgq_get(&sample_queue, &sample, K_NO_WAIT) == 0)) {
+        if (count == 0) {
+            sys_put_le32(sample.timestamp_us, &packet[2]);
+        }
+        for (int i = 0; i < 3; i++) {
+            sys_put_le16(sample.accel[i], p);
+            p += sizeof(int16_t);
+        }
+        for (int i = 0; i < 3; i++) {
+            sys_put_le16(sample.gyro[i], p);
+            p += sizeof(int16_t);
+        }
+        count++;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    sys_put_le16(packet_seq, &packet[0]);
+    packet[6] = count;
+
+    return ZSW_IMU_STREAM_HEADER_LEN + count * ZSW_IMU_STREAM_SAMPLE_LEN;
+}
+
+static void send_work_handler(struct k_work *work)
+{
+    int ret;
+
+    k_mutex_lock(&stream_mutex, K_FOREVER);
+
+    while (streaming) {
+        if (packet_len == 0) {
+            packet_len = build_packet();
+            if (packet_len == 0) {
+                break;
+            }
+        }
+
+        ret = bt_gatt_notify(NULL, data_attr, packet, packet_len);
+        if (ret == -ENOMEM) {
+            // TX buffers full, retry soon. The FIFO batch callback keeps filling the queue meanwhile.
+            k_work_schedule(&send_work, K_MSEC(NO_BUFFER_RETRY_MS));
+            break;
+        } else if (ret) {
+            LOG_WRN("IMU stream notify failed: %d", ret);
+        } else {
+            stats.packets++;
+            stats.samples += packet[6];
+        }
+
+        packet_seq++;
+        packet_len = 0;
+    }
+
+    k_mutex_unlock(&stream_mutex);
+}
+
+static void stream_stop(void)
+{
+    k_mutex_lock(&stream_mutex, K_FOREVER);
+    if (!streaming) {
+        k_mutex_unlock(&stream_mutex);
+        return;
+    }
+    streaming = false;
+    k_mutex_unlock(&stream_mutex);
+
+    zsw_imu_fifo_stop();
+    ble_conn_params_release(BLE_CONN_PARAMS_USER_IMU_STREAM);
+    k_work_cancel_delayable(&send_work);
+    k_msgq_purge(&sample_queue);
+
+    stats.dropped = atomic_get(&dropped);
+    LOG_INF("IMU stream stopped: %u samples in %u packets, %u dropped", stats.samples, stats.packets, stats.dropped);
+}
+
+static int stream_start(void)
+{
+    ble_conn_params_demand_t demand = {
+        // Payload plus headers, with margin so the link keeps up after a short stall.
+        .throughput_bps = rate_hz * ZSW_IMU_STREAM_SAMPLE_LEN * 5 / 4,
+        .max_latency_ms = 1000 / BATCHES_PER_SECOND,
+    };
+    int ret;
+
+    k_mutex_lock(&stream_mutex, K_FOREVER);
+    packet_seq = 0;
+    packet_len = 0;
+    memset(&stats, 0, sizeof(stats));
+    atomic_set(&dropped, 0);
+    k_msgq_purge(&sample_queue);
+    streaming = true;
+    k_mutex_unlock(&stream_mutex);
+
+    ble_conn_params_request(BLE_CONN_PARAMS_USER_IMU_STREAM, &demand);
+
+    ret = zsw_imu_fifo_start(rate_hz, rate_hz / BATCHES_PER_SECOND, on_fifo_batch);
+    if (ret) {
+        LOG_ERR("Failed to start IMU FIFO: %d", ret);
+        stream_stop();
+        return ret;
+    }
+
+    LOG_INF("IMU stream started at %u Hz", rate_hz);
+
+    return 0;
+}
+
+static ssize_t on_config_read(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf, uint16_t len,
+                              uint16_t offset)
+{
+    uint8_t config[CONFIG_READ_LEN];
+    uint8_t accel_range_g = 0;
+    uint16_t gyro_range_dps = 0;
+
+    zsw_imu_fifo_get_scale(&accel_range_g, &gyro_range_dps);
+
+    sys_put_le16(rate_hz, &config[0]);
+    config[2] = accel_range_g;
+    sys_put_le16(gyro_range_dps, &config[3]);
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, config, sizeof(config));
+}
+
+static ssize_t on_config_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, const void *buf, uint16_t len,
+                               uint16_t offset, uint8_t flags)
+{
+    uint16_t new_rate_hz;
+
+    if ((offset != 0) || (len != sizeof(uint16_t))) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    new_rate_hz = sys_get_le16(buf);
+    if ((new_rate_hz != 100) && (new_rate_hz != 200) && (new_rate_hz != 400)) {
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    }
+
+    rate_hz = new_rate_hz;
+
+    if (streaming) {
+        stream_stop();
+        stream_start();
+    }
+
+    return len;
+}
+
+static ssize_t on_ccc_cfg_write(struct bt_conn *conn, const struct bt_gatt_attr *attr, uint16_t value)
+{
+    ARG_UNUSED(conn);
+    ARG_UNUSED(attr);
+    ARG_UNUSED(value);
+
+    // Only called when the peer actually writes the CCCD, before on_ccc_cfg_changed.
+    ignore_restored_ccc = false;
+
+    return sizeof(value);
+}
+
+static void on_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    if (ignore_restored_ccc) {
+        LOG_DBG("Ignoring restored CCC value, phone must re-enable the IMU stream");
+        return;
+    }
+
+    if (value & BT_GATT_CCC_NOTIFY) {
+        if (!streaming) {
+            stream_start();
+        }
+    } else {
+        stream_stop();
+    }
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+    ARG_UNUSED(conn);
+
+    if (err) {
+        return;
+    }
+
+    ignore_restored_ccc = true;
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    ignore_restored_ccc = false;
+    stream_stop();
+}
+
+void zsw_imu_stream_get_stats(zsw_imu_stream_stats_t *p_stats)
+{
+    k_mutex_lock(&stream_mutex, K_FOREVER);
+    *p_stats = stats;
+    p_stats->dropped = atomic_get(&dropped);
+    k_mutex_unlock(&stream_mutex);
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define ZSW_IMU_STREAM_SERVICE_UUID \
+    BT_UUID_128_ENCODE(0x5a535401, 0x696d, 0x7573, 0x8000, 0x00805f9b34fb)
+#define ZSW_IMU_STREAM_CONFIG_UUID \
+    BT_UUID_128_ENCODE(0x5a535402, 0x696d, 0x7573, 0x8000, 0x00805f9b34fb)
+#define ZSW_IMU_STREAM_DATA_UUID \
+    BT_UUID_128_ENCODE(0x5a535403, 0x696d, 0x7573, 0x8000, 0x00805f9b34fb)
+
+/*
+ * Config characteristic, all integers little endian.
+ * Write: u16 rate_hz (100, 200 or 400). Takes effect immediately if streaming.
+ * Read: u16 rate_hz, u8 accel_range_g, u16 gyro_range_dps. A raw value of INT16_MAX equals the range.
+ *
+ * Data characteristic, streaming runs while notifications are enabled:
+ * u16 seq, u32 timestamp_us of first sample, u8 count, count * (i16 ax, ay, az, gx, gy, gz).
+ * Samples in a packet are 1 / rate_hz apart. A gap in seq means packets were dropped on the watch.
+ */
+#define ZSW_IMU_STREAM_HEADER_LEN       7
+#define ZSW_IMU_STREAM_SAMPLE_LEN       12
+
+typedef struct zsw_imu_stream_stats {
+    uint32_t samples;               /**< Samples sent since streaming started. */
+    uint32_t packets;               /**< Notifications sent since streaming started. */
+    uint32_t dropped;               /**< Samples dropped because the link could not keep up. */
+} zsw_imu_stream_stats_t;
+
+/** @brief              Get statistics of the ongoing or last stream.
+ *  @param p_stats      Where to store the statistics
+*/
+void zsw_imu_stream_get_stats(zsw_imu_stream_stats_t *p_stats);
@@ -28,12 +28,15 @@
 #include <zephyr/logging/log.h>
 #include "lvgl.h"
 
+#ifdef CONFIG_GC9A01_TE
+#include "buydisplay_gc9a01.h"
+#define RENDER_ON_TE
+#endif
+
 #include <zephyr/drivers/counter.h>
 
 LOG_MODULE_REGISTER(display_control, LOG_LEVEL_WRN);
 
-#define DISPLAY_BRIGHTNESS_LEVELS 32
-
 static void lvgl_render(struct k_work *item);
 static void set_brightness_level(uint8_t brightness);
 static void brightness_alarm_start_cb(const struct device *counter_dev, uint8_t chan_id, uint32_t ticks,
@@ -53,6 +56,10 @@ static const struct device *counter_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(tim
 static const struct device *const reg_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(regulator_3v3));
 static const struct device *display_dev = DEVICE_DT_GET_OR_NULL(DT_CHOSEN(zephyr_display));
 static const struct device *touch_dev =  DEVICE_DT_GET_OR_NULL(DT_NODELABEL(cst816s));
+#ifdef RENDER_ON_TE
+// Panel whose TE pulses pace LVGL. On native_sim LVGL draws to SDL and the emulated GC9A01 stands in for it.
+static const struct device *te_dev = DEVICE_DT_GET(DT_INST(0, buydisplay_gc9a01));
+#endif
 
 K_WORK_DELAYABLE_DEFINE(lvgl_work, lvgl_render);
 
@@ -64,6 +71,8 @@ static display_state_t display_state;
 static bool first_render_since_poweron;
 static uint8_t last_brightness = 1;
 static struct counter_alarm_cfg bri_alarm_start, bri_alarm_run, bri_alarm_stop;
+static struct k_spinlock render_stats_lock;
+static zsw_display_render_stats_t render_stats;
 
 uint8_t current_driver_brightness_level = DISPLAY_BRIGHTNESS_LEVELS;
 
@@ -287,9 +296,6 @@ int zsw_display_control_set_render_enabled(bool on)
 void zsw_display_control_set_brightness(uint8_t percent)
 {
     uint8_t level = 0;
-    if (!device_is_ready(display_blk.dev)) {
-        return;
-    }
     __ASSERT(percent >= 0 && percent <= 100, "Invalid range for brightness, valid range 0-100, was %d", percent);
 
     k_mutex_lock(&display_mutex, K_FOREVER);
@@ -299,19 +305,97 @@ void zsw_display_control_set_brightness(uint8_t percent)
         level = MAX(((double)percent / (double)100.0) * DISPLAY_BRIGHTNESS_LEVELS, 1);
         last_brightness = percent;
     }
-    set_brightness_level(level);
+    // Still track the setting without a backlight so readers of the brightness agree with the writers.
+    if (device_is_ready(display_blk.dev)) {
+        set_brightness_level(level);
+    }
 
     k_mutex_unlock(&display_mutex);
 }
 
+#ifdef RENDER_ON_TE
+/*
+* Lock LVGL refresh to a divisor of the panel refresh rate. Rendering starts with a panel
+* refresh, so the display driver finds the scanline where it expects it when flushing.
+*/
+static k_timeout_t render_delay_on_te(uint32_t next_update_in_ms)
+{
+    static uint32_t refr_period_ms;
+    uint32_t slot_us = gc9a01_te_get_slot_us(te_dev, CONFIG_LV_DEF_REFR_PERIOD * USEC_PER_MSEC);
+    k_spinlock_key_t key;
+
+    if (slot_us == 0 || next_update_in_ms == LV_NO_TIMER_READY) {
+        return K_MSEC(next_update_in_ms);
+    }
+
+    if (slot_us / USEC_PER_MSEC != refr_period_ms) {
+        // Rounded down, the refresh timer is due by the panel refresh the render work is aligned to.
+        refr_period_ms = slot_us / USEC_PER_MSEC;
+        lv_timer_set_period(lv_display_get_refr_timer(lv_display_get_default()), refr_period_ms);
+        key = k_spin_lock(&render_stats_lock);
+        render_stats.slot_us = slot_us;
+        k_spin_unlock(&render_stats_lock, key);
+    }
+
+    return K_USEC(gc9a01_te_align(te_dev, next_update_in_ms * USEC_PER_MSEC));
+}
+
+static bool render_started_on_te(void)
+{
+    uint32_t period_us = gc9a01_te_get_period_us(te_dev);
+
+    if (period_us == 0) {
+        return false;
+    }
+
+    // Time until the next pulse, the time since the last one is what is left of the period.
+    return (period_us - gc9a01_te_align(te_dev, 0)) % period_us < period_us / 4;
+}
+#else
+static bool render_started_on_te(void)
+{
+    return false;
+}
+#endif
+
 static void lvgl_render(struct k_work *item)
 {
+    bool on_te = render_started_on_te();
+    k_spinlock_key_t key = k_spin_lock(&render_stats_lock);
+
+    render_stats.renders++;
+    if (on_te) {
+        render_stats.renders_on_te++;
+    }
+    k_spin_unlock(&render_stats_lock, key);
+
     const int64_t next_update_in_ms = lv_task_handler();
     if (first_render_since_poweron) {
         zsw_display_control_set_brightness(last_brightness);
         first_render_since_poweron = false;
     }
+#ifdef RENDER_ON_TE
+    k_work_schedule(&lvgl_work, render_delay_on_te(next_update_in_ms));
+#else
     k_work_schedule(&lvgl_work, K_MSEC(next_update_in_ms));
+#endif
+}
+
+void zsw_display_control_get_render_stats(zsw_display_render_stats_t *p_stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&render_stats_lock);
+
+    *p_stats = render_stats;
+    k_spin_unlock(&render_stats_lock, key);
+}
+
+void zsw_display_control_reset_render_stats(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&render_stats_lock);
+
+    render_stats.renders = 0;
+    render_stats.renders_on_te = 0;
+    k_spin_unlock(&render_stats_lock, key);
 }
 
 static void set_brightness_level(uint8_t brightness)
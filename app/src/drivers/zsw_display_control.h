@@ -20,6 +20,16 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+// Steps of the backlight driver, brightness percent is rounded down to one of these.
+#define DISPLAY_BRIGHTNESS_LEVELS 32
+
+/** LVGL renders counted since boot or zsw_display_control_reset_render_stats. */
+typedef struct zsw_display_render_stats_t {
+    uint32_t renders;
+    uint32_t renders_on_te;             /**< Started within the first quarter of a panel refresh. */
+    uint32_t slot_us;                   /**< LVGL refresh period locked to the panel refresh, 0 when not paced. */
+} zsw_display_render_stats_t;
+
 void zsw_display_control_init(void);
 int zsw_display_control_sleep_ctrl(bool on);
 int zsw_display_control_pwr_ctrl(bool on);
@@ -32,4 +42,8 @@ uint8_t zsw_display_control_get_brightness(void);
 * Needed when working with the LVGL image resources so LVGL does not
 * try to render while the image data is being updated.
 */
-int zsw_display_control_set_render_enabled(bool on);
\ No newline at end of file
+int zsw_display_control_set_render_enabled(bool on);
+
+void zsw_display_control_get_render_stats(zsw_display_render_stats_t *p_stats);
+
+void zsw_display_control_reset_render_stats(void);
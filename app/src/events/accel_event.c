@@ -23,6 +23,6 @@ ZBUS_CHAN_DEFINE(accel_data_chan,
                  struct accel_event,
                  NULL,
                  NULL,
-                 ZBUS_OBSERVERS(watchface_accel_lis, power_manager_accel_lis),
+                 ZBUS_OBSERVERS(power_manager_accel_lis),
                  ZBUS_MSG_INIT()
                 );
@@ -22,4 +22,9 @@
 struct pressure_event {
     float pressure;
     float temperature;
+    float altitude;         // Relative altitude in meters, see zsw_altitude.h
+    float vertical_speed;   // Meters per second, positive upwards
+    uint32_t floors_up;
+    uint32_t floors_down;
+    int16_t floors_changed; // Floors climbed minus descended since the previous event
 };
@@ -23,7 +23,7 @@ ZBUS_CHAN_DEFINE(zsw_notification_mgr_chan,
                  struct zsw_notification_event,
                  NULL,
                  NULL,
-                 ZBUS_OBSERVERS(notification_app_lis, main_notification_lis),
+                 ZBUS_OBSERVERS(notification_app_lis, main_notification_lis, watchface_notification_lis),
                  ZBUS_MSG_INIT()
                 );
 
@@ -34,6 +34,6 @@ ZBUS_CHAN_DEFINE(zsw_notification_mgr_remove_chan,
                  struct zsw_notification_remove_event,
                  NULL,
                  NULL,
-                 ZBUS_OBSERVERS(notification_app_remove_lis),
+                 ZBUS_OBSERVERS(notification_app_remove_lis, watchface_notification_lis),
                  ZBUS_MSG_INIT()
                 );
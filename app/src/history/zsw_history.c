@@ -18,6 +18,7 @@
 #include <assert.h>
 #include <string.h>
 #include <stdio.h>
+#include <stddef.h>
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
@@ -48,6 +49,13 @@ static int zsw_history_load_header_cb(const char *p_key, size_t len, settings_re
     num_bytes_header = read_cb(p_cb_arg, &temp_stored_history, sizeof(zsw_history_t));
     LOG_DBG("Read %u header bytes, expecting: %d", num_bytes_header, sizeof(zsw_history_t));
 
+    // Headers stored before total_samples was added lack the last field, treat the stored samples as the total.
+    if (num_bytes_header == offsetof(zsw_history_t, total_samples)) {
+        LOG_WRN("Migrating history header without sample counter");
+        temp_stored_history.total_samples = temp_stored_history.num_samples;
+        num_bytes_header = sizeof(zsw_history_t);
+    }
+
     // In case data structure or the user changed either sample size or number of max samples we need to handle that.
     if ((num_bytes_header == 0) || (num_bytes_header != sizeof(zsw_history_t))) {
         LOG_ERR("Invalid header. Struct size changed!");
@@ -64,6 +72,7 @@ static int zsw_history_load_header_cb(const char *p_key, size_t len, settings_re
         // Everything is fine, we can load the history
         p_history->write_index = temp_stored_history.write_index;
         p_history->num_samples = temp_stored_history.num_samples;
+        p_history->total_samples = temp_stored_history.total_samples;
     }
 
     return 0;
@@ -98,6 +107,7 @@ int zsw_history_init(zsw_history_t *p_history, uint32_t max_samples, uint8_t sam
 
     p_history->write_index = 0;
     p_history->num_samples = 0;
+    p_history->total_samples = 0;
     p_history->max_samples = max_samples;
     p_history->sample_size = sample_size;
     p_history->samples = p_samples;
@@ -136,6 +146,7 @@ int zsw_history_del(zsw_history_t *p_history)
     memset(p_history->samples, 0, p_history->max_samples * p_history->sample_size);
     p_history->write_index = 0;
     p_history->num_samples = 0;
+    p_history->total_samples = 0;
 
     // First: Delete the header
     sprintf(key_header, "%s/%s", p_history->key, ZSW_HISTORY_HEADER_EXTENSION);
@@ -177,6 +188,7 @@ void zsw_history_add(zsw_history_t *p_history, const void *p_sample)
     }
 
     p_history->num_samples = MIN(p_history->num_samples + 1, p_history->max_samples);
+    p_history->total_samples++;
 }
 
 void zsw_history_get(const zsw_history_t *p_history, void *p_sample, uint32_t index)
@@ -264,3 +276,10 @@ int zsw_history_samples(zsw_history_t *p_history)
 
     return p_history->num_samples;
 }
+
+uint32_t zsw_history_total_samples(const zsw_history_t *p_history)
+{
+    __ASSERT(p_history != NULL, "Invalid parameters for zsw_history_total_samples");
+
+    return p_history->total_samples;
+}
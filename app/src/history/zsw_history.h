@@ -31,6 +31,7 @@ typedef struct {
     uint32_t num_samples;                       /**< Number of valid samples stored. */
     char key[ZSW_HISTORY_MAX_KEY_LENGTH];       /**< */
     void *samples;                              /**< Pointer to sample storage. */
+    uint32_t total_samples;                     /**< Number of samples ever added, used as sequence number. */
 } zsw_history_t;
 
 /** @brief              Initialize a history object.
@@ -81,3 +82,10 @@ int zsw_history_save(zsw_history_t *p_history);
  *  @return             Number of samples
 */
 int zsw_history_samples(zsw_history_t *p_history);
+
+/** @brief              Get the number of samples added since the history was created or deleted.
+ *                      The oldest stored sample has sequence number total - num_samples.
+ *  @param p_history    History object
+ *  @return             Total number of samples added
+*/
+uint32_t zsw_history_total_samples(const zsw_history_t *p_history);
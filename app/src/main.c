@@ -55,13 +55,17 @@
 #include "sensors/zsw_imu.h"
 #include "sensors/zsw_magnetometer.h"
 #include "sensors/zsw_pressure_sensor.h"
+#include "sensors/zsw_altitude.h"
 #include "sensors/zsw_light_sensor.h"
+#include "sensor_fusion/zsw_sensor_calibration.h"
 
 #include "drivers/zsw_vibration_motor.h"
 #include "drivers/zsw_display_control.h"
 
 #include "managers/zsw_power_manager.h"
 #include "managers/zsw_app_manager.h"
+#include "managers/zsw_brightness_manager.h"
+#include "managers/zsw_fitness_manager.h"
 #include "managers/zsw_notification_manager.h"
 
 #include "applications/watchface/watchface_app.h"
@@ -106,9 +110,14 @@ static void run_init_work(struct k_work *item)
     enable_bluetooth();
 
     zsw_imu_init();
+    zsw_fitness_manager_init();
     zsw_magnetometer_init();
+    zsw_sensor_calibration_init();
     zsw_pressure_sensor_init();
+    zsw_altitude_init();
     zsw_light_sensor_init();
+    // Before the power manager, which publishes the first display wakeup.
+    zsw_brightness_manager_init();
 
     zsw_power_manager_init();
 
@@ -0,0 +1,379 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "managers/zsw_brightness_manager.h"
+#include "drivers/zsw_display_control.h"
+#include "sensors/zsw_light_sensor.h"
+#include "sensors/zsw_sensor_scheduler.h"
+#include "events/activity_event.h"
+#include "events/light_event.h"
+#include "zsw_settings.h"
+
+LOG_MODULE_REGISTER(zsw_brightness_manager, CONFIG_ZSW_BRIGHTNESS_MANAGER_LOG_LEVEL);
+
+#define SAMPLE_INTERVAL_MS          CONFIG_ZSW_BRIGHTNESS_MANAGER_SAMPLE_INTERVAL_MS
+#define RAMP_STEP_MS                CONFIG_ZSW_BRIGHTNESS_MANAGER_RAMP_STEP_MS
+// A new level is only picked when the light changed this much since the last pick, in decades.
+#define HYSTERESIS_LOG_LUX          0.2f
+// Brighten right away to stay readable, but wait for the light to stay down before dimming,
+// so a passing shadow or a sleeve does not dim the display.
+#define DIM_SAMPLES                 3
+#define DEFAULT_FIXED_BRIGHTNESS    50
+
+typedef struct setting_dest_t {
+    void *data;
+    size_t len;
+} setting_dest_t;
+
+typedef struct curve_point_t {
+    float log_lux;
+    uint8_t level;
+} curve_point_t;
+
+// Backlight level per decade of lux, from a dark room to daylight.
+static const curve_point_t curve[] = {
+    { 0.0f, 2 },                            // 1 lux
+    { 1.0f, 5 },                            // 10 lux
+    { 2.0f, 10 },                           // 100 lux, indoors
+    { 3.0f, 20 },                           // 1000 lux, overcast
+    { 4.0f, DISPLAY_BRIGHTNESS_LEVELS },    // 10000 lux, daylight
+};
+
+static void zbus_activity_event_callback(const struct zbus_channel *chan);
+static void zbus_light_event_callback(const struct zbus_channel *chan);
+static void activity_work_handler(struct k_work *work);
+static void ramp_work_handler(struct k_work *work);
+static int settings_load_handler(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param);
+
+ZBUS_CHAN_DECLARE(activity_state_data_chan);
+ZBUS_CHAN_DECLARE(light_data_chan);
+ZBUS_LISTENER_DEFINE(zsw_brightness_manager_activity_lis, zbus_activity_event_callback);
+ZBUS_LISTENER_DEFINE(zsw_brightness_manager_light_lis, zbus_light_event_callback);
+
+K_WORK_DEFINE(activity_work, activity_work_handler);
+K_WORK_DELAYABLE_DEFINE(ramp_work, ramp_work_handler);
+static K_MUTEX_DEFINE(brightness_mutex);
+
+static zsw_sensor_sched_request_t light_request = {
+    .sensor = ZSW_SENSOR_SCHED_LIGHT,
+    .period_ms = SAMPLE_INTERVAL_MS,
+    .max_latency_ms = SAMPLE_INTERVAL_MS / 4,
+};
+
+static bool enabled;
+static bool awake;
+static bool woke_up;
+static bool requested;
+static bool paused;
+static bool has_reference;
+static float reference_log_lux;
+static uint8_t dim_count;
+static float last_lux;
+static uint8_t level;
+static uint8_t target_level;
+// Brightness this module set last, anything else was set by someone else.
+static uint8_t applied_percent;
+static uint8_t fixed_level;
+static uint8_t fixed_percent;
+// Put the user's stored brightness back once the display is on, after automatic brightness was turned off.
+static bool restore_fixed;
+
+static int64_t accounted_ms;
+static uint64_t awake_ms;
+static uint64_t level_ms;
+static uint64_t fixed_level_ms;
+
+static uint8_t percent_to_level(uint8_t percent)
+{
+    return CLAMP(percent * DISPLAY_BRIGHTNESS_LEVELS / 100, 1, DISPLAY_BRIGHTNESS_LEVELS);
+}
+
+static uint8_t level_to_percent(uint8_t brightness_level)
+{
+    // Smallest percent the display control rounds down to this level.
+    return DIV_ROUND_UP(brightness_level * 100, DISPLAY_BRIGHTNESS_LEVELS);
+}
+
+static uint8_t curve_level(float log_lux)
+{
+    if (log_lux <= curve[0].log_lux) {
+        return curve[0].level;
+    }
+
+    for (int i = 1; i < ARRAY_SIZE(curve); i++) {
+        if (log_lux <= curve[i].log_lux) {
+            float t = (log_lux - curve[i - 1].log_lux) / (curve[i].log_lux - curve[i - 1].log_lux);
+
+            return lroundf(curve[i - 1].level + t * (curve[i].level - curve[i - 1].level));
+        }
+    }
+
+    return curve[ARRAY_SIZE(curve) - 1].level;
+}
+
+static void account_locked(void)
+{
+    int64_t now = k_uptime_get();
+    uint64_t elapsed = now - accounted_ms;
+
+    accounted_ms = now;
+    if (!awake) {
+        return;
+    }
+
+    awake_ms += elapsed;
+    level_ms += elapsed * level;
+    fixed_level_ms += elapsed * fixed_level;
+}
+
+static void check_override_locked(void)
+{
+    uint8_t percent = zsw_display_control_get_brightness();
+
+    if (percent == applied_percent) {
+        return;
+    }
+
+    account_locked();
+    applied_percent = percent;
+    level = percent_to_level(percent);
+    if (enabled && !paused) {
+        LOG_INF("Brightness set to %u%% elsewhere, paused until next wakeup", percent);
+        paused = true;
+    }
+}
+
+static void process_lux_locked(float lux)
+{
+    float log_lux = log10f(MAX(lux, 1.0f));
+
+    last_lux = lux;
+
+    if (!has_reference || log_lux > reference_log_lux + HYSTERESIS_LOG_LUX) {
+        dim_count = 0;
+    } else if (log_lux < reference_log_lux - HYSTERESIS_LOG_LUX) {
+        if (++dim_count < DIM_SAMPLES) {
+            return;
+        }
+        dim_count = 0;
+    } else {
+        dim_count = 0;
+        return;
+    }
+
+    has_reference = true;
+    reference_log_lux = log_lux;
+    target_level = curve_level(log_lux);
+    LOG_DBG("%.1f lux, target level %u", (double)lux, target_level);
+}
+
+static void load_fixed_level_locked(void)
+{
+    zsw_settings_brightness_t brightness = DEFAULT_FIXED_BRIGHTNESS;
+    setting_dest_t dest = { &brightness, sizeof(brightness) };
+
+    // Re-read on every wakeup, the settings app and the watchface store it without telling anyone.
+    settings_load_subtree_direct(ZSW_SETTINGS_BRIGHTNESS, settings_load_handler, &dest);
+    fixed_percent = CLAMP(brightness, 1, 100);
+    fixed_level = percent_to_level(fixed_percent);
+}
+
+static void ramp_work_handler(struct k_work *work)
+{
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    check_override_locked();
+    if (!enabled || !awake || paused || !has_reference || level == target_level) {
+        k_mutex_unlock(&brightness_mutex);
+        return;
+    }
+
+    account_locked();
+    level += (target_level > level) ? 1 : -1;
+    applied_percent = level_to_percent(level);
+    zsw_display_control_set_brightness(applied_percent);
+
+    if (level != target_level) {
+        k_work_schedule(&ramp_work, K_MSEC(RAMP_STEP_MS));
+    }
+    k_mutex_unlock(&brightness_mutex);
+}
+
+static void activity_work_handler(struct k_work *work)
+{
+    zsw_sensor_reading_t reading;
+    bool sample;
+
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    if (woke_up) {
+        woke_up = false;
+        paused = false;
+        // Start over from a fresh reading, the light may be entirely different from the last wakeup.
+        has_reference = false;
+        applied_percent = zsw_display_control_get_brightness();
+        level = percent_to_level(applied_percent);
+        load_fixed_level_locked();
+    }
+
+    if (restore_fixed && awake) {
+        restore_fixed = false;
+        load_fixed_level_locked();
+        account_locked();
+        applied_percent = fixed_percent;
+        level = fixed_level;
+        zsw_display_control_set_brightness(fixed_percent);
+        LOG_DBG("Restored brightness %u%%", fixed_percent);
+    }
+
+    sample = enabled && awake;
+    if (sample && !requested) {
+        requested = (zsw_sensor_scheduler_request(&light_request) == 0);
+    } else if (!sample && requested) {
+        zsw_sensor_scheduler_release(&light_request);
+        requested = false;
+    }
+    k_mutex_unlock(&brightness_mutex);
+
+    if (sample && zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_LIGHT, &reading, 0) == 0) {
+        k_mutex_lock(&brightness_mutex, K_FOREVER);
+        process_lux_locked(reading.data.light);
+        k_mutex_unlock(&brightness_mutex);
+        k_work_schedule(&ramp_work, K_NO_WAIT);
+    }
+}
+
+static void zbus_activity_event_callback(const struct zbus_channel *chan)
+{
+    const struct activity_state_event *event = zbus_chan_const_msg(chan);
+    bool is_awake = (event->state == ZSW_ACTIVITY_STATE_ACTIVE);
+
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    if (is_awake != awake) {
+        account_locked();
+        awake = is_awake;
+        woke_up = is_awake;
+    }
+    k_mutex_unlock(&brightness_mutex);
+
+    k_work_submit(&activity_work);
+}
+
+static void zbus_light_event_callback(const struct zbus_channel *chan)
+{
+    const struct light_event *event = zbus_chan_const_msg(chan);
+
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    if (!enabled || !awake) {
+        k_mutex_unlock(&brightness_mutex);
+        return;
+    }
+    process_lux_locked(event->light);
+    k_mutex_unlock(&brightness_mutex);
+
+    k_work_schedule(&ramp_work, K_NO_WAIT);
+}
+
+void zsw_brightness_manager_set_enabled(bool enable)
+{
+    zsw_settings_auto_brightness_t setting = enable;
+
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    restore_fixed = enabled && !enable;
+    enabled = enable;
+    paused = false;
+    has_reference = false;
+    applied_percent = zsw_display_control_get_brightness();
+    k_mutex_unlock(&brightness_mutex);
+
+    settings_save_one(ZSW_SETTINGS_AUTO_BRIGHTNESS, &setting, sizeof(setting));
+    k_work_submit(&activity_work);
+}
+
+bool zsw_brightness_manager_is_enabled(void)
+{
+    return enabled;
+}
+
+void zsw_brightness_manager_get_status(zsw_brightness_manager_status_t *p_status)
+{
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    check_override_locked();
+    account_locked();
+    *p_status = (zsw_brightness_manager_status_t) {
+        .enabled = enabled,
+        .paused = paused,
+        .lux = last_lux,
+        .level = level,
+        .target_level = target_level,
+        .fixed_level = fixed_level,
+        .awake_ms = awake_ms,
+        .level_ms = level_ms,
+        .fixed_level_ms = fixed_level_ms,
+    };
+    k_mutex_unlock(&brightness_mutex);
+}
+
+int zsw_brightness_manager_init(void)
+{
+    zsw_settings_auto_brightness_t setting = true;
+    setting_dest_t dest = { &setting, sizeof(setting) };
+    float lux = 0;
+    int ret;
+
+    ret = zsw_light_sensor_get_light(&lux);
+    if (ret == -ENODEV) {
+        LOG_WRN("No light sensor, automatic brightness not available");
+        return -ENODEV;
+    } else if (ret != 0) {
+        // The sensor is there, the periodic samples after the next wakeup try again.
+        LOG_WRN("Light sensor read failed: %d, retrying on next sample", ret);
+    }
+
+    settings_subsys_init();
+    settings_load_subtree_direct(ZSW_SETTINGS_AUTO_BRIGHTNESS, settings_load_handler, &dest);
+
+    k_mutex_lock(&brightness_mutex, K_FOREVER);
+    enabled = setting;
+    last_lux = lux;
+    accounted_ms = k_uptime_get();
+    applied_percent = zsw_display_control_get_brightness();
+    level = percent_to_level(applied_percent);
+    target_level = level;
+    load_fixed_level_locked();
+    k_mutex_unlock(&brightness_mutex);
+
+    zbus_chan_add_obs(&activity_state_data_chan, &zsw_brightness_manager_activity_lis, K_MSEC(100));
+    zbus_chan_add_obs(&light_data_chan, &zsw_brightness_manager_light_lis, K_MSEC(100));
+
+    return 0;
+}
+
+static int settings_load_handler(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param)
+{
+    setting_dest_t *p_dest = param;
+
+    if (len != p_dest->len) {
+        return -EINVAL;
+    }
+
+    return read_cb(cb_arg, p_dest->data, len) >= 0 ? 0 : -ENODATA;
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Automatic display brightness from the ambient light sensor. While the display is awake
+ * the light is sampled every CONFIG_ZSW_BRIGHTNESS_MANAGER_SAMPLE_INTERVAL_MS, mapped from
+ * log-lux to a backlight level with hysteresis, and the backlight is ramped one of the
+ * DISPLAY_BRIGHTNESS_LEVELS at a time towards it. Brightness set by anyone else, like the
+ * brightness slider or the flashlight app, pauses the automatic control until the display
+ * wakes up the next time.
+ */
+
+typedef struct zsw_brightness_manager_status_t {
+    bool enabled;
+    bool paused;                        /**< Brightness was set by someone else during this wakeup. */
+    float lux;                          /**< Last sampled ambient light. */
+    uint8_t level;                      /**< Backlight level, 1 to DISPLAY_BRIGHTNESS_LEVELS. */
+    uint8_t target_level;               /**< Level the backlight is ramping to. */
+    uint8_t fixed_level;                /**< Level of the stored brightness setting. */
+    uint64_t awake_ms;                  /**< Display awake time since boot. */
+    uint64_t level_ms;                  /**< Backlight level integrated over the awake time. */
+    uint64_t fixed_level_ms;            /**< Same with the stored brightness setting instead. */
+} zsw_brightness_manager_status_t;
+
+/** @brief Load the setting and start following the display state.
+ *  @return 0 on success, -ENODEV without a light sensor.
+*/
+int zsw_brightness_manager_init(void);
+
+/** @brief          Turn automatic brightness on or off, the setting is stored.
+ *  @param enable   true to control the brightness from the ambient light
+*/
+void zsw_brightness_manager_set_enabled(bool enable);
+
+bool zsw_brightness_manager_is_enabled(void);
+
+/** @brief Get the current state and the backlight energy counters.
+ *
+ *  The backlight current is about proportional to the level, 1 - level_ms / fixed_level_ms
+ *  is the backlight energy saved compared to always using the brightness setting.
+*/
+void zsw_brightness_manager_get_status(zsw_brightness_manager_status_t *p_status);
@@ -0,0 +1,381 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "zsw_fitness_manager.h"
+#include "events/accel_event.h"
+#include "events/step_event.h"
+#include "history/zsw_history.h"
+#include "ble/zsw_history_sync.h"
+#include "zsw_clock.h"
+
+LOG_MODULE_REGISTER(zsw_fitness_manager, CONFIG_ZSW_FITNESS_MANAGER_LOG_LEVEL);
+
+#define SETTING_FITNESS_HIST_KEY    "fitness/step/hist"
+#define SAMPLE_INTERVAL_MIN         60
+#define MAX_SAMPLES                 (ZSW_FITNESS_MANAGER_DAYS * ZSW_FITNESS_MANAGER_HOURS) // One week of hourly samples
+#define STEP_UPDATE_INTERVAL_MS     (CONFIG_ZSW_FITNESS_MANAGER_STEP_UPDATE_INTERVAL_S * 1000)
+
+static void zbus_accel_data_callback(const struct zbus_channel *chan);
+static void step_update_work_handler(struct k_work *work);
+static void sample_work_handler(struct k_work *work);
+
+ZBUS_CHAN_DECLARE(accel_data_chan);
+ZBUS_CHAN_DECLARE(step_data_chan);
+ZBUS_LISTENER_DEFINE(zsw_fitness_manager_accel_lis, zbus_accel_data_callback);
+
+K_WORK_DELAYABLE_DEFINE(step_update_work, step_update_work_handler);
+K_WORK_DELAYABLE_DEFINE(sample_work, sample_work_handler);
+static K_MUTEX_DEFINE(fitness_mutex);
+
+static zsw_history_t fitness_history_context;
+static zsw_step_sample_t samples[MAX_SAMPLES];
+
+static uint32_t cached_steps;
+static int64_t cached_steps_ms;
+static zsw_imu_data_step_activity_t cached_activity = ZSW_IMU_EVT_STEP_ACTIVITY_UNKNOWN;
+static struct step_event last_published = {
+    .steps = UINT32_MAX,
+};
+
+// The day the step counter counts for, the counter is reset when the clock passes into the next day.
+static minimal_zsw_timeval_t current_day;
+
+static void timeval_to_minimal_timeval(const zsw_timeval_t *time, minimal_zsw_timeval_t *minimal_time)
+{
+    minimal_time->tm_sec = time->tm.tm_sec;
+    minimal_time->tm_min = time->tm.tm_min;
+    minimal_time->tm_hour = time->tm.tm_hour;
+    minimal_time->tm_mday = time->tm.tm_mday;
+    minimal_time->tm_mon = time->tm.tm_mon;
+    minimal_time->tm_year = time->tm.tm_year;
+    minimal_time->tm_wday = time->tm.tm_wday;
+    minimal_time->tm_yday = time->tm.tm_yday;
+}
+
+/*
+* Days since year 0, only differences are used to compare dates across year boundaries.
+*/
+static uint32_t day_number(const minimal_zsw_timeval_t *time)
+{
+    uint32_t years = time->tm_year - 1;
+
+    return years * 365 + years / 4 - years / 100 + years / 400 + time->tm_yday;
+}
+
+static int seconds_to_next_hour(const minimal_zsw_timeval_t *time)
+{
+    return 60 * (SAMPLE_INTERVAL_MIN - time->tm_min) - time->tm_sec;
+}
+
+static int read_steps_locked(void)
+{
+    uint32_t steps;
+    int ret;
+
+    ret = zsw_imu_fetch_num_steps(&steps);
+    if (ret != 0) {
+#ifdef CONFIG_ARCH_POSIX
+        steps = cached_steps + rand() % 100;
+#else
+        return ret;
+#endif
+    }
+    cached_steps = steps;
+    cached_steps_ms = k_uptime_get();
+
+    return 0;
+}
+
+static void publish_if_changed(void)
+{
+    struct step_event evt;
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    evt.steps = cached_steps;
+    evt.activity = cached_activity;
+    if (evt.steps == last_published.steps && evt.activity == last_published.activity) {
+        k_mutex_unlock(&fitness_mutex);
+        return;
+    }
+    last_published = evt;
+    k_mutex_unlock(&fitness_mutex);
+
+    zbus_chan_pub(&step_data_chan, &evt, K_MSEC(250));
+}
+
+static void add_sample_locked(const minimal_zsw_timeval_t *time)
+{
+    zsw_step_sample_t sample = {
+        .time = *time,
+        .steps = cached_steps,
+    };
+
+    zsw_history_add(&fitness_history_context, &sample);
+    if (zsw_history_save(&fitness_history_context)) {
+        LOG_ERR("Error during saving of step samples!");
+    }
+    LOG_DBG("Step sample %d:%02d: %d", sample.time.tm_hour, sample.time.tm_min, sample.steps);
+}
+
+/*
+* Close the day when the clock passed midnight. The last sample of a day is stored as 23:59:59
+* with everything counted until now, then the counter starts over. A clock that jumps more
+* than a day, such as when it is set from the phone, only moves the day.
+*/
+static bool check_day_rollover_locked(const minimal_zsw_timeval_t *now)
+{
+    uint32_t today = day_number(now);
+    uint32_t counted_day = day_number(&current_day);
+
+    if (today == counted_day) {
+        return false;
+    }
+
+    if (today == counted_day + 1) {
+        minimal_zsw_timeval_t day_end = current_day;
+
+        day_end.tm_hour = 23;
+        day_end.tm_min = 59;
+        day_end.tm_sec = 59;
+        if (read_steps_locked() != 0) {
+            LOG_WRN("Error during fetching of steps, closing day with cached count");
+        }
+        add_sample_locked(&day_end);
+
+        LOG_DBG("Reset step counter");
+        zsw_imu_reset_step_count();
+        cached_steps = 0;
+        cached_steps_ms = k_uptime_get();
+    } else {
+        LOG_INF("Clock moved from day %u to %u, keeping the step count", counted_day, today);
+    }
+    current_day = *now;
+
+    return true;
+}
+
+static void sample_work_handler(struct k_work *work)
+{
+    zsw_timeval_t time;
+    minimal_zsw_timeval_t now;
+
+    zsw_clock_get_time(&time);
+    timeval_to_minimal_timeval(&time, &now);
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    // Nothing is counted yet during the first hour of a day, the day end sample covers midnight.
+    if (!check_day_rollover_locked(&now) && now.tm_min == 0 && now.tm_hour != 0) {
+        if (read_steps_locked() == 0) {
+            add_sample_locked(&now);
+        } else {
+            LOG_WRN("Error during fetching of steps!");
+        }
+    }
+    k_mutex_unlock(&fitness_mutex);
+
+    publish_if_changed();
+
+    LOG_DBG("Next sample in %d s", seconds_to_next_hour(&now));
+    k_work_reschedule(&sample_work, K_SECONDS(seconds_to_next_hour(&now)));
+}
+
+static void step_update_work_handler(struct k_work *work)
+{
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    if (read_steps_locked() != 0) {
+        LOG_WRN("Error during fetching of steps!");
+    }
+    k_mutex_unlock(&fitness_mutex);
+
+    publish_if_changed();
+}
+
+static void zbus_accel_data_callback(const struct zbus_channel *chan)
+{
+    const struct accel_event *event = zbus_chan_const_msg(chan);
+    int64_t delay_ms;
+
+    if (event->data.type != ZSW_IMU_EVT_TYPE_STEP && event->data.type != ZSW_IMU_EVT_TYPE_STEP_ACTIVITY) {
+        return;
+    }
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    if (event->data.type == ZSW_IMU_EVT_TYPE_STEP_ACTIVITY) {
+        cached_activity = event->data.data.step_activity;
+    }
+    delay_ms = cached_steps_ms + STEP_UPDATE_INTERVAL_MS - k_uptime_get();
+    k_mutex_unlock(&fitness_mutex);
+
+    // Read at most once per interval, k_work_schedule leaves an already pending read alone.
+    k_work_schedule(&step_update_work, K_MSEC(CLAMP(delay_ms, 0, STEP_UPDATE_INTERVAL_MS)));
+}
+
+int zsw_fitness_manager_get_steps(uint32_t *p_steps, uint32_t max_age_ms)
+{
+    int ret = 0;
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    if (k_uptime_get() - cached_steps_ms > max_age_ms) {
+        ret = read_steps_locked();
+    }
+    *p_steps = cached_steps;
+    k_mutex_unlock(&fitness_mutex);
+
+    return ret;
+}
+
+zsw_imu_data_step_activity_t zsw_fitness_manager_get_activity(void)
+{
+    zsw_imu_data_step_activity_t activity;
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    activity = cached_activity;
+    k_mutex_unlock(&fitness_mutex);
+
+    return activity;
+}
+
+void zsw_fitness_manager_get_daily_steps(uint32_t p_steps[ZSW_FITNESS_MANAGER_DAYS],
+                                         uint8_t p_weekdays[ZSW_FITNESS_MANAGER_DAYS])
+{
+    zsw_step_sample_t sample;
+    uint32_t today;
+    uint32_t days_ago;
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    today = day_number(&current_day);
+    memset(p_steps, 0, ZSW_FITNESS_MANAGER_DAYS * sizeof(p_steps[0]));
+
+    for (int i = 0; i < zsw_history_samples(&fitness_history_context); i++) {
+        zsw_history_get(&fitness_history_context, &sample, i);
+        days_ago = today - day_number(&sample.time);
+        if (days_ago < ZSW_FITNESS_MANAGER_DAYS) {
+            p_steps[ZSW_FITNESS_MANAGER_DAYS - 1 - days_ago] = MAX(sample.steps,
+                                                                   p_steps[ZSW_FITNESS_MANAGER_DAYS - 1 - days_ago]);
+        }
+    }
+    p_steps[ZSW_FITNESS_MANAGER_DAYS - 1] = cached_steps;
+
+    if (p_weekdays) {
+        for (int i = 0; i < ZSW_FITNESS_MANAGER_DAYS; i++) {
+            p_weekdays[i] = (current_day.tm_wday + 1 + i) % 7;
+        }
+    }
+    k_mutex_unlock(&fitness_mutex);
+}
+
+void zsw_fitness_manager_get_hourly_steps(uint32_t p_steps[ZSW_FITNESS_MANAGER_HOURS])
+{
+    // Daily count at the start of each hour, UINT32_MAX where no sample was taken.
+    uint32_t at_hour[ZSW_FITNESS_MANAGER_HOURS + 1];
+    zsw_step_sample_t sample;
+    zsw_timeval_t time;
+    int current_hour;
+    uint32_t today;
+
+    zsw_clock_get_time(&time);
+    current_hour = time.tm.tm_hour;
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    today = day_number(&current_day);
+    memset(at_hour, 0xFF, sizeof(at_hour));
+    at_hour[0] = 0;
+
+    for (int i = 0; i < zsw_history_samples(&fitness_history_context); i++) {
+        zsw_history_get(&fitness_history_context, &sample, i);
+        if (day_number(&sample.time) == today && sample.time.tm_hour > 0 && sample.time.tm_min == 0) {
+            at_hour[sample.time.tm_hour] = sample.steps;
+        }
+    }
+    at_hour[current_hour + 1] = cached_steps;
+    k_mutex_unlock(&fitness_mutex);
+
+    memset(p_steps, 0, ZSW_FITNESS_MANAGER_HOURS * sizeof(p_steps[0]));
+    for (int hour = 0; hour <= current_hour; hour++) {
+        if (at_hour[hour + 1] == UINT32_MAX) {
+            // Watch was off at the hour, count the steps in the hour after.
+            at_hour[hour + 1] = at_hour[hour];
+        }
+        if (at_hour[hour + 1] > at_hour[hour]) {
+            p_steps[hour] = at_hour[hour + 1] - at_hour[hour];
+        }
+    }
+}
+
+int zsw_fitness_manager_reset_steps(void)
+{
+    int ret;
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    ret = zsw_imu_reset_step_count();
+    if (ret == 0) {
+        cached_steps = 0;
+        cached_steps_ms = k_uptime_get();
+    }
+    k_mutex_unlock(&fitness_mutex);
+
+    publish_if_changed();
+
+    return ret;
+}
+
+int zsw_fitness_manager_init(void)
+{
+    zsw_step_sample_t last_sample;
+    zsw_timeval_t time;
+    int num_hist_samples;
+
+    zsw_history_init(&fitness_history_context, MAX_SAMPLES, sizeof(zsw_step_sample_t), samples, SETTING_FITNESS_HIST_KEY);
+
+    if (zsw_history_load(&fitness_history_context)) {
+        LOG_ERR("Error during settings_load_subtree!");
+        return -EFAULT;
+    }
+
+    zsw_history_sync_register(&fitness_history_context, ZSW_HISTORY_SYNC_ID_STEPS);
+
+    zsw_clock_get_time(&time);
+    timeval_to_minimal_timeval(&time, &current_day);
+
+    k_mutex_lock(&fitness_mutex, K_FOREVER);
+    num_hist_samples = zsw_history_samples(&fitness_history_context);
+    if (num_hist_samples > 0) {
+        zsw_history_get(&fitness_history_context, &last_sample, num_hist_samples - 1);
+        // If watch was reset the step counter restarts at 0, so we need to update the offset.
+        if (day_number(&last_sample.time) == day_number(&current_day)) {
+            zsw_imu_set_step_offset(last_sample.steps);
+        }
+    }
+    if (read_steps_locked() != 0) {
+        LOG_WRN("Error during fetching of steps!");
+    }
+    k_mutex_unlock(&fitness_mutex);
+
+    zbus_chan_add_obs(&accel_data_chan, &zsw_fitness_manager_accel_lis, K_MSEC(100));
+
+    // Try to sample about every full hour
+    LOG_DBG("Next sample in %d s", seconds_to_next_hour(&current_day));
+    k_work_reschedule(&sample_work, K_SECONDS(seconds_to_next_hour(&current_day)));
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "sensors/zsw_imu.h"
+
+/*
+ * Owner of the daily step count. The BMI270 counts steps on chip, the counter is only
+ * read at the hourly history boundaries, at most once per
+ * CONFIG_ZSW_FITNESS_MANAGER_STEP_UPDATE_INTERVAL_S after step interrupts, or when a
+ * consumer asks for a fresher value than the cached one. Coalesced updates are published
+ * on step_data_chan.
+ */
+
+#define ZSW_FITNESS_MANAGER_DAYS        7
+#define ZSW_FITNESS_MANAGER_HOURS       24
+
+typedef struct minimal_zsw_timeval {
+    // Same structure as zsw_timeval_t, but with smaller types and without tm_isdst and nanoseconds
+    uint8_t  tm_sec;    /**< Seconds [0, 59] */
+    uint8_t  tm_min;     /**< Minutes [0, 59] */
+    uint8_t  tm_hour;   /**< Hours [0, 23] */
+    uint8_t  tm_mday;   /**< Day of the month [1, 31] */
+    uint8_t  tm_mon;    /**< Month [0, 11] */
+    uint16_t tm_year;   /**< Year */
+    uint8_t  tm_wday;   /**< Day of the week [0, 6] (Sunday = 0) (Unknown = -1) */
+    uint16_t tm_yday;   /**< Day of the year [0, 365] (Unknown = -1) */
+} minimal_zsw_timeval_t;
+
+/*
+* Stored in the step history and synced to the phone, steps is the daily count at the sample time.
+*/
+typedef struct {
+    minimal_zsw_timeval_t time;
+    uint32_t steps;
+} zsw_step_sample_t;
+
+/** @brief Restore the step history and today's count, and start the hourly sampling.
+ *  @return 0 on success, negative error code on failure.
+*/
+int zsw_fitness_manager_init(void);
+
+/** @brief              Get today's step count.
+ *  @param p_steps      Where to store the count
+ *  @param max_age_ms   Oldest acceptable cached count, the IMU is only read if the cache is older
+ *  @return             0 on success, negative error code if the IMU could not be read, the cached count is then returned.
+*/
+int zsw_fitness_manager_get_steps(uint32_t *p_steps, uint32_t max_age_ms);
+
+/** @brief Get the last step activity reported by the IMU.
+*/
+zsw_imu_data_step_activity_t zsw_fitness_manager_get_activity(void);
+
+/** @brief              Get the steps of the last days.
+ *  @param p_steps      ZSW_FITNESS_MANAGER_DAYS entries, the last one is today
+ *  @param p_weekdays   Optional, ZSW_FITNESS_MANAGER_DAYS entries filled with the day of the week [0, 6] (Sunday = 0)
+*/
+void zsw_fitness_manager_get_daily_steps(uint32_t p_steps[ZSW_FITNESS_MANAGER_DAYS],
+                                         uint8_t p_weekdays[ZSW_FITNESS_MANAGER_DAYS]);
+
+/** @brief              Get the steps taken during each hour of today.
+ *  @param p_steps      ZSW_FITNESS_MANAGER_HOURS entries, hours not reached yet are 0
+*/
+void zsw_fitness_manager_get_hourly_steps(uint32_t p_steps[ZSW_FITNESS_MANAGER_HOURS]);
+
+/** @brief Reset today's step count to zero.
+ *  @return 0 on success, negative error code on failure.
+*/
+int zsw_fitness_manager_reset_steps(void);
@@ -29,9 +29,9 @@
 #include "ble/ble_comm.h"
 #include "ble/gadgetbridge/ble_gadgetbridge.h"
 #include "events/battery_event.h"
+#include "managers/zsw_fitness_manager.h"
 #include "managers/zsw_power_manager.h"
 #include "events/zsw_notification_event.h"
-#include "sensors/zsw_imu.h"
 #if defined(CONFIG_BT_HRS)
 #include "sensors/zsw_health_data.h"
 #endif
@@ -63,11 +63,11 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
 
 static void send_activity_data(void)
 {
-    uint32_t steps = 0;
-    zsw_imu_data_step_activity_t step_activity = ZSW_IMU_EVT_STEP_ACTIVITY_UNKNOWN;
+    uint32_t steps;
+    zsw_imu_data_step_activity_t step_activity = zsw_fitness_manager_get_activity();
 
-    zsw_imu_fetch_num_steps(&steps);
-    zsw_imu_fetch_step_activity(&step_activity);
+    // Kept current by the step interrupts, no need to read the IMU for every battery sample.
+    zsw_fitness_manager_get_steps(&steps, UINT32_MAX);
 
 #if defined(CONFIG_BT_HRS)
     uint16_t hr = zsw_health_data_get_heart_rate();
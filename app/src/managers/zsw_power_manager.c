@@ -34,6 +34,7 @@
 #include "zsw_power_manager.h"
 #include "zsw_display_control.h"
 #include "zsw_vibration_motor.h"
+#include "zsw_sensor_scheduler.h"
 
 LOG_MODULE_REGISTER(zsw_power_manager, CONFIG_ZSW_PWR_MANAGER_LOG_LEVEL);
 
@@ -58,6 +59,8 @@ LOG_MODULE_REGISTER(zsw_power_manager, CONFIG_ZSW_PWR_MANAGER_LOG_LEVEL);
 #define TILT_AWAY_DOT_MAX                                           0.45f
 // How long watch must face away before tunning off
 #define TILT_AWAY_HOLD_MS                                           800
+// Samples facing the user in a row before sampling stops until the next IMU motion interrupt
+#define TILT_SETTLE_SAMPLES                                         5
 
 static void enter_active(void);
 static void enter_inactive(void);
@@ -66,6 +69,7 @@ static int settings_load_handler(const char *key, size_t len,
 static void update_and_publish_state(zsw_power_manager_state_t new_state);
 static void handle_idle_timeout(struct k_work *item);
 static void tilt_request_reference_update(void);
+static void tilt_start_sampling(void);
 static void update_last_activity_timestamp(void);
 static void zbus_accel_data_callback(const struct zbus_channel *chan);
 static void zbus_battery_sample_data_callback(const struct zbus_channel *chan);
@@ -107,6 +111,9 @@ static struct {
     float ref_z;
     uint8_t ref_count;
     uint32_t away_start_ms;
+    // Sampling is started by IMU any-motion interrupts, otherwise it runs all the time while active.
+    bool motion_wakeup;
+    uint8_t settle_count;
 } tilt;
 
 int zsw_power_manager_init(void)
@@ -175,6 +182,7 @@ void zsw_power_manager_on_user_activity(void)
 
     if (is_active) {
         tilt_request_reference_update();
+        tilt_start_sampling();
     }
 }
 
@@ -186,6 +194,14 @@ static void tilt_request_reference_update(void)
     tilt.ref_z = 0.0f;
     tilt.ref_count = 0;
     tilt.away_start_ms = 0;
+    tilt.settle_count = 0;
+}
+
+static void tilt_start_sampling(void)
+{
+    tilt.settle_count = 0;
+    // Does nothing if already sampling.
+    k_work_schedule(&tilt_work, K_MSEC(TILT_SAMPLE_PERIOD_MS));
 }
 
 static void update_last_activity_timestamp(void)
@@ -248,12 +264,16 @@ static void enter_active(void)
     zsw_imu_feature_disable(ZSW_IMU_FEATURE_NO_MOTION);
     zsw_imu_feature_disable(ZSW_IMU_FEATURE_ANY_MOTION);
 
+    // While active any-motion wakes up the tilt detection, the watch can only be tilted away by moving it.
+    // Falls back to sampling all the time if the interrupt is not available.
+    tilt.motion_wakeup = (zsw_imu_feature_enable(ZSW_IMU_FEATURE_ANY_MOTION, true) == 0);
+
     tilt_request_reference_update();
 
     update_and_publish_state(ZSW_ACTIVITY_STATE_ACTIVE);
 
     k_work_schedule(&idle_work, K_SECONDS(idle_timeout_seconds));
-    k_work_schedule(&tilt_work, K_MSEC(TILT_SAMPLE_PERIOD_MS));
+    tilt_start_sampling();
 }
 
 static void update_and_publish_state(zsw_power_manager_state_t new_state)
@@ -342,9 +362,12 @@ static void tilt_check_monitoring(float ux, float uy, float uz)
     // Watch is facing user
     if (dot >= TILT_FACE_DOT_MIN) {
         tilt.away_start_ms = 0;
+        tilt.settle_count++;
         return;
     }
 
+    tilt.settle_count = 0;
+
     // Watch is tilted away
     if (dot <= TILT_AWAY_DOT_MAX) {
         uint32_t now = k_uptime_get_32();
@@ -373,12 +396,16 @@ static void tilt_detection_work_handler(struct k_work *item)
         return;
     }
 
-    float ax, ay, az;
-    if (zsw_imu_fetch_accel_f(&ax, &ay, &az) != 0) {
-        LOG_ERR("Tilt: zsw_imu_fetch_accel_f failed");
+    // Shares the IMU read with other consumers, ex. the BLE sensor stream, if they read recently.
+    zsw_sensor_reading_t reading;
+    if (zsw_sensor_scheduler_get(ZSW_SENSOR_SCHED_IMU, &reading, TILT_SAMPLE_PERIOD_MS / 2) != 0) {
+        LOG_ERR("Tilt: IMU read failed");
         k_work_schedule(&tilt_work, K_MSEC(TILT_SAMPLE_PERIOD_MS));
         return;
     }
+    float ax = reading.data.imu.accel[0];
+    float ay = reading.data.imu.accel[1];
+    float az = reading.data.imu.accel[2];
 
     float mag_sq = ax * ax + ay * ay + az * az;
     if (mag_sq <= 0.0f) {
@@ -407,6 +434,15 @@ static void tilt_detection_work_handler(struct k_work *item)
         }
     }
 
+    if (!is_active) {
+        return;
+    }
+
+    if (tilt.motion_wakeup && (tilt.state == TILT_STATE_MONITORING) && (tilt.settle_count >= TILT_SETTLE_SAMPLES)) {
+        LOG_DBG("Tilt: facing user, wait for motion");
+        return;
+    }
+
     k_work_schedule(&tilt_work, K_MSEC(TILT_SAMPLE_PERIOD_MS));
 }
 
@@ -419,6 +455,10 @@ static void zbus_accel_data_callback(const struct zbus_channel *chan)
             if (!is_active) {
                 LOG_INF("Wrist wakeup gesture detected");
                 enter_active();
+            } else {
+                // Watch turned towards the user, learn the new orientation.
+                tilt_request_reference_update();
+                tilt_start_sampling();
             }
             break;
         }
@@ -436,25 +476,38 @@ static void zbus_accel_data_callback(const struct zbus_channel *chan)
             break;
         }
         case ZSW_IMU_EVT_TYPE_ANY_MOTION: {
-            LOG_INF("Watch moved, init display");
-            if (!is_active) {
-                is_stationary = false;
-                zsw_display_control_pwr_ctrl(true);
-                zsw_display_control_sleep_ctrl(false);
-                retained.display_off_time += k_uptime_get_32() - last_pwr_off_time;
-                zsw_retained_ram_update();
-                zsw_imu_feature_enable(ZSW_IMU_FEATURE_NO_MOTION, true);
-                zsw_imu_feature_disable(ZSW_IMU_FEATURE_ANY_MOTION);
-
-                update_and_publish_state(ZSW_ACTIVITY_STATE_INACTIVE);
+            if (is_active) {
+                LOG_DBG("Tilt: motion detected, start sampling");
+                tilt_start_sampling();
+                break;
             }
+            LOG_INF("Watch moved, init display");
+            is_stationary = false;
+            zsw_display_control_pwr_ctrl(true);
+            zsw_display_control_sleep_ctrl(false);
+            retained.display_off_time += k_uptime_get_32() - last_pwr_off_time;
+            zsw_retained_ram_update();
+            zsw_imu_feature_enable(ZSW_IMU_FEATURE_NO_MOTION, true);
+            zsw_imu_feature_disable(ZSW_IMU_FEATURE_ANY_MOTION);
+
+            update_and_publish_state(ZSW_ACTIVITY_STATE_INACTIVE);
             break;
         }
         case ZSW_IMU_EVT_TYPE_GESTURE: {
-            if ((event->data.data.gesture == BOSCH_BMI270_GESTURE_FLICK_OUT) &&
-                (idle_timeout_seconds != UINT32_MAX)) {
+            if (idle_timeout_seconds == UINT32_MAX) {
+                break;
+            }
+            if (event->data.data.gesture == BOSCH_BMI270_GESTURE_FLICK_OUT) {
                 LOG_INF("Put device into standby");
                 enter_inactive();
+            } else if ((event->data.data.gesture == BOSCH_BMI270_GESTURE_ARM_DOWN) && is_active &&
+                       ((k_uptime_get_32() - last_activity_time_ms) >= TILT_MIN_LVGL_IDLE_MS)) {
+                // Same user inactivity requirement as the sampled tilt detection.
+                LOG_INF("Tilt: arm down gesture, entering inactive");
+                enter_inactive();
+            } else if ((event->data.data.gesture == BOSCH_BMI270_GESTURE_PIVOT_UP) && is_active) {
+                tilt_request_reference_update();
+                tilt_start_sampling();
             }
             break;
         }
@@ -18,9 +18,11 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/init.h>
+#include <zephyr/bluetooth/conn.h>
 #include "zsw_smp_manager.h"
 #include "zsw_xip_manager.h"
 #include "ble/ble_comm.h"
+#include "ble/ble_conn_params.h"
 
 #ifndef CONFIG_ARCH_POSIX
 #include <zephyr/mgmt/mcumgr/mgmt/callbacks.h>
@@ -35,12 +37,35 @@ LOG_MODULE_REGISTER(zsw_smp_manager, LOG_LEVEL_INF);
 
 #define SMP_AUTO_DISABLE_TIMEOUT_SEC  180
 
+// Image and file (voice memo) transfers, as fast as the link allows.
+static const ble_conn_params_demand_t smp_demand = {
+    .throughput_bps = 16000,
+    .max_latency_ms = 50,
+};
+
 static bool smp_enabled;
 static bool auto_disable_active;
 
 static void smp_auto_disable_work_handler(struct k_work *work);
+static void connected(struct bt_conn *conn, uint8_t err);
 static K_WORK_DELAYABLE_DEFINE(smp_auto_disable_work, smp_auto_disable_work_handler);
 
+BT_CONN_CB_DEFINE(smp_conn_callbacks) = {
+    .connected = connected,
+};
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+    ARG_UNUSED(conn);
+
+    if (err || !smp_enabled) {
+        return;
+    }
+
+    // Demands are dropped with the link, a transfer may go on over the new one.
+    ble_conn_params_request(BLE_CONN_PARAMS_USER_SMP, &smp_demand);
+}
+
 static void smp_auto_disable_work_handler(struct k_work *work)
 {
     ARG_UNUSED(work);
@@ -58,7 +83,7 @@ static void smp_auto_disable_work_handler(struct k_work *work)
     }
 
     ble_comm_set_default_adv_interval();
-    ble_comm_set_default_connection_interval();
+    ble_conn_params_release(BLE_CONN_PARAMS_USER_SMP);
     zsw_xip_disable();
 
     smp_enabled = false;
@@ -144,7 +169,7 @@ int zsw_smp_manager_enable(bool auto_disable)
 
     // Optimize BLE parameters for faster transfer
     ble_comm_set_fast_adv_interval();
-    ble_comm_set_short_connection_interval();
+    ble_conn_params_request(BLE_CONN_PARAMS_USER_SMP, &smp_demand);
 
     smp_enabled = true;
     auto_disable_active = auto_disable;
@@ -175,7 +200,7 @@ int zsw_smp_manager_disable(void)
     }
 
     ble_comm_set_default_adv_interval();
-    ble_comm_set_default_connection_interval();
+    ble_conn_params_release(BLE_CONN_PARAMS_USER_SMP);
 
     zsw_xip_disable();
 
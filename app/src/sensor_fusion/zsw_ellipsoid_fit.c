@@ -0,0 +1,269 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/jakkra/ZSWatch/>.
+ * Copyright (c) 2025 ZSWatch Project, Leonardo Bispo, Jakob Krantz.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#include "zsw_ellipsoid_fit.h"
+
+#define N                   ZSW_ELLIPSOID_FIT_PARAMS
+#define JACOBI_SWEEPS       16
+
+void zsw_ellipsoid_fit_init(zsw_ellipsoid_fit_t *p_fit, float scale, float forgetting)
+{
+    memset(p_fit, 0, sizeof(*p_fit));
+    p_fit->scale = scale;
+    p_fit->forgetting = forgetting;
+}
+
+void zsw_ellipsoid_fit_add(zsw_ellipsoid_fit_t *p_fit, float x, float y, float z)
+{
+    const double sx = x / p_fit->scale;
+    const double sy = y / p_fit->scale;
+    const double sz = z / p_fit->scale;
+    const double d[N] = {
+        sx * sx, sy * sy, sz * sz, 2 * sx * sy, 2 * sx * sz, 2 * sy * sz, 2 * sx, 2 * sy, 2 * sz
+    };
+
+    // Only the upper triangle is used, the lower is filled in when solving.
+    for (int i = 0; i < N; i++) {
+        for (int j = i; j < N; j++) {
+            p_fit->ata[i][j] = p_fit->forgetting * p_fit->ata[i][j] + d[i] * d[j];
+        }
+        p_fit->atb[i] = p_fit->forgetting * p_fit->atb[i] + d[i];
+    }
+    p_fit->weight = p_fit->forgetting * p_fit->weight + 1.0;
+}
+
+// In place Cholesky decomposition and solve of a symmetric positive definite system.
+static int solve_cholesky(double a[N][N], const double b[N], double x[N])
+{
+    for (int j = 0; j < N; j++) {
+        double sum = a[j][j];
+
+        for (int k = 0; k < j; k++) {
+            sum -= a[j][k] * a[j][k];
+        }
+        if (sum <= 1e-12) {
+            return -EDOM;
+        }
+        a[j][j] = sqrt(sum);
+
+        for (int i = j + 1; i < N; i++) {
+            sum = a[i][j];
+            for (int k = 0; k < j; k++) {
+                sum -= a[i][k] * a[j][k];
+            }
+            a[i][j] = sum / a[j][j];
+        }
+    }
+
+    for (int i = 0; i < N; i++) {
+        double sum = b[i];
+
+        for (int k = 0; k < i; k++) {
+            sum -= a[i][k] * x[k];
+        }
+        x[i] = sum / a[i][i];
+    }
+    for (int i = N - 1; i >= 0; i--) {
+        double sum = x[i];
+
+        for (int k = i + 1; k < N; k++) {
+            sum -= a[k][i] * x[k];
+        }
+        x[i] = sum / a[i][i];
+    }
+
+    return 0;
+}
+
+// Eigen decomposition of a symmetric 3x3 matrix, m = v * diag(eig) * v^T.
+static void eigen_symmetric_3x3(double m[3][3], double v[3][3], double eig[3])
+{
+    memset(v, 0, sizeof(double) * 9);
+    v[0][0] = v[1][1] = v[2][2] = 1.0;
+
+    for (int sweep = 0; sweep < JACOBI_SWEEPS; sweep++) {
+        double off = fabs(m[0][1]) + fabs(m[0][2]) + fabs(m[1][2]);
+
+        if (off < 1e-15) {
+            break;
+        }
+
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (fabs(m[p][q]) < 1e-18) {
+                    continue;
+                }
+                const double theta = (m[q][q] - m[p][p]) / (2 * m[p][q]);
+                const double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+                const double c = 1 / sqrt(t * t + 1);
+                const double s = t * c;
+
+                for (int k = 0; k < 3; k++) {
+                    const double mkp = m[k][p];
+                    const double mkq = m[k][q];
+
+                    m[k][p] = c * mkp - s * mkq;
+                    m[k][q] = s * mkp + c * mkq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    const double mpk = m[p][k];
+                    const double mqk = m[q][k];
+
+                    m[p][k] = c * mpk - s * mqk;
+                    m[q][k] = s * mpk + c * mqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    const double vkp = v[k][p];
+                    const double vkq = v[k][q];
+
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        eig[i] = m[i][i];
+    }
+}
+
+int zsw_ellipsoid_fit_solve(const zsw_ellipsoid_fit_t *p_fit, zsw_ellipsoid_t *p_result)
+{
+    double a[N][N];
+    double p[N];
+    double q[3][3];
+    double q_inv[3][3];
+    double center[3];
+    double v[3][3];
+    double eig[3];
+    double k;
+    double det;
+
+    // Nine unknowns, need at least that many samples.
+    if (p_fit->weight < N) {
+        return -EAGAIN;
+    }
+
+    for (int i = 0; i < N; i++) {
+        for (int j = i; j < N; j++) {
+            a[i][j] = p_fit->ata[i][j];
+            a[j][i] = p_fit->ata[i][j];
+        }
+    }
+
+    if (solve_cholesky(a, p_fit->atb, p) != 0) {
+        return -EDOM;
+    }
+
+    q[0][0] = p[0];
+    q[1][1] = p[1];
+    q[2][2] = p[2];
+    q[0][1] = q[1][0] = p[3];
+    q[0][2] = q[2][0] = p[4];
+    q[1][2] = q[2][1] = p[5];
+
+    // center = -Q^-1 * [g h i]
+    det = q[0][0] * (q[1][1] * q[2][2] - q[1][2] * q[2][1]) -
+          q[0][1] * (q[1][0] * q[2][2] - q[1][2] * q[2][0]) +
+          q[0][2] * (q[1][0] * q[2][1] - q[1][1] * q[2][0]);
+    if (fabs(det) < 1e-18) {
+        return -EDOM;
+    }
+    q_inv[0][0] = (q[1][1] * q[2][2] - q[1][2] * q[2][1]) / det;
+    q_inv[0][1] = (q[0][2] * q[2][1] - q[0][1] * q[2][2]) / det;
+    q_inv[0][2] = (q[0][1] * q[1][2] - q[0][2] * q[1][1]) / det;
+    q_inv[1][0] = q_inv[0][1];
+    q_inv[1][1] = (q[0][0] * q[2][2] - q[0][2] * q[2][0]) / det;
+    q_inv[1][2] = (q[0][2] * q[1][0] - q[0][0] * q[1][2]) / det;
+    q_inv[2][0] = q_inv[0][2];
+    q_inv[2][1] = q_inv[1][2];
+    q_inv[2][2] = (q[0][0] * q[1][1] - q[0][1] * q[1][0]) / det;
+
+    for (int i = 0; i < 3; i++) {
+        center[i] = -(q_inv[i][0] * p[6] + q_inv[i][1] * p[7] + q_inv[i][2] * p[8]);
+    }
+
+    // (x - c)^T Q (x - c) = 1 + c^T Q c
+    k = 1.0;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            k += center[i] * q[i][j] * center[j];
+        }
+    }
+    if (k <= 0) {
+        return -EDOM;
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            q[i][j] /= k;
+        }
+    }
+
+    eigen_symmetric_3x3(q, v, eig);
+
+    double radius = 1.0;
+    double r_min = INFINITY;
+    double r_max = 0;
+
+    for (int i = 0; i < 3; i++) {
+        if (eig[i] <= 0) {
+            // Hyperboloid, the samples don't cover enough orientations.
+            return -EDOM;
+        }
+        const double r = 1 / sqrt(eig[i]);
+
+        radius *= r;
+        r_min = r < r_min ? r : r_min;
+        r_max = r > r_max ? r : r_max;
+    }
+    radius = cbrt(radius);
+
+    // transform = V * diag(sqrt(eig) * radius) * V^T
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            double sum = 0;
+
+            for (int e = 0; e < 3; e++) {
+                sum += v[i][e] * sqrt(eig[e]) * radius * v[j][e];
+            }
+            p_result->transform[i][j] = sum;
+        }
+        p_result->center[i] = center[i] * p_fit->scale;
+    }
+    p_result->radius = radius * p_fit->scale;
+    p_result->axis_ratio = r_max / r_min;
+
+    // Residual sum of squares from the normal equations: p^T A p - 2 p^T b + n
+    double residual = p_fit->weight;
+
+    for (int i = 0; i < N; i++) {
+        double row = 0;
+
+        for (int j = 0; j < N; j++) {
+            row += (j >= i ? p_fit->ata[i][j] : p_fit->ata[j][i]) * p[j];
+        }
+        residual += p[i] * row - 2 * p[i] * p_fit->atb[i];
+    }
+    p_result->fit_error = residual > 0 ? sqrt(residual / p_fit->weight) : 0;
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/jakkra/ZSWatch/>.
+ * Copyright (c) 2025 ZSWatch Project, Leonardo Bispo, Jakob Krantz.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Incremental least squares fit of a general ellipsoid
+ *     a*x^2 + b*y^2 + c*z^2 + 2d*xy + 2e*xz + 2f*yz + 2g*x + 2h*y + 2i*z = 1
+ * Only the 9x9 normal equations are kept, so memory does not grow with the number
+ * of samples. Old samples fade out with the forgetting factor, which lets the fit
+ * follow slow changes such as a new strap or nearby metal.
+ */
+
+#define ZSW_ELLIPSOID_FIT_PARAMS    9
+
+typedef struct zsw_ellipsoid_fit_t {
+    double ata[ZSW_ELLIPSOID_FIT_PARAMS][ZSW_ELLIPSOID_FIT_PARAMS];
+    double atb[ZSW_ELLIPSOID_FIT_PARAMS];
+    double weight;                      /**< Sum of sample weights after forgetting. */
+    float scale;                        /**< Samples are divided by this to keep the sums well conditioned. */
+    float forgetting;                   /**< Weight kept by old samples each time a new one is added, 0 < f <= 1. */
+} zsw_ellipsoid_fit_t;
+
+typedef struct zsw_ellipsoid_t {
+    float center[3];                    /**< Offset to subtract, same unit as the samples. */
+    float transform[3][3];              /**< Symmetric matrix mapping the centered ellipsoid to a sphere. */
+    float radius;                       /**< Radius of that sphere, geometric mean of the ellipsoid radii. */
+    float axis_ratio;                   /**< Longest / shortest ellipsoid axis, 1 for a sphere. */
+    float fit_error;                    /**< RMS of the algebraic residual, 0 for a perfect fit. */
+} zsw_ellipsoid_t;
+
+/** @brief              Clear the fit.
+ *  @param p_fit        Fit state
+ *  @param scale        Typical sample magnitude, ex. the expected field strength
+ *  @param forgetting   Weight kept by old samples for each new sample, 1 never forgets
+*/
+void zsw_ellipsoid_fit_init(zsw_ellipsoid_fit_t *p_fit, float scale, float forgetting);
+
+/** @brief              Add one sample.
+*/
+void zsw_ellipsoid_fit_add(zsw_ellipsoid_fit_t *p_fit, float x, float y, float z);
+
+/** @brief              Solve for the ellipsoid from the samples added so far.
+ *  @param p_fit        Fit state, unchanged
+ *  @param p_result     Where to store the ellipsoid
+ *  @return             0 on success, -EAGAIN if too few samples, -EDOM if the samples don't describe an ellipsoid
+*/
+int zsw_ellipsoid_fit_solve(const zsw_ellipsoid_fit_t *p_fit, zsw_ellipsoid_t *p_result);
@@ -0,0 +1,415 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/jakkra/ZSWatch/>.
+ * Copyright (c) 2025 ZSWatch Project, Leonardo Bispo, Jakob Krantz.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/zbus/zbus.h>
+#include <math.h>
+#include <string.h>
+
+#include "events/accel_event.h"
+#include "sensor_fusion/zsw_ellipsoid_fit.h"
+#include "sensor_fusion/zsw_sensor_calibration.h"
+
+LOG_MODULE_REGISTER(sf_calib, CONFIG_ZSW_SENSORS_FUSION_LOG_LEVEL);
+
+#define SETTINGS_NAME_CALIB             "sf_calib"
+#define SETTINGS_KEY_DATA               "data"
+#define SETTINGS_CALIB_DATA             SETTINGS_NAME_CALIB "/" SETTINGS_KEY_DATA
+#define CALIB_STORAGE_VERSION           1
+
+// Fusion samples at 100 Hz, 2 s of still gyroscope samples gives one bias estimate.
+#define GYRO_STILL_THRESHOLD_DPS        3.0f
+#define GYRO_STILL_SAMPLES              200
+#define GYRO_MAX_BIAS_DPS               5.0f
+#define GYRO_BIAS_BLEND                 0.25f
+
+#define ACCEL_MIN_SPACING_G             0.25f
+#define ACCEL_FORGETTING                0.98f
+#define ACCEL_MIN_SAMPLES               12
+#define ACCEL_MAX_RADIUS_ERROR_G        0.1f
+#define ACCEL_MAX_OFFSET_G              0.2f
+#define ACCEL_MAX_AXIS_RATIO            1.1f
+
+#define MAG_EXPECTED_FIELD_UT           50.0f
+#define MAG_MIN_SPACING_UT              3.0f
+#define MAG_FORGETTING                  0.995f
+#define MAG_MIN_SAMPLES                 100
+#define MAG_SOLVE_INTERVAL              25
+#define MAG_MIN_FIELD_UT                20.0f
+#define MAG_MAX_FIELD_UT                80.0f
+#define MAG_MAX_AXIS_RATIO              1.5f
+#define MAG_MAX_FIT_ERROR               0.1f
+
+// Smaller changes since the last write are kept in RAM only, the bias drifts a little with every still window.
+#define SAVE_GYRO_THRESHOLD_DPS         0.1f
+#define SAVE_ACCEL_THRESHOLD_G          0.01f
+#define SAVE_MAG_THRESHOLD_UT           1.0f
+// A sensor that got calibrated for the first time is written soon, not after the long delay.
+#define SAVE_NEW_SENSOR_DELAY_S         10
+
+typedef struct {
+    uint8_t version;
+    zsw_sensor_fusion_calibration_t calibration;
+} calib_storage_t;
+
+static void zbus_accel_data_callback(const struct zbus_channel *chan);
+static void calibration_save_work_handler(struct k_work *work);
+
+ZBUS_CHAN_DECLARE(accel_data_chan);
+ZBUS_LISTENER_DEFINE(zsw_sensor_calibration_lis, zbus_accel_data_callback);
+
+K_WORK_DELAYABLE_DEFINE(calibration_save_work, calibration_save_work_handler);
+static K_MUTEX_DEFINE(calibration_mutex);
+
+static zsw_sensor_fusion_calibration_t calibration;
+// What is in flash, to tell if a change is worth a write.
+static zsw_sensor_fusion_calibration_t saved_calibration;
+static atomic_t calibration_generation;
+static atomic_t imu_no_motion;
+
+static FusionVector gyro_sum;
+static FusionVector accel_sum;
+static uint32_t still_samples;
+static uint32_t gyro_updates;
+
+static zsw_ellipsoid_fit_t accel_fit;
+static FusionVector accel_last_accepted;
+
+static zsw_ellipsoid_fit_t mag_fit;
+static zsw_ellipsoid_t mag_last_fit;
+static FusionVector mag_last_accepted;
+static uint32_t mag_new_samples;
+
+static void zbus_accel_data_callback(const struct zbus_channel *chan)
+{
+    const struct accel_event *event = zbus_chan_const_msg(chan);
+
+    switch (event->data.type) {
+        case ZSW_IMU_EVT_TYPE_NO_MOTION:
+            atomic_set(&imu_no_motion, true);
+            break;
+        case ZSW_IMU_EVT_TYPE_ANY_MOTION:
+        case ZSW_IMU_EVT_TYPE_STEP:
+        case ZSW_IMU_EVT_TYPE_GESTURE:
+        case ZSW_IMU_EVT_TYPE_WRIST_WAKEUP:
+        case ZSW_IMU_EVT_TYPE_SIGNIFICANT_MOTION:
+            atomic_set(&imu_no_motion, false);
+            break;
+        default:
+            break;
+    }
+}
+
+static void calibration_save_work_handler(struct k_work *work)
+{
+    calib_storage_t storage = {
+        .version = CALIB_STORAGE_VERSION,
+    };
+
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+    storage.calibration = calibration;
+    k_mutex_unlock(&calibration_mutex);
+
+    if (settings_save_one(SETTINGS_CALIB_DATA, &storage, sizeof(storage)) != 0) {
+        LOG_ERR("Failed to save sensor calibration");
+        return;
+    }
+
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+    saved_calibration = storage.calibration;
+    k_mutex_unlock(&calibration_mutex);
+}
+
+static float vector_distance(FusionVector a, FusionVector b)
+{
+    return FusionVectorMagnitude(FusionVectorSubtract(a, b));
+}
+
+// Called with calibration_mutex held.
+static bool calibration_moved(void)
+{
+    return vector_distance(calibration.gyro_offset, saved_calibration.gyro_offset) > SAVE_GYRO_THRESHOLD_DPS ||
+           vector_distance(calibration.accel_offset, saved_calibration.accel_offset) > SAVE_ACCEL_THRESHOLD_G ||
+           vector_distance(calibration.hard_iron, saved_calibration.hard_iron) > SAVE_MAG_THRESHOLD_UT;
+}
+
+// Called with calibration_mutex held.
+static void calibration_changed(void)
+{
+    atomic_inc(&calibration_generation);
+
+    if (calibration.flags != saved_calibration.flags) {
+        if (!k_work_delayable_is_pending(&calibration_save_work) ||
+            k_work_delayable_remaining_get(&calibration_save_work) > k_sec_to_ticks_ceil32(SAVE_NEW_SENSOR_DELAY_S)) {
+            k_work_reschedule(&calibration_save_work, K_SECONDS(SAVE_NEW_SENSOR_DELAY_S));
+        }
+    } else if (calibration_moved()) {
+        // Not rescheduled, so a calibration that keeps improving is written at most once per delay.
+        k_work_schedule(&calibration_save_work, K_SECONDS(CONFIG_SENSOR_FUSION_CALIBRATION_SAVE_DELAY_S));
+    }
+}
+
+static void ellipsoid_to_calibration(const zsw_ellipsoid_t *p_ellipsoid, float scale, FusionMatrix *p_matrix,
+                                     FusionVector *p_offset)
+{
+    for (int i = 0; i < 3; i++) {
+        p_offset->array[i] = p_ellipsoid->center[i];
+        for (int j = 0; j < 3; j++) {
+            p_matrix->array[i][j] = p_ellipsoid->transform[i][j] * scale;
+        }
+    }
+}
+
+static void calibration_feed_accel(FusionVector accel_mean)
+{
+    zsw_ellipsoid_t fit;
+
+    // Only new orientations add information, the watch mostly rests in a few.
+    if (accel_fit.weight > 0 && vector_distance(accel_mean, accel_last_accepted) < ACCEL_MIN_SPACING_G) {
+        return;
+    }
+    accel_last_accepted = accel_mean;
+    zsw_ellipsoid_fit_add(&accel_fit, accel_mean.axis.x, accel_mean.axis.y, accel_mean.axis.z);
+
+    if (accel_fit.weight < ACCEL_MIN_SAMPLES || zsw_ellipsoid_fit_solve(&accel_fit, &fit) != 0) {
+        return;
+    }
+
+    const float offset = sqrtf(fit.center[0] * fit.center[0] + fit.center[1] * fit.center[1] +
+                               fit.center[2] * fit.center[2]);
+
+    if (fabsf(fit.radius - 1.0f) > ACCEL_MAX_RADIUS_ERROR_G || offset > ACCEL_MAX_OFFSET_G ||
+        fit.axis_ratio > ACCEL_MAX_AXIS_RATIO) {
+        LOG_DBG("Accel fit rejected: radius %.3f, offset %.3f, ratio %.3f", fit.radius, offset, fit.axis_ratio);
+        return;
+    }
+
+    // Scale the sphere to exactly 1 g.
+    ellipsoid_to_calibration(&fit, 1.0f / fit.radius, &calibration.accel_misalignment, &calibration.accel_offset);
+    calibration.flags |= ZSW_SENSOR_FUSION_CALIBRATION_ACCEL;
+    calibration_changed();
+    LOG_INF("Accel calibrated: offset %.3f %.3f %.3f g", fit.center[0], fit.center[1], fit.center[2]);
+}
+
+static void calibration_feed_gyro(FusionVector gyroscope, FusionVector accelerometer)
+{
+    if (still_samples > 0) {
+        const FusionVector mean = FusionVectorMultiplyScalar(gyro_sum, 1.0f / still_samples);
+        const FusionVector diff = FusionVectorSubtract(gyroscope, mean);
+
+        if (fabsf(diff.axis.x) > GYRO_STILL_THRESHOLD_DPS || fabsf(diff.axis.y) > GYRO_STILL_THRESHOLD_DPS ||
+            fabsf(diff.axis.z) > GYRO_STILL_THRESHOLD_DPS) {
+            still_samples = 0;
+        }
+    }
+
+    if (still_samples == 0) {
+        gyro_sum = FUSION_VECTOR_ZERO;
+        accel_sum = FUSION_VECTOR_ZERO;
+    }
+
+    gyro_sum = FusionVectorAdd(gyro_sum, gyroscope);
+    accel_sum = FusionVectorAdd(accel_sum, accelerometer);
+    still_samples++;
+
+    // The IMU already confirmed that the watch is still, a shorter window is enough.
+    const uint32_t required = atomic_get(&imu_no_motion) ? GYRO_STILL_SAMPLES / 2 : GYRO_STILL_SAMPLES;
+
+    if (still_samples < required) {
+        return;
+    }
+
+    const FusionVector bias = FusionVectorMultiplyScalar(gyro_sum, 1.0f / still_samples);
+    const FusionVector accel_mean = FusionVectorMultiplyScalar(accel_sum, 1.0f / still_samples);
+
+    still_samples = 0;
+
+    // A slow constant rotation looks still too, but is far outside the gyroscope bias spec.
+    if (fabsf(bias.axis.x) > GYRO_MAX_BIAS_DPS || fabsf(bias.axis.y) > GYRO_MAX_BIAS_DPS ||
+        fabsf(bias.axis.z) > GYRO_MAX_BIAS_DPS) {
+        return;
+    }
+
+    if (calibration.flags & ZSW_SENSOR_FUSION_CALIBRATION_GYRO) {
+        calibration.gyro_offset = FusionVectorAdd(calibration.gyro_offset,
+                                                  FusionVectorMultiplyScalar(FusionVectorSubtract(bias, calibration.gyro_offset), GYRO_BIAS_BLEND));
+    } else {
+        calibration.gyro_offset = bias;
+        calibration.flags |= ZSW_SENSOR_FUSION_CALIBRATION_GYRO;
+    }
+    gyro_updates++;
+    calibration_changed();
+    LOG_DBG("Gyro bias %.3f %.3f %.3f dps", calibration.gyro_offset.axis.x, calibration.gyro_offset.axis.y,
+            calibration.gyro_offset.axis.z);
+
+    calibration_feed_accel(accel_mean);
+}
+
+static void calibration_feed_mag(FusionVector magnetometer)
+{
+    zsw_ellipsoid_t fit;
+
+    // The magnetometer is slower than the fusion, skip repeated and too close samples.
+    if (mag_fit.weight > 0 && vector_distance(magnetometer, mag_last_accepted) < MAG_MIN_SPACING_UT) {
+        return;
+    }
+    mag_last_accepted = magnetometer;
+    zsw_ellipsoid_fit_add(&mag_fit, magnetometer.axis.x, magnetometer.axis.y, magnetometer.axis.z);
+    mag_new_samples++;
+
+    if (mag_fit.weight < MAG_MIN_SAMPLES || mag_new_samples < MAG_SOLVE_INTERVAL) {
+        return;
+    }
+    mag_new_samples = 0;
+
+    if (zsw_ellipsoid_fit_solve(&mag_fit, &fit) != 0) {
+        return;
+    }
+
+    if (fit.radius < MAG_MIN_FIELD_UT || fit.radius > MAG_MAX_FIELD_UT || fit.axis_ratio > MAG_MAX_AXIS_RATIO ||
+        fit.fit_error > MAG_MAX_FIT_ERROR) {
+        LOG_DBG("Mag fit rejected: field %.1f, ratio %.3f, error %.3f", fit.radius, fit.axis_ratio, fit.fit_error);
+        return;
+    }
+
+    ellipsoid_to_calibration(&fit, 1.0f, &calibration.soft_iron, &calibration.hard_iron);
+    calibration.flags |= ZSW_SENSOR_FUSION_CALIBRATION_MAG;
+    mag_last_fit = fit;
+    calibration_changed();
+    LOG_INF("Mag calibrated: hard iron %.1f %.1f %.1f uT, field %.1f uT", fit.center[0], fit.center[1],
+            fit.center[2], fit.radius);
+}
+
+static void calibration_reset_fits(void)
+{
+    zsw_ellipsoid_fit_init(&accel_fit, 1.0f, ACCEL_FORGETTING);
+    zsw_ellipsoid_fit_init(&mag_fit, MAG_EXPECTED_FIELD_UT, MAG_FORGETTING);
+    memset(&mag_last_fit, 0, sizeof(mag_last_fit));
+    still_samples = 0;
+    mag_new_samples = 0;
+    gyro_updates = 0;
+}
+
+static int calibration_load(const char *p_key, size_t len, settings_read_cb read_cb, void *p_cb_arg, void *p_param)
+{
+    calib_storage_t storage;
+
+    ARG_UNUSED(p_key);
+
+    if (len != sizeof(storage)) {
+        LOG_WRN("Stored sensor calibration has wrong size, ignoring");
+        return 0;
+    }
+
+    if (read_cb(p_cb_arg, &storage, len) != sizeof(storage)) {
+        LOG_ERR("Error reading sensor calibration");
+        return -EIO;
+    }
+
+    if (storage.version != CALIB_STORAGE_VERSION) {
+        LOG_WRN("Stored sensor calibration version %d not supported", storage.version);
+        return 0;
+    }
+
+    calibration = storage.calibration;
+    saved_calibration = storage.calibration;
+    LOG_INF("Sensor calibration loaded, flags 0x%x", calibration.flags);
+
+    return 0;
+}
+
+int zsw_sensor_calibration_init(void)
+{
+    int ret;
+
+    calibration_reset_fits();
+
+    if (settings_subsys_init()) {
+        LOG_ERR("Error during settings_subsys_init!");
+        return -EFAULT;
+    }
+
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+    ret = settings_load_subtree_direct(SETTINGS_CALIB_DATA, calibration_load, NULL);
+    k_mutex_unlock(&calibration_mutex);
+    if (ret) {
+        LOG_ERR("Error during settings_load_subtree!");
+    }
+    atomic_inc(&calibration_generation);
+
+    return zbus_chan_add_obs(&accel_data_chan, &zsw_sensor_calibration_lis, K_MSEC(100));
+}
+
+void zsw_sensor_calibration_feed(FusionVector gyroscope, FusionVector accelerometer, const FusionVector *p_magnetometer)
+{
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+
+    calibration_feed_gyro(gyroscope, accelerometer);
+    if (p_magnetometer != NULL) {
+        calibration_feed_mag(*p_magnetometer);
+    }
+
+    k_mutex_unlock(&calibration_mutex);
+}
+
+uint32_t zsw_sensor_calibration_get_generation(void)
+{
+    return atomic_get(&calibration_generation);
+}
+
+uint32_t zsw_sensor_calibration_get(zsw_sensor_fusion_calibration_t *p_calibration)
+{
+    uint32_t generation;
+
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+    *p_calibration = calibration;
+    generation = atomic_get(&calibration_generation);
+    k_mutex_unlock(&calibration_mutex);
+
+    return generation;
+}
+
+void zsw_sensor_calibration_get_status(zsw_sensor_calibration_status_t *p_status)
+{
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+    p_status->flags = calibration.flags;
+    p_status->generation = atomic_get(&calibration_generation);
+    p_status->gyro_updates = gyro_updates;
+    p_status->accel_samples = accel_fit.weight;
+    p_status->mag_samples = mag_fit.weight;
+    p_status->mag_field = mag_last_fit.radius;
+    p_status->mag_axis_ratio = mag_last_fit.axis_ratio;
+    p_status->mag_fit_error = mag_last_fit.fit_error;
+    k_mutex_unlock(&calibration_mutex);
+}
+
+int zsw_sensor_calibration_reset(void)
+{
+    k_work_cancel_delayable(&calibration_save_work);
+
+    k_mutex_lock(&calibration_mutex, K_FOREVER);
+    memset(&calibration, 0, sizeof(calibration));
+    memset(&saved_calibration, 0, sizeof(saved_calibration));
+    calibration_reset_fits();
+    atomic_inc(&calibration_generation);
+    k_mutex_unlock(&calibration_mutex);
+
+    return settings_delete(SETTINGS_CALIB_DATA);
+}
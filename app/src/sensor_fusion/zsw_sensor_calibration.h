@@ -0,0 +1,112 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/jakkra/ZSWatch/>.
+ * Copyright (c) 2025 ZSWatch Project, Leonardo Bispo, Jakob Krantz.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "sensor_fusion/zsw_sensor_fusion_core.h"
+
+/*
+ * Online calibration of the sensors feeding the sensor fusion, learnt from the
+ * samples the fusion already reads and persisted in settings:
+ * - Gyroscope bias, averaged while the watch lies still.
+ * - Accelerometer offset and scale, ellipsoid fit of the still periods in different orientations.
+ * - Magnetometer hard and soft iron, ellipsoid fit of the field while the watch is moved around.
+ */
+
+typedef struct zsw_sensor_calibration_status_t {
+    uint32_t flags;                     /**< zsw_sensor_fusion_calibration_flags_t of valid corrections. */
+    uint32_t generation;                /**< Incremented every time the calibration changes. */
+    uint32_t gyro_updates;              /**< Still periods used for the gyroscope bias since boot. */
+    float accel_samples;                /**< Weight of the orientations in the accelerometer fit. */
+    float mag_samples;                  /**< Weight of the samples in the magnetometer fit. */
+    float mag_field;                    /**< Field strength of the last accepted magnetometer fit, uT. */
+    float mag_axis_ratio;               /**< Soft iron distortion of the last accepted fit, 1 is none. */
+    float mag_fit_error;                /**< Residual of the last accepted fit. */
+} zsw_sensor_calibration_status_t;
+
+#ifdef CONFIG_SENSOR_FUSION_ONLINE_CALIBRATION
+
+/** @brief Load the stored calibration and start tracking the IMU motion state.
+ *  @return 0 on success, negative error code on failure.
+*/
+int zsw_sensor_calibration_init(void);
+
+/** @brief                  Learn from one uncalibrated sample, called by the sensor fusion.
+ *  @param gyroscope        Angular rate in deg/s
+ *  @param accelerometer    Acceleration in g
+ *  @param p_magnetometer   Magnetic field in uT, NULL if not read
+*/
+void zsw_sensor_calibration_feed(FusionVector gyroscope, FusionVector accelerometer, const FusionVector *p_magnetometer);
+
+/** @brief Get the generation of the current calibration, cheap enough to poll for every sample.
+*/
+uint32_t zsw_sensor_calibration_get_generation(void);
+
+/** @brief                  Get the current calibration.
+ *  @param p_calibration    Where to store the calibration
+ *  @return                 Generation of the returned calibration.
+*/
+uint32_t zsw_sensor_calibration_get(zsw_sensor_fusion_calibration_t *p_calibration);
+
+/** @brief                  Get the progress of the calibration.
+*/
+void zsw_sensor_calibration_get_status(zsw_sensor_calibration_status_t *p_status);
+
+/** @brief Forget everything learnt and erase the stored calibration.
+ *  @return 0 on success, negative error code on failure.
+*/
+int zsw_sensor_calibration_reset(void);
+
+#else
+
+static inline int zsw_sensor_calibration_init(void)
+{
+    return 0;
+}
+
+static inline void zsw_sensor_calibration_feed(FusionVector gyroscope, FusionVector accelerometer,
+                                               const FusionVector *p_magnetometer)
+{
+}
+
+static inline uint32_t zsw_sensor_calibration_get_generation(void)
+{
+    return 0;
+}
+
+static inline uint32_t zsw_sensor_calibration_get(zsw_sensor_fusion_calibration_t *p_calibration)
+{
+    p_calibration->flags = 0;
+    return 0;
+}
+
+static inline void zsw_sensor_calibration_get_status(zsw_sensor_calibration_status_t *p_status)
+{
+    *p_status = (zsw_sensor_calibration_status_t) {
+        0
+    };
+}
+
+static inline int zsw_sensor_calibration_reset(void)
+{
+    return -ENOTSUP;
+}
+
+#endif
@@ -28,8 +28,11 @@
 #include "../ext_drivers/fusion/Fusion/FusionCompass.h"
 
 #include "sensor_fusion/zsw_sensor_fusion.h"
+#include "sensor_fusion/zsw_sensor_fusion_core.h"
+#include "sensor_fusion/zsw_sensor_calibration.h"
 #include "../sensors/zsw_imu.h"
 #include "../sensors/zsw_magnetometer.h"
+#include "../sensors/zsw_sensor_scheduler.h"
 #include "../ble/zsw_gatt_sensor_server.h"
 #include <string.h>
 
@@ -45,172 +48,221 @@ LOG_MODULE_REGISTER(sf, CONFIG_ZSW_SENSORS_FUSION_LOG_LEVEL);
 static void sensor_fusion_timeout(struct k_work *item);
 K_WORK_DELAYABLE_DEFINE(sensor_fusion_timer, sensor_fusion_timeout);
 
-// Define calibration (replace with actual calibration data if available)
-static const FusionMatrix gyroscopeMisalignment = {.element.xx = 1.0f,
-                                                   .element.xy = 0.0f,
-                                                   .element.xz = 0.0f,
-                                                   .element.yx = 0.0f,
-                                                   .element.yy = 1.0f,
-                                                   .element.yz = 0.0f,
-                                                   .element.zx = 0.0f,
-                                                   .element.zy = 0.0f,
-                                                   .element.zz = 1.0f
-                                                  };
-static const FusionVector gyroscopeSensitivity = {{1.0f, 1.0f, 1.0f}};
-static const FusionVector gyroscopeOffset = {{0.0f, 0.0f, 0.0f}};
-static const FusionMatrix accelerometerMisalignment = {.element.xx = 1.0f,
-                                                       .element.xy = 0.0f,
-                                                       .element.xz = 0.0f,
-                                                       .element.yx = 0.0f,
-                                                       .element.yy = 1.0f,
-                                                       .element.yz = 0.0f,
-                                                       .element.zx = 0.0f,
-                                                       .element.zy = 0.0f,
-                                                       .element.zz = 1.0f
-                                                      };
-static const FusionVector accelerometerSensitivity = {{1.0f, 1.0f, 1.0f}};
-static const FusionVector accelerometerOffset = {{0.0f, 0.0f, 0.0f}};
-#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-static const FusionMatrix softIronMatrix = {.element.xx = 1.0f,
-                                            .element.xy = 0.0f,
-                                            .element.xz = 0.0f,
-                                            .element.yx = 0.0f,
-                                            .element.yy = 1.0f,
-                                            .element.yz = 0.0f,
-                                            .element.zx = 0.0f,
-                                            .element.zy = 0.0f,
-                                            .element.zz = 1.0f
-                                           };
-static const FusionVector hardIronOffset = {{0.0f, 0.0f, 0.0f}};
-#endif
-
 // Initialise algorithms
-static FusionOffset offset;
-static FusionAhrs ahrs;
+static zsw_sensor_fusion_core_t core;
 static int32_t previousTimestamp;
-static sensor_fusion_t readings;
+static FusionVector readings_earth;
 static struct k_work_sync cancel_work_sync;
 static zsw_quat_t readings_quat;
 static float last_delta_time_s = 0.0f;
 static atomic_t sensor_fusion_users = ATOMIC_INIT(0);
+static uint32_t calibration_generation;
+// Only keep the gyroscope and magnetometer powered, samples come from the IMU FIFO or polling below.
+static zsw_sensor_sched_request_t imu_request = {
+    .sensor = ZSW_SENSOR_SCHED_IMU,
+};
+#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
+static zsw_sensor_sched_request_t mag_request = {
+    .sensor = ZSW_SENSOR_SCHED_MAG,
+};
+#endif
+#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
+static FusionVector magnetometer;
+#endif
+#ifdef CONFIG_SENSOR_FUSION_USE_IMU_FIFO
+static bool fifo_active;
+static bool fifo_time_valid;
+static uint32_t fifo_previous_timestamp_us;
+static float fifo_accel_scale;
+static float fifo_gyro_scale;
+#endif
 
 #ifdef CONFIG_SEND_SENSOR_READING_OVER_RTT
 #define UP_BUFFER_SIZE 256
 static uint8_t up_buffer[UP_BUFFER_SIZE];
 #endif
 
-static void sensor_fusion_timeout(struct k_work *work)
+static void sensor_fusion_load_calibration(void)
 {
-    int ret = 0;
-
-    FusionVector gyroscope;
-    FusionVector accelerometer;
-#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    FusionVector magnetometer;
-#endif
+    zsw_sensor_fusion_calibration_t calibration;
 
-    uint32_t start = k_uptime_get_32();
-    ret = zsw_imu_fetch_gyro_f(&gyroscope.axis.x, &gyroscope.axis.y, &gyroscope.axis.z);
-    if (ret != 0) {
-        LOG_ERR("zsw_imu_fetch_gyro_f err: %d", ret);
-    }
-    // Convert from rad/s to deg/s
-    gyroscope.axis.x = gyroscope.axis.x * (180.0F / M_PI);
-    gyroscope.axis.y = gyroscope.axis.y * (180.0F / M_PI);
-    gyroscope.axis.z = gyroscope.axis.z * (180.0F / M_PI);
-
-    ret = zsw_imu_fetch_accel_f(&accelerometer.axis.x, &accelerometer.axis.y, &accelerometer.axis.z);
-    if (ret != 0) {
-        LOG_ERR("zsw_imu_fetch_accel_f err: %d", ret);
-    }
-    // IMU driver converts to m/s2 by multiplying to 10, convert back to g-force
-    accelerometer.axis.x /= SENSOR_GF;
-    accelerometer.axis.y /= SENSOR_GF;
-    accelerometer.axis.z /= SENSOR_GF;
-
-#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    ret = zsw_magnetometer_get_all(&magnetometer.axis.x, &magnetometer.axis.y, &magnetometer.axis.z);
-    if (ret != 0) {
-        LOG_ERR("zsw_magnetometer_get_all err: %d", ret);
-    }
-#endif
+    calibration_generation = zsw_sensor_calibration_get(&calibration);
+    zsw_sensor_fusion_core_set_calibration(&core, &calibration);
+}
 
-    // Apply calibration
-    gyroscope = FusionCalibrationInertial(gyroscope, gyroscopeMisalignment, gyroscopeSensitivity, gyroscopeOffset);
-    accelerometer = FusionCalibrationInertial(accelerometer, accelerometerMisalignment, accelerometerSensitivity,
-                                              accelerometerOffset);
+static void sensor_fusion_update(FusionVector gyroscope, FusionVector accelerometer, float deltaTime)
+{
 #ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    magnetometer = FusionCalibrationMagnetic(magnetometer, softIronMatrix, hardIronOffset);
+    const FusionVector *p_magnetometer = &magnetometer;
+#else
+    const FusionVector *p_magnetometer = NULL;
 #endif
 
-    // Update gyroscope offset correction algorithm
-    gyroscope = FusionOffsetUpdate(&offset, gyroscope);
-
-    // Calculate delta time (in seconds) to account for gyroscope sample clock error
-    const float deltaTime = (start - previousTimestamp) / 1000.0f;
-    previousTimestamp = start;
     last_delta_time_s = deltaTime > 0 ? deltaTime : last_delta_time_s;
 
-    // Update gyroscope AHRS algorithm
-#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    FusionAhrsUpdate(&ahrs, gyroscope, accelerometer, magnetometer, deltaTime);
-#else
-    FusionAhrsUpdateNoMagnetometer(&ahrs, gyroscope, accelerometer, deltaTime);
-#endif
-    // Print algorithm outputs
-    const FusionQuaternion q = FusionAhrsGetQuaternion(&ahrs);
-    const FusionEuler euler = FusionQuaternionToEuler(q);
-    const FusionVector earth = FusionAhrsGetEarthAcceleration(&ahrs);
-#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    float heading = FusionCompassCalculateHeading(FusionConventionNwu, accelerometer, magnetometer);
-#endif
+    zsw_sensor_calibration_feed(gyroscope, accelerometer, p_magnetometer);
+    if (zsw_sensor_calibration_get_generation() != calibration_generation) {
+        sensor_fusion_load_calibration();
+    }
+
+    zsw_sensor_fusion_core_update(&core, gyroscope, accelerometer, p_magnetometer, deltaTime);
 
-    readings.pitch = euler.angle.pitch;
-    readings.roll = euler.angle.roll;
-    readings.yaw = euler.angle.yaw;
-    readings.x = earth.axis.x;
-    readings.y = earth.axis.y;
-    readings.z = earth.axis.z;
+    // Only the quaternion is kept per sample, Euler angles are derived when fetched.
+    const FusionQuaternion q = FusionAhrsGetQuaternion(&core.ahrs);
 
     readings_quat.w = q.element.w;
     readings_quat.x = q.element.x;
     readings_quat.y = q.element.y;
     readings_quat.z = q.element.z;
 
+#ifdef CONFIG_SENSOR_FUSION_EARTH_ACCELERATION
+    readings_earth = FusionAhrsGetEarthAcceleration(&core.ahrs);
+#endif
+
+    if (IS_ENABLED(CONFIG_ZSW_SENSORS_FUSION_LOG_LEVEL_DBG)) {
+        const FusionEuler euler = FusionQuaternionToEuler(q);
 #ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    LOG_DBG("Roll %0.1f, Pitch %0.1f, Yaw %0.1f, Head: %01f, X %0.2f, Y %0.2f, Z %0.1f, X %0.1f, Y %0.1f, Z %0.1f, X %0.1f, Y %0.1f, Z %0.1f\n",
-            euler.angle.roll, euler.angle.pitch,
-            euler.angle.yaw, heading, /*earth.axis.x, earth.axis.y, earth.axis.z*/ accelerometer.axis.x, accelerometer.axis.y,
-            accelerometer.axis.z, gyroscope.axis.x, gyroscope.axis.y, gyroscope.axis.z, magnetometer.axis.x, magnetometer.axis.y,
-            magnetometer.axis.z );
+        float heading = FusionCompassCalculateHeading(FusionConventionNwu, accelerometer, magnetometer);
+
+        LOG_DBG("Roll %0.1f, Pitch %0.1f, Yaw %0.1f, Head: %01f, X %0.2f, Y %0.2f, Z %0.1f, X %0.1f, Y %0.1f, Z %0.1f, X %0.1f, Y %0.1f, Z %0.1f\n",
+                euler.angle.roll, euler.angle.pitch,
+                euler.angle.yaw, heading, accelerometer.axis.x, accelerometer.axis.y,
+                accelerometer.axis.z, gyroscope.axis.x, gyroscope.axis.y, gyroscope.axis.z, magnetometer.axis.x, magnetometer.axis.y,
+                magnetometer.axis.z );
 #else
-    LOG_DBG("Roll %0.1f, Pitch %0.1f, Yaw %0.1f, X %0.2f, Y %0.2f, Z %0.1f, X %0.1f, Y %0.1f, Z %0.1f\n",
-            euler.angle.roll, euler.angle.pitch,
-            euler.angle.yaw, accelerometer.axis.x, accelerometer.axis.y,
-            accelerometer.axis.z, gyroscope.axis.x, gyroscope.axis.y, gyroscope.axis.z);
+        LOG_DBG("Roll %0.1f, Pitch %0.1f, Yaw %0.1f, X %0.2f, Y %0.2f, Z %0.1f, X %0.1f, Y %0.1f, Z %0.1f\n",
+                euler.angle.roll, euler.angle.pitch,
+                euler.angle.yaw, accelerometer.axis.x, accelerometer.axis.y,
+                accelerometer.axis.z, gyroscope.axis.x, gyroscope.axis.y, gyroscope.axis.z);
 #endif
+    }
 #if CONFIG_SEND_SENSOR_READING_OVER_RTT
+    const FusionEuler rtt_euler = FusionQuaternionToEuler(q);
     uint8_t data_buf[UP_BUFFER_SIZE];
 #ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
     int len = snprintf(data_buf, UP_BUFFER_SIZE,
                        "%0.5f, %0.1f, %0.1f, %0.1f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f\n",
-                       k_uptime_get_32() / 1000.0, euler.angle.roll, euler.angle.pitch,
-                       euler.angle.yaw, gyroscope.axis.x,
+                       k_uptime_get_32() / 1000.0, rtt_euler.angle.roll, rtt_euler.angle.pitch,
+                       rtt_euler.angle.yaw, gyroscope.axis.x,
                        gyroscope.axis.y, gyroscope.axis.z,  accelerometer.axis.x, accelerometer.axis.y, accelerometer.axis.z,
                        magnetometer.axis.x, magnetometer.axis.y, magnetometer.axis.z);
 #else
     int len = snprintf(data_buf, UP_BUFFER_SIZE,
                        "%0.5f, %0.1f, %0.1f, %0.1f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f, %0.5f\n",
-                       k_uptime_get_32() / 1000.0, euler.angle.roll, euler.angle.pitch,
-                       euler.angle.yaw, gyroscope.axis.x,
+                       k_uptime_get_32() / 1000.0, rtt_euler.angle.roll, rtt_euler.angle.pitch,
+                       rtt_euler.angle.yaw, gyroscope.axis.x,
                        gyroscope.axis.y, gyroscope.axis.z, accelerometer.axis.x, accelerometer.axis.y, accelerometer.axis.z);
 #endif
     len = SEGGER_RTT_Write(CONFIG_SENSOR_LOG_RTT_TRANSFER_CHANNEL, data_buf, len);
 #endif
+}
+
+#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
+static void sensor_fusion_read_magnetometer(void)
+{
+    int ret;
+
+    ret = zsw_magnetometer_get_all(&magnetometer.axis.x, &magnetometer.axis.y, &magnetometer.axis.z);
+    if (ret != 0) {
+        LOG_ERR("zsw_magnetometer_get_all err: %d", ret);
+    }
+}
+#endif
+
+static void sensor_fusion_timeout(struct k_work *work)
+{
+    int ret = 0;
+
+    FusionVector gyroscope;
+    FusionVector accelerometer;
+
+    uint32_t start = k_uptime_get_32();
+    zsw_imu_snapshot_t imu;
+
+    ret = zsw_imu_fetch_snapshot(&imu);
+    if (ret != 0) {
+        LOG_ERR("zsw_imu_fetch_snapshot err: %d", ret);
+        k_work_schedule(&sensor_fusion_timer, K_MSEC(1000 / SAMPLE_RATE_HZ));
+        return;
+    }
+
+    // Convert from rad/s to deg/s
+    gyroscope.axis.x = imu.gyro[0] * (180.0F / M_PI);
+    gyroscope.axis.y = imu.gyro[1] * (180.0F / M_PI);
+    gyroscope.axis.z = imu.gyro[2] * (180.0F / M_PI);
+
+    // IMU driver converts to m/s2 by multiplying to 10, convert back to g-force
+    accelerometer.axis.x = imu.accel[0] / SENSOR_GF;
+    accelerometer.axis.y = imu.accel[1] / SENSOR_GF;
+    accelerometer.axis.z = imu.accel[2] / SENSOR_GF;
+
+#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
+    sensor_fusion_read_magnetometer();
+#endif
+
+    // Calculate delta time (in seconds) to account for gyroscope sample clock error
+    const float deltaTime = (start - previousTimestamp) / 1000.0f;
+    previousTimestamp = start;
+
+    sensor_fusion_update(gyroscope, accelerometer, deltaTime);
 
     k_work_schedule(&sensor_fusion_timer, K_MSEC((1000 / SAMPLE_RATE_HZ) - (k_uptime_get_32() - start)));
 }
 
+#ifdef CONFIG_SENSOR_FUSION_USE_IMU_FIFO
+static void sensor_fusion_fifo_batch(const zsw_imu_fifo_sample_t *samples, uint16_t num_samples)
+{
+    FusionVector gyroscope;
+    FusionVector accelerometer;
+    float deltaTime;
+
+#ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
+    // The magnetometer is not in the IMU FIFO, it changes slowly enough to use one reading per batch.
+    sensor_fusion_read_magnetometer();
+#endif
+
+    for (uint16_t i = 0; i < num_samples; i++) {
+        // IMU sensor time, exact sample spacing without the jitter of waking up every sample.
+        if (fifo_time_valid) {
+            deltaTime = (samples[i].timestamp_us - fifo_previous_timestamp_us) / 1000000.0f;
+        } else {
+            deltaTime = 1.0f / SAMPLE_RATE_HZ;
+            fifo_time_valid = true;
+        }
+        fifo_previous_timestamp_us = samples[i].timestamp_us;
+
+        gyroscope.axis.x = samples[i].gyro[0] * fifo_gyro_scale;
+        gyroscope.axis.y = samples[i].gyro[1] * fifo_gyro_scale;
+        gyroscope.axis.z = samples[i].gyro[2] * fifo_gyro_scale;
+
+        accelerometer.axis.x = samples[i].accel[0] * fifo_accel_scale;
+        accelerometer.axis.y = samples[i].accel[1] * fifo_accel_scale;
+        accelerometer.axis.z = samples[i].accel[2] * fifo_accel_scale;
+
+        sensor_fusion_update(gyroscope, accelerometer, deltaTime);
+    }
+}
+
+static int sensor_fusion_fifo_start(void)
+{
+    uint8_t accel_range_g;
+    uint16_t gyro_range_dps;
+    int ret;
+
+    ret = zsw_imu_fifo_get_scale(&accel_range_g, &gyro_range_dps);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // FIFO samples are raw, INT16_MAX is the full scale. Fusion wants g and deg/s.
+    fifo_accel_scale = (float)accel_range_g / INT16_MAX;
+    fifo_gyro_scale = (float)gyro_range_dps / INT16_MAX;
+    fifo_time_valid = false;
+
+    return zsw_imu_fifo_start(SAMPLE_RATE_HZ, CONFIG_SENSOR_FUSION_FIFO_BATCH_SIZE, sensor_fusion_fifo_batch);
+}
+#endif
+
 int zsw_sensor_fusion_init(void)
 {
 #if CONFIG_SEND_SENSOR_READING_OVER_RTT
@@ -224,40 +276,34 @@ int zsw_sensor_fusion_init(void)
         return 0;
     }
 
-    ret = zsw_imu_feature_enable(ZSW_IMU_FEATURE_GYRO, false);
+    ret = zsw_sensor_scheduler_request(&imu_request);
     if (ret != 0) {
-        LOG_ERR("zsw_imu_feature_enable err: %d", ret);
+        LOG_ERR("IMU request err: %d", ret);
         atomic_dec(&sensor_fusion_users);
         return ret;
     }
 
 #ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    ret = zsw_magnetometer_set_enable(true);
+    ret = zsw_sensor_scheduler_request(&mag_request);
     if (ret != 0) {
-        LOG_ERR("zsw_magnetometer_set_enable err: %d", ret);
-        zsw_imu_feature_disable(ZSW_IMU_FEATURE_GYRO);
+        LOG_ERR("Magnetometer request err: %d", ret);
+        zsw_sensor_scheduler_release(&imu_request);
         atomic_dec(&sensor_fusion_users);
         return ret;
     }
 #endif
 
-    memset(&ahrs, 0, sizeof(ahrs));
-
-    FusionOffsetInitialise(&offset, SAMPLE_RATE_HZ);
-    FusionAhrsInitialise(&ahrs);
-
-    // Set AHRS algorithm settings
-    /// @todo may want to tune more.
-    const FusionAhrsSettings settings = {
-        .convention = FusionConventionNwu,
-        .gain = 0.5f,
-        .gyroscopeRange = 2000.0f, /* app/drivers/sensor/bmi270/bosch_bmi270.c:426 */
-        .accelerationRejection = 10.0f,
-        .magneticRejection = 10.0f,
-        .recoveryTriggerPeriod = 5 * SAMPLE_RATE_HZ, /* 5 seconds */
-    };
+    zsw_sensor_fusion_core_init(&core, SAMPLE_RATE_HZ);
+    sensor_fusion_load_calibration();
 
-    FusionAhrsSetSettings(&ahrs, &settings);
+#ifdef CONFIG_SENSOR_FUSION_USE_IMU_FIFO
+    // The FIFO has a single user, fall back to polling when it's taken (ex. by the BLE IMU stream).
+    fifo_active = sensor_fusion_fifo_start() == 0;
+    if (fifo_active) {
+        return 0;
+    }
+    LOG_WRN("IMU FIFO not available, polling at %d Hz", SAMPLE_RATE_HZ);
+#endif
 
     k_work_schedule(&sensor_fusion_timer, K_MSEC(1000 / SAMPLE_RATE_HZ));
 
@@ -277,23 +323,50 @@ void zsw_sensor_fusion_deinit(void)
         return;
     }
 
+#ifdef CONFIG_SENSOR_FUSION_USE_IMU_FIFO
+    if (fifo_active) {
+        zsw_imu_fifo_stop();
+        fifo_active = false;
+    }
+#endif
     k_work_cancel_delayable_sync(&sensor_fusion_timer, &cancel_work_sync);
-    zsw_imu_feature_disable(ZSW_IMU_FEATURE_GYRO);
+    zsw_sensor_scheduler_release(&imu_request);
 #ifdef CONFIG_SENSOR_FUSION_INCLUDE_MAGNETOMETER
-    zsw_magnetometer_set_enable(false);
+    zsw_sensor_scheduler_release(&mag_request);
 #endif
 }
 
+static FusionEuler sensor_fusion_get_euler(void)
+{
+    const FusionQuaternion q = {.element = {
+            .w = readings_quat.w,
+            .x = readings_quat.x,
+            .y = readings_quat.y,
+            .z = readings_quat.z,
+        }
+    };
+
+    return FusionQuaternionToEuler(q);
+}
+
 int zsw_sensor_fusion_fetch_all(sensor_fusion_t *p_readings)
 {
-    memcpy(p_readings, &readings, sizeof(sensor_fusion_t));
+    const FusionEuler euler = sensor_fusion_get_euler();
+
+    p_readings->roll = euler.angle.roll;
+    p_readings->pitch = euler.angle.pitch;
+    p_readings->yaw = euler.angle.yaw;
+    // Zero unless CONFIG_SENSOR_FUSION_EARTH_ACCELERATION
+    p_readings->x = readings_earth.axis.x;
+    p_readings->y = readings_earth.axis.y;
+    p_readings->z = readings_earth.axis.z;
     return 0;
 }
 
 int zsw_sensor_fusion_get_heading(float *heading)
 {
     // @todo: implement, this is not correct magnetic heading. Use FusionCompassCalculateHeading
-    *heading = readings.yaw;
+    *heading = sensor_fusion_get_euler().angle.yaw;
     return 0;
 }
 
@@ -0,0 +1,76 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/jakkra/ZSWatch/>.
+ * Copyright (c) 2025 ZSWatch Project, Leonardo Bispo, Jakob Krantz.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "zsw_sensor_fusion_core.h"
+
+void zsw_sensor_fusion_core_init(zsw_sensor_fusion_core_t *p_core, unsigned int sample_rate_hz)
+{
+    memset(p_core, 0, sizeof(*p_core));
+
+    FusionOffsetInitialise(&p_core->offset, sample_rate_hz);
+    FusionAhrsInitialise(&p_core->ahrs);
+
+    // Set AHRS algorithm settings
+    /// @todo may want to tune more.
+    const FusionAhrsSettings settings = {
+        .convention = FusionConventionNwu,
+        .gain = 0.5f,
+        .gyroscopeRange = 2000.0f, /* app/drivers/sensor/bmi270/bosch_bmi270.c:426 */
+        .accelerationRejection = 10.0f,
+        .magneticRejection = 10.0f,
+        .recoveryTriggerPeriod = 5 * sample_rate_hz, /* 5 seconds */
+    };
+
+    FusionAhrsSetSettings(&p_core->ahrs, &settings);
+}
+
+void zsw_sensor_fusion_core_set_calibration(zsw_sensor_fusion_core_t *p_core,
+                                            const zsw_sensor_fusion_calibration_t *p_calibration)
+{
+    p_core->calibration = *p_calibration;
+}
+
+void zsw_sensor_fusion_core_update(zsw_sensor_fusion_core_t *p_core, FusionVector gyroscope,
+                                   FusionVector accelerometer, const FusionVector *p_magnetometer, float delta_time_s)
+{
+    const zsw_sensor_fusion_calibration_t *p_cal = &p_core->calibration;
+    FusionVector magnetometer;
+
+    // Identity corrections are skipped, so an uncalibrated sensor costs nothing.
+    if (p_cal->flags & ZSW_SENSOR_FUSION_CALIBRATION_GYRO) {
+        gyroscope = FusionVectorSubtract(gyroscope, p_cal->gyro_offset);
+    }
+    if (p_cal->flags & ZSW_SENSOR_FUSION_CALIBRATION_ACCEL) {
+        // Same matrix * (v - offset) form as the magnetometer
+        accelerometer = FusionCalibrationMagnetic(accelerometer, p_cal->accel_misalignment, p_cal->accel_offset);
+    }
+    if ((p_cal->flags & ZSW_SENSOR_FUSION_CALIBRATION_MAG) && p_magnetometer != NULL) {
+        magnetometer = FusionCalibrationMagnetic(*p_magnetometer, p_cal->soft_iron, p_cal->hard_iron);
+        p_magnetometer = &magnetometer;
+    }
+
+    // Update gyroscope offset correction algorithm
+    gyroscope = FusionOffsetUpdate(&p_core->offset, gyroscope);
+
+    if (p_magnetometer != NULL) {
+        FusionAhrsUpdate(&p_core->ahrs, gyroscope, accelerometer, *p_magnetometer, delta_time_s);
+    } else {
+        FusionAhrsUpdateNoMagnetometer(&p_core->ahrs, gyroscope, accelerometer, delta_time_s);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/jakkra/ZSWatch/>.
+ * Copyright (c) 2025 ZSWatch Project, Leonardo Bispo, Jakob Krantz.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../ext_drivers/fusion/Fusion/Fusion.h"
+
+/*
+ * Per sample part of the sensor fusion, only what is needed to keep the orientation
+ * up to date. Euler angles, heading and earth acceleration are derived from the AHRS
+ * state when asked for. No Zephyr dependencies, also built by app/tools/fusion_bench.
+ */
+
+typedef enum zsw_sensor_fusion_calibration_flags_t {
+    ZSW_SENSOR_FUSION_CALIBRATION_GYRO = 1 << 0,
+    ZSW_SENSOR_FUSION_CALIBRATION_ACCEL = 1 << 1,
+    ZSW_SENSOR_FUSION_CALIBRATION_MAG = 1 << 2,
+} zsw_sensor_fusion_calibration_flags_t;
+
+/*
+* Corrections applied before the AHRS, only for the sensors set in flags.
+* gyro = uncalibrated - gyro_offset
+* accel = accel_misalignment * (uncalibrated - accel_offset)
+* mag = soft_iron * (uncalibrated - hard_iron)
+*/
+typedef struct zsw_sensor_fusion_calibration_t {
+    uint32_t flags;
+    FusionVector gyro_offset;
+    FusionMatrix accel_misalignment;
+    FusionVector accel_offset;
+    FusionMatrix soft_iron;
+    FusionVector hard_iron;
+} zsw_sensor_fusion_calibration_t;
+
+typedef struct zsw_sensor_fusion_core {
+    FusionOffset offset;
+    FusionAhrs ahrs;
+    zsw_sensor_fusion_calibration_t calibration;
+} zsw_sensor_fusion_core_t;
+
+/** @brief                  Reset the gyroscope offset correction and the AHRS.
+ *  @param p_core           Fusion state
+ *  @param sample_rate_hz   Nominal IMU sample rate
+*/
+void zsw_sensor_fusion_core_init(zsw_sensor_fusion_core_t *p_core, unsigned int sample_rate_hz);
+
+/** @brief                  Set the corrections applied to every following sample.
+ *  @param p_core           Fusion state
+ *  @param p_calibration    Calibration, flags select which sensors are corrected
+*/
+void zsw_sensor_fusion_core_set_calibration(zsw_sensor_fusion_core_t *p_core,
+                                            const zsw_sensor_fusion_calibration_t *p_calibration);
+
+/** @brief                  Feed one IMU sample.
+ *  @param p_core           Fusion state
+ *  @param gyroscope        Angular rate in deg/s
+ *  @param accelerometer    Acceleration in g
+ *  @param p_magnetometer   Magnetic field in any unit, NULL to run without magnetometer
+ *  @param delta_time_s     Time since the previous sample
+*/
+void zsw_sensor_fusion_core_update(zsw_sensor_fusion_core_t *p_core, FusionVector gyroscope,
+                                   FusionVector accelerometer, const FusionVector *p_magnetometer, float delta_time_s);
@@ -0,0 +1,304 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "sensors/zsw_altitude.h"
+#include "sensors/zsw_pressure_sensor.h"
+#include "events/pressure_event.h"
+#include "history/zsw_history.h"
+
+LOG_MODULE_REGISTER(zsw_altitude, CONFIG_ZSW_SENSORS_LOG_LEVEL);
+
+#define SAMPLE_ODR                  BOSCH_BMP581_ODR_01_HZ
+#define SAMPLE_PERIOD_S             1.0f
+#define IIR_COEFF                   BOSCH_BMP581_IIR_COEFF_3
+// Drain before the FIFO wraps, with margin for a late workqueue.
+#define DRAIN_INTERVAL_MS           (BOSCH_BMP581_FIFO_FRAMES * 1000 * 3 / 4)
+
+// Alpha-beta filter on top of the on-chip IIR, gains for altitude and vertical speed.
+#define FILTER_ALPHA                0.3f
+#define FILTER_BETA                 0.05f
+#define DEFAULT_TEMPERATURE         15.0f
+
+#define FLOOR_HEIGHT_M              (CONFIG_ZSW_ALTITUDE_FLOOR_HEIGHT_CM / 100.0f)
+// Vertical speed of walking stairs, slower is weather drift and faster an elevator.
+#define CLIMB_SPEED_MIN             0.1f
+#define CLIMB_SPEED_MAX             1.0f
+// A partial floor survives a pause this long, like a landing between two flights of stairs.
+#define CLIMB_PAUSE_S               15.0f
+
+#define SETTING_ALTITUDE_HIST_KEY   "altitude/hist"
+#define HISTORY_INTERVAL_MS         (CONFIG_ZSW_ALTITUDE_HISTORY_INTERVAL_MIN * 60 * 1000)
+#define MAX_SAMPLES                 (7 * 24 * 60 / CONFIG_ZSW_ALTITUDE_HISTORY_INTERVAL_MIN) // One week
+
+static void drain_work_handler(struct k_work *work);
+
+ZBUS_CHAN_DECLARE(pressure_data_chan);
+
+K_WORK_DELAYABLE_DEFINE(drain_work, drain_work_handler);
+static K_MUTEX_DEFINE(altitude_mutex);
+
+static zsw_history_t altitude_history;
+static zsw_altitude_sample_t samples[MAX_SAMPLES];
+static int64_t last_history_ms;
+static uint32_t history_floors_up;
+static uint32_t history_floors_down;
+
+static bool use_fifo;
+static bool has_reference;
+static float reference_pressure;
+static zsw_altitude_state_t state = {
+    .temperature = DEFAULT_TEMPERATURE,
+};
+static float floor_anchor;
+static float still_s;
+// Floors changed since the last publish, processed samples may come from zsw_altitude_get.
+static int pending_floors;
+static float batch[BOSCH_BMP581_FIFO_FRAMES];
+
+static float pressure_to_altitude(float pressure, float temperature)
+{
+    return ((powf(reference_pressure / pressure, 1.f / 5.257f) - 1.f) * (temperature + 273.15f)) / 0.0065f;
+}
+
+static void track_floors(float dt)
+{
+    float speed = fabsf(state.vertical_speed);
+
+    if (speed > CLIMB_SPEED_MAX) {
+        floor_anchor = state.altitude;
+        still_s = 0;
+        return;
+    }
+
+    if (speed < CLIMB_SPEED_MIN) {
+        still_s += dt;
+        if (still_s >= CLIMB_PAUSE_S) {
+            // Standing still or weather drift, start over from here.
+            floor_anchor = state.altitude;
+            return;
+        }
+    } else {
+        still_s = 0;
+    }
+
+    while (state.altitude - floor_anchor >= FLOOR_HEIGHT_M) {
+        floor_anchor += FLOOR_HEIGHT_M;
+        state.floors_up++;
+        pending_floors++;
+    }
+    while (floor_anchor - state.altitude >= FLOOR_HEIGHT_M) {
+        floor_anchor -= FLOOR_HEIGHT_M;
+        state.floors_down++;
+        pending_floors--;
+    }
+}
+
+static void process_sample_locked(float pressure, float dt)
+{
+    float predicted;
+    float residual;
+
+    if (!has_reference) {
+        reference_pressure = pressure;
+        has_reference = true;
+    }
+
+    predicted = state.altitude + state.vertical_speed * dt;
+    residual = pressure_to_altitude(pressure, state.temperature) - predicted;
+    state.altitude = predicted + FILTER_ALPHA * residual;
+    state.vertical_speed += FILTER_BETA * residual / dt;
+    state.pressure = pressure;
+
+    track_floors(dt);
+}
+
+static int drain_locked(void)
+{
+    uint16_t num_samples = ARRAY_SIZE(batch);
+    float pressure;
+    float temperature;
+    float dt = SAMPLE_PERIOD_S;
+    int ret;
+
+    // Temperature only scales the altitude, one reading per batch is enough.
+    ret = zsw_pressure_sensor_fetch(&pressure, &temperature);
+    if (ret == 0) {
+        state.temperature = temperature;
+    }
+
+    if (use_fifo) {
+        ret = zsw_pressure_sensor_fifo_read(batch, &num_samples);
+    } else if (ret == 0) {
+        batch[0] = pressure;
+        num_samples = 1;
+        dt = DRAIN_INTERVAL_MS / 1000.0f;
+    }
+
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < num_samples; i++) {
+        process_sample_locked(batch[i], dt);
+    }
+
+    return 0;
+}
+
+static void add_history_sample_locked(void)
+{
+    zsw_altitude_sample_t sample = {
+        .altitude_dm = CLAMP(lroundf(state.altitude * 10), INT16_MIN, INT16_MAX),
+        .floors_up = MIN(state.floors_up - history_floors_up, UINT8_MAX),
+        .floors_down = MIN(state.floors_down - history_floors_down, UINT8_MAX),
+    };
+
+    history_floors_up = state.floors_up;
+    history_floors_down = state.floors_down;
+
+    zsw_history_add(&altitude_history, &sample);
+    if (zsw_history_save(&altitude_history)) {
+        LOG_ERR("Error during saving of altitude samples!");
+    }
+}
+
+static void drain_work_handler(struct k_work *work)
+{
+    struct pressure_event evt;
+    int ret;
+
+    k_mutex_lock(&altitude_mutex, K_FOREVER);
+    ret = drain_locked();
+    if (ret != 0) {
+        LOG_WRN("Failed to read pressure samples: %d", ret);
+    }
+
+    if (k_uptime_get() - last_history_ms >= HISTORY_INTERVAL_MS) {
+        last_history_ms += HISTORY_INTERVAL_MS;
+        add_history_sample_locked();
+    }
+
+    evt = (struct pressure_event) {
+        .pressure = state.pressure,
+        .temperature = state.temperature,
+        .altitude = state.altitude,
+        .vertical_speed = state.vertical_speed,
+        .floors_up = state.floors_up,
+        .floors_down = state.floors_down,
+        .floors_changed = pending_floors,
+    };
+    pending_floors = 0;
+    k_mutex_unlock(&altitude_mutex);
+
+    if (evt.floors_changed != 0) {
+        LOG_INF("Floors %+d, altitude %.1f m", evt.floors_changed, (double)evt.altitude);
+    }
+
+    if (ret == 0) {
+        zbus_chan_pub(&pressure_data_chan, &evt, K_MSEC(250));
+    }
+
+    k_work_schedule(&drain_work, K_MSEC(DRAIN_INTERVAL_MS));
+}
+
+int zsw_altitude_get(zsw_altitude_state_t *p_state)
+{
+    int ret;
+
+    k_mutex_lock(&altitude_mutex, K_FOREVER);
+    if (use_fifo) {
+        drain_locked();
+    }
+    *p_state = state;
+    ret = has_reference ? 0 : -ENODATA;
+    k_mutex_unlock(&altitude_mutex);
+
+    return ret;
+}
+
+void zsw_altitude_reset(void)
+{
+    k_mutex_lock(&altitude_mutex, K_FOREVER);
+    reference_pressure = state.pressure;
+    state.altitude = 0;
+    state.floors_up = 0;
+    state.floors_down = 0;
+    state.vertical_speed = 0;
+    floor_anchor = 0;
+    still_s = 0;
+    pending_floors = 0;
+    history_floors_up = 0;
+    history_floors_down = 0;
+    k_mutex_unlock(&altitude_mutex);
+}
+
+int zsw_altitude_get_history(zsw_altitude_sample_t *p_sample, uint32_t index)
+{
+    int ret = -EINVAL;
+
+    k_mutex_lock(&altitude_mutex, K_FOREVER);
+    if (index < zsw_history_samples(&altitude_history)) {
+        zsw_history_get(&altitude_history, p_sample, index);
+        ret = 0;
+    }
+    k_mutex_unlock(&altitude_mutex);
+
+    return ret;
+}
+
+uint32_t zsw_altitude_get_history_samples(void)
+{
+    uint32_t num_samples;
+
+    k_mutex_lock(&altitude_mutex, K_FOREVER);
+    num_samples = zsw_history_samples(&altitude_history);
+    k_mutex_unlock(&altitude_mutex);
+
+    return num_samples;
+}
+
+int zsw_altitude_init(void)
+{
+    int ret;
+
+    zsw_history_init(&altitude_history, MAX_SAMPLES, sizeof(zsw_altitude_sample_t), samples,
+                     SETTING_ALTITUDE_HIST_KEY);
+    if (zsw_history_load(&altitude_history)) {
+        LOG_ERR("Error during settings_load_subtree!");
+    }
+
+    ret = zsw_pressure_sensor_set_odr(SAMPLE_ODR);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = zsw_pressure_sensor_fifo_enable(true, IIR_COEFF);
+    use_fifo = (ret == 0);
+    if (!use_fifo) {
+        LOG_WRN("Pressure FIFO not available (%d), sampling every %d ms", ret, DRAIN_INTERVAL_MS);
+    }
+
+    last_history_ms = k_uptime_get();
+    k_work_schedule(&drain_work, K_MSEC(DRAIN_INTERVAL_MS));
+
+    return 0;
+}
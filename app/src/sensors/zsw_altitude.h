@@ -0,0 +1,72 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Relative altitude, vertical speed and floors climbed from the pressure sensor.
+ * The BMP581 samples continuously at a low rate with its IIR filter and buffers the
+ * samples in its FIFO, which is drained in batches. Every batch is published on
+ * pressure_data_chan, and the altitude and floors are stored in a history at
+ * CONFIG_ZSW_ALTITUDE_HISTORY_INTERVAL_MIN.
+ */
+
+typedef struct zsw_altitude_state_t {
+    float pressure;                     /**< Latest filtered pressure, same unit as the sensor. */
+    float temperature;                  /**< Degrees Celsius. */
+    float altitude;                     /**< Meters above the reference set at boot or by zsw_altitude_reset. */
+    float vertical_speed;               /**< Meters per second, positive upwards. */
+    uint32_t floors_up;                 /**< Floors climbed since boot or zsw_altitude_reset. */
+    uint32_t floors_down;               /**< Floors descended since boot or zsw_altitude_reset. */
+} zsw_altitude_state_t;
+
+/*
+* Stored in the altitude history once per CONFIG_ZSW_ALTITUDE_HISTORY_INTERVAL_MIN.
+*/
+typedef struct zsw_altitude_sample_t {
+    int16_t altitude_dm;                /**< Relative altitude at the end of the interval in decimeters. */
+    uint8_t floors_up;                  /**< Floors climbed during the interval. */
+    uint8_t floors_down;                /**< Floors descended during the interval. */
+} zsw_altitude_sample_t;
+
+/** @brief Start continuous sampling into the pressure sensor FIFO and load the history.
+ *  @return 0 on success, negative error code on failure.
+*/
+int zsw_altitude_init(void);
+
+/** @brief          Get the current state, samples waiting in the FIFO are processed first.
+ *  @param p_state  Where to store the state
+ *  @return         0 on success, -ENODATA before the first sample.
+*/
+int zsw_altitude_get(zsw_altitude_state_t *p_state);
+
+/** @brief Make the current altitude the zero reference and clear the floor counters.
+*/
+void zsw_altitude_reset(void);
+
+/** @brief              Get a sample from the history.
+ *  @param p_sample     Where to store the sample
+ *  @param index        Sample index, 0 is the oldest
+ *  @return             0 on success, -EINVAL if index is out of range.
+*/
+int zsw_altitude_get_history(zsw_altitude_sample_t *p_sample, uint32_t index);
+
+/** @brief Get the number of samples in the history.
+*/
+uint32_t zsw_altitude_get_history_samples(void);
@@ -28,6 +28,19 @@
 
 LOG_MODULE_REGISTER(zsw_imu, CONFIG_ZSW_SENSORS_LOG_LEVEL);
 
+// Frames read from the IMU FIFO in one go, also the max batch size.
+#define FIFO_READ_MAX_FRAMES    32
+// Sensor time runs at 39.0625 us per tick, 25.6 ticks per ms.
+#define SENSOR_MS_TO_TICKS(ms)  (((uint64_t)(ms) * 256ULL) / 10ULL)
+#define SENSOR_TIME_WRAP_TICKS  (BOSCH_BMI270_SENSOR_TIME_MASK + 1ULL)
+
+typedef struct sensor_time_unwrap_t {
+    bool valid;
+    uint32_t last_sensor_time;
+    int64_t last_uptime_ms;
+    uint64_t ticks;
+} sensor_time_unwrap_t;
+
 ZBUS_CHAN_DECLARE(accel_data_chan);
 static const struct device *const bmi270 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(bmi270));
 static struct sensor_trigger bmi270_trigger;
@@ -35,6 +48,100 @@ static int step_offset = 0;
 static zsw_imu_data_step_activity_t last_step_activity = ZSW_IMU_EVT_STEP_ACTIVITY_UNKNOWN;
 static atomic_t feature_refcount[BOSCH_BMI270_FEAT_WEAR_WAKE_UP + 1];
 
+K_MUTEX_DEFINE(fifo_mutex);
+
+static struct sensor_trigger fifo_trigger = {
+    .type = SENSOR_TRIG_FIFO_WATERMARK,
+    .chan = SENSOR_CHAN_FIFO,
+};
+static zsw_imu_fifo_callback_t fifo_callback;
+static uint32_t fifo_period_us;
+static struct sensor_value fifo_saved_accel_odr;
+static struct sensor_value fifo_saved_gyro_odr;
+static sensor_time_unwrap_t fifo_time;
+static uint64_t fifo_last_sample_us;
+static struct bosch_bmi270_fifo_frame fifo_frames[FIFO_READ_MAX_FRAMES];
+static zsw_imu_fifo_sample_t fifo_samples[FIFO_READ_MAX_FRAMES];
+
+// Snapshots can be fetched from any thread.
+static struct k_spinlock snapshot_time_lock;
+static sensor_time_unwrap_t snapshot_time;
+
+// The 24 bit sensor time wraps every ~655 s, reads further apart than that add the wraps told by the kernel uptime.
+static uint64_t unwrap_sensor_time(sensor_time_unwrap_t *p_time, uint32_t sensor_time)
+{
+    int64_t now_ms = k_uptime_get();
+    uint64_t delta;
+    uint64_t elapsed;
+
+    if (!p_time->valid) {
+        p_time->ticks = sensor_time;
+        p_time->valid = true;
+    } else {
+        delta = (sensor_time - p_time->last_sensor_time) & BOSCH_BMI270_SENSOR_TIME_MASK;
+        elapsed = SENSOR_MS_TO_TICKS(now_ms - p_time->last_uptime_ms);
+        if (elapsed > delta) {
+            delta += ((elapsed - delta + SENSOR_TIME_WRAP_TICKS / 2) / SENSOR_TIME_WRAP_TICKS) * SENSOR_TIME_WRAP_TICKS;
+        }
+        p_time->ticks += delta;
+    }
+
+    p_time->last_sensor_time = sensor_time;
+    p_time->last_uptime_ms = now_ms;
+
+    return p_time->ticks;
+}
+
+static void fifo_watermark_handler(const struct device *dev, const struct sensor_trigger *trig)
+{
+    uint16_t num_frames;
+    uint32_t sensor_time;
+    uint64_t last_sample_us;
+
+    k_mutex_lock(&fifo_mutex, K_FOREVER);
+
+    if (fifo_callback == NULL) {
+        k_mutex_unlock(&fifo_mutex);
+        return;
+    }
+
+    // The FIFO can hold more than one read worth of frames when the work queue was busy.
+    do {
+        num_frames = ARRAY_SIZE(fifo_frames);
+        if (bosch_bmi270_fifo_read(bmi270, fifo_frames, &num_frames, &sensor_time) != 0) {
+            LOG_ERR("Failed reading IMU FIFO");
+            break;
+        }
+
+        if (num_frames == 0) {
+            break;
+        }
+
+        if (sensor_time != 0) {
+            // The sensor time is taken right after the last frame.
+            last_sample_us = BOSCH_BMI270_SENSOR_TIME_TO_US(unwrap_sensor_time(&fifo_time, sensor_time));
+        } else {
+            // No sensor time frame when the FIFO was not read empty, continue from the previous batch.
+            last_sample_us = fifo_last_sample_us + num_frames * fifo_period_us;
+        }
+        fifo_last_sample_us = last_sample_us;
+
+        for (uint16_t i = 0; i < num_frames; i++) {
+            fifo_samples[i].timestamp_us = last_sample_us - (num_frames - 1 - i) * fifo_period_us;
+            fifo_samples[i].accel[0] = fifo_frames[i].ax;
+            fifo_samples[i].accel[1] = fifo_frames[i].ay;
+            fifo_samples[i].accel[2] = fifo_frames[i].az;
+            fifo_samples[i].gyro[0] = fifo_frames[i].gx;
+            fifo_samples[i].gyro[1] = fifo_frames[i].gy;
+            fifo_samples[i].gyro[2] = fifo_frames[i].gz;
+        }
+
+        fifo_callback(fifo_samples, num_frames);
+    } while (num_frames == ARRAY_SIZE(fifo_frames));
+
+    k_mutex_unlock(&fifo_mutex);
+}
+
 static void bmi270_trigger_handler(const struct device *dev, const struct sensor_trigger *trig)
 {
     zsw_imu_evt_t evt;
@@ -48,15 +155,8 @@ static void bmi270_trigger_handler(const struct device *dev, const struct sensor
             break;
         }
         case SENSOR_TRIG_STEP: {
-            struct sensor_value sensor_val;
-
-            if (sensor_channel_get(bmi270, SENSOR_CHAN_STEPS, &sensor_val) == 0) {
-
-                evt.type = ZSW_IMU_EVT_TYPE_STEP;
-                evt.data.step.count = sensor_val.val1;
-
-                LOG_DBG("No of steps counted  = %u", evt.data.step.count);
-            }
+            // Only a notification, the counter is read by the fitness manager when it needs it.
+            evt.type = ZSW_IMU_EVT_TYPE_STEP;
 
             break;
         }
@@ -184,6 +284,56 @@ int zsw_imu_fetch_gyro_f(float *x, float *y, float *z)
     return 0;
 }
 
+int zsw_imu_fetch_snapshot(zsw_imu_snapshot_t *snapshot)
+{
+    struct bosch_bmi270_sample sample;
+    struct sensor_value accel_range;
+    struct sensor_value gyro_range;
+    float accel_scale;
+    float gyro_scale;
+    k_spinlock_key_t key;
+
+    if (snapshot == NULL) {
+        return -EINVAL;
+    }
+
+    if (!device_is_ready(bmi270)) {
+        return -ENODEV;
+    }
+
+    // Ranges are cached by the driver, this does not touch the bus.
+    if ((sensor_attr_get(bmi270, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &accel_range) != 0) ||
+        (sensor_attr_get(bmi270, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_FULL_SCALE, &gyro_range) != 0)) {
+        return -EFAULT;
+    }
+
+    if (bosch_bmi270_read_sample(bmi270, &sample) != 0) {
+        return -ENODATA;
+    }
+
+    snapshot->uptime_ms = k_uptime_get();
+    key = k_spin_lock(&snapshot_time_lock);
+    snapshot->timestamp_us = BOSCH_BMI270_SENSOR_TIME_TO_US(unwrap_sensor_time(&snapshot_time, sample.sensor_time));
+    k_spin_unlock(&snapshot_time_lock, key);
+    snapshot->accel_raw[0] = sample.ax;
+    snapshot->accel_raw[1] = sample.ay;
+    snapshot->accel_raw[2] = sample.az;
+    snapshot->gyro_raw[0] = sample.gx;
+    snapshot->gyro_raw[1] = sample.gy;
+    snapshot->gyro_raw[2] = sample.gz;
+
+    // Same scaling as the driver, a raw value of INT16_MAX equals the full scale.
+    accel_scale = (accel_range.val1 * (SENSOR_G / 1000000.0f)) / INT16_MAX;
+    gyro_scale = (gyro_range.val1 * (SENSOR_PI / 1000000.0f)) / (180.0f * INT16_MAX);
+
+    for (int i = 0; i < 3; i++) {
+        snapshot->accel[i] = snapshot->accel_raw[i] * accel_scale;
+        snapshot->gyro[i] = snapshot->gyro_raw[i] * gyro_scale;
+    }
+
+    return 0;
+}
+
 int zsw_imu_fetch_accel(int16_t *x, int16_t *y, int16_t *z)
 {
     struct sensor_value x_temp;
@@ -246,10 +396,8 @@ int zsw_imu_fetch_num_steps(uint32_t *num_steps)
         return -ENODEV;
     }
 
-    if (sensor_sample_fetch_chan(bmi270, SENSOR_CHAN_ALL) != 0) {
-        return -ENODATA;
-    }
-
+    // The step counter is read from the feature registers by sensor_channel_get,
+    // no need to fetch the accelerometer and gyroscope samples.
     if (sensor_channel_get(bmi270, SENSOR_CHAN_STEPS, &sensor_val) != 0) {
         return -ENODATA;
     }
@@ -373,3 +521,126 @@ int zsw_imu_feature_enable(zsw_imu_feature_t feature, bool int_en)
 
     return 0;
 }
+
+int zsw_imu_fifo_start(uint16_t rate_hz, uint16_t batch_size, zsw_imu_fifo_callback_t callback)
+{
+    struct sensor_value accel_odr = { 0 };
+    struct sensor_value gyro_odr = { 0 };
+    struct sensor_value watermark = { 0 };
+    int ret;
+
+    if ((callback == NULL) || (batch_size == 0) || (batch_size > FIFO_READ_MAX_FRAMES)) {
+        return -EINVAL;
+    }
+
+    switch (rate_hz) {
+        case 100:
+            accel_odr.val1 = BOSCH_BMI270_ACC_ODR_100_HZ;
+            gyro_odr.val1 = BOSCH_BMI270_GYR_ODR_100_HZ;
+            break;
+        case 200:
+            accel_odr.val1 = BOSCH_BMI270_ACC_ODR_200_HZ;
+            gyro_odr.val1 = BOSCH_BMI270_GYR_ODR_200_HZ;
+            break;
+        case 400:
+            accel_odr.val1 = BOSCH_BMI270_ACC_ODR_400_HZ;
+            gyro_odr.val1 = BOSCH_BMI270_GYR_ODR_400_HZ;
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    if (!device_is_ready(bmi270)) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&fifo_mutex, K_FOREVER);
+
+    if (fifo_callback != NULL) {
+        k_mutex_unlock(&fifo_mutex);
+        return -EBUSY;
+    }
+
+    if ((sensor_attr_get(bmi270, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &fifo_saved_accel_odr) != 0) ||
+        (sensor_attr_get(bmi270, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &fifo_saved_gyro_odr) != 0)) {
+        k_mutex_unlock(&fifo_mutex);
+        return -EFAULT;
+    }
+
+    ret = zsw_imu_feature_enable(ZSW_IMU_FEATURE_GYRO, false);
+    if (ret) {
+        k_mutex_unlock(&fifo_mutex);
+        return ret;
+    }
+
+    fifo_callback = callback;
+    fifo_period_us = USEC_PER_SEC / rate_hz;
+    fifo_time.valid = false;
+    fifo_last_sample_us = 0;
+    watermark.val1 = batch_size;
+
+    if ((sensor_attr_set(bmi270, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &accel_odr) != 0) ||
+        (sensor_attr_set(bmi270, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &gyro_odr) != 0) ||
+        (sensor_trigger_set(bmi270, &fifo_trigger, fifo_watermark_handler) != 0) ||
+        (sensor_attr_set(bmi270, SENSOR_CHAN_FIFO, SENSOR_ATTR_CONFIGURATION, &watermark) != 0)) {
+        LOG_ERR("Failed to start IMU FIFO");
+        k_mutex_unlock(&fifo_mutex);
+        zsw_imu_fifo_stop();
+        return -EFAULT;
+    }
+
+    LOG_DBG("IMU FIFO started at %u Hz, %u samples per batch", rate_hz, batch_size);
+
+    k_mutex_unlock(&fifo_mutex);
+
+    return 0;
+}
+
+int zsw_imu_fifo_stop(void)
+{
+    struct sensor_value watermark = { 0 };
+    int ret = 0;
+
+    k_mutex_lock(&fifo_mutex, K_FOREVER);
+
+    if (fifo_callback == NULL) {
+        k_mutex_unlock(&fifo_mutex);
+        return 0;
+    }
+
+    // The trigger stays installed, removing it would disable the IMU interrupt for all features.
+    if ((sensor_attr_set(bmi270, SENSOR_CHAN_FIFO, SENSOR_ATTR_CONFIGURATION, &watermark) != 0) ||
+        (sensor_attr_set(bmi270, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &fifo_saved_accel_odr) != 0) ||
+        (sensor_attr_set(bmi270, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &fifo_saved_gyro_odr) != 0)) {
+        LOG_ERR("Failed to stop IMU FIFO");
+        ret = -EFAULT;
+    }
+
+    fifo_callback = NULL;
+
+    k_mutex_unlock(&fifo_mutex);
+
+    zsw_imu_feature_disable(ZSW_IMU_FEATURE_GYRO);
+
+    return ret;
+}
+
+int zsw_imu_fifo_get_scale(uint8_t *accel_range_g, uint16_t *gyro_range_dps)
+{
+    struct sensor_value accel_range;
+    struct sensor_value gyro_range;
+
+    if (!device_is_ready(bmi270)) {
+        return -ENODEV;
+    }
+
+    if ((sensor_attr_get(bmi270, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &accel_range) != 0) ||
+        (sensor_attr_get(bmi270, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_FULL_SCALE, &gyro_range) != 0)) {
+        return -EFAULT;
+    }
+
+    *accel_range_g = accel_range.val1;
+    *gyro_range_dps = gyro_range.val1;
+
+    return 0;
+}
@@ -68,15 +68,35 @@ typedef struct zsw_imu_data_xyz_t {
     int16_t z;
 } zsw_imu_data_xyz_t;
 
-typedef struct zsw_imu_data_step_t {
-    int16_t count;
-} zsw_imu_data_step_t;
+typedef struct zsw_imu_fifo_sample_t {
+    uint32_t timestamp_us;              /**< IMU sensor time unwrapped past its 24 bit (~655 s) wrap, in us.
+                                             The 32 bit value wraps after ~71.6 minutes. */
+    int16_t accel[3];                   /**< Raw accelerometer x, y, z. */
+    int16_t gyro[3];                    /**< Raw gyroscope x, y, z. */
+} zsw_imu_fifo_sample_t;
+
+/*
+* Accelerometer and gyroscope sampled at the same time, read in a single I2C burst.
+*/
+typedef struct zsw_imu_snapshot_t {
+    int64_t uptime_ms;                  /**< Kernel uptime when the sample was read. */
+    uint32_t timestamp_us;              /**< IMU sensor time unwrapped past its 24 bit (~655 s) wrap, in us.
+                                             The 32 bit value wraps after ~71.6 minutes. */
+    int16_t accel_raw[3];               /**< Raw accelerometer x, y, z. */
+    int16_t gyro_raw[3];                /**< Raw gyroscope x, y, z. */
+    float accel[3];                     /**< Accelerometer x, y, z in m/s^2. */
+    float gyro[3];                      /**< Gyroscope x, y, z in rad/s. */
+} zsw_imu_snapshot_t;
+
+/*
+* Called from the IMU interrupt work context with each batch drained from the FIFO.
+*/
+typedef void (*zsw_imu_fifo_callback_t)(const zsw_imu_fifo_sample_t *samples, uint16_t num_samples);
 
 typedef struct zsw_imu_evt_t {
     zsw_imu_evt_type_t type;
     union {
         zsw_imu_data_xyz_t            xyz;
-        zsw_imu_data_step_t           step;
         zsw_imu_data_step_activity_t  step_activity;
         zsw_imu_data_step_gesture_t   gesture;
     } data;
@@ -94,6 +114,17 @@ int zsw_imu_fetch_accel_f(float *x, float *y, float *z);
 */
 int zsw_imu_fetch_gyro_f(float *x, float *y, float *z);
 
+/**
+ * @brief Get a coherent accelerometer and gyroscope sample in raw and SI units.
+ *
+ * Prefer this over calling zsw_imu_fetch_accel_f and zsw_imu_fetch_gyro_f back to back,
+ * which reads the IMU twice. Temperature is not read, use zsw_imu_fetch_temperature.
+ *
+ * @param snapshot Where to store the sample.
+ * @return 0 on success, negative error code on failure.
+ */
+int zsw_imu_fetch_snapshot(zsw_imu_snapshot_t *snapshot);
+
 int zsw_imu_fetch_accel(int16_t *x, int16_t *y, int16_t *z);
 
 int zsw_imu_fetch_gyro(int16_t *x, int16_t *y, int16_t *z);
@@ -122,3 +153,32 @@ int zsw_imu_reset_step_count(void);
 int zsw_imu_feature_disable(zsw_imu_feature_t feature);
 
 int zsw_imu_feature_enable(zsw_imu_feature_t feature, bool int_en);
+
+/**
+ * @brief Start batching raw accelerometer and gyroscope samples in the IMU hardware FIFO.
+ *
+ * Both sensors are sampled at rate_hz and the callback gets all buffered samples every
+ * time the FIFO holds batch_size samples, so the I2C bus is only used once per batch.
+ *
+ * @param rate_hz Sample rate, 100, 200 or 400 Hz.
+ * @param batch_size Number of samples per FIFO watermark interrupt.
+ * @param callback Called with each batch.
+ * @return 0 on success, -EBUSY if already started, negative error code on failure.
+ */
+int zsw_imu_fifo_start(uint16_t rate_hz, uint16_t batch_size, zsw_imu_fifo_callback_t callback);
+
+/**
+ * @brief Stop FIFO batching and restore the previous sample rates.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int zsw_imu_fifo_stop(void);
+
+/**
+ * @brief Get the full scale of the raw samples, a raw value of INT16_MAX equals the range.
+ *
+ * @param accel_range_g Accelerometer range in g.
+ * @param gyro_range_dps Gyroscope range in degrees per second.
+ * @return 0 on success, negative error code on failure.
+ */
+int zsw_imu_fifo_get_scale(uint8_t *accel_range_g, uint16_t *gyro_range_dps);
@@ -16,34 +16,22 @@
  */
 
 #include <zephyr/logging/log.h>
-#include <zephyr/zbus/zbus.h>
 
-#include "events/zsw_periodic_event.h"
-#include "events/light_event.h"
 #include "sensors/zsw_light_sensor.h"
+#include "sensors/zsw_sensor_scheduler.h"
 
 LOG_MODULE_REGISTER(zsw_light_sensor, CONFIG_ZSW_SENSORS_LOG_LEVEL);
 
-static void zbus_periodic_slow_callback(const struct zbus_channel *chan);
+#define LIGHT_PUBLISH_INTERVAL_MS       10000
 
-ZBUS_CHAN_DECLARE(light_data_chan);
-ZBUS_CHAN_DECLARE(periodic_event_10s_chan);
-ZBUS_LISTENER_DEFINE(zsw_light_sensor_lis, zbus_periodic_slow_callback);
 static const struct device *const apds9306 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(apds9306));
 
-static void zbus_periodic_slow_callback(const struct zbus_channel *chan)
-{
-    float light = 0.0;
-
-    if (zsw_light_sensor_get_light(&light)) {
-        return;
-    }
-
-    struct light_event evt = {
-        .light = light,
-    };
-    zbus_chan_pub(&light_data_chan, &evt, K_MSEC(250));
-}
+// Background publish on light_data_chan, may run late to share a wakeup with other sensors.
+static zsw_sensor_sched_request_t publish_request = {
+    .sensor = ZSW_SENSOR_SCHED_LIGHT,
+    .period_ms = LIGHT_PUBLISH_INTERVAL_MS,
+    .max_latency_ms = LIGHT_PUBLISH_INTERVAL_MS / 2,
+};
 
 int zsw_light_sensor_init(void)
 {
@@ -53,7 +41,7 @@ int zsw_light_sensor_init(void)
         return -ENODEV;
     }
 
-    zsw_periodic_chan_add_obs(&periodic_event_10s_chan, &zsw_light_sensor_lis);
+    zsw_sensor_scheduler_request(&publish_request);
 
     return 0;
 }
@@ -23,12 +23,9 @@
 #include <zephyr/pm/device.h>
 #include <zephyr/pm/policy.h>
 #include <zephyr/logging/log.h>
-#include <zephyr/zbus/zbus.h>
 #include <inttypes.h>
 #include <math.h>
 
-#include "events/zsw_periodic_event.h"
-#include "events/magnetometer_event.h"
 #include "sensors/zsw_magnetometer.h"
 
 LOG_MODULE_REGISTER(zsw_magnetometer, CONFIG_ZSW_SENSORS_LOG_LEVEL);
@@ -38,8 +35,16 @@ LOG_MODULE_REGISTER(zsw_magnetometer, CONFIG_ZSW_SENSORS_LOG_LEVEL);
 #endif
 
 #define SETTINGS_NAME_MAGN              "magn"
-#define SETTINGS_KEY_CALIB              "calibr"
+// Offsets in gauss * 10, the unit readings had before they were converted to micro Tesla.
+#define SETTINGS_KEY_CALIB_LEGACY       "calibr"
+#define SETTINGS_KEY_CALIB              "calibr_ut"
+#define SETTINGS_MAGN_CALIB_LEGACY      SETTINGS_NAME_MAGN "/" SETTINGS_KEY_CALIB_LEGACY
 #define SETTINGS_MAGN_CALIB             SETTINGS_NAME_MAGN "/" SETTINGS_KEY_CALIB
+#define LEGACY_CALIB_TO_UT              10.0f
+
+#define MAGN_UT_PER_GAUSS               100
+
+#define MAGN_ODR_HZ                     20
 
 typedef struct {
     float offset_x;
@@ -58,33 +63,12 @@ static double min_y;
 static double min_z;
 static bool is_calibrating;
 static magn_calib_data_t calibration_data;
+static bool calibration_loaded;
+// Given for every data ready sample.
+static K_SEM_DEFINE(sample_sem, 0, 1);
 
-static void zbus_periodic_slow_callback(const struct zbus_channel *chan);
-
-ZBUS_CHAN_DECLARE(magnetometer_data_chan);
-ZBUS_CHAN_DECLARE(periodic_event_1s_chan);
-ZBUS_LISTENER_DEFINE(zsw_magnetometer_lis, zbus_periodic_slow_callback);
 static const struct device *const magnetometer = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(lis2mdl));
 
-static void zbus_periodic_slow_callback(const struct zbus_channel *chan)
-{
-    float x;
-    float y;
-    float z;
-
-    if (zsw_magnetometer_get_all(&x, &y, &z)) {
-        return;
-    }
-
-    struct magnetometer_event evt = {
-        .x = x,
-        .y = y,
-        .z = z
-    };
-
-    zbus_chan_pub(&magnetometer_data_chan, &evt, K_MSEC(250));
-}
-
 static void lis2mdl_trigger_handler(const struct device *dev,
                                     const struct sensor_trigger *trig)
 {
@@ -100,10 +84,10 @@ static void lis2mdl_trigger_handler(const struct device *dev,
             sensor_value_to_float(&magn[0]),
             sensor_value_to_float(&magn[2]));
 
-    // Convert Guass to micro Tesla
-    last_x = sensor_value_to_float(&magn[1]) * 10; // Swap x, y to match IMU orientation
-    last_y = sensor_value_to_float(&magn[0]) * 10;
-    last_z = sensor_value_to_float(&magn[2]) * 10;
+    // Convert Gauss to micro Tesla
+    last_x = sensor_value_to_float(&magn[1]) * MAGN_UT_PER_GAUSS; // Swap x, y to match IMU orientation
+    last_y = sensor_value_to_float(&magn[0]) * MAGN_UT_PER_GAUSS;
+    last_z = sensor_value_to_float(&magn[2]) * MAGN_UT_PER_GAUSS;
 
     if (is_calibrating) {
         if (last_x < min_x) {
@@ -131,23 +115,42 @@ static void lis2mdl_trigger_handler(const struct device *dev,
     last_x = last_x - calibration_data.offset_x;
     last_y = last_y - calibration_data.offset_y;
     last_z = last_z - calibration_data.offset_z;
+
+    k_sem_give(&sample_sem);
 }
 
 static int magn_cal_load(const char *p_key, size_t len,
                          settings_read_cb read_cb, void *p_cb_arg, void *p_param)
 {
-    ARG_UNUSED(p_key);
+    bool legacy = settings_name_steq(p_key, SETTINGS_KEY_CALIB_LEGACY, NULL);
+    magn_calib_data_t data;
+
+    if (!legacy && !settings_name_steq(p_key, SETTINGS_KEY_CALIB, NULL)) {
+        return 0;
+    }
 
     if (len != sizeof(magn_calib_data_t)) {
         LOG_ERR("Invalid length of magn calibration data");
         return -EINVAL;
     }
 
-    if (read_cb(p_cb_arg, &calibration_data, len) != sizeof(magn_calib_data_t)) {
+    if (read_cb(p_cb_arg, &data, len) != sizeof(magn_calib_data_t)) {
         LOG_ERR("Error reading magn calibration data");
         return -EIO;
     }
 
+    if (legacy) {
+        // Only used until a calibration is saved in micro Tesla.
+        if (calibration_loaded) {
+            return 0;
+        }
+        data.offset_x *= LEGACY_CALIB_TO_UT;
+        data.offset_y *= LEGACY_CALIB_TO_UT;
+        data.offset_z *= LEGACY_CALIB_TO_UT;
+    }
+    calibration_data = data;
+    calibration_loaded = !legacy;
+
     LOG_WRN("Calibration data loaded: x: %f, y: %f, z: %f",
             calibration_data.offset_x, calibration_data.offset_y, calibration_data.offset_z);
 
@@ -166,7 +169,7 @@ int zsw_magnetometer_init(void)
         return -EFAULT;
     }
 
-    if (settings_load_subtree_direct(SETTINGS_MAGN_CALIB, magn_cal_load, NULL)) {
+    if (settings_load_subtree_direct(SETTINGS_NAME_MAGN, magn_cal_load, NULL)) {
         LOG_ERR("Error during settings_load_subtree!");
         return -EFAULT;
     }
@@ -174,7 +177,7 @@ int zsw_magnetometer_init(void)
     struct sensor_trigger trig;
     struct sensor_value odr_attr;
 
-    odr_attr.val1 = 20; // TODO what value
+    odr_attr.val1 = MAGN_ODR_HZ;
     odr_attr.val2 = 0;
 
     if (sensor_attr_set(magnetometer, SENSOR_CHAN_ALL,
@@ -193,8 +196,6 @@ int zsw_magnetometer_init(void)
         return -EFAULT;
     }
 
-    zsw_periodic_chan_add_obs(&periodic_event_1s_chan, &zsw_magnetometer_lis);
-
     return 0;
 }
 
@@ -252,6 +253,22 @@ int zsw_magnetometer_stop_calibration(void)
     calibration_data.offset_z = (max_z + min_z) / 2;
 
     settings_save_one(SETTINGS_MAGN_CALIB, &calibration_data, sizeof(magn_calib_data_t));
+    settings_delete(SETTINGS_MAGN_CALIB_LEGACY);
+    calibration_loaded = true;
+
+    return 0;
+}
+
+int zsw_magnetometer_wait_sample(uint32_t max_periods)
+{
+    if (!device_is_ready(magnetometer)) {
+        return -ENODEV;
+    }
+
+    k_sem_reset(&sample_sem);
+    if (k_sem_take(&sample_sem, K_MSEC(max_periods * MSEC_PER_SEC / MAGN_ODR_HZ)) != 0) {
+        return -EAGAIN;
+    }
 
     return 0;
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 int zsw_magnetometer_init(void);
 int zsw_magnetometer_set_enable(bool enabled);
@@ -25,7 +26,7 @@ double zsw_magnetometer_get_heading(void);
 
 /*
 * Get the magnetometer data in micro Tesla.
-* Divide with 10 to get it in Guass.
+* Divide with 100 to get it in Gauss.
 *
 * @param x Pointer to the x-axis data.
 * @param y Pointer to the y-axis data.
@@ -35,5 +36,15 @@ double zsw_magnetometer_get_heading(void);
 
 */
 int zsw_magnetometer_get_all(float *x, float *y, float *z);
+
+/*
+* Wait for the next data ready sample, zsw_magnetometer_get_all returns it afterwards.
+* The magnetometer must be enabled. Called from the LIS2MDL trigger thread it never returns a sample.
+*
+* @param max_periods Number of sample periods to wait.
+*
+* @return 0 on success, -EAGAIN if no sample arrived in time.
+*/
+int zsw_magnetometer_wait_sample(uint32_t max_periods);
 int zsw_magnetometer_start_calibration(void);
 int zsw_magnetometer_stop_calibration(void);
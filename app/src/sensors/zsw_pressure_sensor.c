@@ -16,53 +16,42 @@
  */
 
 #include <zephyr/logging/log.h>
-#include <zephyr/zbus/zbus.h>
 
-#include "events/pressure_event.h"
-#include "events/zsw_periodic_event.h"
 #include "sensors/zsw_pressure_sensor.h"
 
 LOG_MODULE_REGISTER(zsw_pressure_sensor, CONFIG_ZSW_SENSORS_LOG_LEVEL);
 
-static void zbus_periodic_10s_callback(const struct zbus_channel *chan);
-
-ZBUS_CHAN_DECLARE(pressure_data_chan);
-ZBUS_CHAN_DECLARE(periodic_event_10s_chan);
-ZBUS_LISTENER_DEFINE(zsw_pressure_sensor_perioidc_lis, zbus_periodic_10s_callback);
 static const struct device *const bmp581 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(bmp581));
 
-static void zbus_periodic_10s_callback(const struct zbus_channel *chan)
+int zsw_pressure_sensor_init(void)
 {
-    float pressure;
-    float temperature;
-
-    if (zsw_pressure_sensor_get_pressure(&pressure) || zsw_pressure_sensor_get_temperature(&temperature)) {
-        return;
+    if (!device_is_ready(bmp581)) {
+        return -ENODEV;
     }
 
-    LOG_INF("Pressure: %.2f hPa, Temperature: %.2f C", pressure, temperature);
+    zsw_pressure_sensor_set_odr(BOSCH_BMP581_ODR_DEFAULT);
 
-    struct pressure_event evt = {
-        .pressure = pressure,
-        .temperature = temperature
-    };
-    zbus_chan_pub(&pressure_data_chan, &evt, K_MSEC(250));
+    return 0;
 }
 
-int zsw_pressure_sensor_init(void)
+int zsw_pressure_sensor_set_odr(uint8_t odr)
 {
+    struct sensor_value value;
+
     if (!device_is_ready(bmp581)) {
         return -ENODEV;
     }
 
-    zsw_periodic_chan_add_obs(&periodic_event_10s_chan, &zsw_pressure_sensor_perioidc_lis);
+    value.val1 = odr;
 
-    zsw_pressure_sensor_set_odr(BOSCH_BMP581_ODR_DEFAULT);
+    if (sensor_attr_set(bmp581, SENSOR_CHAN_ALL, SENSOR_ATTR_SAMPLING_FREQUENCY, &value) != 0) {
+        return -EIO;
+    }
 
     return 0;
 }
 
-int zsw_pressure_sensor_set_odr(uint8_t odr)
+int zsw_pressure_sensor_fifo_enable(bool enable, uint8_t iir)
 {
     struct sensor_value value;
 
@@ -70,11 +59,42 @@ int zsw_pressure_sensor_set_odr(uint8_t odr)
         return -ENODEV;
     }
 
-    value.val1 = odr;
+    value.val1 = enable;
+    value.val2 = iir;
 
-    if (sensor_attr_set(bmp581, SENSOR_CHAN_ALL, SENSOR_ATTR_SAMPLING_FREQUENCY, &value) != 0) {
-        return -EIO;
+    return sensor_attr_set(bmp581, SENSOR_CHAN_BMP581_FIFO, SENSOR_ATTR_CONFIGURATION, &value);
+}
+
+int zsw_pressure_sensor_fifo_read(float *p_pressure, uint16_t *p_num_samples)
+{
+    if (!device_is_ready(bmp581)) {
+        return -ENODEV;
+    }
+
+    return bosch_bmp581_fifo_read(bmp581, p_pressure, p_num_samples);
+}
+
+int zsw_pressure_sensor_fetch(float *pressure, float *temperature)
+{
+    struct sensor_value sensor_val;
+
+    if (!device_is_ready(bmp581)) {
+        return -ENODEV;
+    }
+
+    if (sensor_sample_fetch(bmp581) != 0) {
+        return -ENODATA;
+    }
+
+    if (sensor_channel_get(bmp581, SENSOR_CHAN_PRESS, &sensor_val) != 0) {
+        return -ENODATA;
     }
+    *pressure = sensor_value_to_float(&sensor_val);
+
+    if (sensor_channel_get(bmp581, SENSOR_CHAN_AMBIENT_TEMP, &sensor_val) != 0) {
+        return -ENODATA;
+    }
+    *temperature = sensor_value_to_float(&sensor_val);
 
     return 0;
 }
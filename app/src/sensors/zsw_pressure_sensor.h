@@ -25,6 +25,33 @@ int zsw_pressure_sensor_init(void);
 
 int zsw_pressure_sensor_set_odr(uint8_t odr);
 
+/**
+ * @brief Start or stop buffering IIR filtered pressure samples in the sensor FIFO.
+ *
+ * @param enable True to start buffering, the FIFO is flushed in both cases.
+ * @param iir IIR coefficient, one of BOSCH_BMP581_IIR_*.
+ * @return 0 on success, -ENOTSUP if the sensor has no FIFO, other negative error code on failure.
+ */
+int zsw_pressure_sensor_fifo_enable(bool enable, uint8_t iir);
+
+/**
+ * @brief Read the pressure samples buffered in the FIFO, oldest first.
+ *
+ * @param p_pressure Where to store the samples in Pa.
+ * @param p_num_samples In: size of p_pressure. Out: number of samples read.
+ * @return 0 on success, negative error code on failure.
+ */
+int zsw_pressure_sensor_fifo_read(float *p_pressure, uint16_t *p_num_samples);
+
+/**
+ * @brief Read pressure and temperature from a single sample.
+ *
+ * @param pressure Pressure in Pa.
+ * @param temperature Temperature in degrees Celsius.
+ * @return 0 on success, negative error code on failure.
+ */
+int zsw_pressure_sensor_fetch(float *pressure, float *temperature);
+
 int zsw_pressure_sensor_get_pressure(float *pressure);
 
 int zsw_pressure_sensor_get_temperature(float *temperature);
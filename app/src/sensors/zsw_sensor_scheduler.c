@@ -0,0 +1,382 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "events/light_event.h"
+#include "events/magnetometer_event.h"
+#include "sensors/zsw_imu.h"
+#include "sensors/zsw_light_sensor.h"
+#include "sensors/zsw_magnetometer.h"
+#include "sensors/zsw_pressure_sensor.h"
+#include "sensors/zsw_sensor_scheduler.h"
+#include "sensors/zsw_sensor_trace.h"
+
+LOG_MODULE_REGISTER(zsw_sensor_scheduler, CONFIG_ZSW_SENSORS_LOG_LEVEL);
+
+// Sample periods to wait for the first magnetometer sample after powering it for a single read.
+#define MAG_WAKE_SAMPLE_PERIODS     3
+
+typedef struct {
+    sys_slist_t requests;
+    uint32_t period_ms;
+    uint32_t max_latency_ms;
+    int64_t next_due_ms;
+    bool powered;
+    // Reads that powered the sensor just for themselves and wait for a sample without the mutex.
+    uint8_t one_shot_reads;
+    bool has_reading;
+    zsw_sensor_reading_t reading;
+    uint32_t fetches;
+    uint32_t cache_hits;
+    uint32_t power_changes;
+} sensor_state_t;
+
+ZBUS_CHAN_DECLARE(magnetometer_data_chan);
+ZBUS_CHAN_DECLARE(light_data_chan);
+
+static void scheduler_work_handler(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(scheduler_work, scheduler_work_handler);
+static K_MUTEX_DEFINE(scheduler_mutex);
+
+static sensor_state_t sensors[ZSW_SENSOR_SCHED_COUNT];
+
+static const char *const sensor_names[ZSW_SENSOR_SCHED_COUNT] = {
+    [ZSW_SENSOR_SCHED_IMU] = "imu",
+    [ZSW_SENSOR_SCHED_MAG] = "mag",
+    [ZSW_SENSOR_SCHED_PRESSURE] = "pressure",
+    [ZSW_SENSOR_SCHED_LIGHT] = "light",
+};
+
+static int sensor_fetch(zsw_sensor_sched_sensor_t sensor, zsw_sensor_reading_t *p_reading)
+{
+    int ret;
+
+    // A replayed sensor trace replaces the sensors it contains.
+    if (zsw_sensor_trace_replay_get(sensor, p_reading) == 0) {
+        return 0;
+    }
+
+    switch (sensor) {
+        case ZSW_SENSOR_SCHED_IMU:
+            ret = zsw_imu_fetch_snapshot(&p_reading->data.imu);
+            break;
+        case ZSW_SENSOR_SCHED_MAG:
+            ret = zsw_magnetometer_get_all(&p_reading->data.mag.x, &p_reading->data.mag.y, &p_reading->data.mag.z);
+            break;
+        case ZSW_SENSOR_SCHED_PRESSURE:
+            ret = zsw_pressure_sensor_fetch(&p_reading->data.pressure.pressure, &p_reading->data.pressure.temperature);
+            break;
+        case ZSW_SENSOR_SCHED_LIGHT:
+            ret = zsw_light_sensor_get_light(&p_reading->data.light);
+            break;
+        default:
+            ret = -EINVAL;
+            break;
+    }
+
+    p_reading->timestamp_ms = k_uptime_get();
+
+    if (ret == 0) {
+        zsw_sensor_trace_on_reading(sensor, p_reading);
+    }
+
+    return ret;
+}
+
+static int sensor_set_power(zsw_sensor_sched_sensor_t sensor, bool on)
+{
+    switch (sensor) {
+        case ZSW_SENSOR_SCHED_IMU:
+            // The accelerometer is always on for the step counter, only the gyroscope is switched.
+            return on ? zsw_imu_feature_enable(ZSW_IMU_FEATURE_GYRO, false) : zsw_imu_feature_disable(
+                       ZSW_IMU_FEATURE_GYRO);
+        case ZSW_SENSOR_SCHED_MAG:
+            return zsw_magnetometer_set_enable(on);
+        default:
+            return 0;
+    }
+}
+
+static void sensor_publish(zsw_sensor_sched_sensor_t sensor, const zsw_sensor_reading_t *p_reading)
+{
+    switch (sensor) {
+        case ZSW_SENSOR_SCHED_MAG: {
+            struct magnetometer_event evt = {
+                .x = p_reading->data.mag.x,
+                .y = p_reading->data.mag.y,
+                .z = p_reading->data.mag.z,
+            };
+            zbus_chan_pub(&magnetometer_data_chan, &evt, K_MSEC(250));
+            break;
+        }
+        case ZSW_SENSOR_SCHED_LIGHT: {
+            struct light_event evt = {
+                .light = p_reading->data.light,
+            };
+            zbus_chan_pub(&light_data_chan, &evt, K_MSEC(250));
+            break;
+        }
+        default:
+            // IMU snapshots have no channel, readers use zsw_sensor_scheduler_get.
+            // pressure_data_chan is published by zsw_altitude with the filtered FIFO batches.
+            break;
+    }
+}
+
+// Called with scheduler_mutex held.
+static int sensor_fetch_locked(zsw_sensor_sched_sensor_t sensor)
+{
+    sensor_state_t *p_state = &sensors[sensor];
+    zsw_sensor_reading_t reading;
+    int ret;
+
+    ret = sensor_fetch(sensor, &reading);
+    if (ret != 0) {
+        return ret;
+    }
+
+    p_state->reading = reading;
+    p_state->has_reading = true;
+    p_state->fetches++;
+
+    return 0;
+}
+
+// Wake up at the latest moment the most urgent sensor allows, others due by then share the wakeup.
+static void reschedule_locked(int64_t now)
+{
+    int64_t wake = INT64_MAX;
+
+    for (int i = 0; i < ZSW_SENSOR_SCHED_COUNT; i++) {
+        if (sensors[i].period_ms == 0) {
+            continue;
+        }
+        wake = MIN(wake, sensors[i].next_due_ms + sensors[i].max_latency_ms);
+    }
+
+    if (wake == INT64_MAX) {
+        k_work_cancel_delayable(&scheduler_work);
+        return;
+    }
+
+    k_work_reschedule(&scheduler_work, K_MSEC(MAX(wake - now, 0)));
+}
+
+// Merge all requests of a sensor into one period, latency and power state.
+static int sensor_update_locked(zsw_sensor_sched_sensor_t sensor)
+{
+    sensor_state_t *p_state = &sensors[sensor];
+    zsw_sensor_sched_request_t *p_request;
+    uint32_t period_ms = 0;
+    uint32_t max_latency_ms = UINT32_MAX;
+    bool power = !sys_slist_is_empty(&p_state->requests);
+    int ret = 0;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&p_state->requests, p_request, node) {
+        if (p_request->period_ms == 0) {
+            continue;
+        }
+        period_ms = period_ms == 0 ? p_request->period_ms : MIN(period_ms, p_request->period_ms);
+        max_latency_ms = MIN(max_latency_ms, p_request->max_latency_ms);
+    }
+
+    if (power != p_state->powered) {
+        // A waiting one-shot read keeps the sensor on, it powers it off when done.
+        ret = (power || p_state->one_shot_reads == 0) ? sensor_set_power(sensor, power) : 0;
+        if (ret != 0) {
+            LOG_ERR("Failed to power %s %s: %d", sensor_names[sensor], power ? "on" : "off", ret);
+            if (power) {
+                return ret;
+            }
+        }
+        p_state->powered = power;
+        p_state->power_changes++;
+    }
+
+    if (period_ms != 0 && p_state->period_ms == 0) {
+        // Start from the cached reading so a new consumer doesn't cause an extra fetch.
+        p_state->next_due_ms = p_state->has_reading ? p_state->reading.timestamp_ms + period_ms : k_uptime_get();
+    } else if (period_ms != 0 && period_ms < p_state->period_ms) {
+        p_state->next_due_ms = MIN(p_state->next_due_ms, p_state->reading.timestamp_ms + period_ms);
+    }
+
+    p_state->period_ms = period_ms;
+    p_state->max_latency_ms = period_ms != 0 ? max_latency_ms : 0;
+
+    return 0;
+}
+
+static void scheduler_work_handler(struct k_work *work)
+{
+    zsw_sensor_reading_t readings[ZSW_SENSOR_SCHED_COUNT];
+    uint32_t publish_mask = 0;
+    int64_t now = k_uptime_get();
+
+    ARG_UNUSED(work);
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    for (int i = 0; i < ZSW_SENSOR_SCHED_COUNT; i++) {
+        sensor_state_t *p_state = &sensors[i];
+
+        if (p_state->period_ms == 0 || now < p_state->next_due_ms) {
+            continue;
+        }
+        // Keep the average interval at the period, a late fetch doesn't push the following ones.
+        p_state->next_due_ms += p_state->period_ms;
+        if (p_state->next_due_ms <= now) {
+            p_state->next_due_ms = now + p_state->period_ms;
+        }
+        if (sensor_fetch_locked(i) == 0) {
+            readings[i] = p_state->reading;
+            publish_mask |= BIT(i);
+        }
+    }
+    reschedule_locked(now);
+    k_mutex_unlock(&scheduler_mutex);
+
+    // Published without the lock, listeners may call zsw_sensor_scheduler_get.
+    for (int i = 0; i < ZSW_SENSOR_SCHED_COUNT; i++) {
+        if (publish_mask & BIT(i)) {
+            sensor_publish(i, &readings[i]);
+        }
+    }
+}
+
+int zsw_sensor_scheduler_request(zsw_sensor_sched_request_t *p_request)
+{
+    sensor_state_t *p_state;
+    sys_snode_t *p_prev;
+    int ret;
+
+    if (p_request->sensor >= ZSW_SENSOR_SCHED_COUNT) {
+        return -EINVAL;
+    }
+    p_state = &sensors[p_request->sensor];
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if (!sys_slist_find(&p_state->requests, &p_request->node, &p_prev)) {
+        sys_slist_append(&p_state->requests, &p_request->node);
+    }
+    ret = sensor_update_locked(p_request->sensor);
+    if (ret != 0) {
+        // The sensor could not be powered, the request is not kept.
+        sys_slist_find_and_remove(&p_state->requests, &p_request->node);
+    }
+    reschedule_locked(k_uptime_get());
+    k_mutex_unlock(&scheduler_mutex);
+
+    return ret;
+}
+
+int zsw_sensor_scheduler_release(zsw_sensor_sched_request_t *p_request)
+{
+    int ret = 0;
+
+    if (p_request->sensor >= ZSW_SENSOR_SCHED_COUNT) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if (sys_slist_find_and_remove(&sensors[p_request->sensor].requests, &p_request->node)) {
+        sensor_update_locked(p_request->sensor);
+        reschedule_locked(k_uptime_get());
+    } else {
+        ret = -EALREADY;
+    }
+    k_mutex_unlock(&scheduler_mutex);
+
+    return ret;
+}
+
+int zsw_sensor_scheduler_get(zsw_sensor_sched_sensor_t sensor, zsw_sensor_reading_t *p_reading, uint32_t max_age_ms)
+{
+    sensor_state_t *p_state;
+    zsw_sensor_reading_t replayed;
+    int ret = 0;
+
+    if (sensor >= ZSW_SENSOR_SCHED_COUNT) {
+        return -EINVAL;
+    }
+    p_state = &sensors[sensor];
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if (p_state->has_reading && max_age_ms != 0 &&
+        (k_uptime_get() - p_state->reading.timestamp_ms) <= max_age_ms) {
+        p_state->cache_hits++;
+    } else if (!p_state->powered && sensor == ZSW_SENSOR_SCHED_MAG &&
+               zsw_sensor_trace_replay_get(sensor, &replayed) != 0) {
+        // Nobody keeps the magnetometer on, power it just for this read. The cached sample is from when it
+        // was last on, wait for a new one instead.
+        if (p_state->one_shot_reads == 0) {
+            ret = sensor_set_power(sensor, true);
+        }
+        if (ret == 0) {
+            p_state->one_shot_reads++;
+            // Other scheduler users, the periodic work included, go on while waiting for the sample.
+            k_mutex_unlock(&scheduler_mutex);
+            ret = zsw_magnetometer_wait_sample(MAG_WAKE_SAMPLE_PERIODS);
+            k_mutex_lock(&scheduler_mutex, K_FOREVER);
+            p_state->one_shot_reads--;
+            if (ret == 0) {
+                ret = sensor_fetch_locked(sensor);
+            }
+            // Left on if a consumer requested it meanwhile.
+            if (!p_state->powered && p_state->one_shot_reads == 0) {
+                sensor_set_power(sensor, false);
+            }
+        }
+    } else {
+        ret = sensor_fetch_locked(sensor);
+    }
+    if (ret == 0) {
+        *p_reading = p_state->reading;
+    }
+    k_mutex_unlock(&scheduler_mutex);
+
+    return ret;
+}
+
+int zsw_sensor_scheduler_get_stats(zsw_sensor_sched_sensor_t sensor, zsw_sensor_sched_stats_t *p_stats)
+{
+    sensor_state_t *p_state;
+
+    if (sensor >= ZSW_SENSOR_SCHED_COUNT) {
+        return -EINVAL;
+    }
+    p_state = &sensors[sensor];
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    p_stats->consumers = sys_slist_len(&p_state->requests);
+    p_stats->period_ms = p_state->period_ms;
+    p_stats->max_latency_ms = p_state->max_latency_ms;
+    p_stats->powered = p_state->powered;
+    p_stats->fetches = p_state->fetches;
+    p_stats->cache_hits = p_state->cache_hits;
+    p_stats->power_changes = p_state->power_changes;
+    k_mutex_unlock(&scheduler_mutex);
+
+    return 0;
+}
+
+const char *zsw_sensor_scheduler_sensor_name(zsw_sensor_sched_sensor_t sensor)
+{
+    return sensor < ZSW_SENSOR_SCHED_COUNT ? sensor_names[sensor] : "unknown";
+}
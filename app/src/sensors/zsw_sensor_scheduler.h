@@ -0,0 +1,113 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/slist.h>
+
+#include "sensors/zsw_imu.h"
+
+/*
+ * Single owner of the polled sensors. Consumers declare how often they need a sensor
+ * and how late a reading may be, the scheduler merges all requests into one schedule
+ * per device, keeps the device powered only while requested, fetches once and
+ * publishes the reading on the sensor's zbus channel (magnetometer_data_chan,
+ * light_data_chan). Pressure is only fetched, pressure_data_chan is published by
+ * zsw_altitude. Readers that just want a recent value use zsw_sensor_scheduler_get,
+ * which shares the cached reading instead of fetching again.
+ */
+
+typedef enum zsw_sensor_sched_sensor_t {
+    ZSW_SENSOR_SCHED_IMU,               /**< Accelerometer and gyroscope snapshot, powers the gyroscope. */
+    ZSW_SENSOR_SCHED_MAG,               /**< Magnetometer, powered only while requested. */
+    ZSW_SENSOR_SCHED_PRESSURE,          /**< Pressure and temperature. */
+    ZSW_SENSOR_SCHED_LIGHT,             /**< Ambient light. */
+    ZSW_SENSOR_SCHED_COUNT,
+} zsw_sensor_sched_sensor_t;
+
+typedef struct zsw_sensor_reading_t {
+    int64_t timestamp_ms;               /**< Uptime when the reading was fetched. */
+    union {
+        zsw_imu_snapshot_t imu;
+        struct {
+            float x;
+            float y;
+            float z;
+        } mag;                          /**< Micro Tesla, gauss * 100. */
+        struct {
+            float pressure;             /**< Pa. */
+            float temperature;          /**< Degrees Celsius. */
+        } pressure;
+        float light;                    /**< Lux. */
+    } data;
+} zsw_sensor_reading_t;
+
+/*
+* One per consumer and sensor, owned by the consumer and must stay valid until released.
+*/
+typedef struct zsw_sensor_sched_request_t {
+    sys_snode_t node;
+    zsw_sensor_sched_sensor_t sensor;
+    uint32_t period_ms;                 /**< Fetch and publish interval, 0 to only keep the sensor powered. */
+    uint32_t max_latency_ms;            /**< How late a periodic fetch may be, lets it share a wakeup with others. */
+} zsw_sensor_sched_request_t;
+
+typedef struct zsw_sensor_sched_stats_t {
+    uint32_t consumers;
+    uint32_t period_ms;                 /**< Merged period, 0 when nothing polls the sensor. */
+    uint32_t max_latency_ms;
+    bool powered;
+    uint32_t fetches;                   /**< Device reads since boot. */
+    uint32_t cache_hits;                /**< zsw_sensor_scheduler_get calls served without a read. */
+    uint32_t power_changes;
+} zsw_sensor_sched_stats_t;
+
+/**
+ * @brief Add a request, or apply a changed period or latency of an already added one.
+ *
+ * @param p_request Request owned by the caller.
+ * @return 0 on success, negative error code if the sensor could not be powered, the request is then not added.
+ */
+int zsw_sensor_scheduler_request(zsw_sensor_sched_request_t *p_request);
+
+/**
+ * @brief Remove a request, the sensor is powered down when it was the last one.
+ *
+ * @param p_request Request previously passed to zsw_sensor_scheduler_request.
+ * @return 0 on success, -EALREADY if not added.
+ */
+int zsw_sensor_scheduler_release(zsw_sensor_sched_request_t *p_request);
+
+/**
+ * @brief Get a reading no older than max_age_ms, the device is only read if the cached one is older.
+ *
+ * @param sensor Sensor to read.
+ * @param p_reading Where to store the reading.
+ * @param max_age_ms Oldest acceptable reading, 0 always reads the device.
+ * @return 0 on success, -EAGAIN if the magnetometer was off and gave no new sample in time,
+ *         other negative error code on failure.
+ */
+int zsw_sensor_scheduler_get(zsw_sensor_sched_sensor_t sensor, zsw_sensor_reading_t *p_reading, uint32_t max_age_ms);
+
+/**
+ * @brief Get the merged schedule and counters of a sensor.
+ */
+int zsw_sensor_scheduler_get_stats(zsw_sensor_sched_sensor_t sensor, zsw_sensor_sched_stats_t *p_stats);
+
+const char *zsw_sensor_scheduler_sensor_name(zsw_sensor_sched_sensor_t sensor);
@@ -0,0 +1,547 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef CONFIG_ZSW_SENSOR_TRACE
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/sensor.h>
+#if defined(CONFIG_ZSW_BMP581_EMUL) || defined(CONFIG_ZSW_APDS9306_EMUL)
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_sensor.h>
+#endif
+
+#include "sensors/zsw_sensor_trace.h"
+#include "sensors/zsw_imu.h"
+
+LOG_MODULE_REGISTER(zsw_sensor_trace, CONFIG_ZSW_SENSORS_LOG_LEVEL);
+
+#define MAX_PATH_LEN            64
+#define WRITE_BUF_SIZE          512
+// Records handled per replay work run before yielding the workqueue.
+#define REPLAY_BATCH            32
+
+typedef struct {
+    zsw_sensor_trace_record_t record;
+    uint8_t payload[ZSW_SENSOR_TRACE_MAX_PAYLOAD];
+} trace_entry_t;
+
+// Record and payload are written as one, so a failed write never leaves a record without its payload.
+BUILD_ASSERT(offsetof(trace_entry_t, payload) == sizeof(zsw_sensor_trace_record_t));
+
+static void write_work_handler(struct k_work *work);
+static void replay_work_handler(struct k_work *work);
+
+K_MSGQ_DEFINE(trace_msgq, sizeof(trace_entry_t), CONFIG_ZSW_SENSOR_TRACE_QUEUE_SIZE, 4);
+K_WORK_DEFINE(write_work, write_work_handler);
+K_WORK_DELAYABLE_DEFINE(replay_work, replay_work_handler);
+static K_MUTEX_DEFINE(trace_mutex);
+
+static const uint8_t payload_size[ZSW_SENSOR_SCHED_COUNT] = {
+    [ZSW_SENSOR_SCHED_IMU] = 6 * sizeof(int16_t),
+    [ZSW_SENSOR_SCHED_MAG] = 3 * sizeof(float),
+    [ZSW_SENSOR_SCHED_PRESSURE] = 2 * sizeof(float),
+    [ZSW_SENSOR_SCHED_LIGHT] = sizeof(float),
+};
+
+static zsw_sensor_trace_mode_t mode;
+static struct fs_file_t file;
+static zsw_sensor_trace_header_t header;
+static uint32_t records;
+static atomic_t dropped;
+static uint32_t elapsed_ms;
+
+// Recording
+static atomic_t recording;
+// Written while not recording and published by setting recording, read without trace_mutex.
+static uint32_t record_mask;
+static int64_t record_start_ms;
+static zsw_sensor_sched_request_t requests[ZSW_SENSOR_SCHED_COUNT];
+static uint8_t write_buf[WRITE_BUF_SIZE];
+static size_t write_buf_pos;
+
+// Replay
+static struct k_spinlock replay_lock;
+static zsw_sensor_reading_t replay_readings[ZSW_SENSOR_SCHED_COUNT];
+static uint32_t replay_valid;
+static int64_t replay_start_ms;
+static uint8_t replay_speed;
+static trace_entry_t replay_next;
+static bool replay_has_next;
+
+static void make_path(char *p_path, const char *name)
+{
+    snprintf(p_path, MAX_PATH_LEN, ZSW_SENSOR_TRACE_DIR "/%s", name);
+}
+
+static int flush_write_buf(void)
+{
+    ssize_t written;
+
+    if (write_buf_pos == 0) {
+        return 0;
+    }
+
+    written = fs_write(&file, write_buf, write_buf_pos);
+    if (written < 0) {
+        LOG_ERR("Flash write failed: %d", (int)written);
+        return (int)written;
+    }
+    if ((size_t)written != write_buf_pos) {
+        LOG_ERR("Short write: %d/%u", (int)written, (unsigned int)write_buf_pos);
+        return -EIO;
+    }
+    write_buf_pos = 0;
+
+    return 0;
+}
+
+static int buffered_write(const void *p_data, size_t len)
+{
+    int ret;
+
+    if (write_buf_pos + len > sizeof(write_buf)) {
+        ret = flush_write_buf();
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    memcpy(&write_buf[write_buf_pos], p_data, len);
+    write_buf_pos += len;
+
+    return 0;
+}
+
+static void encode_payload(zsw_sensor_sched_sensor_t sensor, const zsw_sensor_reading_t *p_reading,
+                           uint8_t *p_payload)
+{
+    switch (sensor) {
+        case ZSW_SENSOR_SCHED_IMU:
+            memcpy(p_payload, p_reading->data.imu.accel_raw, sizeof(p_reading->data.imu.accel_raw));
+            memcpy(p_payload + sizeof(p_reading->data.imu.accel_raw), p_reading->data.imu.gyro_raw,
+                   sizeof(p_reading->data.imu.gyro_raw));
+            break;
+        case ZSW_SENSOR_SCHED_MAG:
+            memcpy(p_payload, &p_reading->data.mag, payload_size[sensor]);
+            break;
+        case ZSW_SENSOR_SCHED_PRESSURE:
+            memcpy(p_payload, &p_reading->data.pressure, payload_size[sensor]);
+            break;
+        case ZSW_SENSOR_SCHED_LIGHT:
+            memcpy(p_payload, &p_reading->data.light, payload_size[sensor]);
+            break;
+        default:
+            break;
+    }
+}
+
+static void decode_payload(zsw_sensor_sched_sensor_t sensor, const uint8_t *p_payload,
+                           zsw_sensor_reading_t *p_reading)
+{
+    switch (sensor) {
+        case ZSW_SENSOR_SCHED_IMU: {
+            zsw_imu_snapshot_t *p_imu = &p_reading->data.imu;
+            // Same scaling as zsw_imu_fetch_snapshot, a raw value of INT16_MAX equals the full scale.
+            float accel_scale = (header.accel_range_g * (SENSOR_G / 1000000.0f)) / INT16_MAX;
+            float gyro_scale = (header.gyro_range_dps * (SENSOR_PI / 1000000.0f)) / (180.0f * INT16_MAX);
+
+            memcpy(p_imu->accel_raw, p_payload, sizeof(p_imu->accel_raw));
+            memcpy(p_imu->gyro_raw, p_payload + sizeof(p_imu->accel_raw), sizeof(p_imu->gyro_raw));
+            for (int i = 0; i < 3; i++) {
+                p_imu->accel[i] = p_imu->accel_raw[i] * accel_scale;
+                p_imu->gyro[i] = p_imu->gyro_raw[i] * gyro_scale;
+            }
+            break;
+        }
+        case ZSW_SENSOR_SCHED_MAG:
+            memcpy(&p_reading->data.mag, p_payload, payload_size[sensor]);
+            break;
+        case ZSW_SENSOR_SCHED_PRESSURE:
+            memcpy(&p_reading->data.pressure, p_payload, payload_size[sensor]);
+            break;
+        case ZSW_SENSOR_SCHED_LIGHT:
+            memcpy(&p_reading->data.light, p_payload, payload_size[sensor]);
+            break;
+        default:
+            break;
+    }
+}
+
+static void write_queued_locked(void)
+{
+    trace_entry_t entry;
+
+    while (k_msgq_get(&trace_msgq, &entry, K_NO_WAIT) == 0) {
+        if (buffered_write(&entry, sizeof(entry.record) + payload_size[entry.record.sensor]) != 0) {
+            atomic_inc(&dropped);
+            continue;
+        }
+        records++;
+        elapsed_ms = entry.record.time_ms;
+    }
+}
+
+static void write_work_handler(struct k_work *work)
+{
+    k_mutex_lock(&trace_mutex, K_FOREVER);
+    if (mode == ZSW_SENSOR_TRACE_RECORDING) {
+        write_queued_locked();
+    }
+    k_mutex_unlock(&trace_mutex);
+}
+
+void zsw_sensor_trace_on_reading(zsw_sensor_sched_sensor_t sensor, const zsw_sensor_reading_t *p_reading)
+{
+    trace_entry_t entry;
+
+    if (!atomic_get(&recording)) {
+        return;
+    }
+    // Pairs with the fence in zsw_sensor_trace_record_start, the mask and start time are seen as published.
+    barrier_dmem_fence_full();
+    if (!(record_mask & BIT(sensor))) {
+        return;
+    }
+
+    entry.record.time_ms = (uint32_t)(p_reading->timestamp_ms - record_start_ms);
+    entry.record.sensor = sensor;
+    encode_payload(sensor, p_reading, entry.payload);
+
+    // Called with the scheduler locked, flash writes are left to the workqueue.
+    if (k_msgq_put(&trace_msgq, &entry, K_NO_WAIT) != 0) {
+        atomic_inc(&dropped);
+        return;
+    }
+    k_work_submit(&write_work);
+}
+
+static void release_requests(void)
+{
+    for (int i = 0; i < ZSW_SENSOR_SCHED_COUNT; i++) {
+        if (requests[i].period_ms != 0) {
+            zsw_sensor_scheduler_release(&requests[i]);
+            requests[i].period_ms = 0;
+        }
+    }
+}
+
+int zsw_sensor_trace_record_start(const char *name, uint32_t period_ms, uint32_t sensor_mask)
+{
+    char path[MAX_PATH_LEN];
+    int ret;
+
+    k_mutex_lock(&trace_mutex, K_FOREVER);
+    if (mode != ZSW_SENSOR_TRACE_IDLE) {
+        ret = -EBUSY;
+        goto out;
+    }
+
+    ret = fs_mkdir(ZSW_SENSOR_TRACE_DIR);
+    if ((ret != 0) && (ret != -EEXIST)) {
+        LOG_ERR("Failed to create %s: %d", ZSW_SENSOR_TRACE_DIR, ret);
+        goto out;
+    }
+
+    make_path(path, name);
+    fs_file_t_init(&file);
+    ret = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE | FS_O_TRUNC);
+    if (ret != 0) {
+        LOG_ERR("Failed to open %s: %d", path, ret);
+        goto out;
+    }
+
+    header = (zsw_sensor_trace_header_t) {
+        .magic = ZSW_SENSOR_TRACE_MAGIC,
+        .version = ZSW_SENSOR_TRACE_VERSION,
+    };
+    if (zsw_imu_fifo_get_scale(&header.accel_range_g, &header.gyro_range_dps) != 0) {
+        sensor_mask &= ~BIT(ZSW_SENSOR_SCHED_IMU);
+    }
+
+    write_buf_pos = 0;
+    ret = buffered_write(&header, sizeof(header));
+    if (ret != 0) {
+        fs_close(&file);
+        goto out;
+    }
+
+    k_msgq_purge(&trace_msgq);
+    records = 0;
+    elapsed_ms = 0;
+    atomic_set(&dropped, 0);
+    record_mask = sensor_mask;
+    record_start_ms = k_uptime_get();
+    mode = ZSW_SENSOR_TRACE_RECORDING;
+    barrier_dmem_fence_full();
+    atomic_set(&recording, true);
+
+    if (period_ms != 0) {
+        for (int i = 0; i < ZSW_SENSOR_SCHED_COUNT; i++) {
+            if (!(sensor_mask & BIT(i))) {
+                continue;
+            }
+            requests[i] = (zsw_sensor_sched_request_t) {
+                .sensor = i,
+                .period_ms = period_ms,
+                .max_latency_ms = period_ms / 2,
+            };
+            if (zsw_sensor_scheduler_request(&requests[i]) != 0) {
+                LOG_WRN("%s not available, not recorded", zsw_sensor_scheduler_sensor_name(i));
+                requests[i].period_ms = 0;
+            }
+        }
+    }
+
+    LOG_INF("Recording %s", path);
+
+out:
+    k_mutex_unlock(&trace_mutex);
+    return ret;
+}
+
+static int read_entry_locked(trace_entry_t *p_entry)
+{
+    ssize_t len;
+
+    len = fs_read(&file, &p_entry->record, sizeof(p_entry->record));
+    if (len != sizeof(p_entry->record)) {
+        return len < 0 ? (int)len : -ENODATA;
+    }
+
+    if (p_entry->record.sensor >= ZSW_SENSOR_SCHED_COUNT) {
+        LOG_ERR("Corrupt trace, sensor %u", p_entry->record.sensor);
+        return -EINVAL;
+    }
+
+    len = fs_read(&file, p_entry->payload, payload_size[p_entry->record.sensor]);
+    if (len != payload_size[p_entry->record.sensor]) {
+        return len < 0 ? (int)len : -ENODATA;
+    }
+
+    return 0;
+}
+
+static void replay_to_emulators(zsw_sensor_sched_sensor_t sensor, const zsw_sensor_reading_t *p_reading)
+{
+#if defined(CONFIG_ZSW_BMP581_EMUL) || defined(CONFIG_ZSW_APDS9306_EMUL)
+    struct sensor_chan_spec chan = { 0 };
+    const struct emul *p_emul = NULL;
+    q31_t value;
+    // Pressure and lux both fit in 17 integer bits.
+    const int8_t shift = 17;
+
+    switch (sensor) {
+#ifdef CONFIG_ZSW_BMP581_EMUL
+        case ZSW_SENSOR_SCHED_PRESSURE:
+            p_emul = EMUL_DT_GET(DT_NODELABEL(bmp581));
+            chan.chan_type = SENSOR_CHAN_PRESS;
+            value = (q31_t)(p_reading->data.pressure.pressure * (1 << (31 - shift)));
+            break;
+#endif
+#ifdef CONFIG_ZSW_APDS9306_EMUL
+        case ZSW_SENSOR_SCHED_LIGHT:
+            p_emul = EMUL_DT_GET(DT_NODELABEL(apds9306));
+            chan.chan_type = SENSOR_CHAN_LIGHT;
+            value = (q31_t)(p_reading->data.light * (1 << (31 - shift)));
+            break;
+#endif
+        default:
+            break;
+    }
+
+    // Lets consumers that read the driver directly, like the altitude engine, see the trace too.
+    if (p_emul != NULL) {
+        emul_sensor_backend_set_channel(p_emul, chan, &value, shift);
+    }
+#endif
+}
+
+static void replay_stop_locked(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&replay_lock);
+
+    replay_valid = 0;
+    k_spin_unlock(&replay_lock, key);
+
+    fs_close(&file);
+    mode = ZSW_SENSOR_TRACE_IDLE;
+    LOG_INF("Replay stopped after %u records", records);
+}
+
+static void replay_work_handler(struct k_work *work)
+{
+    zsw_sensor_reading_t reading;
+    int64_t now;
+    int64_t due;
+
+    k_mutex_lock(&trace_mutex, K_FOREVER);
+    if (mode != ZSW_SENSOR_TRACE_REPLAYING) {
+        k_mutex_unlock(&trace_mutex);
+        return;
+    }
+
+    for (int i = 0; i < REPLAY_BATCH; i++) {
+        if (!replay_has_next) {
+            if (read_entry_locked(&replay_next) != 0) {
+                replay_stop_locked();
+                k_mutex_unlock(&trace_mutex);
+                return;
+            }
+            replay_has_next = true;
+        }
+
+        now = k_uptime_get();
+        due = replay_start_ms + replay_next.record.time_ms / replay_speed;
+        if (due > now) {
+            k_work_schedule(&replay_work, K_MSEC(due - now));
+            k_mutex_unlock(&trace_mutex);
+            return;
+        }
+
+        memset(&reading, 0, sizeof(reading));
+        decode_payload(replay_next.record.sensor, replay_next.payload, &reading);
+
+        k_spinlock_key_t key = k_spin_lock(&replay_lock);
+        replay_readings[replay_next.record.sensor] = reading;
+        replay_valid |= BIT(replay_next.record.sensor);
+        k_spin_unlock(&replay_lock, key);
+
+        replay_to_emulators(replay_next.record.sensor, &reading);
+
+        records++;
+        elapsed_ms = replay_next.record.time_ms;
+        replay_has_next = false;
+    }
+
+    k_work_schedule(&replay_work, K_NO_WAIT);
+    k_mutex_unlock(&trace_mutex);
+}
+
+int zsw_sensor_trace_replay_get(zsw_sensor_sched_sensor_t sensor, zsw_sensor_reading_t *p_reading)
+{
+    k_spinlock_key_t key = k_spin_lock(&replay_lock);
+    int ret = -ENODATA;
+
+    if (replay_valid & BIT(sensor)) {
+        *p_reading = replay_readings[sensor];
+        p_reading->timestamp_ms = k_uptime_get();
+        if (sensor == ZSW_SENSOR_SCHED_IMU) {
+            p_reading->data.imu.uptime_ms = p_reading->timestamp_ms;
+        }
+        ret = 0;
+    }
+    k_spin_unlock(&replay_lock, key);
+
+    return ret;
+}
+
+int zsw_sensor_trace_replay_start(const char *name, uint8_t speed)
+{
+    char path[MAX_PATH_LEN];
+    ssize_t len;
+    int ret;
+
+    if (speed == 0) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&trace_mutex, K_FOREVER);
+    if (mode != ZSW_SENSOR_TRACE_IDLE) {
+        ret = -EBUSY;
+        goto out;
+    }
+
+    make_path(path, name);
+    fs_file_t_init(&file);
+    ret = fs_open(&file, path, FS_O_READ);
+    if (ret != 0) {
+        LOG_ERR("Failed to open %s: %d", path, ret);
+        goto out;
+    }
+
+    len = fs_read(&file, &header, sizeof(header));
+    if ((len != sizeof(header)) || (header.magic != ZSW_SENSOR_TRACE_MAGIC) ||
+        (header.version != ZSW_SENSOR_TRACE_VERSION)) {
+        LOG_ERR("%s is not a sensor trace", path);
+        fs_close(&file);
+        ret = -EINVAL;
+        goto out;
+    }
+
+    records = 0;
+    elapsed_ms = 0;
+    atomic_set(&dropped, 0);
+    replay_speed = speed;
+    replay_has_next = false;
+    replay_start_ms = k_uptime_get();
+    mode = ZSW_SENSOR_TRACE_REPLAYING;
+    k_work_schedule(&replay_work, K_NO_WAIT);
+
+    LOG_INF("Replaying %s at %ux", path, speed);
+
+out:
+    k_mutex_unlock(&trace_mutex);
+    return ret;
+}
+
+int zsw_sensor_trace_stop(void)
+{
+    struct k_work_sync sync;
+    int ret = 0;
+
+    k_work_cancel_delayable_sync(&replay_work, &sync);
+
+    k_mutex_lock(&trace_mutex, K_FOREVER);
+    switch (mode) {
+        case ZSW_SENSOR_TRACE_RECORDING:
+            atomic_set(&recording, false);
+            release_requests();
+            write_queued_locked();
+            ret = flush_write_buf();
+            fs_close(&file);
+            mode = ZSW_SENSOR_TRACE_IDLE;
+            LOG_INF("Recorded %u records, %u dropped", records, (uint32_t)atomic_get(&dropped));
+            break;
+        case ZSW_SENSOR_TRACE_REPLAYING:
+            replay_stop_locked();
+            break;
+        default:
+            ret = -EALREADY;
+            break;
+    }
+    k_mutex_unlock(&trace_mutex);
+
+    return ret;
+}
+
+void zsw_sensor_trace_get_status(zsw_sensor_trace_status_t *p_status)
+{
+    k_mutex_lock(&trace_mutex, K_FOREVER);
+    p_status->mode = mode;
+    p_status->records = records;
+    p_status->dropped = atomic_get(&dropped);
+    p_status->elapsed_ms = elapsed_ms;
+    k_mutex_unlock(&trace_mutex);
+}
+
+#endif /* CONFIG_ZSW_SENSOR_TRACE */
@@ -0,0 +1,120 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+#include "sensors/zsw_sensor_scheduler.h"
+
+/*
+ * Records the readings fetched through the sensor scheduler to a file and replays such
+ * a file in place of the sensors, so sensor consumers can be tested against the same
+ * recorded walk, run or night. Traces are stored in ZSW_SENSOR_TRACE_DIR.
+ *
+ * Only consumers that read through the sensor scheduler see a replay. Sensor fusion with
+ * CONFIG_SENSOR_FUSION_USE_IMU_FIFO reads batches straight from the IMU FIFO, and steps come
+ * from the IMU's hardware step counter, so neither is recorded or replayed.
+ *
+ * File format, little endian:
+ *   zsw_sensor_trace_header_t
+ *   zsw_sensor_trace_record_t followed by the sensor payload, repeated until end of file:
+ *     IMU:      int16_t accel_raw[3], int16_t gyro_raw[3]
+ *     MAG:      float x, y, z in micro Tesla (gauss * 100)
+ *     PRESSURE: float pressure in Pa, float temperature in degrees Celsius
+ *     LIGHT:    float lux
+ */
+
+#define ZSW_SENSOR_TRACE_DIR            "/user/traces"
+#define ZSW_SENSOR_TRACE_MAGIC          0x5254535AUL    // "ZSTR"
+// 2: magnetometer readings in micro Tesla, they were gauss * 10 before.
+#define ZSW_SENSOR_TRACE_VERSION        2
+#define ZSW_SENSOR_TRACE_MAX_PAYLOAD    12
+
+typedef struct __packed zsw_sensor_trace_header_t {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t accel_range_g;              /**< Full scale of the raw accelerometer samples. */
+    uint16_t gyro_range_dps;            /**< Full scale of the raw gyroscope samples. */
+} zsw_sensor_trace_header_t;
+
+typedef struct __packed zsw_sensor_trace_record_t {
+    uint32_t time_ms;                   /**< Since the recording started. */
+    uint8_t sensor;                     /**< zsw_sensor_sched_sensor_t */
+} zsw_sensor_trace_record_t;
+
+typedef enum zsw_sensor_trace_mode_t {
+    ZSW_SENSOR_TRACE_IDLE,
+    ZSW_SENSOR_TRACE_RECORDING,
+    ZSW_SENSOR_TRACE_REPLAYING,
+} zsw_sensor_trace_mode_t;
+
+typedef struct zsw_sensor_trace_status_t {
+    zsw_sensor_trace_mode_t mode;
+    uint32_t records;                   /**< Records written or replayed. */
+    uint32_t dropped;                   /**< Readings not recorded because the write queue was full or a write failed. */
+    uint32_t elapsed_ms;                /**< Trace time of the last record. */
+} zsw_sensor_trace_status_t;
+
+#ifdef CONFIG_ZSW_SENSOR_TRACE
+
+/** @brief              Start recording every reading fetched through the sensor scheduler.
+ *  @param name         File name in ZSW_SENSOR_TRACE_DIR, overwritten if it exists
+ *  @param period_ms    Also poll the sensors in sensor_mask at this period, 0 to only record other consumers' reads
+ *  @param sensor_mask  Bit per zsw_sensor_sched_sensor_t to record
+ *  @return             0 on success, -EBUSY if already recording or replaying, negative error code on failure.
+*/
+int zsw_sensor_trace_record_start(const char *name, uint32_t period_ms, uint32_t sensor_mask);
+
+/** @brief          Replay a trace, the sensor scheduler returns the traced readings instead of reading the sensors.
+ *  @param name     File name in ZSW_SENSOR_TRACE_DIR
+ *  @param speed    Replay speed, 1 is real time
+ *  @return         0 on success, -EBUSY if already recording or replaying, negative error code on failure.
+*/
+int zsw_sensor_trace_replay_start(const char *name, uint8_t speed);
+
+/** @brief Stop recording or replaying, a recording is flushed to flash.
+ *  @return 0 on success, -EALREADY if idle, negative error code on failure.
+*/
+int zsw_sensor_trace_stop(void);
+
+void zsw_sensor_trace_get_status(zsw_sensor_trace_status_t *p_status);
+
+/** @brief Called by the sensor scheduler with every reading fetched from a sensor.
+*/
+void zsw_sensor_trace_on_reading(zsw_sensor_sched_sensor_t sensor, const zsw_sensor_reading_t *p_reading);
+
+/** @brief              Called by the sensor scheduler before reading a sensor.
+ *  @return             0 with the replayed reading in p_reading, -ENODATA if the sensor is not replayed.
+*/
+int zsw_sensor_trace_replay_get(zsw_sensor_sched_sensor_t sensor, zsw_sensor_reading_t *p_reading);
+
+#else
+
+static inline void zsw_sensor_trace_on_reading(zsw_sensor_sched_sensor_t sensor,
+                                               const zsw_sensor_reading_t *p_reading)
+{
+}
+
+static inline int zsw_sensor_trace_replay_get(zsw_sensor_sched_sensor_t sensor, zsw_sensor_reading_t *p_reading)
+{
+    return -ENODATA;
+}
+
+#endif
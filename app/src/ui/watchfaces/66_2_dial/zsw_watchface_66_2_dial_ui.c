@@ -459,7 +459,8 @@ static watchface_ui_api_t ui_api = {
     .set_watch_env_sensors = watchface_66_2_dial_set_watch_env_sensors,
     .ui_invalidate_cached = watchface_66_2_dial_invalidate_cached,
     .get_preview_img = watchface_66_2_dial_get_preview_img,
-    .name = "Jungle"
+    .name = "Jungle",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_MINUTE,
 };
 
 static int watchface_66_2_dial_init(void)
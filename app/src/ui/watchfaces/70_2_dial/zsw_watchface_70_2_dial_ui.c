@@ -12,6 +12,7 @@
 
 #include "ui/zsw_ui.h"
 #include "applications/watchface/watchface_app.h"
+#include "ui/watchfaces/zsw_watchface_planner.h"
 
 LOG_MODULE_REGISTER(watchface_70_2_dial, LOG_LEVEL_WRN);
 
@@ -173,9 +174,9 @@ static void watchface_70_2_dial_set_datetime(int day_of_week, int date, int day,
     if (getPlaceValue(last_minute, 2) != getPlaceValue(minute, 2)) {
         lv_image_set_src(face_70_2_dial_4_125929, face_70_2_dial_1_125929_group[(minute / 10) % 10]);
     }
-    lv_image_set_rotation(face_70_2_dial_13_60900, hour * 300 + (minute * 5));
-    lv_image_set_rotation(face_70_2_dial_29_90967, minute * 60);
-    lv_image_set_rotation(face_70_2_dial_45_130547, second * 60);
+    zsw_watchface_planner_set_rotation(face_70_2_dial_13_60900, hour * 300 + (minute * 5));
+    zsw_watchface_planner_set_rotation(face_70_2_dial_29_90967, minute * 60);
+    zsw_watchface_planner_set_rotation(face_70_2_dial_45_130547, second * 60);
 
     last_hour = hour;
     last_minute = minute;
@@ -448,6 +449,7 @@ static watchface_ui_api_t ui_api = {
     .ui_invalidate_cached = watchface_70_2_dial_invalidate_cached,
     .get_preview_img = watchface_70_2_dial_get_preview_img,
     .name = "Yin-yang",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_SECOND,
 };
 
 static int watchface_70_2_dial_init(void)
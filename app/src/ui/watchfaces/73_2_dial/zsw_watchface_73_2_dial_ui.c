@@ -668,6 +668,7 @@ static watchface_ui_api_t ui_api = {
     .ui_invalidate_cached = watchface_73_2_dial_invalidate_cached,
     .get_preview_img = watchface_73_2_dial_get_preview_img,
     .name = "Digital Fire",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_MINUTE,
 };
 
 static int watchface_73_2_dial_init(void)
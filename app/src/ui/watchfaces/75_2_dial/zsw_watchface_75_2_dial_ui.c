@@ -12,6 +12,7 @@
 
 #include "ui/zsw_ui.h"
 #include "applications/watchface/watchface_app.h"
+#include "ui/watchfaces/zsw_watchface_planner.h"
 #include "ui/watchfaces/zsw_ui_notification_area.h"
 
 LOG_MODULE_REGISTER(watchface_75_2_dial, LOG_LEVEL_WRN);
@@ -137,9 +138,9 @@ static void watchface_75_2_dial_set_datetime(int day_of_week, int date, int day,
     if (getPlaceValue(last_weekday, 1) != getPlaceValue(weekday, 1)) {
         lv_image_set_src(face_75_2_dial_2_216824, face_75_2_dial_2_216824_group[((weekday + 6) / 1) % 7]);
     }
-    lv_image_set_rotation(face_75_2_dial_3_59132, hour * 300 + (minute * 5));
-    lv_image_set_rotation(face_75_2_dial_19_89191, minute * 60);
-    lv_image_set_rotation(face_75_2_dial_35_138999, second * 60);
+    zsw_watchface_planner_set_rotation(face_75_2_dial_3_59132, hour * 300 + (minute * 5));
+    zsw_watchface_planner_set_rotation(face_75_2_dial_19_89191, minute * 60);
+    zsw_watchface_planner_set_rotation(face_75_2_dial_35_138999, second * 60);
 
     last_weekday = weekday;
 }
@@ -291,6 +292,7 @@ static watchface_ui_api_t ui_api = {
     .ui_invalidate_cached = watchface_75_2_dial_invalidate_cached,
     .get_preview_img = watchface_75_2_dial_get_preview_img,
     .name = "Analog Blue",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_SECOND,
 };
 
 static int watchface_75_2_dial_init(void)
@@ -446,6 +446,7 @@ static watchface_ui_api_t ui_api = {
     .ui_invalidate_cached = watchface_84_2_dial_invalidate_cached,
     .get_preview_img = watchface_84_2_dial_get_preview_img,
     .name = "Floating Space",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_MINUTE,
 };
 
 static int watchface_84_2_dial_init(void)
@@ -635,6 +635,7 @@ static watchface_ui_api_t ui_api = {
     .ui_invalidate_cached = watchface_ui_invalidate_cached,
     .get_preview_img = watchface_get_preview_img,
     .name = "ZSWatch Digital",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_SECOND,
 };
 
 static int watchface_init(void)
@@ -23,6 +23,7 @@
 #include "ui/utils/zsw_ui_utils.h"
 #include "applications/watchface/watchface_app.h"
 #include "ui/watchfaces/zsw_ui_notification_area.h"
+#include "ui/watchfaces/zsw_watchface_planner.h"
 
 LOG_MODULE_REGISTER(watchface_minimal, LOG_LEVEL_WRN);
 
@@ -49,6 +50,8 @@ static int last_hour = -1;
 static int last_minute = -1;
 static int last_second = -1;
 static int last_num_not = -1;
+static int last_date = -1;
+static int last_day_of_week = -1;
 
 static void watchface_show(lv_obj_t *parent, watchface_app_evt_listener evt_cb, zsw_settings_watchface_t *settings)
 {
@@ -183,7 +186,11 @@ static void watchface_set_datetime(int day_of_week, int date, int day, int month
     }
     char *days[] = { "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT"};
 
-    lv_label_set_text_fmt(ui_day_data_label, "%s %d", days[day_of_week], date);
+    if (last_date != date || last_day_of_week != day_of_week) {
+        lv_label_set_text_fmt(ui_day_data_label, "%s %d", days[day_of_week], date);
+        last_date = date;
+        last_day_of_week = day_of_week;
+    }
 
     hour = hour % 12;
     // Move hour hand with greater resolution than 12.
@@ -191,11 +198,11 @@ static void watchface_set_datetime(int day_of_week, int date, int day, int month
     last_hour = hour_minute_offset + hour * (3600 / 12);
     last_minute = minute * (3600 / 60);
     last_second = second * (3600 / 60);
-    lv_image_set_rotation(ui_hour_img, last_hour);
-    lv_image_set_rotation(ui_min_img, last_minute);
+    zsw_watchface_planner_set_rotation(ui_hour_img, last_hour);
+    zsw_watchface_planner_set_rotation(ui_min_img, last_minute);
 
     last_second += lv_map(usec, 0, 999999, 0, 3600 / 60);
-    lv_image_set_rotation(ui_second_img, last_second);
+    zsw_watchface_planner_set_rotation(ui_second_img, last_second);
 }
 
 static void watchface_set_watch_env_sensors(int pressure)
@@ -208,6 +215,8 @@ static void watchface_ui_invalidate_cached(void)
     last_minute = -1;
     last_num_not = -1;
     last_second = -1;
+    last_date = -1;
+    last_day_of_week = -1;
 }
 
 static const void *watchface_get_preview_img(void)
@@ -229,6 +238,7 @@ static watchface_ui_api_t ui_api = {
     .ui_invalidate_cached = watchface_ui_invalidate_cached,
     .get_preview_img = watchface_get_preview_img,
     .name = "Analog Minimal",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_SUB_SECOND,
 };
 
 static int watchface_init(void)
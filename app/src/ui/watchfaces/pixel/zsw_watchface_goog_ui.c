@@ -776,7 +776,8 @@ static watchface_ui_api_t ui_api = {
     .set_watch_env_sensors = watchface_goog_set_watch_env_sensors,
     .ui_invalidate_cached = watchface_goog_invalidate_cached,
     .get_preview_img = watchface_goog_get_preview_img,
-    .name = "Pixel"
+    .name = "Pixel",
+    .time_granularity = WATCHFACE_TIME_GRANULARITY_MINUTE,
 };
 
 static int watchface_goog_init(void)
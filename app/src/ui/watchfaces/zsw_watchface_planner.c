@@ -0,0 +1,338 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "ui/watchfaces/zsw_watchface_planner.h"
+
+LOG_MODULE_REGISTER(watchface_planner, LOG_LEVEL_WRN);
+
+// Same limit as LVGL, more invalidated areas than this and LVGL redraws the whole screen.
+#define MAX_TICK_AREAS      LV_INV_BUF_SIZE
+#define HAND_SEGMENTS       4
+// Room for the hour, minute and second hand, at their old and new position.
+#define MAX_HAND_AREAS      (3 * 2 * HAND_SEGMENTS)
+// Anti-aliased edges of a rotated image bleed into the pixel next to it.
+#define HAND_MARGIN         2
+
+static lv_display_t *display;
+static bool active;
+static uint32_t active_start_ms;
+// Updated on the LVGL thread and read from the shell, guards the stats and the active time.
+static struct k_spinlock stats_lock;
+static zsw_watchface_planner_stats_t stats;
+
+static bool in_tick;
+static lv_area_t tick_areas[MAX_TICK_AREAS];
+static uint32_t num_tick_areas;
+static bool tick_full_screen;
+
+static lv_area_t hand_areas[MAX_HAND_AREAS];
+static uint32_t num_hand_areas;
+
+static void sort_ascending(int32_t *values, uint32_t num)
+{
+    for (uint32_t i = 1; i < num; i++) {
+        int32_t value = values[i];
+        uint32_t j = i;
+
+        for (; j > 0 && values[j - 1] > value; j--) {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+}
+
+// Pixels covered by any of the areas, counting overlaps once. Sweeps the vertical strips between area edges.
+static uint32_t union_size(const lv_area_t *areas, uint32_t num)
+{
+    int32_t xs[2 * MAX_TICK_AREAS];
+    uint32_t num_xs = 0;
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i < num; i++) {
+        xs[num_xs++] = areas[i].x1;
+        xs[num_xs++] = areas[i].x2 + 1;
+    }
+    sort_ascending(xs, num_xs);
+
+    for (uint32_t k = 0; k + 1 < num_xs; k++) {
+        int32_t y1s[MAX_TICK_AREAS];
+        int32_t y2s[MAX_TICK_AREAS];
+        uint32_t num_ys = 0;
+        int32_t covered = 0;
+        int32_t end = INT32_MIN;
+
+        if (xs[k] == xs[k + 1]) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < num; i++) {
+            if (areas[i].x1 <= xs[k] && areas[i].x2 >= xs[k + 1] - 1) {
+                y1s[num_ys] = areas[i].y1;
+                y2s[num_ys] = areas[i].y2 + 1;
+                num_ys++;
+            }
+        }
+
+        // Start and end points sorted on their own still give the length of the union of the intervals.
+        sort_ascending(y1s, num_ys);
+        sort_ascending(y2s, num_ys);
+        for (uint32_t i = 0; i < num_ys; i++) {
+            int32_t start = MAX(y1s[i], end);
+
+            if (y2s[i] > start) {
+                covered += y2s[i] - start;
+            }
+            end = MAX(end, y2s[i]);
+        }
+
+        size += covered * (xs[k + 1] - xs[k]);
+    }
+
+    return size;
+}
+
+// Join areas while the joined area is no larger than the two apart, the rule LVGL uses for its own areas.
+static void merge_areas(lv_area_t *areas, uint32_t *p_num)
+{
+    bool merged;
+
+    do {
+        merged = false;
+        for (uint32_t i = 0; i < *p_num && !merged; i++) {
+            for (uint32_t j = i + 1; j < *p_num && !merged; j++) {
+                lv_area_t joined;
+
+                lv_area_join(&joined, &areas[i], &areas[j]);
+                if (lv_area_get_size(&joined) <= lv_area_get_size(&areas[i]) + lv_area_get_size(&areas[j])) {
+                    areas[i] = joined;
+                    areas[j] = areas[*p_num - 1];
+                    (*p_num)--;
+                    merged = true;
+                }
+            }
+        }
+    } while (merged);
+}
+
+static void invalidate_hand_areas(void)
+{
+    merge_areas(hand_areas, &num_hand_areas);
+    for (uint32_t i = 0; i < num_hand_areas; i++) {
+        lv_inv_area(display, &hand_areas[i]);
+    }
+    num_hand_areas = 0;
+}
+
+static void add_hand_segments(lv_obj_t *hand, int32_t angle)
+{
+    lv_area_t coords;
+    lv_point_t pivot;
+    int32_t w = lv_obj_get_width(hand);
+    int32_t h = lv_obj_get_height(hand);
+    bool vertical = h >= w;
+    int32_t len = vertical ? h : w;
+
+    lv_obj_get_coords(hand, &coords);
+    lv_image_get_pivot(hand, &pivot);
+
+    if (num_hand_areas + HAND_SEGMENTS > MAX_HAND_AREAS) {
+        invalidate_hand_areas();
+    }
+
+    for (int i = 0; i < HAND_SEGMENTS; i++) {
+        int32_t start = len * i / HAND_SEGMENTS;
+        int32_t end = len * (i + 1) / HAND_SEGMENTS;
+        lv_point_t corners[4] = {
+            vertical ? (lv_point_t){ 0, start } : (lv_point_t){ start, 0 },
+            vertical ? (lv_point_t){ w, start } : (lv_point_t){ start, h },
+            vertical ? (lv_point_t){ 0, end } : (lv_point_t){ end, 0 },
+            vertical ? (lv_point_t){ w, end } : (lv_point_t){ end, h },
+        };
+        lv_area_t *area = &hand_areas[num_hand_areas++];
+
+        area->x1 = INT32_MAX;
+        area->y1 = INT32_MAX;
+        area->x2 = INT32_MIN;
+        area->y2 = INT32_MIN;
+        for (int c = 0; c < ARRAY_SIZE(corners); c++) {
+            lv_point_transform(&corners[c], angle, LV_SCALE_NONE, LV_SCALE_NONE, &pivot, true);
+            area->x1 = MIN(area->x1, corners[c].x);
+            area->y1 = MIN(area->y1, corners[c].y);
+            area->x2 = MAX(area->x2, corners[c].x);
+            area->y2 = MAX(area->y2, corners[c].y);
+        }
+        lv_area_increase(area, HAND_MARGIN, HAND_MARGIN);
+        lv_area_move(area, coords.x1, coords.y1);
+    }
+}
+
+static void display_event_cb(lv_event_t *e)
+{
+    const lv_area_t *area = lv_event_get_param(e);
+
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_INVALIDATE_AREA:
+            if (!in_tick || tick_full_screen) {
+                break;
+            }
+            if (num_tick_areas < MAX_TICK_AREAS) {
+                tick_areas[num_tick_areas++] = *area;
+            } else {
+                tick_full_screen = true;
+            }
+            break;
+        case LV_EVENT_FLUSH_START: {
+            uint32_t bytes = lv_area_get_size(area) * lv_color_format_get_size(lv_display_get_color_format(display));
+            k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+            stats.flushed_bytes += bytes;
+            stats.flushes++;
+            k_spin_unlock(&stats_lock, key);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void zsw_watchface_planner_start(void)
+{
+    if (active) {
+        return;
+    }
+
+    display = lv_display_get_default();
+    if (display == NULL) {
+        return;
+    }
+
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(display, display_event_cb, LV_EVENT_FLUSH_START, NULL);
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    active_start_ms = k_uptime_get_32();
+    active = true;
+    k_spin_unlock(&stats_lock, key);
+}
+
+void zsw_watchface_planner_stop(void)
+{
+    if (!active) {
+        return;
+    }
+
+    lv_display_remove_event_cb_with_user_data(display, display_event_cb, NULL);
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    stats.active_ms += k_uptime_get_32() - active_start_ms;
+    active = false;
+    k_spin_unlock(&stats_lock, key);
+    in_tick = false;
+}
+
+void zsw_watchface_planner_begin_tick(void)
+{
+    in_tick = active;
+    num_tick_areas = 0;
+    tick_full_screen = false;
+}
+
+bool zsw_watchface_planner_end_tick(void)
+{
+    k_spinlock_key_t key;
+    uint32_t tick_px;
+
+    if (!in_tick) {
+        return true;
+    }
+
+    invalidate_hand_areas();
+    in_tick = false;
+
+    if (tick_full_screen) {
+        tick_px = lv_display_get_horizontal_resolution(display) * lv_display_get_vertical_resolution(display);
+    } else {
+        tick_px = union_size(tick_areas, num_tick_areas);
+    }
+
+    key = k_spin_lock(&stats_lock);
+    stats.ticks++;
+    stats.invalidated_px += tick_px;
+    stats.max_tick_px = MAX(stats.max_tick_px, tick_px);
+    if (tick_px == 0) {
+        stats.skipped_ticks++;
+    }
+    k_spin_unlock(&stats_lock, key);
+
+    return tick_px > 0;
+}
+
+void zsw_watchface_planner_set_rotation(lv_obj_t *hand, int32_t angle)
+{
+    lv_display_t *disp = lv_obj_get_display(hand);
+
+    angle %= 3600;
+    if (angle < 0) {
+        angle += 3600;
+    }
+
+    if (angle == lv_image_get_rotation(hand)) {
+        return;
+    }
+
+    // Scaled hands are left to LVGL, the segments assume the image is drawn at its size.
+    if (!active || lv_image_get_scale(hand) != LV_SCALE_NONE || lv_obj_has_flag(hand, LV_OBJ_FLAG_HIDDEN)) {
+        lv_image_set_rotation(hand, angle);
+        return;
+    }
+
+    lv_obj_update_layout(hand);
+    add_hand_segments(hand, lv_image_get_rotation(hand));
+
+    lv_display_enable_invalidation(disp, false);
+    lv_image_set_rotation(hand, angle);
+    lv_display_enable_invalidation(disp, true);
+
+    add_hand_segments(hand, angle);
+    if (!in_tick) {
+        invalidate_hand_areas();
+    }
+}
+
+void zsw_watchface_planner_get_stats(zsw_watchface_planner_stats_t *p_stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    *p_stats = stats;
+    if (active) {
+        p_stats->active_ms += k_uptime_get_32() - active_start_ms;
+    }
+    k_spin_unlock(&stats_lock, key);
+}
+
+void zsw_watchface_planner_reset_stats(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    memset(&stats, 0, sizeof(stats));
+    active_start_ms = k_uptime_get_32();
+    k_spin_unlock(&stats_lock, key);
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of ZSWatch project <https://github.com/zswatch/>.
+ * Copyright (c) 2025 ZSWatch Project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+/*
+ * Plans what a watchface redraws on each clock tick. A tick is the set_datetime call of the
+ * watchface. Rotated hands invalidate the merged bounding boxes of their segments instead of the
+ * whole image. Other areas, such as digit cells of changed labels, are invalidated by LVGL itself,
+ * which joins them with the hand areas by the same rule when it refreshes. Everything a tick
+ * invalidates is counted once. A tick that changes nothing visible invalidates nothing, so LVGL
+ * neither renders nor flushes.
+ */
+
+/** Redraw work counted while the watchface is shown, since start or zsw_watchface_planner_reset_stats. */
+typedef struct zsw_watchface_planner_stats_t {
+    uint32_t ticks;
+    uint32_t skipped_ticks;             /**< Ticks that invalidated nothing. */
+    uint64_t invalidated_px;            /**< Sum over ticks of the pixels in the union of invalidated areas. */
+    uint32_t max_tick_px;
+    uint64_t flushed_bytes;             /**< Pixel data sent to the display, for any reason. */
+    uint32_t flushes;
+    uint32_t active_ms;                 /**< Time the watchface was shown. */
+} zsw_watchface_planner_stats_t;
+
+/** @brief Start counting, called when the watchface is shown or wakes up. */
+void zsw_watchface_planner_start(void);
+
+/** @brief Stop counting, called when the watchface is removed or goes to sleep. */
+void zsw_watchface_planner_stop(void);
+
+/** @brief Start collecting the areas invalidated by a clock tick. */
+void zsw_watchface_planner_begin_tick(void);
+
+/** @brief  Invalidate the merged hand areas of the tick and count the pixels in the union of
+ *          everything the tick invalidated.
+ *  @return True if anything visible changed.
+*/
+bool zsw_watchface_planner_end_tick(void);
+
+/** @brief          Rotate a watch hand image, invalidating only where the hand was and where it is now.
+ *  @param hand     Image with its pivot set
+ *  @param angle    Rotation in 0.1 degree units, as for lv_image_set_rotation
+ *
+ *  The hand is cut into segments along its longer side, each rotated segment invalidates its own
+ *  bounding box instead of the whole rotated image.
+*/
+void zsw_watchface_planner_set_rotation(lv_obj_t *hand, int32_t angle);
+
+void zsw_watchface_planner_get_stats(zsw_watchface_planner_stats_t *p_stats);
+
+void zsw_watchface_planner_reset_stats(void);
@@ -68,6 +68,83 @@ bool zsw_clock_rtc_available(void)
 {
     return rtc_is_available;
 }
+
+/*
+ * The RTC only counts whole seconds. The start of the second is estimated on the kernel clock
+ * from reads that saw the seconds advance, it lies between such a read and the one before it.
+ * While that window is wide the estimate is moved early by half of it, readers waking up for the
+ * next second then narrow it down. Once a minute it is widened again to follow drift between
+ * the RTC and the kernel clock.
+ */
+#define RTC_SYNC_TOLERANCE_US   10000
+#define RTC_RESYNC_INTERVAL_US  (60 * USEC_PER_SEC)
+
+// Guards the estimate, the clock is read from several threads.
+static struct k_spinlock rtc_usec_lock;
+static int64_t rtc_second_start_us = -1;
+static int64_t rtc_uncertainty_us;
+static int64_t rtc_resync_us;
+static int64_t rtc_last_read_us;
+static int rtc_last_sec = -1;
+
+/*
+ * now_us is taken right after the RTC read. A read that lost the race against a newer one on
+ * another thread is not used to update the estimate.
+ */
+static uint32_t rtc_get_usec(const struct rtc_time *tm, int64_t now_us)
+{
+    k_spinlock_key_t key = k_spin_lock(&rtc_usec_lock);
+    uint32_t usec;
+
+    if (now_us < rtc_last_read_us) {
+        goto out;
+    }
+
+    if (rtc_last_sec >= 0 && (tm->tm_sec - rtc_last_sec + 60) % 60 == 1 &&
+        now_us - rtc_last_read_us < 2 * USEC_PER_SEC) {
+        int64_t start_us = now_us;
+
+        if (rtc_second_start_us >= 0) {
+            start_us = now_us - (now_us - rtc_second_start_us) % USEC_PER_SEC;
+        }
+        if (rtc_second_start_us < 0 || start_us <= rtc_last_read_us) {
+            // The second started after the previous read, the estimate was too early.
+            start_us = now_us;
+            rtc_uncertainty_us = now_us - rtc_last_read_us;
+        }
+        if (now_us - rtc_resync_us >= RTC_RESYNC_INTERVAL_US) {
+            rtc_uncertainty_us = MAX(rtc_uncertainty_us, 4 * RTC_SYNC_TOLERANCE_US);
+            rtc_resync_us = now_us;
+        }
+        if (rtc_uncertainty_us > RTC_SYNC_TOLERANCE_US) {
+            rtc_uncertainty_us /= 2;
+            start_us -= rtc_uncertainty_us;
+        }
+        rtc_second_start_us = start_us;
+    }
+    rtc_last_sec = tm->tm_sec;
+    rtc_last_read_us = now_us;
+
+out:
+    // A stale read may predate the estimated start of the second.
+    usec = rtc_second_start_us < 0 ? 0 :
+           ((now_us - rtc_second_start_us) % USEC_PER_SEC + USEC_PER_SEC) % USEC_PER_SEC;
+    k_spin_unlock(&rtc_usec_lock, key);
+
+    return usec;
+}
+
+/*
+ * Setting the RTC starts a new second, the old estimate no longer applies.
+ */
+static void rtc_reset_usec(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&rtc_usec_lock);
+
+    rtc_second_start_us = -1;
+    rtc_last_sec = -1;
+    k_spin_unlock(&rtc_usec_lock, key);
+}
 #endif
 
 void zsw_clock_set_time(zsw_timeval_t *ztm)
@@ -75,6 +152,7 @@ void zsw_clock_set_time(zsw_timeval_t *ztm)
 #if CONFIG_RTC
     if (rtc_is_available) {
         rtc_set_time(rtc, &ztm->tm);
+        rtc_reset_usec();
         return;
     }
 #endif
@@ -94,7 +172,10 @@ void zsw_clock_get_time(zsw_timeval_t *ztm)
 
         memset(&tm, 0, sizeof(struct rtc_time));
         if (rtc_get_time(rtc, &tm) == 0) {
+            int64_t read_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
             memcpy(ztm, &tm, sizeof(struct rtc_time));
+            ztm->tv_usec = rtc_get_usec(&tm, read_us);
         } else {
             LOG_WRN("RTC read failed, falling back to software clock");
             goto sw_fallback;
@@ -107,6 +188,7 @@ sw_fallback:
         gettimeofday(&tv, NULL);
         tm = localtime(&tv.tv_sec);
         memcpy(&ztm->tm, tm, sizeof(struct tm));
+        ztm->tv_usec = tv.tv_usec;
     }
 #else
     struct tm *tm;
@@ -115,6 +197,7 @@ sw_fallback:
     gettimeofday(&tv, NULL);
     tm = localtime(&tv.tv_sec);
     memcpy(ztm, tm, sizeof(struct tm));
+    ztm->tv_usec = tv.tv_usec;
 #endif
 
     // Add 1900 to the year because we want to count from 1900
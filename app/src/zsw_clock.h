@@ -32,7 +32,7 @@ typedef struct {
 #else
     struct tm   tm;         /**< Modified time object with 1900 added to the year*/
 #endif
-    uint32_t    tv_usec;
+    uint32_t    tv_usec;    /**< Microseconds into the second, estimated when the RTC only counts seconds */
 } zsw_timeval_t;
 
 /**
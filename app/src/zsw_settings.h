@@ -25,6 +25,10 @@ typedef int32_t zsw_settings_brightness_t;
 #define ZSW_SETTINGS_KEY_BRIGHTNESS "bri"
 #define ZSW_SETTINGS_BRIGHTNESS (ZSW_SETTINGS_PATH "/" ZSW_SETTINGS_KEY_BRIGHTNESS)
 
+typedef bool zsw_settings_auto_brightness_t;
+#define ZSW_SETTINGS_KEY_AUTO_BRIGHTNESS "auto_bri"
+#define ZSW_SETTINGS_AUTO_BRIGHTNESS (ZSW_SETTINGS_PATH "/" ZSW_SETTINGS_KEY_AUTO_BRIGHTNESS)
+
 typedef bool zsw_settings_vib_on_press_t;
 #define ZSW_SETTINGS_KEY_VIBRATION_ON_PRESS "vib"
 #define ZSW_SETTINGS_VIBRATE_ON_PRESS (ZSW_SETTINGS_PATH "/" ZSW_SETTINGS_KEY_VIBRATION_ON_PRESS)
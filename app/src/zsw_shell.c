@@ -12,6 +12,16 @@
 #ifdef CONFIG_RETENTION_BOOT_MODE
 #include <zephyr/retention/bootmode.h>
 #endif
+#if defined(CONFIG_ZSW_BMP581_EMUL) || defined(CONFIG_ZSW_APDS9306_EMUL)
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_sensor.h>
+#endif
+#ifdef CONFIG_GC9A01_EMUL
+#include <zephyr/drivers/display.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/sys/byteorder.h>
+#include "buydisplay_gc9a01.h"
+#endif
 
 #include "zsw_settings.h"
 #include <zsw_coredump.h>
@@ -19,11 +29,18 @@
 #include "fuel_gauge/zsw_pmic.h"
 #include "managers/zsw_power_manager.h"
 #include "managers/zsw_app_manager.h"
+#include "managers/zsw_brightness_manager.h"
 #include "drivers/zsw_vibration_motor.h"
 #include "drivers/zsw_display_control.h"
 #include "ui/zsw_ui_controller.h"
+#include "ui/watchfaces/zsw_watchface_planner.h"
+#include "applications/watchface/watchface_app.h"
 #include "events/battery_event.h"
 #include "events/pressure_event.h"
+#include "sensor_fusion/zsw_sensor_calibration.h"
+#include "sensors/zsw_sensor_scheduler.h"
+#include "sensors/zsw_altitude.h"
+#include "sensors/zsw_sensor_trace.h"
 
 ZBUS_CHAN_DECLARE(battery_sample_data_chan);
 ZBUS_CHAN_DECLARE(pressure_data_chan);
@@ -186,14 +203,401 @@ static int cmd_display_get_brightness(const struct shell *sh, size_t argc, char
     return 0;
 }
 
+static int cmd_display_render_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    zsw_display_render_stats_t stats;
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset") != 0) {
+            shell_error(sh, "Usage: display render_stats [reset]");
+            return -EINVAL;
+        }
+        zsw_display_control_reset_render_stats();
+        shell_print(sh, "Render counters reset");
+        return 0;
+    }
+
+    zsw_display_control_get_render_stats(&stats);
+    shell_print(sh, "LVGL renders: %u, %u started on a panel refresh, refresh slot %u us", stats.renders,
+                stats.renders_on_te, stats.slot_us);
+
+    return 0;
+}
+
+static int cmd_display_auto_brightness(const struct shell *sh, size_t argc, char **argv)
+{
+    zsw_brightness_manager_status_t status;
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "on") == 0) {
+            zsw_brightness_manager_set_enabled(true);
+        } else if (strcmp(argv[1], "off") == 0) {
+            zsw_brightness_manager_set_enabled(false);
+        } else {
+            shell_error(sh, "Invalid argument '%s' (expected on|off)", argv[1]);
+            return -EINVAL;
+        }
+    }
+
+    zsw_brightness_manager_get_status(&status);
+    shell_print(sh, "Auto brightness: %s%s", status.enabled ? "on" : "off", status.paused ? " (paused)" : "");
+    shell_print(sh, "Ambient light: %.1f lux", (double)status.lux);
+    shell_print(sh, "Backlight level: %u", status.level);
+    shell_print(sh, "Target level: %u", status.target_level);
+    shell_print(sh, "Fixed level: %u", status.fixed_level);
+    shell_print(sh, "Awake time: %u s", (uint32_t)(status.awake_ms / 1000));
+    if (status.fixed_level_ms > 0) {
+        shell_print(sh, "Backlight energy saved: %d%%",
+                    (int)(100 - (int64_t)(status.level_ms * 100 / status.fixed_level_ms)));
+    }
+
+    return 0;
+}
+
+#ifdef CONFIG_ZSW_APDS9306_EMUL
+static int cmd_display_emul_lux(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct emul *apds9306_emul = EMUL_DT_GET(DT_NODELABEL(apds9306));
+    struct sensor_chan_spec chan = {
+        .chan_type = SENSOR_CHAN_LIGHT,
+        .chan_idx = 0,
+    };
+    // Lux fits in 17 integer bits.
+    q31_t value = (q31_t)(strtof(argv[1], NULL) * (1 << (31 - 17)));
+    int ret = emul_sensor_backend_set_channel(apds9306_emul, chan, &value, 17);
+
+    if (ret != 0) {
+        shell_error(sh, "Failed to set emulated light (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Emulated light set to %s lux", argv[1]);
+
+    return 0;
+}
+#endif
+
+#ifdef CONFIG_GC9A01_EMUL
+#define BENCH_FRAMES        5
+#define BENCH_STRIP_ROWS    10
+#define BENCH_BLOCK_SIZE    40
+#define BENCH_BLOCKS        6
+#define BENCH_WIDTH         DT_PROP(DT_NODELABEL(gc9a01), width)
+#define BENCH_HEIGHT        DT_PROP(DT_NODELABEL(gc9a01), height)
+// Cost of every area when each display write resumed and suspended the bus on its own and sent
+// CASET, RASET and RAMWR as standalone commands, a transaction for each command and its data.
+#define BENCH_LEGACY_PM_TRANSITIONS 2
+#define BENCH_LEGACY_TRANSACTIONS   6
+#define BENCH_LEGACY_CMD_BYTES      (1 + 4 + 1 + 4 + 1)
+
+static uint16_t bench_buf[BENCH_WIDTH * BENCH_HEIGHT / 4];
+static uint32_t bench_mismatches;
+
+static uint16_t bench_pixel(uint16_t x, uint16_t y, uint8_t seed)
+{
+    return (uint16_t)(x * 31 + y * 7 + seed);
+}
+
+/*
+* Write one area as LVGL would and check what arrived in the emulated display memory.
+*/
+static int bench_write_area(const struct device *dev, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                            bool last, uint8_t seed)
+{
+    const uint16_t *framebuffer = gc9a01_emul_get_framebuffer(EMUL_DT_GET(DT_NODELABEL(gc9a01)));
+    struct display_buffer_descriptor desc = {
+        .buf_size = width * height * sizeof(uint16_t),
+        .width = width,
+        .height = height,
+        .pitch = width,
+        .frame_incomplete = !last,
+    };
+    int ret;
+
+    for (uint16_t row = 0; row < height; row++) {
+        for (uint16_t col = 0; col < width; col++) {
+            bench_buf[row * width + col] = sys_cpu_to_be16(bench_pixel(x + col, y + row, seed));
+        }
+    }
+
+    ret = display_write(dev, x, y, &desc, bench_buf);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (uint16_t row = 0; row < height; row++) {
+        for (uint16_t col = 0; col < width; col++) {
+            if (framebuffer[(y + row) * BENCH_WIDTH + x + col] != bench_pixel(x + col, y + row, seed)) {
+                bench_mismatches++;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void bench_print(const struct shell *sh, const char *name, const struct gc9a01_bus_stats *p_stats)
+{
+    uint32_t writes = p_stats->writes / p_stats->frames;
+
+    shell_print(sh, "%s: %u areas, %u PM transitions, %u transactions, %u command bytes, %u window skips per frame",
+                name, writes, p_stats->pm_transitions / p_stats->frames, p_stats->transactions / p_stats->frames,
+                p_stats->cmd_bytes / p_stats->frames, p_stats->window_skips / p_stats->frames);
+    shell_print(sh, "  Without frame sessions: %u PM transitions, %u transactions, %u command bytes per frame",
+                writes * BENCH_LEGACY_PM_TRANSITIONS, writes * BENCH_LEGACY_TRANSACTIONS,
+                writes * BENCH_LEGACY_CMD_BYTES);
+}
+
+static int cmd_display_bus_bench(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(gc9a01));
+    struct gc9a01_bus_stats stats;
+    int ret = 0;
+
+    if (!device_is_ready(dev)) {
+        shell_error(sh, "GC9A01 not ready");
+        return -ENODEV;
+    }
+
+    bench_mismatches = 0;
+
+    // Full redraw in strips, every strip continues right below the previous one.
+    gc9a01_reset_bus_stats(dev);
+    for (uint8_t frame = 0; frame < BENCH_FRAMES && ret == 0; frame++) {
+        for (uint16_t y = 0; y < BENCH_HEIGHT && ret == 0; y += BENCH_STRIP_ROWS) {
+            ret = bench_write_area(dev, 0, y, BENCH_WIDTH, BENCH_STRIP_ROWS, y + BENCH_STRIP_ROWS >= BENCH_HEIGHT,
+                                   frame);
+        }
+    }
+    gc9a01_get_bus_stats(dev, &stats);
+    if (ret == 0) {
+        bench_print(sh, "Contiguous strips", &stats);
+    }
+
+    // Small widgets spread over the screen, every area needs its own window.
+    gc9a01_reset_bus_stats(dev);
+    for (uint8_t frame = 0; frame < BENCH_FRAMES && ret == 0; frame++) {
+        for (uint16_t i = 0; i < BENCH_BLOCKS && ret == 0; i++) {
+            ret = bench_write_area(dev, i * BENCH_BLOCK_SIZE, (i * 70) % (BENCH_HEIGHT - BENCH_BLOCK_SIZE),
+                                   BENCH_BLOCK_SIZE, BENCH_BLOCK_SIZE, i == BENCH_BLOCKS - 1, frame);
+        }
+    }
+    gc9a01_get_bus_stats(dev, &stats);
+    if (ret == 0) {
+        bench_print(sh, "Scattered areas", &stats);
+    }
+
+    if (ret != 0) {
+        shell_error(sh, "Display write failed (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Mismatched pixels: %u", bench_mismatches);
+
+    return 0;
+}
+
+#ifdef CONFIG_GC9A01_TE
+#define TE_BENCH_FRAMES     60
+
+/*
+* Sweep a second hand around the dial, the quadrant holding it is redrawn every LVGL refresh.
+*/
+static int te_bench_run(const struct shell *sh, const struct device *dev, bool gate, const char *name)
+{
+    const struct emul *emul = EMUL_DT_GET(DT_NODELABEL(gc9a01));
+    uint32_t slot_us = gc9a01_te_get_slot_us(dev, CONFIG_LV_DEF_REFR_PERIOD * USEC_PER_MSEC);
+    uint32_t divisor = DIV_ROUND_CLOSEST(slot_us, gc9a01_te_get_period_us(dev));
+    struct gc9a01_emul_stats emul_stats;
+    struct gc9a01_bus_stats stats;
+    uint32_t slots;
+    int64_t start_ms;
+    int64_t elapsed_ms;
+    int ret = 0;
+
+    gc9a01_te_set_gate(dev, gate);
+    k_sleep(K_USEC(gc9a01_te_align(dev, 0)));
+    gc9a01_reset_bus_stats(dev);
+    gc9a01_emul_reset_stats(emul);
+
+    for (uint8_t frame = 0; frame < TE_BENCH_FRAMES && ret == 0; frame++) {
+        uint8_t quadrant = frame * 4 / TE_BENCH_FRAMES;
+        uint16_t x = quadrant < 2 ? BENCH_WIDTH / 2 : 0;
+        uint16_t y = (quadrant == 1 || quadrant == 2) ? BENCH_HEIGHT / 2 : 0;
+
+        start_ms = k_uptime_get();
+        ret = bench_write_area(dev, x, y, BENCH_WIDTH / 2, BENCH_HEIGHT / 2, true, frame);
+        elapsed_ms = k_uptime_get() - start_ms;
+        // Next slot as lvgl_render schedules it, the refresh timer in whole ms aligned up to the next panel
+        // refresh. A frame overrunning its slot drops the next one. The render stats cover the real LVGL path.
+        k_sleep(K_USEC(gc9a01_te_align(dev, MAX(0, (int64_t)(slot_us / USEC_PER_MSEC) - elapsed_ms) * USEC_PER_MSEC)));
+    }
+
+    gc9a01_te_set_gate(dev, true);
+    if (ret != 0) {
+        shell_error(sh, "Display write failed (%d)", ret);
+        return ret;
+    }
+
+    gc9a01_get_bus_stats(dev, &stats);
+    gc9a01_emul_get_stats(emul, &emul_stats);
+    slots = emul_stats.refreshes / divisor;
+    shell_print(sh, "%s: %u frames, %u panel refreshes, %u dropped, %u torn, %u waited for the scanline",
+                name, TE_BENCH_FRAMES, emul_stats.refreshes, slots > TE_BENCH_FRAMES ? slots - TE_BENCH_FRAMES : 0,
+                emul_stats.torn_writes, stats.te_waits);
+
+    return 0;
+}
+
+static int cmd_display_te_bench(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(gc9a01));
+    uint32_t period_us = gc9a01_te_get_period_us(dev);
+    int ret;
+
+    if (period_us == 0) {
+        shell_error(sh, "No tearing effect pulses from the GC9A01");
+        return -ENODATA;
+    }
+
+    shell_print(sh, "Panel refresh: %u us, LVGL refresh every %u us", period_us,
+                gc9a01_te_get_slot_us(dev, CONFIG_LV_DEF_REFR_PERIOD * USEC_PER_MSEC));
+
+    ret = te_bench_run(sh, dev, false, "Without TE gate");
+    if (ret == 0) {
+        ret = te_bench_run(sh, dev, true, "With TE gate");
+    }
+
+    return ret;
+}
+#endif
+#endif
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_display,
                                SHELL_CMD_ARG(set_brightness, NULL, "Set display brightness percent", cmd_display_set_brightness, 2, 0),
                                SHELL_CMD_ARG(get_brightness, NULL, "Get current display brightness", cmd_display_get_brightness, 1, 0),
+                               SHELL_CMD_ARG(render_stats, NULL, "Show or reset LVGL render counters: render_stats [reset]",
+                                             cmd_display_render_stats, 1, 1),
+                               SHELL_CMD_ARG(auto_brightness, NULL, "Show or set automatic brightness: auto_brightness [on|off]",
+                                             cmd_display_auto_brightness, 1, 1),
+#ifdef CONFIG_ZSW_APDS9306_EMUL
+                               SHELL_CMD_ARG(emul_lux, NULL, "Set the emulated ambient light: emul_lux <lux>",
+                                             cmd_display_emul_lux, 2, 0),
+#endif
+#ifdef CONFIG_GC9A01_EMUL
+                               SHELL_CMD_ARG(bus_bench, NULL, "Count SPI bus work per frame on the emulated GC9A01",
+                                             cmd_display_bus_bench, 1, 0),
+#endif
+#if defined(CONFIG_GC9A01_EMUL) && defined(CONFIG_GC9A01_TE)
+                               SHELL_CMD_ARG(te_bench, NULL, "Count dropped and torn frames on the emulated GC9A01",
+                                             cmd_display_te_bench, 1, 0),
+#endif
                                SHELL_SUBCMD_SET_END
                               );
 
 SHELL_CMD_REGISTER(display, &sub_display, "Display control commands", NULL);
 
+/* --- watchface commands --- */
+
+static int cmd_watchface_planner(const struct shell *sh, size_t argc, char **argv)
+{
+    zsw_watchface_planner_stats_t stats;
+    uint32_t frame_bytes;
+    uint32_t bytes_per_s;
+    uint32_t px_per_tick;
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset") != 0) {
+            shell_error(sh, "Usage: watchface planner [reset]");
+            return -EINVAL;
+        }
+        zsw_watchface_planner_reset_stats();
+        shell_print(sh, "Watchface redraw counters reset");
+        return 0;
+    }
+
+    zsw_watchface_planner_get_stats(&stats);
+    frame_bytes = DT_PROP(DT_CHOSEN(zephyr_display), width) * DT_PROP(DT_CHOSEN(zephyr_display), height) *
+                  sizeof(uint16_t);
+    bytes_per_s = stats.active_ms > 0 ? stats.flushed_bytes * MSEC_PER_SEC / stats.active_ms : 0;
+    px_per_tick = stats.ticks > 0 ? stats.invalidated_px / stats.ticks : 0;
+
+    shell_print(sh, "Ticks: %u, %u skipped as nothing visible changed", stats.ticks, stats.skipped_ticks);
+    shell_print(sh, "Invalidated per tick: %u px average, %u px max, of %u px", px_per_tick, stats.max_tick_px,
+                frame_bytes / sizeof(uint16_t));
+    shell_print(sh, "Flushed: %u areas, %u bytes per second, %u permille of a full frame per second", stats.flushes,
+                bytes_per_s, bytes_per_s * 1000 / frame_bytes);
+
+    return 0;
+}
+
+static int cmd_watchface_wakeups(const struct shell *sh, size_t argc, char **argv)
+{
+    const char *granularity_str[] = {"second", "minute", "sub-second"};
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset") != 0) {
+            shell_error(sh, "Usage: watchface wakeups [reset]");
+            return -EINVAL;
+        }
+        watchface_app_reset_wakeup_stats();
+        shell_print(sh, "Watchface wakeup counters reset");
+        return 0;
+    }
+
+    for (int i = 0; i < watchface_app_get_num_faces(); i++) {
+        watchface_app_wakeup_stats_t stats;
+        const lv_img_dsc_t *preview;
+        const char *name;
+        uint32_t per_hour;
+
+        if (watchface_app_get_face_info(i, &preview, &name) != 0 || watchface_app_get_wakeup_stats(i, &stats) != 0) {
+            continue;
+        }
+
+        per_hour = stats.shown_ms > 0 ? (uint64_t)stats.wakeups * 3600 * MSEC_PER_SEC / stats.shown_ms : 0;
+        shell_print(sh, "  [%d] %s (%s): %u wakeups in %u s shown, %u per hour%s", i, name,
+                    granularity_str[stats.granularity], stats.wakeups, stats.shown_ms / MSEC_PER_SEC, per_hour,
+                    i == watchface_app_get_current_face() ? " [current]" : "");
+    }
+
+    return 0;
+}
+
+static void watchface_select_async(void *p_index)
+{
+    watchface_change((int)(intptr_t)p_index);
+}
+
+static int cmd_watchface_select(const struct shell *sh, size_t argc, char **argv)
+{
+    char *endptr;
+    long index = strtol(argv[1], &endptr, 10);
+
+    if (*endptr != '\0' || index < 0 || index >= watchface_app_get_num_faces()) {
+        shell_error(sh, "Invalid watchface index '%s' (expected 0-%d)", argv[1], watchface_app_get_num_faces() - 1);
+        return -EINVAL;
+    }
+
+    // The watchface is replaced on the LVGL thread.
+    lv_async_call(watchface_select_async, (void *)(intptr_t)index);
+    shell_print(sh, "Selecting watchface %ld", index);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_watchface,
+                               SHELL_CMD_ARG(planner, NULL, "Show watchface redraw counters: planner [reset]",
+                                             cmd_watchface_planner, 1, 1),
+                               SHELL_CMD_ARG(wakeups, NULL, "Show clock wakeups per hour of each watchface: wakeups [reset]",
+                                             cmd_watchface_wakeups, 1, 1),
+                               SHELL_CMD_ARG(select, NULL, "Show the watchface at an index of the wakeups list: select <index>",
+                                             cmd_watchface_select, 2, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(watchface, &sub_watchface, "Watchface commands", NULL);
+
 static int cmd_coredump_init(const struct shell *sh, size_t argc, char **argv)
 {
     ARG_UNUSED(argc);
@@ -302,6 +706,261 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_cpu,
 
 SHELL_CMD_REGISTER(cpu, &sub_cpu, "CPU frequency commands", cmd_cpu_get_freq);
 
+static int cmd_sensor_sched_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    zsw_sensor_sched_stats_t stats;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(sh, "sensor, consumers, period_ms, latency_ms, powered, fetches, cache_hits, power_changes");
+    for (int i = 0; i < ZSW_SENSOR_SCHED_COUNT; i++) {
+        zsw_sensor_scheduler_get_stats(i, &stats);
+        shell_print(sh, "%s, %u, %u, %u, %d, %u, %u, %u", zsw_sensor_scheduler_sensor_name(i), stats.consumers,
+                    stats.period_ms, stats.max_latency_ms, stats.powered, stats.fetches, stats.cache_hits,
+                    stats.power_changes);
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_sensor_sched,
+                               SHELL_CMD_ARG(stats, NULL, "Show merged schedule and read counters per sensor",
+                                             cmd_sensor_sched_stats, 1, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(sensor_sched, &sub_sensor_sched, "Sensor scheduler commands", cmd_sensor_sched_stats);
+
+static int cmd_altitude_status(const struct shell *sh, size_t argc, char **argv)
+{
+    zsw_altitude_state_t state;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (zsw_altitude_get(&state) != 0) {
+        shell_error(sh, "No pressure samples yet");
+        return -ENODATA;
+    }
+
+    shell_print(sh, "Pressure:       %.2f hPa, %.1f C", (double)state.pressure, (double)state.temperature);
+    shell_print(sh, "Altitude:       %.2f m", (double)state.altitude);
+    shell_print(sh, "Vertical speed: %.2f m/s", (double)state.vertical_speed);
+    shell_print(sh, "Floors up: %u", state.floors_up);
+    shell_print(sh, "Floors down: %u", state.floors_down);
+    shell_print(sh, "History samples: %u", zsw_altitude_get_history_samples());
+
+    return 0;
+}
+
+static int cmd_altitude_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    zsw_altitude_reset();
+    shell_print(sh, "Altitude reference and floors reset");
+
+    return 0;
+}
+
+#ifdef CONFIG_ZSW_BMP581_EMUL
+static int cmd_altitude_emul(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct emul *bmp581_emul = EMUL_DT_GET(DT_NODELABEL(bmp581));
+    struct sensor_chan_spec chan = {
+        .chan_type = SENSOR_CHAN_PRESS,
+        .chan_idx = 0,
+    };
+    // Pressure fits in 11 integer bits.
+    q31_t value = (q31_t)(strtof(argv[1], NULL) * (1 << (31 - 11)));
+    int ret = emul_sensor_backend_set_channel(bmp581_emul, chan, &value, 11);
+
+    if (ret != 0) {
+        shell_error(sh, "Failed to set emulated pressure (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Emulated pressure moving to %s hPa", argv[1]);
+
+    return 0;
+}
+#endif
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_altitude,
+                               SHELL_CMD_ARG(status, NULL, "Show altitude, vertical speed and floors", cmd_altitude_status, 1,
+                                             0),
+                               SHELL_CMD_ARG(reset, NULL, "Zero the altitude and the floor counters", cmd_altitude_reset, 1, 0),
+#ifdef CONFIG_ZSW_BMP581_EMUL
+                               SHELL_CMD_ARG(emul, NULL, "Move the emulated pressure: altitude emul <hPa>", cmd_altitude_emul, 2,
+                                             0),
+#endif
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(altitude, &sub_altitude, "Pressure altitude and floors commands", cmd_altitude_status);
+
+#ifdef CONFIG_ZSW_SENSOR_TRACE
+
+static int cmd_sensor_trace_record(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t period_ms = argc > 2 ? strtoul(argv[2], NULL, 10) : 0;
+    uint32_t sensor_mask = 0;
+    int ret;
+
+    for (int i = 3; i < argc; i++) {
+        int sensor;
+
+        for (sensor = 0; sensor < ZSW_SENSOR_SCHED_COUNT; sensor++) {
+            if (strcmp(argv[i], zsw_sensor_scheduler_sensor_name(sensor)) == 0) {
+                break;
+            }
+        }
+        if (sensor == ZSW_SENSOR_SCHED_COUNT) {
+            shell_error(sh, "Unknown sensor: %s", argv[i]);
+            return -EINVAL;
+        }
+        sensor_mask |= BIT(sensor);
+    }
+
+    if (sensor_mask == 0) {
+        sensor_mask = BIT_MASK(ZSW_SENSOR_SCHED_COUNT);
+    }
+
+    ret = zsw_sensor_trace_record_start(argv[1], period_ms, sensor_mask);
+    if (ret != 0) {
+        shell_error(sh, "Failed to start recording (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Recording %s/%s", ZSW_SENSOR_TRACE_DIR, argv[1]);
+
+    return 0;
+}
+
+static int cmd_sensor_trace_replay(const struct shell *sh, size_t argc, char **argv)
+{
+    uint8_t speed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+    int ret = zsw_sensor_trace_replay_start(argv[1], speed);
+
+    if (ret != 0) {
+        shell_error(sh, "Failed to start replay (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Replaying %s/%s at %ux", ZSW_SENSOR_TRACE_DIR, argv[1], speed);
+
+    return 0;
+}
+
+static int cmd_sensor_trace_stop(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int ret = zsw_sensor_trace_stop();
+
+    if (ret != 0) {
+        shell_error(sh, "Failed to stop (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Sensor trace stopped");
+
+    return 0;
+}
+
+static int cmd_sensor_trace_status(const struct shell *sh, size_t argc, char **argv)
+{
+    static const char *const mode_names[] = { "idle", "recording", "replaying" };
+    zsw_sensor_trace_status_t status;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    zsw_sensor_trace_get_status(&status);
+    shell_print(sh, "Mode: %s", mode_names[status.mode]);
+    shell_print(sh, "Records: %u", status.records);
+    shell_print(sh, "Dropped: %u", status.dropped);
+    shell_print(sh, "Trace time: %u ms", status.elapsed_ms);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_sensor_trace,
+                               SHELL_CMD_ARG(record, NULL,
+                                             "Record sensor readings: record <name> [period_ms] [imu|mag|pressure|light ...]",
+                                             cmd_sensor_trace_record, 2, 5),
+                               SHELL_CMD_ARG(replay, NULL, "Replay a recording in place of the sensors: replay <name> [speed]",
+                                             cmd_sensor_trace_replay, 2, 1),
+                               SHELL_CMD_ARG(stop, NULL, "Stop recording or replaying", cmd_sensor_trace_stop, 1, 0),
+                               SHELL_CMD_ARG(status, NULL, "Show recorder or replay progress", cmd_sensor_trace_status, 1, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(sensor_trace, &sub_sensor_trace, "Sensor trace record and replay commands", cmd_sensor_trace_status);
+
+#endif /* CONFIG_ZSW_SENSOR_TRACE */
+
+#ifdef CONFIG_SENSOR_FUSION_ONLINE_CALIBRATION
+
+static int cmd_calib_status(const struct shell *sh, size_t argc, char **argv)
+{
+    zsw_sensor_fusion_calibration_t calibration;
+    zsw_sensor_calibration_status_t status;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    zsw_sensor_calibration_get(&calibration);
+    zsw_sensor_calibration_get_status(&status);
+
+    shell_print(sh, "Generation: %u", status.generation);
+    shell_print(sh, "Gyro:  %s, %u still periods, bias %.3f %.3f %.3f dps",
+                (status.flags & ZSW_SENSOR_FUSION_CALIBRATION_GYRO) ? "valid" : "none", status.gyro_updates,
+                (double)calibration.gyro_offset.axis.x, (double)calibration.gyro_offset.axis.y,
+                (double)calibration.gyro_offset.axis.z);
+    shell_print(sh, "Accel: %s, %.1f orientations, offset %.3f %.3f %.3f g",
+                (status.flags & ZSW_SENSOR_FUSION_CALIBRATION_ACCEL) ? "valid" : "none", (double)status.accel_samples,
+                (double)calibration.accel_offset.axis.x, (double)calibration.accel_offset.axis.y,
+                (double)calibration.accel_offset.axis.z);
+    shell_print(sh, "Mag:   %s, %.1f samples, hard iron %.1f %.1f %.1f uT",
+                (status.flags & ZSW_SENSOR_FUSION_CALIBRATION_MAG) ? "valid" : "none", (double)status.mag_samples,
+                (double)calibration.hard_iron.axis.x, (double)calibration.hard_iron.axis.y,
+                (double)calibration.hard_iron.axis.z);
+    shell_print(sh, "       last fit field %.1f uT, axis ratio %.3f, error %.4f", (double)status.mag_field,
+                (double)status.mag_axis_ratio, (double)status.mag_fit_error);
+
+    return 0;
+}
+
+static int cmd_calib_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int ret = zsw_sensor_calibration_reset();
+
+    if (ret != 0 && ret != -ENOENT) {
+        shell_error(sh, "Failed to erase stored calibration (%d)", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Sensor calibration cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_calib,
+                               SHELL_CMD_ARG(status, NULL, "Show learnt sensor calibration", cmd_calib_status, 1, 0),
+                               SHELL_CMD_ARG(reset, NULL, "Forget and erase the sensor calibration", cmd_calib_reset, 1, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(calib, &sub_calib, "Sensor fusion calibration commands", cmd_calib_status);
+
+#endif /* CONFIG_SENSOR_FUSION_ONLINE_CALIBRATION */
+
 #ifdef CONFIG_RETENTION_BOOT_MODE
 
 static void boot_work_handler(struct k_work *work)
@@ -610,3 +1269,317 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_mic,
 SHELL_CMD_REGISTER(mic, &sub_mic, "Microphone commands", NULL);
 
 #endif /* CONFIG_ZSW_MIC */
+
+/* --- history sync commands --- */
+#if defined(CONFIG_ZSW_HISTORY_SYNC)
+#include "ble/zsw_history_sync.h"
+
+static int cmd_history_sync_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    zsw_history_sync_stats_t stats;
+
+    shell_print(sh, "Sync active: %s", zsw_history_sync_is_active() ? "Yes" : "No");
+    if (zsw_history_sync_get_stats(&stats) != 0) {
+        shell_print(sh, "No finished sync yet");
+        return 0;
+    }
+
+    shell_print(sh, "Last sync of history %d:", stats.id);
+    shell_print(sh, "  Samples:       %u", stats.samples);
+    shell_print(sh, "  Duration:      %u ms", stats.duration_ms);
+    shell_print(sh, "  Notifications: %u", stats.notifications);
+    shell_print(sh, "  Conn events:   ~%u", stats.conn_events);
+    if (stats.samples > 0) {
+        shell_print(sh, "  Per 1000 samples: %llu ms, %llu notifications, ~%llu conn events",
+                    stats.duration_ms * 1000ULL / stats.samples,
+                    stats.notifications * 1000ULL / stats.samples,
+                    stats.conn_events * 1000ULL / stats.samples);
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_history_sync,
+                               SHELL_CMD_ARG(stats, NULL, "Show statistics of the last history sync", cmd_history_sync_stats,
+                                             1, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(history_sync, &sub_history_sync, "BLE history sync commands", NULL);
+
+#endif /* CONFIG_ZSW_HISTORY_SYNC */
+
+/* --- BLE connection parameter commands --- */
+#include "ble/ble_conn_params.h"
+
+static int cmd_ble_conn_params(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_conn_params_state_t state;
+
+    ble_conn_params_get_state(&state);
+    shell_print(sh, "Connection parameters:");
+    shell_print(sh, "  Interval:     %u.%02u ms", state.interval * 125 / 100, state.interval * 125 % 100);
+    shell_print(sh, "  Latency:      %u", state.latency);
+    shell_print(sh, "  Timeout:      %u ms", state.timeout * 10);
+    shell_print(sh, "  Active users: 0x%x", state.active_users);
+    shell_print(sh, "  Updates:      %u", state.num_updates);
+    return 0;
+}
+
+#if defined(CONFIG_ZSW_IMU_STREAM)
+#include "ble/zsw_imu_stream.h"
+
+static int cmd_ble_imu_stream(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    zsw_imu_stream_stats_t stats;
+
+    zsw_imu_stream_get_stats(&stats);
+    shell_print(sh, "IMU stream:");
+    shell_print(sh, "  Samples:      %u", stats.samples);
+    shell_print(sh, "  Packets:      %u", stats.packets);
+    shell_print(sh, "  Dropped:      %u", stats.dropped);
+    return 0;
+}
+#endif /* CONFIG_ZSW_IMU_STREAM */
+
+#include "ble/ble_comm.h"
+#include "ble/ble_reassembler.h"
+
+static int cmd_ble_rx(const struct shell *sh, size_t argc, char **argv)
+{
+    // One extra byte so the text based parsers always find a terminator.
+    uint8_t data[CONFIG_BT_L2CAP_TX_MTU + 1] = { 0 };
+    size_t len;
+
+    len = hex2bin(argv[1], strlen(argv[1]), data, sizeof(data) - 1);
+    if (len == 0) {
+        shell_error(sh, "Invalid hex data");
+        return -EINVAL;
+    }
+
+    ble_comm_receive(data, len);
+    return 0;
+}
+
+static int cmd_ble_reassembly(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_reassembler_stats_t stats;
+
+    ble_reassembler_get_stats(&stats);
+    shell_print(sh, "Reassembly:");
+    shell_print(sh, "  Completed:    %u", stats.completed);
+    shell_print(sh, "  Timeouts:     %u", stats.timeouts);
+    shell_print(sh, "  Aborted:      %u", stats.aborted);
+    shell_print(sh, "  Rejected:     %u", stats.rejected);
+    shell_print(sh, "  Duplicates:   %u", stats.duplicates);
+    return 0;
+}
+
+#if defined(CONFIG_ZSW_BLE_RX_BENCH)
+#include "ble/ble_rx_bench.h"
+
+static int cmd_ble_bench_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_rx_bench_reset();
+    return 0;
+}
+
+static int cmd_ble_bench_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_rx_bench_summary_t summary;
+
+    ble_rx_bench_get_summary(&summary);
+    shell_print(sh, "RX bench:");
+    shell_print(sh, "  Messages:     %u", summary.messages);
+    shell_print(sh, "  Dropped:      %u", summary.dropped);
+    shell_print(sh, "  Overflows:    %u", summary.overflows);
+    shell_print(sh, "  Queue:        max %u us", summary.queue_max_us);
+    shell_print(sh, "  Decode:       avg %u us, max %u us", summary.decode_avg_us, summary.decode_max_us);
+    shell_print(sh, "  Publish:      max %u us", summary.publish_max_us);
+    shell_print(sh, "  Stack unused: %u", summary.stack_unused);
+    return 0;
+}
+
+static int cmd_ble_bench_dump(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_rx_bench_sample_t sample;
+
+    shell_print(sh, "stream,len,queue_us,decode_us,publish_us,events");
+    for (uint32_t i = 0; ble_rx_bench_get_sample(i, &sample) == 0; i++) {
+        shell_print(sh, "%s,%u,%u,%u,%u,%u", sample.p_stream, sample.len, sample.queue_us, sample.decode_us,
+                    sample.publish_us, sample.events);
+    }
+    shell_print(sh, "end");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_ble_bench,
+                               SHELL_CMD_ARG(reset, NULL, "Clear recorded samples", cmd_ble_bench_reset, 1, 0),
+                               SHELL_CMD_ARG(stats, NULL, "Show latency, stack and drop summary", cmd_ble_bench_stats, 1, 0),
+                               SHELL_CMD_ARG(dump, NULL, "Print recorded samples as CSV", cmd_ble_bench_dump, 1, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+#endif /* CONFIG_ZSW_BLE_RX_BENCH */
+
+#include "ble/ble_http.h"
+
+static int cmd_ble_http(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_http_stats_t stats;
+
+    zsw_ble_http_get_stats(&stats);
+    shell_print(sh, "HTTP proxy:");
+    shell_print(sh, "  Requests:     %u", stats.requests);
+    shell_print(sh, "  Cache hits:   %u (%u%%)", stats.cache_hits,
+                stats.requests ? stats.cache_hits * 100 / stats.requests : 0);
+    shell_print(sh, "  Completed:    %u", stats.completed);
+    shell_print(sh, "  Errors:       %u", stats.errors);
+    shell_print(sh, "  Timeouts:     %u", stats.timeouts);
+    shell_print(sh, "  Dropped:      %u", stats.dropped);
+    shell_print(sh, "  Latency:      avg %u ms, max %u ms", stats.latency_avg_ms, stats.latency_max_ms);
+    shell_print(sh, "  Outstanding:  %u", stats.outstanding);
+    shell_print(sh, "  Queued:       %u", stats.queued);
+    return 0;
+}
+
+#include "ble/gadgetbridge/ble_gadgetbridge.h"
+
+// How ble_http.c used to fix up the response, a heap copy with strlen() in the loop and only \" handled.
+static void http_bench_legacy_unescape(const char *p_src)
+{
+    char *p_dst = k_malloc(strlen(p_src) + 1);
+    int i;
+    int j;
+
+    if (p_dst == NULL) {
+        return;
+    }
+
+    for (i = 0, j = 0; i < strlen(p_src) - 1;) {
+        if (p_src[i] == '\\' && p_src[i + 1] == '"') {
+            p_dst[j++] = '\"';
+            i += 2;
+        } else {
+            p_dst[j++] = p_src[i++];
+        }
+    }
+    p_dst[j > 0 ? j - 1 : 0] = '\0';
+
+    k_free(p_dst);
+}
+
+static int cmd_ble_http_bench(const struct shell *sh, size_t argc, char **argv)
+{
+    // Escaped like Gadgetbridge sends HTTP responses.
+    static const char chunk[] = "{\\\"t\\\":12.5},";
+    int size = argc > 1 ? strtol(argv[1], NULL, 10) : MAX_HTTP_FIELD_LENGTH;
+    int iterations = 100;
+    uint32_t start;
+    uint32_t cycles;
+    uint64_t ns;
+    uint64_t legacy_ns;
+    char *p_src;
+    char *p_dst;
+
+    if (size < (int)sizeof(chunk) || size > 16 * 1024) {
+        shell_error(sh, "Size must be %u-16384 bytes", (unsigned int)sizeof(chunk));
+        return -EINVAL;
+    }
+
+    p_src = k_malloc(size + 1);
+    p_dst = k_malloc(size + 1);
+    if (p_src == NULL || p_dst == NULL) {
+        k_free(p_src);
+        k_free(p_dst);
+        return -ENOMEM;
+    }
+
+    for (int i = 0; i < size; i++) {
+        p_src[i] = chunk[i % (sizeof(chunk) - 1)];
+    }
+    p_src[size - 1] = '"';
+    p_src[size] = '\0';
+
+    start = k_cycle_get_32();
+    for (int i = 0; i < iterations; i++) {
+        ble_gadgetbridge_unescape_string(p_src, p_dst, size + 1);
+    }
+    cycles = k_cycle_get_32() - start;
+    ns = k_cyc_to_ns_floor64(cycles) / iterations;
+
+    start = k_cycle_get_32();
+    for (int i = 0; i < iterations; i++) {
+        http_bench_legacy_unescape(p_src);
+    }
+    cycles = k_cycle_get_32() - start;
+    legacy_ns = k_cyc_to_ns_floor64(cycles) / iterations;
+
+    shell_print(sh, "Unescaped %d bytes in %llu us, %llu us/KB", size, ns / 1000, ns * 1024 / size / 1000);
+    shell_print(sh, "Before: %llu us, %llu us/KB", legacy_ns / 1000, legacy_ns * 1024 / size / 1000);
+
+    k_free(p_src);
+    k_free(p_dst);
+    return 0;
+}
+
+#include "ble/ble_log_backend.h"
+
+static int cmd_ble_log(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    ble_log_backend_stats_t stats;
+
+    ble_log_backend_get_stats(&stats);
+    shell_print(sh, "BLE log backend:");
+    shell_print(sh, "  Frames:       %u", stats.frames);
+    shell_print(sh, "  Bytes:        %u", stats.bytes);
+    shell_print(sh, "  Dropped:      %u bytes, %u messages", stats.dropped_bytes, stats.dropped_messages);
+    shell_print(sh, "  Rate limited: %u bytes", stats.rate_limited_bytes);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_ble,
+                               SHELL_CMD_ARG(log, NULL, "Show BLE log backend statistics", cmd_ble_log, 1, 0),
+                               SHELL_CMD_ARG(http_bench, NULL, "Time unescaping of an HTTP response: ble http_bench [bytes]",
+                                             cmd_ble_http_bench, 1, 1),
+                               SHELL_CMD_ARG(http, NULL, "Show HTTP proxy request, cache and latency statistics",
+                                             cmd_ble_http, 1, 0),
+                               SHELL_CMD_ARG(rx, NULL, "Inject one packet as if written by the phone: ble rx <hex>",
+                                             cmd_ble_rx, 2, 0),
+                               SHELL_CMD_ARG(reassembly, NULL, "Show fragment reassembly statistics",
+                                             cmd_ble_reassembly, 1, 0),
+                               SHELL_COND_CMD(CONFIG_ZSW_BLE_RX_BENCH, bench, &sub_ble_bench,
+                                              "Parse latency of injected phone messages", NULL),
+                               SHELL_CMD_ARG(conn_params, NULL, "Show applied connection parameters and active users",
+                                             cmd_ble_conn_params, 1, 0),
+                               SHELL_COND_CMD_ARG(CONFIG_ZSW_IMU_STREAM, imu_stream, NULL,
+                                                  "Show statistics of the raw IMU stream", cmd_ble_imu_stream, 1, 0),
+                               SHELL_SUBCMD_SET_END
+                              );
+
+SHELL_CMD_REGISTER(ble, &sub_ble, "BLE commands", NULL);
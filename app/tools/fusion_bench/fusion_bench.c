@@ -0,0 +1,368 @@
+/*
+ * fusion_bench — compare the lean on-watch fusion path against the full float path.
+ *
+ * Replays an IMU trace recorded with scripts/sensor_fusion_analyze.py (the RTT
+ * format written by zsw_sensor_fusion.c with CONFIG_SEND_SENSOR_READING_OVER_RTT):
+ *     t, roll, pitch, yaw, gx, gy, gz, ax, ay, az[, mx, my, mz]
+ * gyroscope in deg/s, accelerometer in g, one sample per line.
+ *
+ * "full" is what the watch did for every sample before: calibration of all three
+ * sensors, offset correction, AHRS update, quaternion, Euler angles, earth
+ * acceleration and compass heading.
+ * "lean" is zsw_sensor_fusion_core_update() as built on the watch by default,
+ * with only the quaternion read back per sample.
+ *
+ * Build:
+ *     cmake -S app/tools/fusion_bench -B build_fusion_bench
+ *     cmake --build build_fusion_bench
+ *
+ * Usage:
+ *     ./fusion_bench collected_<date>.csv [--no-mag] [--repeat N]
+ *     ./fusion_bench --synthetic [--no-mag] [--repeat N]
+ *
+ * Output is the time per update for both paths (and TSC cycles on x86_64) and
+ * how far the lean orientation strays from the full one, which stays 0 as long as
+ * the lean path does the same math. Accuracy needs a known orientation, so only
+ * the synthetic rotation reports the error of each path against its ground truth,
+ * leaving out the first seconds while the AHRS converges.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "sensor_fusion/zsw_sensor_fusion_core.h"
+
+#define SAMPLE_RATE_HZ      100
+#define SYNTHETIC_SAMPLES   (60 * SAMPLE_RATE_HZ)
+// The AHRS starts with a high gain and needs a while to settle.
+#define CONVERGE_SAMPLES    (5 * SAMPLE_RATE_HZ)
+
+typedef struct {
+    float delta_time_s;
+    FusionVector gyroscope;
+    FusionVector accelerometer;
+    FusionVector magnetometer;
+    FusionQuaternion truth;             // Sensor to earth, synthetic samples only.
+} bench_sample_t;
+
+typedef struct {
+    double sum;
+    float max;
+    int count;
+} error_stats_t;
+
+typedef struct {
+    FusionOffset offset;
+    FusionAhrs ahrs;
+} full_fusion_t;
+
+static const FusionMatrix identity = {.element.xx = 1.0f, .element.yy = 1.0f, .element.zz = 1.0f};
+static const FusionVector ones = {{1.0f, 1.0f, 1.0f}};
+static const FusionVector zeros = {{0.0f, 0.0f, 0.0f}};
+
+// Keeps the compiler from dropping the outputs the full path calculates.
+static volatile float sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t now_cycles(void)
+{
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int load_trace(const char *path, bool *has_mag, bench_sample_t **pp_samples)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+    size_t capacity = 1024;
+    size_t count = 0;
+    double prev_t = 0;
+    bench_sample_t *samples;
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    samples = malloc(capacity * sizeof(*samples));
+    *has_mag = true;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        double v[13];
+        int n = sscanf(line, "%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf",
+                       &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10], &v[11], &v[12]);
+        if (n != 10 && n != 13) {
+            continue;
+        }
+        if (n == 10) {
+            *has_mag = false;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            samples = realloc(samples, capacity * sizeof(*samples));
+        }
+
+        bench_sample_t *s = &samples[count];
+        s->delta_time_s = count == 0 || v[0] <= prev_t ? 1.0f / SAMPLE_RATE_HZ : (float)(v[0] - prev_t);
+        s->gyroscope = (FusionVector) {{v[4], v[5], v[6]}};
+        s->accelerometer = (FusionVector) {{v[7], v[8], v[9]}};
+        s->magnetometer = n == 13 ? (FusionVector) {{v[10], v[11], v[12]}} : zeros;
+        prev_t = v[0];
+        count++;
+    }
+    fclose(f);
+
+    *pp_samples = samples;
+    return (int)count;
+}
+
+// Slow wrist rotation around all axes with sensor noise, gravity and earth field rotated along.
+static int make_synthetic(bench_sample_t **pp_samples)
+{
+    bench_sample_t *samples = malloc(SYNTHETIC_SAMPLES * sizeof(*samples));
+    FusionQuaternion truth = FUSION_IDENTITY_QUATERNION;
+
+    srand(1);
+
+    for (int i = 0; i < SYNTHETIC_SAMPLES; i++) {
+        const float t = (float)i / SAMPLE_RATE_HZ;
+        const FusionVector rate = {{
+                60.0f * sinf(0.5f * t), 45.0f * sinf(0.31f * t), 90.0f * sinf(0.17f * t)
+            }
+        };
+        // Integrate the noise free rate as ground truth to rotate gravity and magnetic field.
+        const FusionVector half = FusionVectorMultiplyScalar(rate, 0.5f * FusionDegreesToRadians(1.0f) / SAMPLE_RATE_HZ);
+        truth = FusionQuaternionNormalise(FusionQuaternionAdd(truth, FusionQuaternionMultiplyVector(truth, half)));
+        const FusionMatrix r = FusionQuaternionToMatrix(truth);
+        const FusionMatrix rt = {.element = {
+                .xx = r.element.xx, .xy = r.element.yx, .xz = r.element.zx,
+                .yx = r.element.xy, .yy = r.element.yy, .yz = r.element.zy,
+                .zx = r.element.xz, .zy = r.element.yz, .zz = r.element.zz,
+            }
+        };
+        const FusionVector gravity = {{0.0f, 0.0f, 1.0f}};
+        const FusionVector field = {{20.0f, 0.0f, -40.0f}};
+
+        samples[i].delta_time_s = 1.0f / SAMPLE_RATE_HZ;
+        samples[i].gyroscope = FusionVectorAdd(rate, (FusionVector) {{
+                (rand() % 100 - 50) * 0.01f, (rand() % 100 - 50) * 0.01f, (rand() % 100 - 50) * 0.01f
+            }
+        });
+        samples[i].accelerometer = FusionVectorAdd(FusionMatrixMultiplyVector(rt, gravity), (FusionVector) {{
+                (rand() % 100 - 50) * 0.0002f, (rand() % 100 - 50) * 0.0002f, (rand() % 100 - 50) * 0.0002f
+            }
+        });
+        samples[i].magnetometer = FusionMatrixMultiplyVector(rt, field);
+        samples[i].truth = truth;
+    }
+
+    *pp_samples = samples;
+    return SYNTHETIC_SAMPLES;
+}
+
+static void full_init(full_fusion_t *p_full)
+{
+    const FusionAhrsSettings settings = {
+        .convention = FusionConventionNwu,
+        .gain = 0.5f,
+        .gyroscopeRange = 2000.0f,
+        .accelerationRejection = 10.0f,
+        .magneticRejection = 10.0f,
+        .recoveryTriggerPeriod = 5 * SAMPLE_RATE_HZ,
+    };
+
+    FusionOffsetInitialise(&p_full->offset, SAMPLE_RATE_HZ);
+    FusionAhrsInitialise(&p_full->ahrs);
+    FusionAhrsSetSettings(&p_full->ahrs, &settings);
+}
+
+static FusionQuaternion full_update(full_fusion_t *p_full, const bench_sample_t *s, bool use_mag)
+{
+    FusionVector gyroscope = FusionCalibrationInertial(s->gyroscope, identity, ones, zeros);
+    const FusionVector accelerometer = FusionCalibrationInertial(s->accelerometer, identity, ones, zeros);
+    const FusionVector magnetometer = FusionCalibrationMagnetic(s->magnetometer, identity, zeros);
+
+    gyroscope = FusionOffsetUpdate(&p_full->offset, gyroscope);
+    if (use_mag) {
+        FusionAhrsUpdate(&p_full->ahrs, gyroscope, accelerometer, magnetometer, s->delta_time_s);
+    } else {
+        FusionAhrsUpdateNoMagnetometer(&p_full->ahrs, gyroscope, accelerometer, s->delta_time_s);
+    }
+
+    const FusionQuaternion q = FusionAhrsGetQuaternion(&p_full->ahrs);
+    const FusionEuler euler = FusionQuaternionToEuler(q);
+    const FusionVector earth = FusionAhrsGetEarthAcceleration(&p_full->ahrs);
+
+    sink = euler.angle.yaw + earth.axis.z;
+    if (use_mag) {
+        sink = FusionCompassCalculateHeading(FusionConventionNwu, accelerometer, magnetometer);
+    }
+
+    return q;
+}
+
+static FusionQuaternion lean_update(zsw_sensor_fusion_core_t *p_core, const bench_sample_t *s, bool use_mag)
+{
+    zsw_sensor_fusion_core_update(p_core, s->gyroscope, s->accelerometer, use_mag ? &s->magnetometer : NULL,
+                                  s->delta_time_s);
+    return FusionAhrsGetQuaternion(&p_core->ahrs);
+}
+
+static float angle_between_deg(FusionQuaternion a, FusionQuaternion b)
+{
+    float dot = fabsf(a.element.w * b.element.w + a.element.x * b.element.x +
+                      a.element.y * b.element.y + a.element.z * b.element.z);
+
+    if (dot > 1.0f) {
+        dot = 1.0f;
+    }
+    return FusionRadiansToDegrees(2.0f * acosf(dot));
+}
+
+// Angle between where the two orientations point the sensor z axis in the earth frame, heading ignored.
+static float tilt_between_deg(FusionQuaternion a, FusionQuaternion b)
+{
+    const FusionVector up = {{0.0f, 0.0f, 1.0f}};
+    const FusionVector a_up = FusionMatrixMultiplyVector(FusionQuaternionToMatrix(a), up);
+    const FusionVector b_up = FusionMatrixMultiplyVector(FusionQuaternionToMatrix(b), up);
+    float dot = FusionVectorDotProduct(a_up, b_up);
+
+    dot = dot > 1.0f ? 1.0f : (dot < -1.0f ? -1.0f : dot);
+    return FusionRadiansToDegrees(acosf(dot));
+}
+
+static void error_add(error_stats_t *p_stats, float err)
+{
+    p_stats->sum += err;
+    p_stats->max = err > p_stats->max ? err : p_stats->max;
+    p_stats->count++;
+}
+
+static double error_mean(const error_stats_t *p_stats)
+{
+    return p_stats->count > 0 ? p_stats->sum / p_stats->count : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    bool synthetic = false;
+    bool no_mag = false;
+    bool has_mag;
+    int repeat = 20;
+    bench_sample_t *samples;
+    int num_samples;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--synthetic") == 0) {
+            synthetic = true;
+        } else if (strcmp(argv[i], "--no-mag") == 0) {
+            no_mag = true;
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (synthetic) {
+        has_mag = true;
+        num_samples = make_synthetic(&samples);
+    } else if (path != NULL) {
+        num_samples = load_trace(path, &has_mag, &samples);
+    } else {
+        fprintf(stderr, "Usage: %s <trace.csv> | --synthetic [--no-mag] [--repeat N]\n", argv[0]);
+        return 1;
+    }
+
+    if (num_samples <= 0) {
+        fprintf(stderr, "No samples\n");
+        return 1;
+    }
+
+    const bool use_mag = has_mag && !no_mag;
+    full_fusion_t full;
+    zsw_sensor_fusion_core_t core;
+    uint64_t full_ns = 0, lean_ns = 0, full_cycles = 0, lean_cycles = 0;
+    error_stats_t diff = {0};
+    error_stats_t full_err = {0};
+    error_stats_t lean_err = {0};
+
+    // Both paths fed the same samples side by side.
+    full_init(&full);
+    zsw_sensor_fusion_core_init(&core, SAMPLE_RATE_HZ);
+    for (int i = 0; i < num_samples; i++) {
+        const FusionQuaternion qf = full_update(&full, &samples[i], use_mag);
+        const FusionQuaternion ql = lean_update(&core, &samples[i], use_mag);
+
+        error_add(&diff, angle_between_deg(qf, ql));
+        if (synthetic && i >= CONVERGE_SAMPLES) {
+            // Without the magnetometer the heading drifts freely, so only tilt is comparable.
+            const FusionQuaternion truth = samples[i].truth;
+
+            error_add(&full_err, use_mag ? angle_between_deg(qf, truth) : tilt_between_deg(qf, truth));
+            error_add(&lean_err, use_mag ? angle_between_deg(ql, truth) : tilt_between_deg(ql, truth));
+        }
+    }
+
+    // Speed, each path on its own so they don't share caches and branch history per sample.
+    for (int r = 0; r < repeat; r++) {
+        uint64_t start_ns, start_cycles;
+
+        full_init(&full);
+        start_ns = now_ns();
+        start_cycles = now_cycles();
+        for (int i = 0; i < num_samples; i++) {
+            full_update(&full, &samples[i], use_mag);
+        }
+        full_cycles += now_cycles() - start_cycles;
+        full_ns += now_ns() - start_ns;
+
+        zsw_sensor_fusion_core_init(&core, SAMPLE_RATE_HZ);
+        start_ns = now_ns();
+        start_cycles = now_cycles();
+        for (int i = 0; i < num_samples; i++) {
+            lean_update(&core, &samples[i], use_mag);
+        }
+        lean_cycles += now_cycles() - start_cycles;
+        lean_ns += now_ns() - start_ns;
+    }
+
+    const double updates = (double)num_samples * repeat;
+
+    printf("samples: %d, magnetometer: %s, repeat: %d\n", num_samples, use_mag ? "yes" : "no", repeat);
+    printf("path, ns/update, cycles/update\n");
+    printf("full, %.1f, %.1f\n", full_ns / updates, full_cycles / updates);
+    printf("lean, %.1f, %.1f\n", lean_ns / updates, lean_cycles / updates);
+    printf("speedup: %.2fx\n", lean_ns > 0 ? (double)full_ns / lean_ns : 0.0);
+    printf("lean vs full difference deg: mean %.4f, max %.4f\n", error_mean(&diff), diff.max);
+    if (synthetic) {
+        printf("%s error vs ground truth deg, after %d s:\n", use_mag ? "orientation" : "tilt",
+               CONVERGE_SAMPLES / SAMPLE_RATE_HZ);
+        printf("full, mean %.3f, max %.3f\n", error_mean(&full_err), full_err.max);
+        printf("lean, mean %.3f, max %.3f\n", error_mean(&lean_err), lean_err.max);
+    } else {
+        printf("no ground truth in a recorded trace, accuracy is only reported with --synthetic\n");
+    }
+
+    free(samples);
+    return 0;
+}